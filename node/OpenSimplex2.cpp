@@ -278,13 +278,17 @@ namespace {
         return grads[gi] * dx + grads[gi + 1] * dy;
     }
 
-    inline float grad3(int64_t seed, int64_t xrvp, int64_t yrvp, int64_t zrvp, float dx, float dy, float dz) {
+    inline const float* gradient3(int64_t seed, int64_t xrvp, int64_t yrvp, int64_t zrvp) {
         int64_t hash = (seed ^ xrvp) ^ (yrvp ^ zrvp);
         hash = (int64_t)((uint64_t)hash * (uint64_t)HASH_MULTIPLIER);
         hash ^= hash >> (64 - N_GRADS_3D_EXPONENT + 2);
         int gi = (int)(hash & ((N_GRADS_3D - 1) << 2));
-        const auto& grads = getGradients().gradients3D;
-        return grads[gi] * dx + grads[gi + 1] * dy + grads[gi + 2] * dz;
+        return &getGradients().gradients3D[gi];
+    }
+
+    inline float grad3(int64_t seed, int64_t xrvp, int64_t yrvp, int64_t zrvp, float dx, float dy, float dz) {
+        const float* g = gradient3(seed, xrvp, yrvp, zrvp);
+        return g[0] * dx + g[1] * dy + g[2] * dz;
     }
     
     inline float grad4(int64_t seed, int64_t xsvp, int64_t ysvp, int64_t zsvp, int64_t wsvp, float dx, float dy, float dz, float dw) {
@@ -354,7 +358,35 @@ float OpenSimplex2::noise2_ImproveX(int64_t seed, double x, double y) {
     return noise2_UnskewedBase(seed, yy + xx, yy - xx);
 }
 
-float OpenSimplex2::noise3_UnrotatedBase(int64_t seed_arg, double xr, double yr, double zr) {
+namespace {
+    // Kernel accumulators for the 3D base: plain value, or value plus the
+    // analytic gradient w.r.t. the rotated input (d/d(xr, yr, zr)).
+    // Each kernel is a^4 * dot(g, d) with a = R^2 - |d|^2.
+    struct ValueAccum3 {
+        float value = 0.0f;
+        inline void add(float a, int64_t seed, int64_t xrvp, int64_t yrvp, int64_t zrvp, float dx, float dy, float dz) {
+            value += (a * a) * (a * a) * grad3(seed, xrvp, yrvp, zrvp, dx, dy, dz);
+        }
+    };
+
+    struct GradientAccum3 {
+        float value = 0.0f;
+        float gx = 0.0f, gy = 0.0f, gz = 0.0f;
+        inline void add(float a, int64_t seed, int64_t xrvp, int64_t yrvp, int64_t zrvp, float dx, float dy, float dz) {
+            const float* g = gradient3(seed, xrvp, yrvp, zrvp);
+            float d = g[0] * dx + g[1] * dy + g[2] * dz;
+            float a2 = a * a;
+            float a4 = a2 * a2;
+            float k = -8.0f * a2 * a * d;
+            value += a4 * d;
+            gx += a4 * g[0] + k * dx;
+            gy += a4 * g[1] + k * dy;
+            gz += a4 * g[2] + k * dz;
+        }
+    };
+
+template <typename Accum>
+inline void noise3Base(int64_t seed_arg, double xr, double yr, double zr, Accum& acc) {
     int64_t seed = seed_arg;
     int xrb = fastRound(xr);
     int yrb = fastRound(yr);
@@ -375,12 +407,11 @@ float OpenSimplex2::noise3_UnrotatedBase(int64_t seed_arg, double xr, double yr,
     int64_t yrbp = (int64_t)((uint64_t)yrb * (uint64_t)PRIME_Y);
     int64_t zrbp = (int64_t)((uint64_t)zrb * (uint64_t)PRIME_Z);
 
-    float value = 0.0f;
     float a = (RSQUARED_3D - xri * xri) - (yri * yri + zri * zri);
     
     for (int l = 0; ; l++) {
         if (a > 0.0f) {
-            value += (a * a) * (a * a) * grad3(seed, xrbp, yrbp, zrbp, xri, yri, zri);
+            acc.add(a, seed, xrbp, yrbp, zrbp, xri, yri, zri);
         }
 
         if (ax0 >= ay0 && ax0 >= az0) {
@@ -388,19 +419,19 @@ float OpenSimplex2::noise3_UnrotatedBase(int64_t seed_arg, double xr, double yr,
             if (b > 1.0f) {
                 b -= 1.0f;
                 // Note: explicit casting to handle operator precedence and signed/unsigned mix
-                value += (b * b) * (b * b) * grad3(seed, xrbp - (int64_t)xNSign * PRIME_X, yrbp, zrbp, xri + (float)xNSign, yri, zri);
+                acc.add(b, seed, xrbp - (int64_t)xNSign * PRIME_X, yrbp, zrbp, xri + (float)xNSign, yri, zri);
             }
         } else if (ay0 > ax0 && ay0 >= az0) {
             float b = a + ay0 + ay0;
             if (b > 1.0f) {
                 b -= 1.0f;
-                value += (b * b) * (b * b) * grad3(seed, xrbp, yrbp - (int64_t)yNSign * PRIME_Y, zrbp, xri, yri + (float)yNSign, zri);
+                acc.add(b, seed, xrbp, yrbp - (int64_t)yNSign * PRIME_Y, zrbp, xri, yri + (float)yNSign, zri);
             }
         } else {
             float b = a + az0 + az0;
             if (b > 1.0f) {
                 b -= 1.0f;
-                value += (b * b) * (b * b) * grad3(seed, xrbp, yrbp, zrbp - (int64_t)zNSign * PRIME_Z, xri, yri, zri + (float)zNSign);
+                acc.add(b, seed, xrbp, yrbp, zrbp - (int64_t)zNSign * PRIME_Z, xri, yri, zri + (float)zNSign);
             }
         }
 
@@ -426,8 +457,13 @@ float OpenSimplex2::noise3_UnrotatedBase(int64_t seed_arg, double xr, double yr,
         
         seed ^= SEED_FLIP_3D;
     }
+}
+}
 
-    return value;
+float OpenSimplex2::noise3_UnrotatedBase(int64_t seed, double xr, double yr, double zr) {
+    ValueAccum3 acc;
+    noise3Base(seed, xr, yr, zr, acc);
+    return acc.value;
 }
 
 float OpenSimplex2::noise3_ImproveXY(int64_t seed, double x, double y, double z) {
@@ -450,6 +486,26 @@ float OpenSimplex2::noise3_ImproveXZ(int64_t seed, double x, double y, double z)
     return noise3_UnrotatedBase(seed, xr, yr, zr);
 }
 
+float OpenSimplex2::noise3_ImproveXZ(int64_t seed, double x, double y, double z, float gradient[3]) {
+    double xz = x + z;
+    double s2 = xz * ROTATE_3D_ORTHOGONALIZER;
+    double yy = y * ROOT3OVER3;
+    double xr = x + s2 + yy;
+    double zr = z + s2 + yy;
+    double yr = xz * -ROOT3OVER3 + yy;
+
+    GradientAccum3 acc;
+    noise3Base(seed, xr, yr, zr, acc);
+
+    // Chain rule through the (linear) ImproveXZ rotation
+    const float k = (float)ROTATE_3D_ORTHOGONALIZER;
+    const float r = (float)ROOT3OVER3;
+    gradient[0] = acc.gx * (1.0f + k) - acc.gy * r + acc.gz * k;
+    gradient[1] = (acc.gx + acc.gy + acc.gz) * r;
+    gradient[2] = acc.gx * k - acc.gy * r + acc.gz * (1.0f + k);
+    return acc.value;
+}
+
 float OpenSimplex2::noise3_Fallback(int64_t seed, double x, double y, double z) {
     double r = FALLBACK_ROTATE_3D * (x + y + z);
     return noise3_UnrotatedBase(seed, r - x, r - y, r - z);
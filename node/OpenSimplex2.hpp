@@ -19,6 +19,8 @@ public:
     // 3D Noise
     static float noise3_ImproveXY(int64_t seed, double x, double y, double z);
     static float noise3_ImproveXZ(int64_t seed, double x, double y, double z);
+    // Same as above, also writes the analytic gradient d/dx, d/dy, d/dz
+    static float noise3_ImproveXZ(int64_t seed, double x, double y, double z, float gradient[3]);
     static float noise3_Fallback(int64_t seed, double x, double y, double z);
 
     // 4D Noise
@@ -50,6 +52,8 @@ public:
     // 3D Noise
     static float noise3_ImproveXY(int64_t seed, double x, double y, double z);
     static float noise3_ImproveXZ(int64_t seed, double x, double y, double z);
+    // Same as above, also writes the analytic gradient d/dx, d/dy, d/dz
+    static float noise3_ImproveXZ(int64_t seed, double x, double y, double z, float gradient[3]);
     static float noise3_Fallback(int64_t seed, double x, double y, double z);
 
     // 4D Noise
@@ -569,13 +569,17 @@ namespace {
         return grads[gi] * dx + grads[gi + 1] * dy;
     }
 
-    inline float smooth_grad3(int64_t seed, int64_t xrvp, int64_t yrvp, int64_t zrvp, float dx, float dy, float dz) {
+    inline const float* smooth_gradient3(int64_t seed, int64_t xrvp, int64_t yrvp, int64_t zrvp) {
         int64_t hash = (seed ^ xrvp) ^ (yrvp ^ zrvp);
          hash = (int64_t)((uint64_t)hash * (uint64_t)HASH_MULTIPLIER);
         hash ^= hash >> (64 - N_GRADS_3D_EXPONENT + 2);
         int gi = (int)(hash & ((N_GRADS_3D - 1) << 2));
-        const auto& grads = getStaticData().gradients3D;
-        return grads[gi] * dx + grads[gi + 1] * dy + grads[gi + 2] * dz;
+        return &getStaticData().gradients3D[gi];
+    }
+
+    inline float smooth_grad3(int64_t seed, int64_t xrvp, int64_t yrvp, int64_t zrvp, float dx, float dy, float dz) {
+        const float* g = smooth_gradient3(seed, xrvp, yrvp, zrvp);
+        return g[0] * dx + g[1] * dy + g[2] * dz;
     }
     
     inline float smooth_grad4(int64_t seed, int64_t xsvp, int64_t ysvp, int64_t zsvp, int64_t wsvp, float dx, float dy, float dz, float dw) {
@@ -639,7 +643,35 @@ float OpenSimplex2S::noise2(int64_t seed, double x, double y) {
     return noise2_UnskewedBase(seed, x + s, y + s);
 }
 
-float OpenSimplex2S::noise3_UnrotatedBase(int64_t seed, double xr, double yr, double zr) {
+namespace {
+    // Kernel accumulators for the 3D base: plain value, or value plus the
+    // analytic gradient w.r.t. the rotated input (d/d(xr, yr, zr)).
+    // Each kernel is a^4 * dot(g, d) with a = R^2 - |d|^2.
+    struct ValueAccum3 {
+        float value = 0.0f;
+        inline void add(float a, int64_t seed, int64_t xrvp, int64_t yrvp, int64_t zrvp, float dx, float dy, float dz) {
+            value += (a * a) * (a * a) * smooth_grad3(seed, xrvp, yrvp, zrvp, dx, dy, dz);
+        }
+    };
+
+    struct GradientAccum3 {
+        float value = 0.0f;
+        float gx = 0.0f, gy = 0.0f, gz = 0.0f;
+        inline void add(float a, int64_t seed, int64_t xrvp, int64_t yrvp, int64_t zrvp, float dx, float dy, float dz) {
+            const float* g = smooth_gradient3(seed, xrvp, yrvp, zrvp);
+            float d = g[0] * dx + g[1] * dy + g[2] * dz;
+            float a2 = a * a;
+            float a4 = a2 * a2;
+            float k = -8.0f * a2 * a * d;
+            value += a4 * d;
+            gx += a4 * g[0] + k * dx;
+            gy += a4 * g[1] + k * dy;
+            gz += a4 * g[2] + k * dz;
+        }
+    };
+
+template <typename Accum>
+inline void smooth_noise3Base(int64_t seed, double xr, double yr, double zr, Accum& acc) {
     int xrb = fastFloor(xr);
     int yrb = fastFloor(yr);
     int zrb = fastFloor(zr);
@@ -661,9 +693,8 @@ float OpenSimplex2S::noise3_UnrotatedBase(int64_t seed, double xr, double yr, do
     float z0 = zri + (float)zNMask;
     
     float a0 = RSQUARED_3D - x0 * x0 - y0 * y0 - z0 * z0;
-    float value = 0.0f;
     if (a0 > 0.0f) {
-        value += (a0 * a0) * (a0 * a0) * smooth_grad3(
+        acc.add(a0,
             seed,
             xrbp + ((int64_t)xNMask & PRIME_X),
             yrbp + ((int64_t)yNMask & PRIME_Y),
@@ -677,7 +708,7 @@ float OpenSimplex2S::noise3_UnrotatedBase(int64_t seed, double xr, double yr, do
     float z1 = zri - 0.5f;
     float a1 = RSQUARED_3D - x1 * x1 - y1 * y1 - z1 * z1;
     if (a1 > 0.0f) {
-        value += (a1 * a1) * (a1 * a1) * smooth_grad3(
+        acc.add(a1,
             seed2,
             xrbp + PRIME_X,
             yrbp + PRIME_Y,
@@ -699,7 +730,7 @@ float OpenSimplex2S::noise3_UnrotatedBase(int64_t seed, double xr, double yr, do
         float x2 = x0 - (float)(xNMask | 1);
         float y2 = y0;
         float z2 = z0;
-        value += (a2 * a2) * (a2 * a2) * smooth_grad3(
+        acc.add(a2,
             seed,
             xrbp + ((int64_t)(~xNMask) & PRIME_X),
             yrbp + ((int64_t)yNMask & PRIME_Y),
@@ -712,7 +743,7 @@ float OpenSimplex2S::noise3_UnrotatedBase(int64_t seed, double xr, double yr, do
             float x3 = x0;
             float y3 = y0 - (float)(yNMask | 1);
             float z3 = z0 - (float)(zNMask | 1);
-            value += (a3 * a3) * (a3 * a3) * smooth_grad3(
+            acc.add(a3,
                 seed,
                 xrbp + ((int64_t)xNMask & PRIME_X),
                 yrbp + ((int64_t)(~yNMask) & PRIME_Y),
@@ -726,7 +757,7 @@ float OpenSimplex2S::noise3_UnrotatedBase(int64_t seed, double xr, double yr, do
             float x4 = (float)(xNMask | 1) + x1;
             float y4 = y1;
             float z4 = z1;
-            value += (a4 * a4) * (a4 * a4) * smooth_grad3(
+            acc.add(a4,
                 seed2,
                 xrbp + ((int64_t)xNMask & (PRIME_X << 1)),
                 yrbp + PRIME_Y,
@@ -743,7 +774,7 @@ float OpenSimplex2S::noise3_UnrotatedBase(int64_t seed, double xr, double yr, do
         float x6 = x0;
         float y6 = y0 - (float)(yNMask | 1);
         float z6 = z0;
-        value += (a6 * a6) * (a6 * a6) * smooth_grad3(
+        acc.add(a6,
             seed,
             xrbp + ((int64_t)xNMask & PRIME_X),
             yrbp + ((int64_t)(~yNMask) & PRIME_Y),
@@ -756,7 +787,7 @@ float OpenSimplex2S::noise3_UnrotatedBase(int64_t seed, double xr, double yr, do
             float x7 = x0 - (float)(xNMask | 1);
             float y7 = y0;
             float z7 = z0 - (float)(zNMask | 1);
-            value += (a7 * a7) * (a7 * a7) * smooth_grad3(
+            acc.add(a7,
                 seed,
                 xrbp + ((int64_t)(~xNMask) & PRIME_X),
                 yrbp + ((int64_t)yNMask & PRIME_Y),
@@ -770,7 +801,7 @@ float OpenSimplex2S::noise3_UnrotatedBase(int64_t seed, double xr, double yr, do
             float x8 = x1;
             float y8 = (float)(yNMask | 1) + y1;
             float z8 = z1;
-            value += (a8 * a8) * (a8 * a8) * smooth_grad3(
+            acc.add(a8,
                 seed2,
                 xrbp + PRIME_X,
                 yrbp + ((int64_t)yNMask & (PRIME_Y << 1)),
@@ -787,7 +818,7 @@ float OpenSimplex2S::noise3_UnrotatedBase(int64_t seed, double xr, double yr, do
         float xA = x0;
         float yA = y0;
         float zA = z0 - (float)(zNMask | 1);
-        value += (aA_val * aA_val) * (aA_val * aA_val) * smooth_grad3(
+        acc.add(aA_val,
             seed,
             xrbp + ((int64_t)xNMask & PRIME_X),
             yrbp + ((int64_t)yNMask & PRIME_Y),
@@ -800,7 +831,7 @@ float OpenSimplex2S::noise3_UnrotatedBase(int64_t seed, double xr, double yr, do
             float xB = x0 - (float)(xNMask | 1);
             float yB = y0 - (float)(yNMask | 1);
             float zB = z0;
-            value += (aB * aB) * (aB * aB) * smooth_grad3(
+            acc.add(aB,
                 seed,
                 xrbp + ((int64_t)(~xNMask) & PRIME_X),
                 yrbp + ((int64_t)(~yNMask) & PRIME_Y),
@@ -814,7 +845,7 @@ float OpenSimplex2S::noise3_UnrotatedBase(int64_t seed, double xr, double yr, do
             float xC = x1;
             float yC = y1;
             float zC = (float)(zNMask | 1) + z1;
-            value += (aC * aC) * (aC * aC) * smooth_grad3(
+            acc.add(aC,
                 seed2,
                 xrbp + PRIME_X,
                 yrbp + PRIME_Y,
@@ -831,7 +862,7 @@ float OpenSimplex2S::noise3_UnrotatedBase(int64_t seed, double xr, double yr, do
             float x5 = x1;
             float y5 = (float)(yNMask | 1) + y1;
             float z5 = (float)(zNMask | 1) + z1;
-            value += (a5 * a5) * (a5 * a5) * smooth_grad3(
+            acc.add(a5,
                 seed2,
                 xrbp + PRIME_X,
                 yrbp + ((int64_t)yNMask & (PRIME_Y << 1)),
@@ -847,7 +878,7 @@ float OpenSimplex2S::noise3_UnrotatedBase(int64_t seed, double xr, double yr, do
             float x9 = (float)(xNMask | 1) + x1;
             float y9 = y1;
             float z9 = (float)(zNMask | 1) + z1;
-            value += (a9 * a9) * (a9 * a9) * smooth_grad3(
+            acc.add(a9,
                 seed2,
                 xrbp + ((int64_t)xNMask & (PRIME_X << 1)),
                 yrbp + PRIME_Y,
@@ -863,7 +894,7 @@ float OpenSimplex2S::noise3_UnrotatedBase(int64_t seed, double xr, double yr, do
             float xD = (float)(xNMask | 1) + x1;
             float yD = (float)(yNMask | 1) + y1;
             float zD = z1;
-            value += (aD * aD) * (aD * aD) * smooth_grad3(
+            acc.add(aD,
                 seed2,
                 xrbp + ((int64_t)xNMask & (PRIME_X << 1)),
                 yrbp + ((int64_t)yNMask & (PRIME_Y << 1)),
@@ -872,8 +903,13 @@ float OpenSimplex2S::noise3_UnrotatedBase(int64_t seed, double xr, double yr, do
             );
         }
     }
+}
+}
 
-    return value;
+float OpenSimplex2S::noise3_UnrotatedBase(int64_t seed, double xr, double yr, double zr) {
+    ValueAccum3 acc;
+    smooth_noise3Base(seed, xr, yr, zr, acc);
+    return acc.value;
 }
 
 float OpenSimplex2S::noise3_ImproveXY(int64_t seed, double x, double y, double z) {
@@ -896,6 +932,26 @@ float OpenSimplex2S::noise3_ImproveXZ(int64_t seed, double x, double y, double z
     return noise3_UnrotatedBase(seed, xr, yr, zr);
 }
 
+float OpenSimplex2S::noise3_ImproveXZ(int64_t seed, double x, double y, double z, float gradient[3]) {
+    double xz = x + z;
+    double s2 = xz * ROTATE3_ORTHOGONALIZER;
+    double yy = y * ROOT3OVER3;
+    double xr = x + s2 + yy;
+    double zr = z + s2 + yy;
+    double yr = xz * -ROOT3OVER3 + yy;
+
+    GradientAccum3 acc;
+    smooth_noise3Base(seed, xr, yr, zr, acc);
+
+    // Chain rule through the (linear) ImproveXZ rotation
+    const float k = (float)ROTATE3_ORTHOGONALIZER;
+    const float r = (float)ROOT3OVER3;
+    gradient[0] = acc.gx * (1.0f + k) - acc.gy * r + acc.gz * k;
+    gradient[1] = (acc.gx + acc.gy + acc.gz) * r;
+    gradient[2] = acc.gx * k - acc.gy * r + acc.gz * (1.0f + k);
+    return acc.value;
+}
+
 float OpenSimplex2S::noise3_Fallback(int64_t seed, double x, double y, double z) {
     double r = FALLBACK_ROTATE3 * (x + y + z);
     return noise3_UnrotatedBase(seed, r - x, r - y, r - z);
@@ -43,6 +43,24 @@ public:
         }
     }
 
+    // .nscene に保存するベイク済みキャッシュを圧縮する（小さくなるが読み込み時に展開が必要）
+    bool compressBakedCaches() const { return m_compressBakedCaches; }
+    void setCompressBakedCaches(bool compress) {
+        if (m_compressBakedCaches != compress) {
+            m_compressBakedCaches = compress;
+            emit compressBakedCachesChanged(compress);
+        }
+    }
+
+    // レンダースレッドを CPU に固定する（RenderScheduler のアフィニティ）
+    bool pinRenderThreads() const { return m_pinRenderThreads; }
+    void setPinRenderThreads(bool pin) {
+        if (m_pinRenderThreads != pin) {
+            m_pinRenderThreads = pin;
+            emit pinRenderThreadsChanged(pin);
+        }
+    }
+
     Language language() const { return m_language; }
     void setLanguage(Language lang) {
         if (m_language != lang) {
@@ -196,6 +214,8 @@ public:
             {"Shader", {{Language::Japanese, "シェーダー"}, {Language::Chinese, "着色器"}}},
             
             // Settings menu
+            {"Pin Render Threads to Cores", {{Language::Japanese, "レンダースレッドをコアに固定"}, {Language::Chinese, "将渲染线程绑定到核心"}}},
+            {"Compress Baked Caches", {{Language::Japanese, "ベイク済みキャッシュを圧縮"}, {Language::Chinese, "压缩烘焙缓存"}}},
             {"Settings", {{Language::Japanese, "設定"}, {Language::Chinese, "设置"}}},
             {"CPU Usage (Threads):", {{Language::Japanese, "CPU使用率 (スレッド):"}, {Language::Chinese, "CPU使用率 (线程):"}}},
             {"Show FPS", {{Language::Japanese, "FPSを表示"}, {Language::Chinese, "显示FPS"}}},
@@ -252,19 +272,23 @@ public:
 signals:
     void maxThreadsChanged(int count);
     void showFPSChanged(bool show);
+    void compressBakedCachesChanged(bool compress);
+    void pinRenderThreadsChanged(bool pin);
     void languageChanged(Language lang);
     void themeChanged(Theme theme);
     void renderResolutionChanged(int width, int height);
     void viewportRangeChanged();
 
 private:
-    AppSettings() : m_maxThreads(4), m_showFPS(false), m_language(Language::English), m_theme(Theme::Dark),
+    AppSettings() : m_maxThreads(4), m_showFPS(false), m_compressBakedCaches(false), m_pinRenderThreads(false), m_language(Language::English), m_theme(Theme::Dark),
                     m_renderWidth(512), m_renderHeight(512),
                     m_viewportMinU(0.0), m_viewportMinV(0.0), m_viewportMaxU(1.0), m_viewportMaxV(1.0) {}
     Q_DISABLE_COPY(AppSettings)
 
     int m_maxThreads;
     bool m_showFPS;
+    bool m_compressBakedCaches;
+    bool m_pinRenderThreads;
     Language m_language;
     Theme m_theme;
     int m_renderWidth;
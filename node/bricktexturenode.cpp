@@ -56,33 +56,36 @@ BrickTextureNode::~BrickTextureNode() {}
 void BrickTextureNode::evaluate() {
     // Stateless
 }
-QVector<Node::ParameterInfo> BrickTextureNode::parameters() const {
+QVector<Node::ParameterInfo> BrickTextureNode::describeParameters() const {
     QVector<ParameterInfo> params;
     
     // Socket-matching parameters (enables UI widgets for unconnected sockets)
-    params.append(ParameterInfo("Scale", 0.1, 50.0, m_scaleInput->defaultValue().toDouble(), 0.1, "Overall scale"));
-    params.append(ParameterInfo("Mortar Size", 0.0, 0.5, m_mortarSizeInput->defaultValue().toDouble(), 0.01, "Mortar width"));
-    params.append(ParameterInfo("Mortar Smooth", 0.0, 1.0, m_mortarSmoothInput->defaultValue().toDouble(), 0.01, "Mortar smoothness"));
-    params.append(ParameterInfo("Bias", -1.0, 1.0, m_biasInput->defaultValue().toDouble(), 0.01, "Color bias"));
-    params.append(ParameterInfo("Brick Width", 0.01, 1.0, m_brickWidthInput->defaultValue().toDouble(), 0.01, "Brick width ratio"));
-    params.append(ParameterInfo("Row Height", 0.01, 1.0, m_rowHeightInput->defaultValue().toDouble(), 0.01, "Row height ratio"));
+    params.append(ParameterInfo("Scale", 0.1, 50.0, m_scaleInput->defaultValue().toDouble(), 0.1, "Overall scale")
+        .bind<BrickTextureNode>([](const BrickTextureNode& n) { return n.m_scaleInput->defaultValue().toDouble(); }));
+    params.append(ParameterInfo("Mortar Size", 0.0, 0.5, m_mortarSizeInput->defaultValue().toDouble(), 0.01, "Mortar width")
+        .bind<BrickTextureNode>([](const BrickTextureNode& n) { return n.m_mortarSizeInput->defaultValue().toDouble(); }));
+    params.append(ParameterInfo("Mortar Smooth", 0.0, 1.0, m_mortarSmoothInput->defaultValue().toDouble(), 0.01, "Mortar smoothness")
+        .bind<BrickTextureNode>([](const BrickTextureNode& n) { return n.m_mortarSmoothInput->defaultValue().toDouble(); }));
+    params.append(ParameterInfo("Bias", -1.0, 1.0, m_biasInput->defaultValue().toDouble(), 0.01, "Color bias")
+        .bind<BrickTextureNode>([](const BrickTextureNode& n) { return n.m_biasInput->defaultValue().toDouble(); }));
+    params.append(ParameterInfo("Brick Width", 0.01, 1.0, m_brickWidthInput->defaultValue().toDouble(), 0.01, "Brick width ratio")
+        .bind<BrickTextureNode>([](const BrickTextureNode& n) { return n.m_brickWidthInput->defaultValue().toDouble(); }));
+    params.append(ParameterInfo("Row Height", 0.01, 1.0, m_rowHeightInput->defaultValue().toDouble(), 0.01, "Row height ratio")
+        .bind<BrickTextureNode>([](const BrickTextureNode& n) { return n.m_rowHeightInput->defaultValue().toDouble(); }));
     
     // Custom parameters (not sockets)
-    ParameterInfo offsetParam("Offset", 0.0, 1.0, m_offset, 0.01, "Row Offset");
-    offsetParam.setter = [this](const QVariant& v) { const_cast<BrickTextureNode*>(this)->setOffset(v.toDouble()); };
-    params.append(offsetParam);
-
-    ParameterInfo offsetFreqParam("Offset Frequency", 1.0, 10.0, m_offsetFrequency, 1.0, "Offset Frequency");
-    offsetFreqParam.setter = [this](const QVariant& v) { const_cast<BrickTextureNode*>(this)->setOffsetFrequency(v.toInt()); };
-    params.append(offsetFreqParam);
-
-    ParameterInfo squashParam("Squash", 0.0, 10.0, m_squash, 0.1, "Squash Amount");
-    squashParam.setter = [this](const QVariant& v) { const_cast<BrickTextureNode*>(this)->setSquash(v.toDouble()); };
-    params.append(squashParam);
-
-    ParameterInfo squashFreqParam("Squash Frequency", 1.0, 10.0, m_squashFrequency, 1.0, "Squash Frequency");
-    squashFreqParam.setter = [this](const QVariant& v) { const_cast<BrickTextureNode*>(this)->setSquashFrequency(v.toInt()); };
-    params.append(squashFreqParam);
+    params.append(ParameterInfo("Offset", 0.0, 1.0, m_offset, 0.01, "Row Offset")
+        .bind<BrickTextureNode>([](const BrickTextureNode& n) { return n.m_offset; },
+                                [](BrickTextureNode& n, const QVariant& v) { n.setOffset(v.toDouble()); }));
+    params.append(ParameterInfo("Offset Frequency", 1.0, 10.0, m_offsetFrequency, 1.0, "Offset Frequency")
+        .bind<BrickTextureNode>([](const BrickTextureNode& n) { return n.m_offsetFrequency; },
+                                [](BrickTextureNode& n, const QVariant& v) { n.setOffsetFrequency(v.toInt()); }));
+    params.append(ParameterInfo("Squash", 0.0, 10.0, m_squash, 0.1, "Squash Amount")
+        .bind<BrickTextureNode>([](const BrickTextureNode& n) { return n.m_squash; },
+                                [](BrickTextureNode& n, const QVariant& v) { n.setSquash(v.toDouble()); }));
+    params.append(ParameterInfo("Squash Frequency", 1.0, 10.0, m_squashFrequency, 1.0, "Squash Frequency")
+        .bind<BrickTextureNode>([](const BrickTextureNode& n) { return n.m_squashFrequency; },
+                                [](BrickTextureNode& n, const QVariant& v) { n.setSquashFrequency(v.toInt()); }));
 
     return params;
 }
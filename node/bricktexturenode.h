@@ -10,7 +10,6 @@ public:
 
     void evaluate() override;
     QVariant compute(const QVector3D& pos, NodeSocket* socket) override;
-    QVector<ParameterInfo> parameters() const override;
 
     double offset() const { return m_offset; }
     void setOffset(double v);
@@ -24,6 +23,9 @@ public:
     int squashFrequency() const { return m_squashFrequency; }
     void setSquashFrequency(int v);
 
+protected:
+    QVector<ParameterInfo> describeParameters() const override;
+
 private:
     NodeSocket* m_vectorInput;
     NodeSocket* m_color1Input;
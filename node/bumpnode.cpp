@@ -1,7 +1,8 @@
 #include "bumpnode.h"
+#include "dual.h"
 #include <cmath>
 
-BumpNode::BumpNode() : Node("Bump"), m_invert(false) {
+BumpNode::BumpNode() : Node("Bump"), m_invert(false), m_analytic(false) {
     m_strengthInput = new NodeSocket("Strength", SocketType::Float, SocketDirection::Input, this);
     m_strengthInput->setDefaultValue(1.0);
     addInputSocket(m_strengthInput);
@@ -34,10 +35,28 @@ void BumpNode::setInvert(bool inv) {
     setDirty(true);
 }
 
-QVector<Node::ParameterInfo> BumpNode::parameters() const {
+void BumpNode::setAnalytic(bool enabled) {
+    if (m_analytic == enabled) return;
+    m_analytic = enabled;
+    setDirty(true);
+}
+
+int BumpNode::stencilRadius() const {
+    if (isMuted()) return 0;
+    // 解析的勾配が取れるなら近傍タップ用のバッファは不要
+    DualVec probe;
+    if (m_analytic && m_heightInput->getDual(QVector3D(0, 0, 0), probe)) return 0;
+    return 1;
+}
+
+QVector<Node::ParameterInfo> BumpNode::describeParameters() const {
     return {
         ParameterInfo("Strength", 0.0, 1.0, 1.0, 0.01, "Bump strength"),
-        ParameterInfo("Distance", 0.0, 100.0, 1.0, 0.1, "Bump distance")
+        ParameterInfo("Distance", 0.0, 100.0, 1.0, 0.1, "Bump distance"),
+        ParameterInfo("Analytic", m_analytic, nullptr,
+            "Use exact height derivatives when the upstream graph supports them")
+            .bind<BumpNode>([](const BumpNode& n) { return n.analytic(); },
+                            [](BumpNode& n, const QVariant& v) { n.setAnalytic(v.toBool()); })
     };
 }
 
@@ -67,12 +86,21 @@ QVariant BumpNode::compute(const QVector3D& pos, NodeSocket* socket) {
         double h_center = 0.0;
         
         if (m_heightInput->isConnected()) {
-            h_center = m_heightInput->getValue(pos).toDouble();
-            double h_x = m_heightInput->getValue(pos + QVector3D(delta, 0, 0)).toDouble();
-            double h_y = m_heightInput->getValue(pos + QVector3D(0, delta, 0)).toDouble();
-            
-            double dHdX = (h_x - h_center); // / delta (which is 1.0)
-            double dHdY = (h_y - h_center);
+            double dHdX = 0.0;
+            double dHdY = 0.0;
+            DualVec height;
+            if (m_analytic && m_heightInput->getDual(pos, height)) {
+                dHdX = height.x.du;
+                dHdY = height.x.dv;
+            } else {
+                // Taps come from the render's stencil buffer when available
+                h_center = stencilSample(pos);
+                double h_x = stencilSample(pos + QVector3D(delta, 0, 0));
+                double h_y = stencilSample(pos + QVector3D(0, delta, 0));
+                
+                dHdX = (h_x - h_center); // / delta (which is 1.0)
+                dHdY = (h_y - h_center);
+            }
             
             // Perturb normal
             // Surface gradient in pixel space.
@@ -96,10 +124,12 @@ QVariant BumpNode::compute(const QVector3D& pos, NodeSocket* socket) {
 QJsonObject BumpNode::save() const {
     QJsonObject json = Node::save();
     json["invert"] = m_invert;
+    json["analytic"] = m_analytic;
     return json;
 }
 
 void BumpNode::restore(const QJsonObject& json) {
     Node::restore(json);
     if (json.contains("invert")) m_invert = json["invert"].toBool();
+    if (json.contains("analytic")) m_analytic = json["analytic"].toBool();
 }
@@ -11,14 +11,24 @@ public:
     void evaluate() override;
     QVariant compute(const QVector3D& pos, NodeSocket* socket) override;
     
-    QVector<ParameterInfo> parameters() const override;
+    // Finite differences read the height at +1 pixel in X and Y
+    // (not needed when the analytic gradient is available)
+    int stencilRadius() const override;
+    NodeSocket* stencilInput() const override { return m_heightInput; }
 
     bool invert() const { return m_invert; }
     void setInvert(bool inv);
 
+    // 高さ入力の勾配を自動微分で求める（非対応のグラフでは有限差分）
+    bool analytic() const { return m_analytic; }
+    void setAnalytic(bool enabled);
+
     QJsonObject save() const override;
     void restore(const QJsonObject& json) override;
 
+protected:
+    QVector<ParameterInfo> describeParameters() const override;
+
 private:
     NodeSocket* m_strengthInput;
     NodeSocket* m_distanceInput;
@@ -27,6 +37,7 @@ private:
     NodeSocket* m_normalOutput;
     
     bool m_invert;
+    bool m_analytic;
 };
 
 #endif // BUMPNODE_H
@@ -1,5 +1,7 @@
 #include "calculusnode.h"
 #include "appsettings.h"
+#include "rendercontext.h"
+#include "dual.h"
 #include <QDebug>
 #include <cmath>
 #include <QColor>
@@ -7,6 +9,7 @@
 CalculusNode::CalculusNode() 
     : Node("Calculus")
     , m_mode(Mode::Gradient)
+    , m_analytic(false)
 {
     // 入力ソケット
     m_valueInput = new NodeSocket("値", SocketType::Float, SocketDirection::Input, this);
@@ -35,27 +38,32 @@ CalculusNode::CalculusNode()
 
 CalculusNode::~CalculusNode() {}
 
-QVector<Node::ParameterInfo> CalculusNode::parameters() const {
+QVector<Node::ParameterInfo> CalculusNode::describeParameters() const {
     return {
         ParameterInfo("Operation Mode", 
                       {"Derivative X", "Derivative Y", "Gradient", "Laplacian", "Integral X", "Integral Y"}, 
-                      QVariant::fromValue(static_cast<int>(m_mode)), 
-                      [this](const QVariant& v) {
-                          const_cast<CalculusNode*>(this)->setMode(static_cast<Mode>(v.toInt()));
-                      },
-                      "Select the calculus operation"),
+                      QVariant::fromValue(static_cast<int>(m_mode)), nullptr,
+                      "Select the calculus operation")
+            .bind<CalculusNode>([](const CalculusNode& n) { return static_cast<int>(n.m_mode); },
+                                [](CalculusNode& n, const QVariant& v) { n.setMode(static_cast<Mode>(v.toInt())); }),
         ParameterInfo("サンプル距離", 0.1, 10.0, 1.0, 0.1, 
             "微分計算時のサンプリング間隔（ピクセル）\n"
             "小さいほど精密、大きいほど滑らか"),
         ParameterInfo("スケール", 0.0, 100.0, 1.0, 0.1, 
             "出力値の倍率\n"
             "微分結果は小さいことが多いので拡大して可視化"),
+        ParameterInfo("解析的微分", m_analytic, nullptr,
+            "上流ノードが対応していれば自動微分で正確な微分を求める\n"
+            "（微分X/Y・勾配のみ。非対応の場合は差分法）")
+            .bind<CalculusNode>([](const CalculusNode& n) { return n.analytic(); },
+                                [](CalculusNode& n, const QVariant& v) { n.setAnalytic(v.toBool()); }),
     };
 }
 
 QJsonObject CalculusNode::save() const {
     QJsonObject root = Node::save();
     root["mode"] = static_cast<int>(m_mode);
+    root["analytic"] = m_analytic;
     return root;
 }
 
@@ -65,14 +73,57 @@ void CalculusNode::restore(const QJsonObject& json) {
         m_mode = static_cast<Mode>(json["mode"].toInt());
         notifyStructureChanged(); // Update UI
     }
+    if (json.contains("analytic")) {
+        m_analytic = json["analytic"].toBool();
+    }
 }
 
 void CalculusNode::evaluate() {
     // Stateless
 }
 
-void CalculusNode::setDirty(bool dirty) {
-    Node::setDirty(dirty);
+void CalculusNode::invalidate() {
+    std::atomic_store(&m_integralTable, std::shared_ptr<const IntegralTable>());
+    Node::invalidate();
+}
+
+// 微分モードは近傍ピクセルを読むので、入力をステンシルバッファに1回だけ評価する
+// Only integer sample distances at pixel positions can be served from the buffer
+int CalculusNode::stencilRadius() const {
+    if (m_mode == Mode::IntegralX || m_mode == Mode::IntegralY) return 0;
+    if (m_vectorInput->isConnected() || m_sampleDistInput->isConnected()) return 0;
+    
+    // 解析的微分が使えるならバッファは不要（ラプラシアンは常に差分）
+    double dx = 0.0, dy = 0.0;
+    if (m_mode != Mode::Laplacian && analyticDerivatives(QVector3D(0, 0, 0), dx, dy)) return 0;
+    
+    double h = qMax(0.1, m_sampleDistInput->value().toDouble());
+    if (h != std::floor(h)) return 0;
+    return static_cast<int>(h);
+}
+
+void CalculusNode::prepareRender(int width, int height) {
+    Node::prepareRender(width, height);
+    
+    m_tableWidth.store(width);
+    m_tableHeight.store(height);
+    if (m_mode != Mode::IntegralX && m_mode != Mode::IntegralY) return;
+    if (!m_valueInput->isConnected()) return;
+    
+    auto table = std::atomic_load(&m_integralTable);
+    if (table && table->mode == m_mode && table->width == width && table->height == height) return;
+    
+    QMutexLocker locker(&m_mutex);
+    std::atomic_store(&m_integralTable, buildIntegralTable(width, height, true));
+}
+
+bool CalculusNode::isPrepared(int width, int height) const {
+    if (!Node::isPrepared(width, height)) return false;
+    if (m_mode != Mode::IntegralX && m_mode != Mode::IntegralY) return true;
+    if (!m_valueInput->isConnected()) return true;
+
+    auto table = std::atomic_load(&m_integralTable);
+    return table && table->mode == m_mode && table->width == width && table->height == height;
 }
 
 CalculusNode::Mode CalculusNode::mode() const { return m_mode; }
@@ -92,6 +143,13 @@ void CalculusNode::setSampleDistance(double d) {
     setDirty(true); 
 }
 
+void CalculusNode::setAnalytic(bool enabled) {
+    if (m_analytic != enabled) {
+        m_analytic = enabled;
+        setDirty(true);
+    }
+}
+
 void CalculusNode::setScale(double s) { 
     m_scaleInput->setValue(s); 
     setDirty(true); 
@@ -103,17 +161,19 @@ double CalculusNode::sampleValue(const QVector3D& pos) {
         return 0.0;
     }
     
-    QVariant val = m_valueInput->getValue(pos);
-    
-    if (val.canConvert<double>()) {
-        return val.toDouble();
-    } else if (val.canConvert<QColor>()) {
-        QColor c = val.value<QColor>();
-        // グレースケール変換（輝度）
-        return 0.299 * c.redF() + 0.587 * c.greenF() + 0.114 * c.blueF();
-    }
+    // ステンシルバッファにあればそこから読む（グレースケール変換込み）
+    return stencilSample(pos);
+}
+
+bool CalculusNode::analyticDerivatives(const QVector3D& pos, double& dx, double& dy) const {
+    // ベクトル入力があると座標が置き換わるので、ピクセル微分とは一致しない
+    if (!m_analytic || m_vectorInput->isConnected() || !m_valueInput->isConnected()) return false;
     
-    return 0.0;
+    DualVec value;
+    if (!m_valueInput->getDual(pos, value)) return false;
+    dx = value.x.du;
+    dy = value.x.dv;
+    return true;
 }
 
 // X方向の微分（∂f/∂x）
@@ -159,6 +219,108 @@ double CalculusNode::computeLaplacian(const QVector3D& pos, double h) {
     return (fRight + fLeft + fUp + fDown - 4.0 * fCenter) / (h * h);
 }
 
+// 入力を全ピクセルで1回だけ評価し、積分方向に累積和を取る
+// Rows (Integral X) or column blocks (Integral Y) are summed in parallel
+std::shared_ptr<const CalculusNode::IntegralTable> CalculusNode::buildIntegralTable(int width, int height, bool parallel) {
+    auto table = std::make_shared<IntegralTable>();
+    table->mode = m_mode;
+    table->width = qMax(1, width);
+    table->height = qMax(1, height);
+    table->prefix.resize(static_cast<size_t>(table->width) * table->height);
+    
+    const int w = table->width;
+    const int hgt = table->height;
+    float* data = table->prefix.data();
+    
+    auto run = [parallel](int count, const std::function<void(int)>& body) {
+        if (parallel) {
+            RenderContext::parallelFor(count, body);
+        } else {
+            for (int i = 0; i < count; ++i) body(i);
+        }
+    };
+    
+    if (m_mode == Mode::IntegralX) {
+        run(hgt, [&](int y) {
+            float* row = data + static_cast<size_t>(y) * w;
+            double sum = 0.0;
+            for (int x = 0; x < w; ++x) {
+                sum += sampleValue(QVector3D(x, y, 0));
+                row[x] = static_cast<float>(sum);
+            }
+        });
+    } else {
+        run(hgt, [&](int y) {
+            float* row = data + static_cast<size_t>(y) * w;
+            for (int x = 0; x < w; ++x) {
+                row[x] = static_cast<float>(sampleValue(QVector3D(x, y, 0)));
+            }
+        });
+        
+        // Column prefix sums over blocks of adjacent columns (cache friendly)
+        const int blockSize = 64;
+        const int blocks = (w + blockSize - 1) / blockSize;
+        run(blocks, [&](int b) {
+            const int x0 = b * blockSize;
+            const int x1 = qMin(w, x0 + blockSize);
+            double sums[blockSize] = {};
+            for (int y = 0; y < hgt; ++y) {
+                float* row = data + static_cast<size_t>(y) * w;
+                for (int x = x0; x < x1; ++x) {
+                    sums[x - x0] += row[x];
+                    row[x] = static_cast<float>(sums[x - x0]);
+                }
+            }
+        });
+    }
+    
+    return table;
+}
+
+std::shared_ptr<const CalculusNode::IntegralTable> CalculusNode::integralTable() {
+    // Use the resolution of the last render pass; fall back to the settings
+    // when the node has never been prepared
+    int width = m_tableWidth.load();
+    int height = m_tableHeight.load();
+    if (width <= 0 || height <= 0) {
+        width = qBound(1, AppSettings::instance().renderWidth(), 8192);
+        height = qBound(1, AppSettings::instance().renderHeight(), 8192);
+    }
+    auto matches = [&](const std::shared_ptr<const IntegralTable>& t) {
+        return t && t->mode == m_mode && t->width == width && t->height == height;
+    };
+    
+    auto table = std::atomic_load(&m_integralTable);
+    if (matches(table)) return table;
+    
+    // Not prepared by a render pass (e.g. preview) - build serially
+    QMutexLocker locker(&m_mutex);
+    table = std::atomic_load(&m_integralTable);
+    if (!matches(table)) {
+        table = buildIntegralTable(width, height, false);
+        std::atomic_store(&m_integralTable, table);
+    }
+    return table;
+}
+
+// 原点から現在位置までの平均値（正規化済み累積和）
+double CalculusNode::computeIntegral(const QVector3D& p) {
+    if (!m_valueInput->isConnected()) return 0.0;
+    
+    auto table = integralTable();
+    const bool alongX = (table->mode == Mode::IntegralX);
+    
+    int steps = static_cast<int>(alongX ? p.x() : p.y());
+    if (steps < 0) return 0.0;
+    steps = qMin(steps, (alongX ? table->width : table->height) - 1);
+    
+    int x = alongX ? steps : qBound(0, static_cast<int>(p.x()), table->width - 1);
+    int y = alongX ? qBound(0, static_cast<int>(p.y()), table->height - 1) : steps;
+    
+    double sum = table->prefix[static_cast<size_t>(y) * table->width + x];
+    return sum / (steps + 1);  // 正規化
+}
+
 QVariant CalculusNode::compute(const QVector3D& pos, NodeSocket* socket) {
     QVector3D p;
     if (m_vectorInput->isConnected()) {
@@ -178,17 +340,21 @@ QVariant CalculusNode::compute(const QVector3D& pos, NodeSocket* socket) {
     
     double result = 0.0;
     
+    double dx = 0.0, dy = 0.0;
+    bool exact = (m_mode == Mode::DerivativeX || m_mode == Mode::DerivativeY || m_mode == Mode::Gradient)
+        && analyticDerivatives(pos, dx, dy);
+    
     switch (m_mode) {
         case Mode::DerivativeX:
-            result = computeDerivativeX(p, h);
+            result = exact ? dx : computeDerivativeX(p, h);
             break;
             
         case Mode::DerivativeY:
-            result = computeDerivativeY(p, h);
+            result = exact ? dy : computeDerivativeY(p, h);
             break;
             
         case Mode::Gradient:
-            result = computeGradient(p, h);
+            result = exact ? std::sqrt(dx * dx + dy * dy) : computeGradient(p, h);
             break;
             
         case Mode::Laplacian:
@@ -199,22 +365,8 @@ QVariant CalculusNode::compute(const QVector3D& pos, NodeSocket* socket) {
             
         case Mode::IntegralX:
         case Mode::IntegralY:
-            // 簡易積分（現在位置までの累積）
-            // 注意: これは近似であり、厳密な積分ではない
-            {
-                double sum = 0.0;
-                int steps = static_cast<int>(m_mode == Mode::IntegralX ? p.x() : p.y());
-                steps = qMin(steps, 100);  // 計算量制限
-                
-                for (int i = 0; i <= steps; ++i) {
-                    QVector3D samplePos = (m_mode == Mode::IntegralX) 
-                        ? QVector3D(i, p.y(), p.z())
-                        : QVector3D(p.x(), i, p.z());
-                    sum += sampleValue(samplePos) * h;
-                }
-                
-                result = sum / (steps + 1);  // 正規化
-            }
+            // 現在位置までの累積（累積和テーブルからO(1)で取得）
+            result = computeIntegral(p) * h;
             break;
     }
     
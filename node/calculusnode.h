@@ -3,6 +3,9 @@
 
 #include "node.h"
 #include <QRecursiveMutex>
+#include <atomic>
+#include <memory>
+#include <vector>
 
 // 微分積分ノード - 初心者にもわかりやすい微積分操作
 // Calculus Node - Beginner-friendly differential and integral operations
@@ -22,10 +25,12 @@ public:
     CalculusNode();
     ~CalculusNode() override;
 
-    QVector<ParameterInfo> parameters() const override;
     void evaluate() override;
     QVariant compute(const QVector3D& pos, NodeSocket* socket) override;
-    void setDirty(bool dirty) override;
+    void prepareRender(int width, int height) override;
+    bool isPrepared(int width, int height) const override;
+    int stencilRadius() const override;
+    NodeSocket* stencilInput() const override { return m_valueInput; }
     
     QJsonObject save() const override;
     void restore(const QJsonObject& json) override;
@@ -35,12 +40,18 @@ public:
     double sampleDistance() const;
     double scale() const;
     bool normalize() const;
+    bool analytic() const { return m_analytic; }
 
     // Setters
     void setMode(Mode m);
     void setSampleDistance(double d);
     void setScale(double s);
     void setNormalize(bool n);
+    void setAnalytic(bool enabled);
+
+protected:
+    QVector<ParameterInfo> describeParameters() const override;
+    void invalidate() override;
 
 private:
     // 近傍サンプリングによる微分計算
@@ -49,6 +60,20 @@ private:
     double computeDerivativeY(const QVector3D& pos, double h);
     double computeGradient(const QVector3D& pos, double h);
     double computeLaplacian(const QVector3D& pos, double h);
+    // 自動微分で ∂f/∂x, ∂f/∂y を求める（上流が非対応なら false）
+    bool analyticDerivatives(const QVector3D& pos, double& dx, double& dy) const;
+    
+    // 積分モード用の累積和テーブル（レンダー毎に1回だけ入力をラスタライズ）
+    // Prefix sums of the input along the integral axis, one entry per pixel
+    struct IntegralTable {
+        Mode mode;
+        int width;
+        int height;
+        std::vector<float> prefix;
+    };
+    std::shared_ptr<const IntegralTable> buildIntegralTable(int width, int height, bool parallel);
+    std::shared_ptr<const IntegralTable> integralTable();
+    double computeIntegral(const QVector3D& pos);
     
     NodeSocket* m_valueInput;        // 入力値
     NodeSocket* m_vectorInput;       // 座標入力（オプション）
@@ -60,6 +85,11 @@ private:
     NodeSocket* m_colorOutput;       // カラー出力
 
     Mode m_mode;
+    bool m_analytic;
+    std::shared_ptr<const IntegralTable> m_integralTable;
+    // 直近の prepareRender の解像度（0 = まだ無い）。遅延構築もこの解像度で作る
+    std::atomic<int> m_tableWidth{0};
+    std::atomic<int> m_tableHeight{0};
     mutable QRecursiveMutex m_mutex;
 };
 
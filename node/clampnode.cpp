@@ -18,7 +18,7 @@ ClampNode::ClampNode() : Node("Clamp") {
 
 ClampNode::~ClampNode() {}
 
-QVector<Node::ParameterInfo> ClampNode::parameters() const {
+QVector<Node::ParameterInfo> ClampNode::describeParameters() const {
     return {
         ParameterInfo("Min", -100.0, 100.0, 0.0),
         ParameterInfo("Max", -100.0, 100.0, 1.0)
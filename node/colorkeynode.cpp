@@ -98,7 +98,7 @@ QVariant ColorKeyNode::compute(const QVector3D& pos, NodeSocket* socket) {
     return QVariant::fromValue(outputColor);
 }
 
-QVector<Node::ParameterInfo> ColorKeyNode::parameters() const {
+QVector<Node::ParameterInfo> ColorKeyNode::describeParameters() const {
     QVector<ParameterInfo> params;
     
     // Key Color - the color to remove/make transparent
@@ -107,13 +107,13 @@ QVector<Node::ParameterInfo> ColorKeyNode::parameters() const {
     keyInfo.name = "Key Color";
     keyInfo.defaultValue = m_keyColor;
     keyInfo.tooltip = "Color to make transparent (click to pick)";
-    keyInfo.setter = [this](const QVariant& v) {
-        auto* self = const_cast<ColorKeyNode*>(this);
-        if (v.canConvert<QColor>()) {
-            self->m_keyColor = v.value<QColor>();
-        }
-        self->setDirty(true);
-    };
+    keyInfo.bind<ColorKeyNode>([](const ColorKeyNode& n) { return n.m_keyColor; },
+                               [](ColorKeyNode& n, const QVariant& v) {
+                                   if (v.canConvert<QColor>()) {
+                                       n.m_keyColor = v.value<QColor>();
+                                   }
+                                   n.setDirty(true);
+                               });
     params.append(keyInfo);
     
     // Tolerance - how close colors need to be to match
@@ -125,10 +125,11 @@ QVector<Node::ParameterInfo> ColorKeyNode::parameters() const {
     tolInfo.defaultValue = m_tolerance;
     tolInfo.step = 0.01;
     tolInfo.tooltip = "Color matching range (0=exact match only, 1=all colors)";
-    tolInfo.setter = [this](const QVariant& v) {
-        const_cast<ColorKeyNode*>(this)->m_tolerance = v.toDouble();
-        const_cast<ColorKeyNode*>(this)->setDirty(true);
-    };
+    tolInfo.bind<ColorKeyNode>([](const ColorKeyNode& n) { return n.m_tolerance; },
+                               [](ColorKeyNode& n, const QVariant& v) {
+                                   n.m_tolerance = v.toDouble();
+                                   n.setDirty(true);
+                               });
     params.append(tolInfo);
     
     // Falloff - edge softness
@@ -140,19 +141,21 @@ QVector<Node::ParameterInfo> ColorKeyNode::parameters() const {
     fallInfo.defaultValue = m_falloff;
     fallInfo.step = 0.01;
     fallInfo.tooltip = "Edge softness for smooth transitions";
-    fallInfo.setter = [this](const QVariant& v) {
-        const_cast<ColorKeyNode*>(this)->m_falloff = v.toDouble();
-        const_cast<ColorKeyNode*>(this)->setDirty(true);
-    };
+    fallInfo.bind<ColorKeyNode>([](const ColorKeyNode& n) { return n.m_falloff; },
+                                [](ColorKeyNode& n, const QVariant& v) {
+                                    n.m_falloff = v.toDouble();
+                                    n.setDirty(true);
+                                });
     params.append(fallInfo);
     
     // Invert
-    params.append(ParameterInfo("Invert", m_invert,
-        [this](const QVariant& v) {
-            const_cast<ColorKeyNode*>(this)->m_invert = v.toBool();
-            const_cast<ColorKeyNode*>(this)->setDirty(true);
-        },
-        "Invert: make key color opaque, others transparent"));
+    params.append(ParameterInfo("Invert", m_invert, nullptr,
+        "Invert: make key color opaque, others transparent")
+        .bind<ColorKeyNode>([](const ColorKeyNode& n) { return n.m_invert; },
+                            [](ColorKeyNode& n, const QVariant& v) {
+                                n.m_invert = v.toBool();
+                                n.setDirty(true);
+                            }));
     
     return params;
 }
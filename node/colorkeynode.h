@@ -14,7 +14,6 @@ public:
     void evaluate() override;
     QVariant compute(const QVector3D& pos, NodeSocket* socket) override;
     
-    QVector<ParameterInfo> parameters() const override;
     QJsonObject save() const override;
     void restore(const QJsonObject& json) override;
     
@@ -22,6 +21,9 @@ public:
     QColor keyColor() const { return m_keyColor; }
     void setKeyColor(const QColor& c) { m_keyColor = c; setDirty(true); }
     
+protected:
+    QVector<ParameterInfo> describeParameters() const override;
+
 private:
     // Input sockets
     NodeSocket* m_colorInput;      // Input color to process
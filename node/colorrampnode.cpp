@@ -26,6 +26,7 @@ void ColorRampNode::evaluate() {
 
 void ColorRampNode::clearStops() {
     m_stops.clear();
+    rebuildRamp();
     setDirty(true);
 }
 
@@ -35,12 +36,14 @@ void ColorRampNode::addStop(double pos, const QColor& color) {
     std::sort(m_stops.begin(), m_stops.end(), [](const Stop& a, const Stop& b) {
         return a.position < b.position;
     });
+    rebuildRamp();
     setDirty(true);
 }
 
 void ColorRampNode::removeStop(int index) {
     if (index >= 0 && index < m_stops.size() && m_stops.size() > 1) {
         m_stops.remove(index);
+        rebuildRamp();
         setDirty(true);
     }
 }
@@ -51,6 +54,7 @@ void ColorRampNode::setStopPosition(int index, double pos) {
         std::sort(m_stops.begin(), m_stops.end(), [](const Stop& a, const Stop& b) {
             return a.position < b.position;
         });
+        rebuildRamp();
         setDirty(true);
     }
 }
@@ -58,39 +62,13 @@ void ColorRampNode::setStopPosition(int index, double pos) {
 void ColorRampNode::setStopColor(int index, const QColor& color) {
     if (index >= 0 && index < m_stops.size()) {
         m_stops[index].color = color;
+        rebuildRamp();
         setDirty(true);
     }
 }
 
-QColor ColorRampNode::evaluateRamp(double t) {
-    t = std::max(0.0, std::min(1.0, t));
-
-    if (m_stops.isEmpty()) return Qt::black;
-    if (m_stops.size() == 1) return m_stops[0].color;
-
-    // Find segment
-    for (int i = 0; i < m_stops.size() - 1; ++i) {
-        if (t >= m_stops[i].position && t <= m_stops[i+1].position) {
-            double range = m_stops[i+1].position - m_stops[i].position;
-            if (range < 0.0001) return m_stops[i].color;
-            
-            double localT = (t - m_stops[i].position) / range;
-            
-            // Linear interpolation
-            double r = m_stops[i].color.redF() * (1.0 - localT) + m_stops[i+1].color.redF() * localT;
-            double g = m_stops[i].color.greenF() * (1.0 - localT) + m_stops[i+1].color.greenF() * localT;
-            double b = m_stops[i].color.blueF() * (1.0 - localT) + m_stops[i+1].color.blueF() * localT;
-            double a = m_stops[i].color.alphaF() * (1.0 - localT) + m_stops[i+1].color.alphaF() * localT;
-            
-            return QColor::fromRgbF(r, g, b, a);
-        }
-    }
-
-    // Handle out of bounds (clamping)
-    if (t < m_stops.first().position) return m_stops.first().color;
-    if (t > m_stops.last().position) return m_stops.last().color;
-
-    return Qt::black; // Should not reach here
+void ColorRampNode::rebuildRamp() {
+    std::atomic_store(&m_ramp, RampTable::bakeFrom(m_stops));
 }
 
 QVariant ColorRampNode::compute(const QVector3D& pos, NodeSocket* socket) {
@@ -108,12 +86,13 @@ QVariant ColorRampNode::compute(const QVector3D& pos, NodeSocket* socket) {
         fac = m_facInput->value().toDouble();
     }
 
-    QColor resultColor = evaluateRamp(fac);
+    float rgba[4];
+    std::atomic_load(&m_ramp)->sample(fac, rgba);
 
     if (socket == m_colorOutput) {
-        return resultColor;
+        return QColor::fromRgbF(rgba[0], rgba[1], rgba[2], rgba[3]);
     } else if (socket == m_alphaOutput) {
-        return resultColor.alphaF();
+        return static_cast<double>(rgba[3]);
     }
 
     return QVariant();
@@ -147,5 +126,6 @@ void ColorRampNode::restore(const QJsonObject& json) {
         std::sort(m_stops.begin(), m_stops.end(), [](const Stop& a, const Stop& b) {
             return a.position < b.position;
         });
+        rebuildRamp();
     }
 }
@@ -2,7 +2,9 @@
 #define COLORRAMPNODE_H
 
 #include "node.h"
+#include "ramptable.h"
 #include <QVector>
+#include <memory>
 #include <QColor>
 #include <QPair>
 
@@ -31,13 +33,15 @@ public:
     void restore(const QJsonObject& json) override;
 
 private:
-    QColor evaluateRamp(double t);
+    // ストップ変更時にテーブルを焼き直す
+    void rebuildRamp();
 
     NodeSocket* m_facInput;
     NodeSocket* m_colorOutput;
     NodeSocket* m_alphaOutput;
 
     QVector<Stop> m_stops;
+    std::shared_ptr<const RampTable> m_ramp;
 };
 
 #endif // COLORRAMPNODE_H
@@ -15,7 +15,7 @@ CombineXYZNode::CombineXYZNode() : Node("Combine XYZ") {
 
 CombineXYZNode::~CombineXYZNode() {}
 
-QVector<Node::ParameterInfo> CombineXYZNode::parameters() const {
+QVector<Node::ParameterInfo> CombineXYZNode::describeParameters() const {
     return {};
 }
 
@@ -1,14 +1,23 @@
 #include "connectiongraphicsitem.h"
 #include "nodegraphicsitem.h"
-#include <QPainterPath>
+#include <QPainter>
+#include <QPainterPathStroker>
+#include <QStyleOptionGraphicsItem>
+
+namespace {
+
+// この倍率未満ではワイヤーを直線で描く
+constexpr qreal kCurveLevelOfDetail = 0.5;
+
+} // namespace
 
 ConnectionGraphicsItem::ConnectionGraphicsItem(NodeGraphicsSocket* from, NodeGraphicsSocket* to, QGraphicsItem* parent)
-    : QGraphicsPathItem(parent)
+    : QGraphicsItem(parent)
     , m_from(from)
     , m_to(to)
     , m_isDragging(to == nullptr)
+    , m_pen(QColor(200, 200, 200), 2)
 {
-    setPen(QPen(QColor(200, 200, 200), 2));
     setZValue(-1); // ノードの下に描画
     
     // 接続を選択可能にする
@@ -69,16 +78,66 @@ void ConnectionGraphicsItem::updatePath() {
         return;
     }
     
-    QPainterPath path;
-    path.moveTo(startPos);
+    if (m_hasEnds && startPos == m_start && endPos == m_end) return;
     
-    qreal dx = endPos.x() - startPos.x();
-    qreal dy = endPos.y() - startPos.y();
+    prepareGeometryChange();
+    m_hasEnds = true;
+    m_start = startPos;
+    m_end = endPos;
+    m_pathDirty = true;
+}
+
+QPainterPath ConnectionGraphicsItem::path() const {
+    if (m_pathDirty) {
+        m_path = QPainterPath();
+        if (m_hasEnds) {
+            m_path.moveTo(m_start);
+            
+            qreal dx = m_end.x() - m_start.x();
+            
+            QPointF ctrl1(m_start.x() + dx * 0.5, m_start.y());
+            QPointF ctrl2(m_end.x() - dx * 0.5, m_end.y());
+            
+            m_path.cubicTo(ctrl1, ctrl2, m_end);
+        }
+        m_pathDirty = false;
+    }
+    return m_path;
+}
+
+QRectF ConnectionGraphicsItem::boundingRect() const {
+    if (!m_hasEnds) return QRectF();
+    const qreal margin = m_pen.widthF();
+    return QRectF(m_start, m_end).normalized().adjusted(-margin, -margin, margin, margin);
+}
+
+QPainterPath ConnectionGraphicsItem::shape() const {
+    QPainterPathStroker stroker;
+    stroker.setWidth(m_pen.widthF());
+    return stroker.createStroke(path());
+}
+
+void ConnectionGraphicsItem::paint(QPainter* painter, const QStyleOptionGraphicsItem* option, QWidget* widget) {
+    Q_UNUSED(widget);
+    if (!m_hasEnds) return;
     
-    QPointF ctrl1(startPos.x() + dx * 0.5, startPos.y());
-    QPointF ctrl2(endPos.x() - dx * 0.5, endPos.y());
+    QPen pen = m_pen;
+    if (isSelected()) {
+        pen.setColor(QColor(255, 150, 50));
+    }
     
-    path.cubicTo(ctrl1, ctrl2, endPos);
+    const qreal lod = option->levelOfDetailFromTransform(painter->worldTransform());
+    if (lod < kCurveLevelOfDetail) {
+        // 縮小時は曲線を作らず、アンチエイリアスなしの直線で描く
+        pen.setCosmetic(true);
+        pen.setWidth(1);
+        painter->setRenderHint(QPainter::Antialiasing, false);
+        painter->setPen(pen);
+        painter->drawLine(m_start, m_end);
+        return;
+    }
     
-    setPath(path);
+    painter->setPen(pen);
+    painter->setBrush(Qt::NoBrush);
+    painter->drawPath(path());
 }
@@ -1,16 +1,23 @@
 #ifndef CONNECTIONGRAPHICSITEM_H
 #define CONNECTIONGRAPHICSITEM_H
 
-#include <QGraphicsPathItem>
+#include <QGraphicsItem>
+#include <QPainterPath>
 #include <QPen>
 
 class NodeGraphicsSocket;
 
-class ConnectionGraphicsItem : public QGraphicsPathItem {
+// ワイヤー（ノード間の接続）
+// Only the end points are tracked when nodes move; the curve itself is
+// built lazily when the wire is painted or hit-tested. The bezier control
+// points lie inside the box spanned by the end points, so that box is the
+// bounding rect. Zoomed out the wire is drawn as a straight line.
+class ConnectionGraphicsItem : public QGraphicsItem {
 public:
     ConnectionGraphicsItem(NodeGraphicsSocket* from, NodeGraphicsSocket* to, QGraphicsItem* parent = nullptr);
     ~ConnectionGraphicsItem() override;
     
+    // Re-reads the socket positions. Cheap; the path is rebuilt on demand.
     void updatePath();
     
     NodeGraphicsSocket* fromSocket() const { return m_from; }
@@ -22,11 +29,24 @@ public:
     // Socket deletion notification
     void onSocketDeleted(const NodeGraphicsSocket* socket);
 
+    QRectF boundingRect() const override;
+    QPainterPath shape() const override;
+    void paint(QPainter* painter, const QStyleOptionGraphicsItem* option, QWidget* widget) override;
+
+    QPainterPath path() const;
+
 private:
     NodeGraphicsSocket* m_from;
     NodeGraphicsSocket* m_to;
     QPointF m_endPoint;
     bool m_isDragging;
+    
+    QPen m_pen;
+    bool m_hasEnds = false;
+    QPointF m_start;
+    QPointF m_end;
+    mutable QPainterPath m_path;
+    mutable bool m_pathDirty = true;
 };
 
 #endif // CONNECTIONGRAPHICSITEM_H
@@ -0,0 +1,102 @@
+#ifndef DUAL_H
+#define DUAL_H
+
+#include <QVector3D>
+#include <cmath>
+#include <algorithm>
+
+// Dual number for forward-mode automatic differentiation.
+// v is the value, du/dv its derivatives w.r.t. the render pixel x/y.
+struct Dual {
+    double v = 0.0;
+    double du = 0.0;
+    double dv = 0.0;
+
+    Dual() = default;
+    Dual(double value) : v(value) {}
+    Dual(double value, double dU, double dV) : v(value), du(dU), dv(dV) {}
+
+    Dual operator-() const { return Dual(-v, -du, -dv); }
+    Dual& operator+=(const Dual& o) { v += o.v; du += o.du; dv += o.dv; return *this; }
+    Dual& operator-=(const Dual& o) { v -= o.v; du -= o.du; dv -= o.dv; return *this; }
+    Dual& operator*=(const Dual& o) { *this = Dual(v * o.v, du * o.v + v * o.du, dv * o.v + v * o.dv); return *this; }
+};
+
+inline Dual operator+(Dual a, const Dual& b) { return a += b; }
+inline Dual operator-(Dual a, const Dual& b) { return a -= b; }
+inline Dual operator*(Dual a, const Dual& b) { return a *= b; }
+inline Dual operator/(const Dual& a, const Dual& b) {
+    double inv = 1.0 / b.v;
+    return Dual(a.v * inv, (a.du * b.v - a.v * b.du) * inv * inv, (a.dv * b.v - a.v * b.dv) * inv * inv);
+}
+
+// Chain rule helper: f(a) with f'(a) = slope
+inline Dual chain(const Dual& a, double value, double slope) { return Dual(value, a.du * slope, a.dv * slope); }
+
+inline Dual sin(const Dual& a) { return chain(a, std::sin(a.v), std::cos(a.v)); }
+inline Dual cos(const Dual& a) { return chain(a, std::cos(a.v), -std::sin(a.v)); }
+inline Dual tan(const Dual& a) { double t = std::tan(a.v); return chain(a, t, 1.0 + t * t); }
+inline Dual asin(const Dual& a) { return chain(a, std::asin(a.v), 1.0 / std::sqrt(std::max(1e-12, 1.0 - a.v * a.v))); }
+inline Dual acos(const Dual& a) { return chain(a, std::acos(a.v), -1.0 / std::sqrt(std::max(1e-12, 1.0 - a.v * a.v))); }
+inline Dual atan(const Dual& a) { return chain(a, std::atan(a.v), 1.0 / (1.0 + a.v * a.v)); }
+inline Dual atan2(const Dual& y, const Dual& x) {
+    double r2 = x.v * x.v + y.v * y.v;
+    if (r2 == 0.0) return Dual(std::atan2(y.v, x.v));
+    return Dual(std::atan2(y.v, x.v), (x.v * y.du - y.v * x.du) / r2, (x.v * y.dv - y.v * x.dv) / r2);
+}
+inline Dual sinh(const Dual& a) { return chain(a, std::sinh(a.v), std::cosh(a.v)); }
+inline Dual cosh(const Dual& a) { return chain(a, std::cosh(a.v), std::sinh(a.v)); }
+inline Dual tanh(const Dual& a) { double t = std::tanh(a.v); return chain(a, t, 1.0 - t * t); }
+inline Dual exp(const Dual& a) { double e = std::exp(a.v); return chain(a, e, e); }
+inline Dual log(const Dual& a) { return chain(a, std::log(a.v), 1.0 / a.v); }
+inline Dual sqrt(const Dual& a) { double s = std::sqrt(a.v); return chain(a, s, s > 0.0 ? 0.5 / s : 0.0); }
+inline Dual abs(const Dual& a) { return a.v < 0.0 ? -a : a; }
+inline Dual pow(const Dual& a, const Dual& b) {
+    double p = std::pow(a.v, b.v);
+    double dA = (a.v != 0.0) ? b.v * std::pow(a.v, b.v - 1.0) : 0.0;
+    double dB = (a.v > 0.0) ? p * std::log(a.v) : 0.0;
+    return Dual(p, a.du * dA + b.du * dB, a.dv * dA + b.dv * dB);
+}
+// Piecewise-constant functions have zero derivative almost everywhere
+inline Dual floor(const Dual& a) { return Dual(std::floor(a.v)); }
+inline Dual ceil(const Dual& a) { return Dual(std::ceil(a.v)); }
+inline Dual round(const Dual& a) { return Dual(std::round(a.v)); }
+inline Dual dualMin(const Dual& a, const Dual& b) { return (a.v <= b.v) ? a : b; }
+inline Dual dualMax(const Dual& a, const Dual& b) { return (a.v >= b.v) ? a : b; }
+inline Dual dualClamp(const Dual& a, double lo, double hi) {
+    if (a.v < lo) return Dual(lo);
+    if (a.v > hi) return Dual(hi);
+    return a;
+}
+
+// Three dual components - Vector sockets use x/y/z, Float sockets store the
+// value broadcast to all three (matching the Float -> Vector conversion)
+struct DualVec {
+    Dual x, y, z;
+
+    DualVec() = default;
+    DualVec(const Dual& dx, const Dual& dy, const Dual& dz) : x(dx), y(dy), z(dz) {}
+    explicit DualVec(const QVector3D& c) : x(c.x()), y(c.y()), z(c.z()) {}
+
+    static DualVec scalar(const Dual& s) { return DualVec(s, s, s); }
+    QVector3D value() const { return QVector3D(x.v, y.v, z.v); }
+
+    DualVec operator-() const { return DualVec(-x, -y, -z); }
+};
+
+inline DualVec operator+(const DualVec& a, const DualVec& b) { return DualVec(a.x + b.x, a.y + b.y, a.z + b.z); }
+inline DualVec operator-(const DualVec& a, const DualVec& b) { return DualVec(a.x - b.x, a.y - b.y, a.z - b.z); }
+inline DualVec operator*(const DualVec& a, const DualVec& b) { return DualVec(a.x * b.x, a.y * b.y, a.z * b.z); }
+inline DualVec operator*(const DualVec& a, const Dual& s) { return DualVec(a.x * s, a.y * s, a.z * s); }
+inline Dual dot(const DualVec& a, const DualVec& b) { return a.x * b.x + a.y * b.y + a.z * b.z; }
+inline DualVec cross(const DualVec& a, const DualVec& b) {
+    return DualVec(a.y * b.z - a.z * b.y, a.z * b.x - a.x * b.z, a.x * b.y - a.y * b.x);
+}
+inline Dual length(const DualVec& a) { return sqrt(dot(a, a)); }
+inline DualVec normalize(const DualVec& a) {
+    Dual len = length(a);
+    if (len.v <= 0.0) return DualVec();
+    return a * (Dual(1.0) / len);
+}
+
+#endif // DUAL_H
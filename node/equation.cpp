@@ -0,0 +1,407 @@
+#include "equation.h"
+#include "renderscheduler.h"
+#include <algorithm>
+#include <cmath>
+#include <cstring>
+#include <map>
+#include <stack>
+#include <tuple>
+#include <vector>
+
+namespace {
+
+using Op = Equation::Op;
+using Instruction = Equation::Instruction;
+
+// 1命令分の計算。定数畳み込みとスカラー評価で共用する
+// (Div/Sqrt/Log keep the guarded behaviour of the old string interpreter)
+inline double apply(Op op, double a, double b) {
+    switch (op) {
+    case Op::Add: return a + b;
+    case Op::Sub: return a - b;
+    case Op::Mul: return a * b;
+    case Op::Div: return b != 0 ? a / b : 0.0;
+    case Op::Pow: return std::pow(a, b);
+    case Op::Neg: return -a;
+    case Op::Sin: return std::sin(a);
+    case Op::Cos: return std::cos(a);
+    case Op::Tan: return std::tan(a);
+    case Op::Abs: return std::abs(a);
+    case Op::Sqrt: return a >= 0 ? std::sqrt(a) : 0.0;
+    case Op::Log: return a > 0 ? std::log(a) : -100.0;
+    case Op::Exp: return std::exp(a);
+    case Op::Sign: return a > 0 ? 1.0 : (a < 0 ? -1.0 : 0.0);
+    case Op::Step: return a > 0 ? 1.0 : 0.0;
+    default: return 0.0;
+    }
+}
+
+inline bool isBinary(Op op) {
+    return op == Op::Add || op == Op::Sub || op == Op::Mul || op == Op::Div || op == Op::Pow;
+}
+
+// SSA 形式で命令を積む。同じ命令は同じレジスタを返す (value numbering)
+class Builder {
+public:
+    QVector<Instruction> code;
+
+    int constant(double value) {
+        return intern({Op::Const, -1, -1, value});
+    }
+
+    int variable() {
+        return intern({Op::X, -1, -1, 0.0});
+    }
+
+    bool isConstant(int r, double value) const {
+        return code[r].op == Op::Const && code[r].value == value;
+    }
+
+    int emit(Op op, int a, int b = -1) {
+        const bool constA = code[a].op == Op::Const;
+        const bool constB = b >= 0 && code[b].op == Op::Const;
+
+        // 定数畳み込み
+        if (constA && (b < 0 || constB)) {
+            return constant(apply(op, code[a].value, b >= 0 ? code[b].value : 0.0));
+        }
+
+        // 代数的な簡約（主に導関数の生成で出てくる 0 と 1 を消す）
+        switch (op) {
+        case Op::Add:
+            if (isConstant(a, 0.0)) return b;
+            if (isConstant(b, 0.0)) return a;
+            break;
+        case Op::Sub:
+            if (isConstant(b, 0.0)) return a;
+            if (isConstant(a, 0.0)) return emit(Op::Neg, b);
+            if (a == b) return constant(0.0);
+            break;
+        case Op::Mul:
+            if (isConstant(a, 0.0) || isConstant(b, 0.0)) return constant(0.0);
+            if (isConstant(a, 1.0)) return b;
+            if (isConstant(b, 1.0)) return a;
+            if (isConstant(a, -1.0)) return emit(Op::Neg, b);
+            if (isConstant(b, -1.0)) return emit(Op::Neg, a);
+            break;
+        case Op::Div:
+            if (isConstant(a, 0.0)) return constant(0.0);
+            if (isConstant(b, 1.0)) return a;
+            break;
+        case Op::Pow:
+            if (isConstant(b, 1.0)) return a;
+            if (isConstant(b, 0.0)) return constant(1.0);
+            break;
+        case Op::Neg:
+            if (code[a].op == Op::Neg) return code[a].a;
+            break;
+        default:
+            break;
+        }
+
+        // 可換演算はオペランドの順序を揃えて共通部分式を見つけやすくする
+        if ((op == Op::Add || op == Op::Mul) && a > b) std::swap(a, b);
+        return intern({op, a, b, 0.0});
+    }
+
+private:
+    using Key = std::tuple<int, int, int, quint64>;
+    std::map<Key, int> m_known;
+
+    int intern(const Instruction& instruction) {
+        quint64 bits = 0;
+        std::memcpy(&bits, &instruction.value, sizeof(bits));
+        const Key key(static_cast<int>(instruction.op), instruction.a, instruction.b, bits);
+        auto it = m_known.find(key);
+        if (it != m_known.end()) return it->second;
+        code.append(instruction);
+        const int r = code.size() - 1;
+        m_known.emplace(key, r);
+        return r;
+    }
+};
+
+// Shunting-yard: the same grammar the node has always accepted
+QVector<QString> toRpn(const QString& text) {
+    QString eq = text.toLower().remove(" ").remove("y="); // Normalize
+
+    QVector<QString> outputQueue;
+    std::stack<QString> operatorStack;
+
+    auto precedence = [](const QString& op) {
+        if (op == "+" || op == "-") return 1;
+        if (op == "*" || op == "/") return 2;
+        if (op == "^") return 3;
+        return 0;
+    };
+
+    auto isFunc = [](const QString& s) {
+        return s=="sin"||s=="cos"||s=="tan"||s=="abs"||s=="sqrt"||s=="log"||s=="exp";
+    };
+
+    int i = 0;
+    while (i < eq.length()) {
+        QChar c = eq[i];
+
+        if (c.isDigit() || c == '.') {
+            int start = i;
+            while (i < eq.length() && (eq[i].isDigit() || eq[i] == '.')) i++;
+            outputQueue.append(eq.mid(start, i - start));
+            continue;
+        }
+
+        if (c.isLetter()) {
+            int start = i;
+            while (i < eq.length() && eq[i].isLetter()) i++;
+            QString ident = eq.mid(start, i - start);
+            if (isFunc(ident)) {
+                operatorStack.push(ident);
+            } else { // Variable (x, or constants e, pi)
+                outputQueue.append(ident);
+            }
+            continue;
+        }
+
+        if (QString("+-*/^").contains(c)) {
+            QString op = QString(c);
+            while (!operatorStack.empty()) {
+                QString top = operatorStack.top();
+                if (top == "(") break;
+                if (precedence(top) >= precedence(op)) {
+                    outputQueue.append(operatorStack.top());
+                    operatorStack.pop();
+                } else break;
+            }
+            operatorStack.push(op);
+            i++;
+            continue;
+        }
+
+        if (c == '(') {
+            operatorStack.push("(");
+            i++;
+            continue;
+        }
+
+        if (c == ')') {
+            while (!operatorStack.empty() && operatorStack.top() != "(") {
+                outputQueue.append(operatorStack.top());
+                operatorStack.pop();
+            }
+            if (!operatorStack.empty()) operatorStack.pop(); // Pop '('
+            if (!operatorStack.empty() && isFunc(operatorStack.top())) {
+                outputQueue.append(operatorStack.top());
+                operatorStack.pop();
+            }
+            i++;
+            continue;
+        }
+
+        i++; // Skip unknowns
+    }
+
+    while (!operatorStack.empty()) {
+        outputQueue.append(operatorStack.top());
+        operatorStack.pop();
+    }
+    return outputQueue;
+}
+
+// 各命令の導関数を前から順に生成する（オペランドは常に前の命令なので一巡で済む）
+int derive(Builder& builder, int result) {
+    const int count = builder.code.size();
+    std::vector<int> d(count, -1);
+
+    for (int i = 0; i < count; ++i) {
+        const Instruction ins = builder.code[i];
+        const int a = ins.a;
+        const int b = ins.b;
+        const int da = a >= 0 ? d[a] : -1;
+        const int db = b >= 0 ? d[b] : -1;
+
+        switch (ins.op) {
+        case Op::Const: d[i] = builder.constant(0.0); break;
+        case Op::X: d[i] = builder.constant(1.0); break;
+        case Op::Add: d[i] = builder.emit(Op::Add, da, db); break;
+        case Op::Sub: d[i] = builder.emit(Op::Sub, da, db); break;
+        case Op::Mul:
+            d[i] = builder.emit(Op::Add, builder.emit(Op::Mul, da, b), builder.emit(Op::Mul, a, db));
+            break;
+        case Op::Div:
+            // (a/b)' = (a' - (a/b) b') / b
+            d[i] = builder.emit(Op::Div, builder.emit(Op::Sub, da, builder.emit(Op::Mul, i, db)), b);
+            break;
+        case Op::Pow:
+            if (builder.code[b].op == Op::Const) {
+                const double n = builder.code[b].value;
+                d[i] = builder.emit(Op::Mul,
+                                    builder.emit(Op::Mul, builder.constant(n), builder.emit(Op::Pow, a, builder.constant(n - 1.0))),
+                                    da);
+            } else {
+                // (a^b)' = a^b (b' ln a + b a' / a)
+                const int lnA = builder.emit(Op::Log, a);
+                const int term = builder.emit(Op::Add, builder.emit(Op::Mul, db, lnA),
+                                              builder.emit(Op::Div, builder.emit(Op::Mul, b, da), a));
+                d[i] = builder.emit(Op::Mul, i, term);
+            }
+            break;
+        case Op::Neg: d[i] = builder.emit(Op::Neg, da); break;
+        case Op::Sin: d[i] = builder.emit(Op::Mul, builder.emit(Op::Cos, a), da); break;
+        case Op::Cos: d[i] = builder.emit(Op::Neg, builder.emit(Op::Mul, builder.emit(Op::Sin, a), da)); break;
+        case Op::Tan: {
+            const int c = builder.emit(Op::Cos, a);
+            d[i] = builder.emit(Op::Div, da, builder.emit(Op::Mul, c, c));
+            break;
+        }
+        case Op::Abs: d[i] = builder.emit(Op::Mul, builder.emit(Op::Sign, a), da); break;
+        case Op::Sqrt: d[i] = builder.emit(Op::Div, da, builder.emit(Op::Mul, builder.constant(2.0), i)); break;
+        case Op::Log: d[i] = builder.emit(Op::Mul, builder.emit(Op::Step, a), builder.emit(Op::Div, da, a)); break;
+        case Op::Exp: d[i] = builder.emit(Op::Mul, i, da); break;
+        case Op::Sign:
+        case Op::Step: d[i] = builder.constant(0.0); break;
+        }
+    }
+    return d[result];
+}
+
+// 1ブロックで同時に評価するレーン数
+constexpr int BlockSize = 64;
+
+} // namespace
+
+std::shared_ptr<const Equation> Equation::compile(const QString& text) {
+    std::shared_ptr<Equation> equation(new Equation());
+    Builder builder;
+
+    // RPN → SSA（スタックが足りない演算子は従来通り読み飛ばす）
+    std::vector<int> stack;
+    for (const QString& s : toRpn(text)) {
+        if (s[0].isDigit() || s[0] == '.') {
+            stack.push_back(builder.constant(s.toDouble()));
+        } else if (s.length() == 1 && QString("+-*/^").contains(s)) {
+            if (stack.size() < 2) continue;
+            const int b = stack.back(); stack.pop_back();
+            const int a = stack.back(); stack.pop_back();
+            const Op op = s == "+" ? Op::Add : s == "-" ? Op::Sub : s == "*" ? Op::Mul : s == "/" ? Op::Div : Op::Pow;
+            stack.push_back(builder.emit(op, a, b));
+        } else if (s == "sin" || s == "cos" || s == "tan" || s == "abs" || s == "sqrt" || s == "log" || s == "exp") {
+            if (stack.empty()) continue;
+            const int a = stack.back(); stack.pop_back();
+            const Op op = s == "sin" ? Op::Sin : s == "cos" ? Op::Cos : s == "tan" ? Op::Tan
+                        : s == "abs" ? Op::Abs : s == "sqrt" ? Op::Sqrt : s == "log" ? Op::Log : Op::Exp;
+            stack.push_back(builder.emit(op, a));
+        } else if (s == "pi") {
+            stack.push_back(builder.constant(3.14159265));
+        } else if (s == "e") {
+            stack.push_back(builder.constant(2.71828));
+        } else {
+            stack.push_back(builder.variable()); // treat as x
+        }
+    }
+    if (stack.empty()) {
+        return equation;
+    }
+
+    const int result = stack.back();
+    const int derivative = derive(builder, result);
+
+    // 使われない命令を除いて詰め直す
+    const QVector<Instruction>& code = builder.code;
+    std::vector<bool> live(code.size(), false);
+    live[result] = true;
+    live[derivative] = true;
+    for (int i = code.size() - 1; i >= 0; --i) {
+        if (!live[i]) continue;
+        if (code[i].a >= 0) live[code[i].a] = true;
+        if (code[i].b >= 0) live[code[i].b] = true;
+    }
+    std::vector<int> remap(code.size(), -1);
+    for (int i = 0; i < code.size(); ++i) {
+        if (!live[i]) continue;
+        Instruction ins = code[i];
+        if (ins.a >= 0) ins.a = remap[ins.a];
+        if (ins.b >= 0) ins.b = remap[ins.b];
+        remap[i] = equation->m_code.size();
+        equation->m_code.append(ins);
+    }
+    equation->m_result = remap[result];
+    equation->m_derivative = remap[derivative];
+    return equation;
+}
+
+void Equation::evaluate(double x, double& fx, double& dfx) const {
+    if (m_result < 0) {
+        fx = 0.0;
+        dfx = 0.0;
+        return;
+    }
+
+    ScratchArena::Scope scratch;
+    double* regs = scratch.allocate<double>(m_code.size());
+    for (int i = 0; i < m_code.size(); ++i) {
+        const Instruction& ins = m_code[i];
+        switch (ins.op) {
+        case Op::Const: regs[i] = ins.value; break;
+        case Op::X: regs[i] = x; break;
+        default:
+            regs[i] = apply(ins.op, regs[ins.a], isBinary(ins.op) ? regs[ins.b] : 0.0);
+            break;
+        }
+    }
+    fx = regs[m_result];
+    dfx = regs[m_derivative];
+}
+
+void Equation::evaluate(const double* x, double* fx, double* dfx, int count) const {
+    if (m_result < 0) {
+        std::fill(fx, fx + count, 0.0);
+        if (dfx) std::fill(dfx, dfx + count, 0.0);
+        return;
+    }
+
+    // レジスタ r のブロックは regs[r * BlockSize ...]
+    ScratchArena::Scope scratch;
+    double* regs = scratch.allocate<double>(static_cast<size_t>(m_code.size()) * BlockSize);
+
+    for (int start = 0; start < count; start += BlockSize) {
+        const int n = std::min(BlockSize, count - start);
+
+        for (int i = 0; i < m_code.size(); ++i) {
+            const Instruction& ins = m_code[i];
+            double* out = regs + static_cast<size_t>(i) * BlockSize;
+            const double* a = ins.a >= 0 ? regs + static_cast<size_t>(ins.a) * BlockSize : nullptr;
+            const double* b = ins.b >= 0 ? regs + static_cast<size_t>(ins.b) * BlockSize : nullptr;
+
+            switch (ins.op) {
+            case Op::Const: std::fill(out, out + n, ins.value); break;
+            case Op::X: std::copy(x + start, x + start + n, out); break;
+            case Op::Add: for (int k = 0; k < n; ++k) out[k] = a[k] + b[k]; break;
+            case Op::Sub: for (int k = 0; k < n; ++k) out[k] = a[k] - b[k]; break;
+            case Op::Mul: for (int k = 0; k < n; ++k) out[k] = a[k] * b[k]; break;
+            case Op::Div:
+                for (int k = 0; k < n; ++k) out[k] = b[k] != 0 ? a[k] / b[k] : 0.0;
+                break;
+            case Op::Neg: for (int k = 0; k < n; ++k) out[k] = -a[k]; break;
+            case Op::Abs: for (int k = 0; k < n; ++k) out[k] = std::abs(a[k]); break;
+            case Op::Sign:
+                for (int k = 0; k < n; ++k) out[k] = a[k] > 0 ? 1.0 : (a[k] < 0 ? -1.0 : 0.0);
+                break;
+            case Op::Step: for (int k = 0; k < n; ++k) out[k] = a[k] > 0 ? 1.0 : 0.0; break;
+            case Op::Sqrt:
+                for (int k = 0; k < n; ++k) out[k] = a[k] >= 0 ? std::sqrt(a[k]) : 0.0;
+                break;
+            default:
+                // 超越関数はライブラリ呼び出しのまま
+                for (int k = 0; k < n; ++k) out[k] = apply(ins.op, a[k], b ? b[k] : 0.0);
+                break;
+            }
+        }
+
+        const double* result = regs + static_cast<size_t>(m_result) * BlockSize;
+        std::copy(result, result + n, fx + start);
+        if (dfx) {
+            const double* derivative = regs + static_cast<size_t>(m_derivative) * BlockSize;
+            std::copy(derivative, derivative + n, dfx + start);
+        }
+    }
+}
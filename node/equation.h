@@ -0,0 +1,52 @@
+#ifndef EQUATION_H
+#define EQUATION_H
+
+#include <QString>
+#include <QVector>
+#include <cstdint>
+#include <memory>
+
+// Equation - a custom y = f(x) expression compiled to typed bytecode.
+//
+// The parser produces RPN as before; the compiler turns it into a
+// register program (one instruction per register, operands always refer
+// to earlier registers) while folding constants and sharing common
+// subexpressions, then appends the analytic derivative f'(x) to the same
+// program so both are evaluated in one pass. Immutable once compiled.
+class Equation {
+public:
+    enum class Op : uint8_t {
+        Const, X,
+        Add, Sub, Mul, Div, Pow,
+        Neg, Sin, Cos, Tan, Abs, Sqrt, Log, Exp,
+        Sign, Step
+    };
+
+    struct Instruction {
+        Op op;
+        int a;        // operand registers (-1 = unused)
+        int b;
+        double value; // Const
+    };
+
+    static std::shared_ptr<const Equation> compile(const QString& text);
+
+    // f(x) と f'(x) をまとめて評価
+    void evaluate(double x, double& fx, double& dfx) const;
+
+    // Batch evaluation over arrays of x. The program is run one
+    // instruction at a time across a block of lanes, so the inner loops are
+    // plain array arithmetic the compiler can vectorize. dfx may be null.
+    void evaluate(const double* x, double* fx, double* dfx, int count) const;
+
+    const QVector<Instruction>& code() const { return m_code; }
+
+private:
+    Equation() = default;
+
+    QVector<Instruction> m_code;
+    int m_result = -1;      // f(x) の レジスタ (-1 = 空の式 → 0)
+    int m_derivative = -1;  // f'(x) の レジスタ
+};
+
+#endif // EQUATION_H
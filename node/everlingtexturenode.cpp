@@ -59,20 +59,20 @@ void EverlingTextureNode::evaluate() {
     // Stateless - computation happens in compute()
 }
 
-QVector<Node::ParameterInfo> EverlingTextureNode::parameters() const {
+QVector<Node::ParameterInfo> EverlingTextureNode::describeParameters() const {
     QVector<ParameterInfo> params;
     
     // Access Method enum with setter
     params.append(ParameterInfo(
         "Access Method", 
         {"Stack", "Random", "Gaussian", "Mixed"},
-        QVariant::fromValue(m_accessMethod),
-        [this](const QVariant& v) {
-            const_cast<EverlingTextureNode*>(this)->m_accessMethod = v.toInt();
-            const_cast<EverlingTextureNode*>(this)->setDirty(true);
-        },
-        "Traversal Strategy:\nStack = Fractal veins\nRandom = Erosion patterns\nGaussian = Cloudy clusters\nMixed = Balanced"
-    ));
+        QVariant::fromValue(m_accessMethod), nullptr,
+        "Traversal Strategy:\nStack = Fractal veins\nRandom = Erosion patterns\nGaussian = Cloudy clusters\nMixed = Balanced")
+        .bind<EverlingTextureNode>([](const EverlingTextureNode& n) { return n.m_accessMethod; },
+                                   [](EverlingTextureNode& n, const QVariant& v) {
+                                       n.m_accessMethod = v.toInt();
+                                       n.setDirty(true);
+                                   }));
     
     // Seed as integer with setter - regenerates noise
     ParameterInfo seedInfo;
@@ -83,14 +83,14 @@ QVector<Node::ParameterInfo> EverlingTextureNode::parameters() const {
     seedInfo.defaultValue = m_seed;
     seedInfo.step = 1;
     seedInfo.tooltip = "Random seed (changes pattern)";
-    seedInfo.setter = [this](const QVariant& v) {
-        auto* self = const_cast<EverlingTextureNode*>(this);
-        self->m_seed = v.toInt();
-        self->m_noise = std::make_unique<PerlinNoise>(self->m_seed);
-        // Force buffer regeneration by clearing cached values
-        self->m_noise->clearEverlingCache();
-        self->setDirty(true);
-    };
+    seedInfo.bind<EverlingTextureNode>([](const EverlingTextureNode& n) { return n.m_seed; },
+                                       [](EverlingTextureNode& n, const QVariant& v) {
+                                           n.m_seed = v.toInt();
+                                           n.m_noise = std::make_unique<PerlinNoise>(n.m_seed);
+                                           // Force buffer regeneration by clearing cached values
+                                           n.m_noise->clearEverlingCache();
+                                           n.setDirty(true);
+                                       });
     params.append(seedInfo);
     
     // Scale with setter
@@ -102,12 +102,12 @@ QVector<Node::ParameterInfo> EverlingTextureNode::parameters() const {
     scaleInfo.defaultValue = m_scale;
     scaleInfo.step = 0.1;
     scaleInfo.tooltip = "Texture scale";
-    scaleInfo.setter = [this](const QVariant& v) {
-        auto* self = const_cast<EverlingTextureNode*>(this);
-        self->m_scale = v.toDouble();
-        if (self->m_scaleInput) self->m_scaleInput->setDefaultValue(self->m_scale);
-        self->setDirty(true);
-    };
+    scaleInfo.bind<EverlingTextureNode>([](const EverlingTextureNode& n) { return n.m_scale; },
+                                        [](EverlingTextureNode& n, const QVariant& v) {
+                                            n.m_scale = v.toDouble();
+                                            if (n.m_scaleInput) n.m_scaleInput->setDefaultValue(n.m_scale);
+                                            n.setDirty(true);
+                                        });
     params.append(scaleInfo);
     
     // Mean with setter
@@ -119,12 +119,12 @@ QVector<Node::ParameterInfo> EverlingTextureNode::parameters() const {
     meanInfo.defaultValue = m_mean;
     meanInfo.step = 0.1;
     meanInfo.tooltip = "Gaussian mean (negative=valleys, positive=mountains)";
-    meanInfo.setter = [this](const QVariant& v) {
-        auto* self = const_cast<EverlingTextureNode*>(this);
-        self->m_mean = v.toDouble();
-        if (self->m_meanInput) self->m_meanInput->setDefaultValue(self->m_mean);
-        self->setDirty(true);
-    };
+    meanInfo.bind<EverlingTextureNode>([](const EverlingTextureNode& n) { return n.m_mean; },
+                                       [](EverlingTextureNode& n, const QVariant& v) {
+                                           n.m_mean = v.toDouble();
+                                           if (n.m_meanInput) n.m_meanInput->setDefaultValue(n.m_mean);
+                                           n.setDirty(true);
+                                       });
     params.append(meanInfo);
     
     // StdDev with setter
@@ -136,12 +136,12 @@ QVector<Node::ParameterInfo> EverlingTextureNode::parameters() const {
     stddevInfo.defaultValue = m_stddev;
     stddevInfo.step = 0.1;
     stddevInfo.tooltip = "Standard deviation (higher=more rugged)";
-    stddevInfo.setter = [this](const QVariant& v) {
-        auto* self = const_cast<EverlingTextureNode*>(this);
-        self->m_stddev = v.toDouble();
-        if (self->m_stddevInput) self->m_stddevInput->setDefaultValue(self->m_stddev);
-        self->setDirty(true);
-    };
+    stddevInfo.bind<EverlingTextureNode>([](const EverlingTextureNode& n) { return n.m_stddev; },
+                                         [](EverlingTextureNode& n, const QVariant& v) {
+                                             n.m_stddev = v.toDouble();
+                                             if (n.m_stddevInput) n.m_stddevInput->setDefaultValue(n.m_stddev);
+                                             n.setDirty(true);
+                                         });
     params.append(stddevInfo);
     
     // Cluster Spread (Gaussian Mode only)
@@ -153,12 +153,12 @@ QVector<Node::ParameterInfo> EverlingTextureNode::parameters() const {
     spreadInfo.defaultValue = m_clusterSpread;
     spreadInfo.step = 0.05;
     spreadInfo.tooltip = "Cluster spread (Gaussian mode only)";
-    spreadInfo.setter = [this](const QVariant& v) {
-        auto* self = const_cast<EverlingTextureNode*>(this);
-        self->m_clusterSpread = v.toDouble();
-        if (self->m_clusterSpreadInput) self->m_clusterSpreadInput->setDefaultValue(self->m_clusterSpread);
-        self->setDirty(true);
-    };
+    spreadInfo.bind<EverlingTextureNode>([](const EverlingTextureNode& n) { return n.m_clusterSpread; },
+                                         [](EverlingTextureNode& n, const QVariant& v) {
+                                             n.m_clusterSpread = v.toDouble();
+                                             if (n.m_clusterSpreadInput) n.m_clusterSpreadInput->setDefaultValue(n.m_clusterSpread);
+                                             n.setDirty(true);
+                                         });
     params.append(spreadInfo);
 
     // Smooth Edges (Checkbox)
@@ -167,11 +167,11 @@ QVector<Node::ParameterInfo> EverlingTextureNode::parameters() const {
     smoothInfo.name = "Smooth Edges";
     smoothInfo.defaultValue = m_smoothEdges;
     smoothInfo.tooltip = "Fade edges to prevent hard cuts at tile boundaries";
-    smoothInfo.setter = [this](const QVariant& v) {
-        auto* self = const_cast<EverlingTextureNode*>(this);
-        self->m_smoothEdges = v.toBool();
-        self->setDirty(true);
-    };
+    smoothInfo.bind<EverlingTextureNode>([](const EverlingTextureNode& n) { return n.m_smoothEdges; },
+                                         [](EverlingTextureNode& n, const QVariant& v) {
+                                             n.m_smoothEdges = v.toBool();
+                                             n.setDirty(true);
+                                         });
     params.append(smoothInfo);
 
     // Smooth Width (Float, only if Smooth Edges is on ideally, but we show always)
@@ -183,11 +183,11 @@ QVector<Node::ParameterInfo> EverlingTextureNode::parameters() const {
     smoothWidthInfo.defaultValue = m_smoothWidth;
     smoothWidthInfo.step = 0.01;
     smoothWidthInfo.tooltip = "Width of the edge transition (0.0 - 0.5)";
-    smoothWidthInfo.setter = [this](const QVariant& v) {
-        auto* self = const_cast<EverlingTextureNode*>(this);
-        self->m_smoothWidth = v.toDouble();
-        self->setDirty(true);
-    };
+    smoothWidthInfo.bind<EverlingTextureNode>([](const EverlingTextureNode& n) { return n.m_smoothWidth; },
+                                              [](EverlingTextureNode& n, const QVariant& v) {
+                                                  n.m_smoothWidth = v.toDouble();
+                                                  n.setDirty(true);
+                                              });
     params.append(smoothWidthInfo);
 
     // Grid Size (Int)
@@ -199,11 +199,11 @@ QVector<Node::ParameterInfo> EverlingTextureNode::parameters() const {
     gridInfo.defaultValue = m_gridSize;
     gridInfo.step = 16;
     gridInfo.tooltip = "Internal simulation grid size. Higher = Larger non-repeating area but slower generation.";
-    gridInfo.setter = [this](const QVariant& v) {
-        auto* self = const_cast<EverlingTextureNode*>(this);
-        self->m_gridSize = v.toInt();
-        self->setDirty(true);
-    };
+    gridInfo.bind<EverlingTextureNode>([](const EverlingTextureNode& n) { return n.m_gridSize; },
+                                       [](EverlingTextureNode& n, const QVariant& v) {
+                                           n.m_gridSize = v.toInt();
+                                           n.setDirty(true);
+                                       });
     params.append(gridInfo);
     
     // Periodicity
@@ -212,11 +212,11 @@ QVector<Node::ParameterInfo> EverlingTextureNode::parameters() const {
     periodInfo.name = "Tiling Mode";
     periodInfo.options = {"Repeat (Hard Edge)", "Mirror (Seamless)"};
     periodInfo.defaultValue = QVariant::fromValue(m_periodicity);
-    periodInfo.setter = [this](const QVariant& v) {
-        auto* self = const_cast<EverlingTextureNode*>(this);
-        self->m_periodicity = v.toInt();
-        self->setDirty(true);
-    };
+    periodInfo.bind<EverlingTextureNode>([](const EverlingTextureNode& n) { return n.m_periodicity; },
+                                         [](EverlingTextureNode& n, const QVariant& v) {
+                                             n.m_periodicity = v.toInt();
+                                             n.setDirty(true);
+                                         });
     params.append(periodInfo);
 
     // Distortion
@@ -225,12 +225,12 @@ QVector<Node::ParameterInfo> EverlingTextureNode::parameters() const {
     distInfo.name = "Distortion";
     distInfo.min = 0.0; distInfo.max = 10.0;
     distInfo.defaultValue = m_distortion;
-    distInfo.setter = [this](const QVariant& v) {
-        auto* self = const_cast<EverlingTextureNode*>(this);
-        self->m_distortion = v.toDouble();
-        if (self->m_distortionInput) self->m_distortionInput->setDefaultValue(self->m_distortion);
-        self->setDirty(true);
-    };
+    distInfo.bind<EverlingTextureNode>([](const EverlingTextureNode& n) { return n.m_distortion; },
+                                       [](EverlingTextureNode& n, const QVariant& v) {
+                                           n.m_distortion = v.toDouble();
+                                           if (n.m_distortionInput) n.m_distortionInput->setDefaultValue(n.m_distortion);
+                                           n.setDirty(true);
+                                       });
     params.append(distInfo);
     
     // Detail (Octaves)
@@ -239,12 +239,12 @@ QVector<Node::ParameterInfo> EverlingTextureNode::parameters() const {
     octaveInfo.name = "Detail";
     octaveInfo.min = 1; octaveInfo.max = 10;
     octaveInfo.defaultValue = m_octaves;
-    octaveInfo.setter = [this](const QVariant& v) {
-        auto* self = const_cast<EverlingTextureNode*>(this);
-        self->m_octaves = v.toInt();
-        if (self->m_detailInput) self->m_detailInput->setDefaultValue(self->m_octaves);
-        self->setDirty(true);
-    };
+    octaveInfo.bind<EverlingTextureNode>([](const EverlingTextureNode& n) { return n.m_octaves; },
+                                         [](EverlingTextureNode& n, const QVariant& v) {
+                                             n.m_octaves = v.toInt();
+                                             if (n.m_detailInput) n.m_detailInput->setDefaultValue(n.m_octaves);
+                                             n.setDirty(true);
+                                         });
     params.append(octaveInfo);
     
     // Gain (Roughness)
@@ -253,11 +253,11 @@ QVector<Node::ParameterInfo> EverlingTextureNode::parameters() const {
     gainInfo.name = "Roughness";
     gainInfo.min = 0.0; gainInfo.max = 1.0;
     gainInfo.defaultValue = m_gain;
-    gainInfo.setter = [this](const QVariant& v) {
-        auto* self = const_cast<EverlingTextureNode*>(this);
-        self->m_gain = v.toDouble();
-        self->setDirty(true);
-    };
+    gainInfo.bind<EverlingTextureNode>([](const EverlingTextureNode& n) { return n.m_gain; },
+                                       [](EverlingTextureNode& n, const QVariant& v) {
+                                           n.m_gain = v.toDouble();
+                                           n.setDirty(true);
+                                       });
     params.append(gainInfo);
 
     return params;
@@ -362,3 +362,13 @@ void EverlingTextureNode::restore(const QJsonObject& data) {
     if (m_distortionInput) m_distortionInput->setDefaultValue(m_distortion);
     if (m_detailInput) m_detailInput->setDefaultValue(m_octaves);
 }
+
+QByteArray EverlingTextureNode::saveBakedCache() const {
+    QMutexLocker locker(&m_mutex);
+    return m_noise->saveEverlingCache();
+}
+
+bool EverlingTextureNode::restoreBakedCache(const uchar* data, qint64 size) {
+    QMutexLocker locker(&m_mutex);
+    return m_noise->restoreEverlingCache(data, size);
+}
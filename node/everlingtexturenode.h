@@ -17,10 +17,14 @@ public:
     void evaluate() override;
     
     // Unified Parameter API
-    QVector<ParameterInfo> parameters() const override;
     QJsonObject save() const override;
     void restore(const QJsonObject& data) override;
+    QByteArray saveBakedCache() const override;
+    bool restoreBakedCache(const uchar* data, qint64 size) override;
     
+protected:
+    QVector<ParameterInfo> describeParameters() const override;
+
 private:
     NodeSocket* m_vectorInput;
     NodeSocket* m_scaleInput;
@@ -101,7 +101,7 @@ QVariant GaborTextureNode::compute(const QVector3D& pos, NodeSocket* socket) {
     return result.value;
 }
 
-QVector<Node::ParameterInfo> GaborTextureNode::parameters() const {
+QVector<Node::ParameterInfo> GaborTextureNode::describeParameters() const {
     QVector<ParameterInfo> params;
     
     // Core parameters
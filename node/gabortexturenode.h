@@ -13,12 +13,13 @@ public:
     
     void evaluate() override;
     QVariant compute(const QVector3D& pos, NodeSocket* socket) override;
-    
-    QVector<ParameterInfo> parameters() const override;
-    
+
     QJsonObject save() const override;
     void restore(const QJsonObject& json) override;
     
+protected:
+    QVector<ParameterInfo> describeParameters() const override;
+
 private:
     std::unique_ptr<PerlinNoise> m_noise;
     mutable QRecursiveMutex m_mutex;
@@ -0,0 +1,202 @@
+#include "glyphatlas.h"
+#include <QFont>
+#include <QImage>
+#include <QMutexLocker>
+#include <QPainter>
+#include <QPainterPath>
+#include <algorithm>
+#include <cmath>
+#include <limits>
+
+namespace {
+
+const float kInf = 1e20f;
+
+// Felzenszwalb & Huttenlocher の1次元二乗距離変換
+void distanceTransform1D(const float* f, int n, float* d, int* v, float* z) {
+    int k = 0;
+    v[0] = 0;
+    z[0] = -kInf;
+    z[1] = kInf;
+    for (int q = 1; q < n; ++q) {
+        float s = ((f[q] + q * q) - (f[v[k]] + v[k] * v[k])) / (2.0f * q - 2.0f * v[k]);
+        while (s <= z[k]) {
+            --k;
+            s = ((f[q] + q * q) - (f[v[k]] + v[k] * v[k])) / (2.0f * q - 2.0f * v[k]);
+        }
+        ++k;
+        v[k] = q;
+        z[k] = s;
+        z[k + 1] = kInf;
+    }
+    k = 0;
+    for (int q = 0; q < n; ++q) {
+        while (z[k + 1] < q) ++k;
+        const float dq = static_cast<float>(q - v[k]);
+        d[q] = dq * dq + f[v[k]];
+    }
+}
+
+// grid: 0 = 特徴点, kInf = それ以外。結果は二乗距離
+void distanceTransform2D(std::vector<float>& grid, int width, int height) {
+    const int n = std::max(width, height);
+    std::vector<float> f(n), d(n), z(n + 1);
+    std::vector<int> v(n);
+
+    for (int x = 0; x < width; ++x) {
+        for (int y = 0; y < height; ++y) f[y] = grid[static_cast<size_t>(y) * width + x];
+        distanceTransform1D(f.data(), height, d.data(), v.data(), z.data());
+        for (int y = 0; y < height; ++y) grid[static_cast<size_t>(y) * width + x] = d[y];
+    }
+    for (int y = 0; y < height; ++y) {
+        float* row = grid.data() + static_cast<size_t>(y) * width;
+        std::copy(row, row + width, f.begin());
+        distanceTransform1D(f.data(), width, d.data(), v.data(), z.data());
+        std::copy(d.begin(), d.begin() + width, row);
+    }
+}
+
+} // namespace
+
+float GlyphAtlas::Glyph::distance(float x, float y) const {
+    // ビットマップ座標（テクセル中心基準）
+    const float bx = x - originX - 0.5f;
+    const float by = y - originY - 0.5f;
+
+    if (width == 0 || bx < 0.0f || by < 0.0f || bx > width - 1 || by > height - 1) {
+        // 外側はインクから少なくとも spread 離れている
+        const float dx = std::max({0.0f, -bx, bx - (width - 1)});
+        const float dy = std::max({0.0f, -by, by - (height - 1)});
+        return spread + std::sqrt(dx * dx + dy * dy);
+    }
+
+    const int x0 = std::min(static_cast<int>(bx), width - 2 < 0 ? 0 : width - 2);
+    const int y0 = std::min(static_cast<int>(by), height - 2 < 0 ? 0 : height - 2);
+    const int x1 = std::min(x0 + 1, width - 1);
+    const int y1 = std::min(y0 + 1, height - 1);
+    const float tx = bx - x0;
+    const float ty = by - y0;
+
+    const uint8_t* p = sdf.data();
+    const float top = p[y0 * width + x0] + (p[y0 * width + x1] - p[y0 * width + x0]) * tx;
+    const float bottom = p[y1 * width + x0] + (p[y1 * width + x1] - p[y1 * width + x0]) * tx;
+    const float value = top + (bottom - top) * ty;
+    return (128.0f - value) / 127.0f * spread;
+}
+
+int GlyphAtlas::sizeClassFor(double emPixels) {
+    // SDF は2倍程度の拡大まで輪郭が保たれる: the smallest power of two
+    // (32 .. 1024) that is at least half the em size. Only beyond an em of
+    // 2048 px does magnification exceed 2x.
+    int sizeClass = 32;
+    while (sizeClass * 2.0 < emPixels && sizeClass < 1024) {
+        sizeClass *= 2;
+    }
+    return sizeClass;
+}
+
+std::shared_ptr<GlyphAtlas> GlyphAtlas::forFont(const QString& family, int sizeClass) {
+    static QMutex registryMutex;
+    static QHash<QString, std::shared_ptr<GlyphAtlas>> registry;
+
+    const QString key = family + QLatin1Char('@') + QString::number(sizeClass);
+    QMutexLocker locker(&registryMutex);
+    auto it = registry.find(key);
+    if (it != registry.end()) {
+        return it.value();
+    }
+    std::shared_ptr<GlyphAtlas> atlas(new GlyphAtlas(family, sizeClass));
+    registry.insert(key, atlas);
+    return atlas;
+}
+
+GlyphAtlas::GlyphAtlas(const QString& family, int sizeClass)
+    : m_family(family)
+    , m_sizeClass(sizeClass)
+{
+}
+
+GlyphAtlas::GlyphPtr GlyphAtlas::glyph(char32_t codepoint) {
+    {
+        QMutexLocker locker(&m_mutex);
+        auto it = m_glyphs.find(codepoint);
+        if (it != m_glyphs.end()) {
+            return it.value();
+        }
+    }
+
+    GlyphPtr result = rasterize(codepoint);
+
+    QMutexLocker locker(&m_mutex);
+    auto it = m_glyphs.find(codepoint);
+    if (it != m_glyphs.end()) {
+        return it.value();
+    }
+    m_glyphs.insert(codepoint, result);
+    return result;
+}
+
+GlyphAtlas::GlyphPtr GlyphAtlas::rasterize(char32_t codepoint) const {
+    auto glyph = std::make_shared<Glyph>();
+    glyph->spread = std::max(2.0f, m_sizeClass / 8.0f);
+
+    QFont font(m_family);
+    font.setPixelSize(m_sizeClass);
+    QPainterPath path;
+    path.addText(0, 0, font, QString::fromUcs4(&codepoint, 1));
+    const QRectF bounds = path.boundingRect();
+    if (path.isEmpty() || bounds.isEmpty()) {
+        return glyph;  // 空白など
+    }
+
+    // spread 分の余白を付けてカバレッジを描画
+    const int pad = static_cast<int>(std::ceil(glyph->spread)) + 1;
+    glyph->originX = static_cast<float>(std::floor(bounds.left()) - pad);
+    glyph->originY = static_cast<float>(std::floor(bounds.top()) - pad);
+    glyph->width = static_cast<int>(std::ceil(bounds.right()) - std::floor(bounds.left())) + 2 * pad;
+    glyph->height = static_cast<int>(std::ceil(bounds.bottom()) - std::floor(bounds.top())) + 2 * pad;
+
+    QImage coverage(glyph->width, glyph->height, QImage::Format_ARGB32_Premultiplied);
+    coverage.fill(Qt::transparent);
+    {
+        QPainter painter(&coverage);
+        painter.setRenderHint(QPainter::Antialiasing);
+        painter.translate(-glyph->originX, -glyph->originY);
+        painter.fillPath(path, Qt::white);
+    }
+
+    // 内側・外側それぞれへの距離を厳密なユークリッド距離変換で求める
+    const int w = glyph->width;
+    const int h = glyph->height;
+    const size_t count = static_cast<size_t>(w) * h;
+    std::vector<float> alpha(count);
+    std::vector<float> toInside(count), toOutside(count);
+    for (int y = 0; y < h; ++y) {
+        const QRgb* line = reinterpret_cast<const QRgb*>(coverage.constScanLine(y));
+        for (int x = 0; x < w; ++x) {
+            const size_t i = static_cast<size_t>(y) * w + x;
+            alpha[i] = qAlpha(line[x]) / 255.0f;
+            const bool inside = alpha[i] >= 0.5f;
+            toInside[i] = inside ? 0.0f : kInf;
+            toOutside[i] = inside ? kInf : 0.0f;
+        }
+    }
+    distanceTransform2D(toInside, w, h);
+    distanceTransform2D(toOutside, w, h);
+
+    glyph->sdf.resize(count);
+    for (size_t i = 0; i < count; ++i) {
+        float d;
+        if (alpha[i] > 0.0f && alpha[i] < 1.0f) {
+            // 輪郭上のピクセルはカバレッジから符号付き距離を近似
+            d = 0.5f - alpha[i];
+        } else if (alpha[i] >= 0.5f) {
+            d = 0.5f - std::sqrt(toOutside[i]);
+        } else {
+            d = std::sqrt(toInside[i]) - 0.5f;
+        }
+        const float value = 128.0f - d / glyph->spread * 127.0f;
+        glyph->sdf[i] = static_cast<uint8_t>(std::clamp(value, 0.0f, 255.0f) + 0.5f);
+    }
+    return glyph;
+}
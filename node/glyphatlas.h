@@ -0,0 +1,51 @@
+#ifndef GLYPHATLAS_H
+#define GLYPHATLAS_H
+
+#include <QHash>
+#include <QMutex>
+#include <QString>
+#include <cstdint>
+#include <memory>
+#include <vector>
+
+// Glyph Atlas - signed distance fields of glyphs for one font family at
+// one size class, shared by every TextNode using that font. Glyphs are
+// rasterized once on first use; because the stored value is a distance,
+// one size class serves a wide range of output sizes.
+class GlyphAtlas {
+public:
+    struct Glyph {
+        int width = 0;         // SDF bitmap size (base pixels, incl. spread)
+        int height = 0;
+        float originX = 0.0f;  // bitmap top-left relative to the pen position on the baseline
+        float originY = 0.0f;
+        float spread = 0.0f;   // distance range encoded in the bitmap
+        std::vector<uint8_t> sdf;  // 128 = edge, larger = inside
+
+        // Signed distance in base pixels (negative inside) at a point
+        // relative to the pen position on the baseline
+        float distance(float x, float y) const;
+    };
+    using GlyphPtr = std::shared_ptr<const Glyph>;
+
+    // サイズクラス（基準の em サイズ、ピクセル）
+    static int sizeClassFor(double emPixels);
+    static std::shared_ptr<GlyphAtlas> forFont(const QString& family, int sizeClass);
+
+    QString family() const { return m_family; }
+    int sizeClass() const { return m_sizeClass; }
+
+    // Rasterizes on first use; safe to call from several threads
+    GlyphPtr glyph(char32_t codepoint);
+
+private:
+    GlyphAtlas(const QString& family, int sizeClass);
+    GlyphPtr rasterize(char32_t codepoint) const;
+
+    QString m_family;
+    int m_sizeClass;
+    QMutex m_mutex;
+    QHash<char32_t, GlyphPtr> m_glyphs;
+};
+
+#endif // GLYPHATLAS_H
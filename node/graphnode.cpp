@@ -1,7 +1,6 @@
 #include "graphnode.h"
+#include <algorithm>
 #include <cmath>
-#include <stack>
-#include <QRegularExpression>
 
 GraphNode::GraphNode() : Node("Graph") {
     // Inputs
@@ -45,72 +44,82 @@ GraphNode::GraphNode() : Node("Graph") {
     compileEquation();
 }
 
-QVector<Node::ParameterInfo> GraphNode::parameters() const {
+QVector<Node::ParameterInfo> GraphNode::describeParameters() const {
     using PI = Node::ParameterInfo;
     return {
         // Coefficients (Match Input Sockets 1-4)
-        PI(PI::Float, "A", m_coeffA, [this](const QVariant& v) { 
-            auto* node = const_cast<GraphNode*>(this);
-            node->m_coeffA = v.toFloat(); 
-            node->setDirty(true); 
-        }).range(-10.0, 10.0),
-
-        PI(PI::Float, "B", m_coeffB, [this](const QVariant& v) { 
-            auto* node = const_cast<GraphNode*>(this);
-            node->m_coeffB = v.toFloat(); 
-            node->setDirty(true); 
-        }).range(-10.0, 10.0),
-
-        PI(PI::Float, "C", m_coeffC, [this](const QVariant& v) { 
-            auto* node = const_cast<GraphNode*>(this);
-            node->m_coeffC = v.toFloat(); 
-            node->setDirty(true); 
-        }).range(-10.0, 10.0),
-
-        PI(PI::Float, "D", m_coeffD, [this](const QVariant& v) { 
-            auto* node = const_cast<GraphNode*>(this);
-            node->m_coeffD = v.toFloat(); 
-            node->setDirty(true); 
-        }).range(-10.0, 10.0),
+        PI(PI::Float, "A", m_coeffA)
+            .bind<GraphNode>([](const GraphNode& n) { return n.m_coeffA; },
+                             [](GraphNode& n, const QVariant& v) {
+                                 n.m_coeffA = v.toFloat();
+                                 n.setDirty(true);
+                             }).range(-10.0, 10.0),
+
+        PI(PI::Float, "B", m_coeffB)
+            .bind<GraphNode>([](const GraphNode& n) { return n.m_coeffB; },
+                             [](GraphNode& n, const QVariant& v) {
+                                 n.m_coeffB = v.toFloat();
+                                 n.setDirty(true);
+                             }).range(-10.0, 10.0),
+
+        PI(PI::Float, "C", m_coeffC)
+            .bind<GraphNode>([](const GraphNode& n) { return n.m_coeffC; },
+                             [](GraphNode& n, const QVariant& v) {
+                                 n.m_coeffC = v.toFloat();
+                                 n.setDirty(true);
+                             }).range(-10.0, 10.0),
+
+        PI(PI::Float, "D", m_coeffD)
+            .bind<GraphNode>([](const GraphNode& n) { return n.m_coeffD; },
+                             [](GraphNode& n, const QVariant& v) {
+                                 n.m_coeffD = v.toFloat();
+                                 n.setDirty(true);
+                             }).range(-10.0, 10.0),
 
         // Thickness (Match Socket 5)
-        PI(PI::Float, "Thickness", m_thickness, [this](const QVariant& v) { 
-            auto* node = const_cast<GraphNode*>(this);
-            node->m_thickness = v.toFloat(); 
-            node->setDirty(true); 
-        }, "Curve Width").range(0.001, 0.5),
+        PI(PI::Float, "Thickness", m_thickness, nullptr, "Curve Width")
+            .bind<GraphNode>([](const GraphNode& n) { return n.m_thickness; },
+                             [](GraphNode& n, const QVariant& v) {
+                                 n.m_thickness = v.toFloat();
+                                 n.setDirty(true);
+                             }).range(0.001, 0.5),
         
         // View Range Parameters (Match Sockets 6-9)
-        PI(PI::Float, "X Min", m_xMin, [this](const QVariant& v) { 
-            auto* node = const_cast<GraphNode*>(this);
-            node->m_xMin = v.toFloat(); 
-            node->setDirty(true); 
-        }).range(-100.0, 100.0),
+        PI(PI::Float, "X Min", m_xMin)
+            .bind<GraphNode>([](const GraphNode& n) { return n.m_xMin; },
+                             [](GraphNode& n, const QVariant& v) {
+                                 n.m_xMin = v.toFloat();
+                                 n.setDirty(true);
+                             }).range(-100.0, 100.0),
         
-        PI(PI::Float, "X Max", m_xMax, [this](const QVariant& v) { 
-            auto* node = const_cast<GraphNode*>(this);
-            node->m_xMax = v.toFloat(); 
-            node->setDirty(true); 
-        }).range(-100.0, 100.0),
-
-        PI(PI::Float, "Y Min", m_yMin, [this](const QVariant& v) { 
-            auto* node = const_cast<GraphNode*>(this);
-            node->m_yMin = v.toFloat(); 
-            node->setDirty(true); 
-        }).range(-100.0, 100.0),
-
-        PI(PI::Float, "Y Max", m_yMax, [this](const QVariant& v) { 
-            auto* node = const_cast<GraphNode*>(this);
-            node->m_yMax = v.toFloat(); 
-            node->setDirty(true); 
-        }).range(-100.0, 100.0),
+        PI(PI::Float, "X Max", m_xMax)
+            .bind<GraphNode>([](const GraphNode& n) { return n.m_xMax; },
+                             [](GraphNode& n, const QVariant& v) {
+                                 n.m_xMax = v.toFloat();
+                                 n.setDirty(true);
+                             }).range(-100.0, 100.0),
+
+        PI(PI::Float, "Y Min", m_yMin)
+            .bind<GraphNode>([](const GraphNode& n) { return n.m_yMin; },
+                             [](GraphNode& n, const QVariant& v) {
+                                 n.m_yMin = v.toFloat();
+                                 n.setDirty(true);
+                             }).range(-100.0, 100.0),
+
+        PI(PI::Float, "Y Max", m_yMax)
+            .bind<GraphNode>([](const GraphNode& n) { return n.m_yMax; },
+                             [](GraphNode& n, const QVariant& v) {
+                                 n.m_yMax = v.toFloat();
+                                 n.setDirty(true);
+                             }).range(-100.0, 100.0),
 
         // Function Selection
-        PI(PI::Combo, "Function", m_functionType, [this](const QVariant& v) { 
-            auto* node = const_cast<GraphNode*>(this);
-            node->m_functionType = v.toInt(); 
-            node->setDirty(true); 
-        }, "").withOptions({ 
+        PI(PI::Combo, "Function", m_functionType, nullptr, "")
+            .bind<GraphNode>([](const GraphNode& n) { return n.m_functionType; },
+                             [](GraphNode& n, const QVariant& v) {
+                                 n.m_functionType = v.toInt();
+                                 n.setDirty(true);
+                             }).withOptions({ 
             "Linear (mx+b)", 
             "Quadratic (ax^2+bx+c)", 
             "Cubic (ax^3+bx^2+cx+d)", 
@@ -128,26 +137,29 @@ QVector<Node::ParameterInfo> GraphNode::parameters() const {
         }),
 
         // Equation Input
-        PI(PI::String, "Equation", m_equationStr, [this](const QVariant& v) { 
-            auto* node = const_cast<GraphNode*>(this);
-            node->m_equationStr = v.toString();
-            if (node->m_functionType != 13) node->m_functionType = 13;
-            node->compileEquation(); 
-            node->setDirty(true); 
-        }, "e.g. sin(x) * x"),
+        PI(PI::String, "Equation", m_equationStr, nullptr, "e.g. sin(x) * x")
+            .bind<GraphNode>([](const GraphNode& n) { return n.m_equationStr; },
+                             [](GraphNode& n, const QVariant& v) {
+                                 n.m_equationStr = v.toString();
+                                 if (n.m_functionType != 13) n.m_functionType = 13;
+                                 n.compileEquation();
+                                 n.setDirty(true);
+                             }),
 
         // Options
-        PI(PI::Bool, "Fill Below", m_fillBelow, [this](const QVariant& v) { 
-            auto* node = const_cast<GraphNode*>(this);
-            node->m_fillBelow = v.toBool(); 
-            node->setDirty(true); 
-        }),
+        PI(PI::Bool, "Fill Below", m_fillBelow)
+            .bind<GraphNode>([](const GraphNode& n) { return n.m_fillBelow; },
+                             [](GraphNode& n, const QVariant& v) {
+                                 n.m_fillBelow = v.toBool();
+                                 n.setDirty(true);
+                             }),
         
-        PI(PI::Bool, "Show Axes", m_showAxes, [this](const QVariant& v) { 
-            auto* node = const_cast<GraphNode*>(this);
-            node->m_showAxes = v.toBool(); 
-            node->setDirty(true); 
-        })
+        PI(PI::Bool, "Show Axes", m_showAxes)
+            .bind<GraphNode>([](const GraphNode& n) { return n.m_showAxes; },
+                             [](GraphNode& n, const QVariant& v) {
+                                 n.m_showAxes = v.toBool();
+                                 n.setDirty(true);
+                             })
     };
 }
 
@@ -155,107 +167,32 @@ void GraphNode::evaluate() {
     setDirty(false);
 }
 
-// Simple expression parser
 void GraphNode::compileEquation() {
-    m_rpn.clear();
-    QString eq = m_equationStr.toLower().remove(" ").remove("y="); // Normalize
-    
-    // Shunting-yard algorithm
-    QVector<QString> outputQueue;
-    std::stack<QString> operatorStack;
-    
-    auto precedence = [](const QString& op) {
-        if (op == "+" || op == "-") return 1;
-        if (op == "*" || op == "/") return 2;
-        if (op == "^") return 3;
-        return 0;
-    };
-    
-    auto isFunc = [](const QString& s) {
-        return s=="sin"||s=="cos"||s=="tan"||s=="abs"||s=="sqrt"||s=="log"||s=="exp";
-    };
+    std::atomic_store(&m_equation, Equation::compile(m_equationStr));
+}
 
-    int i = 0;
-    while (i < eq.length()) {
-        QChar c = eq[i];
-        
-        if (c.isDigit() || c == '.') {
-            int start = i;
-            while (i < eq.length() && (eq[i].isDigit() || eq[i] == '.')) i++;
-            outputQueue.append(eq.mid(start, i - start));
-            continue;
-        }
-        
-        if (c.isLetter()) {
-            int start = i;
-            while (i < eq.length() && eq[i].isLetter()) i++;
-            QString ident = eq.mid(start, i - start);
-            if (isFunc(ident)) {
-                operatorStack.push(ident);
-            } else { // Variable (x, or constants e, pi)
-                outputQueue.append(ident);
-            }
-            continue;
-        }
-        
-        if (QString("+-*/^").contains(c)) {
-            QString op = QString(c);
-            while (!operatorStack.empty()) {
-                QString top = operatorStack.top();
-                if (top == "(") break;
-                if (precedence(top) >= precedence(op)) {
-                    outputQueue.append(operatorStack.top());
-                    operatorStack.pop();
-                } else break;
-            }
-            operatorStack.push(op);
-            i++;
-            continue;
-        }
-        
-        if (c == '(') {
-            operatorStack.push("(");
-            i++;
-            continue;
-        }
-        
-        if (c == ')') {
-            while (!operatorStack.empty() && operatorStack.top() != "(") {
-                outputQueue.append(operatorStack.top());
-                operatorStack.pop();
-            }
-            if (!operatorStack.empty()) operatorStack.pop(); // Pop '('
-            if (!operatorStack.empty() && isFunc(operatorStack.top())) {
-                outputQueue.append(operatorStack.top());
-                operatorStack.pop();
-            }
-            i++;
-            continue;
-        }
-        
-        i++; // Skip unknowns
-    }
-    
-    while (!operatorStack.empty()) {
-        outputQueue.append(operatorStack.top());
-        operatorStack.pop();
-    }
-    
-    // Convert to Tokens
-    for (const QString& s : outputQueue) {
-        if (s[0].isDigit() || s[0] == '.') {
-            m_rpn.append({Number, s.toDouble(), ""});
-        } else if (isFunc(s)) {
-            m_rpn.append({Func, 0, s});
-        } else if (QString("+-*/^").contains(s)) {
-            m_rpn.append({Op, 0, s});
-        } else {
-             // Variable or constant
-             if (s == "pi") m_rpn.append({Number, 3.14159265, ""});
-             else if (s == "e") m_rpn.append({Number, 2.71828, ""});
-             else m_rpn.append({Variable, 0, s}); // treat as x
+void GraphNode::prepareRender(int width, int height) {
+    Node::prepareRender(width, height);
+
+    std::shared_ptr<const ColumnTable> table;
+    // UV と X 範囲が固定なら x は列だけで決まるので、1行分をまとめて評価しておく
+    if (m_functionType == 13 && !m_inputSockets[0]->isConnected() &&
+        !m_inputSockets[6]->isConnected() && !m_inputSockets[7]->isConnected()) {
+        auto columns = std::make_shared<ColumnTable>();
+        columns->equation = std::atomic_load(&m_equation);
+        columns->x.resize(width);
+        std::vector<double> xs(width);
+        for (int col = 0; col < width; ++col) {
+            // compute() と同じ式で x を求める（一致判定に使う）
+            columns->x[col] = m_xMin + static_cast<float>(col) * (m_xMax - m_xMin);
+            xs[col] = columns->x[col];
         }
+        columns->fx.resize(width);
+        columns->dfx.resize(width);
+        columns->equation->evaluate(xs.data(), columns->fx.data(), columns->dfx.data(), width);
+        table = columns;
     }
+    std::atomic_store(&m_columnTable, table);
 }
 
 QVariant GraphNode::compute(const QVector3D& pos, NodeSocket* socket) {
@@ -378,66 +315,20 @@ QVariant GraphNode::compute(const QVector3D& pos, NodeSocket* socket) {
         break;
     case 13: // Custom Equation
     {
-        // Evaluate RPN
-        std::stack<double> stack;
-        for (const auto& tok : m_rpn) {
-            if (tok.type == Number) stack.push(tok.val);
-            else if (tok.type == Variable) stack.push(x);
-            else if (tok.type == Op) {
-                if (stack.size() < 2) continue; // Error
-                double b = stack.top(); stack.pop();
-                double a = stack.top(); stack.pop();
-                if (tok.str == "+") stack.push(a + b);
-                else if (tok.str == "-") stack.push(a - b);
-                else if (tok.str == "*") stack.push(a * b);
-                else if (tok.str == "/") stack.push(b != 0 ? a / b : 0);
-                else if (tok.str == "^") stack.push(std::pow(a, b));
-            } else if (tok.type == Func) {
-                 if (stack.empty()) continue;
-                 double a = stack.top(); stack.pop();
-                 if (tok.str == "sin") stack.push(std::sin(a));
-                 else if (tok.str == "cos") stack.push(std::cos(a));
-                 else if (tok.str == "tan") stack.push(std::tan(a));
-                 else if (tok.str == "abs") stack.push(std::abs(a));
-                 else if (tok.str == "sqrt") stack.push(a>=0 ? std::sqrt(a) : 0);
-                 else if (tok.str == "log") stack.push(a>0 ? std::log(a) : -100);
-                 else if (tok.str == "exp") stack.push(std::exp(a));
-            }
-        }
-        if (!stack.empty()) fx = stack.top();
-        else fx = 0.0f;
-        
-        // Approx derivative for AA
-        float h = 0.001f;
-        float fa = fx;
-        std::stack<double> stack2;
-        float x2 = x + h; 
-        for (const auto& tok : m_rpn) {
-            if (tok.type == Number) stack2.push(tok.val);
-            else if (tok.type == Variable) stack2.push(x2);
-            else if (tok.type == Op) {
-                 if (stack2.size() < 2) continue;
-                 double b = stack2.top(); stack2.pop();
-                 double a = stack2.top(); stack2.pop();
-                 if (tok.str == "+") stack2.push(a + b);
-                 else if (tok.str == "-") stack2.push(a - b);
-                 else if (tok.str == "*") stack2.push(a * b);
-                 else if (tok.str == "/") stack2.push(b != 0 ? a / b : 0);
-                 else if (tok.str == "^") stack2.push(std::pow(a, b));
-            } else if (tok.type == Func) {
-                 if (stack2.empty()) continue;
-                 double a = stack2.top(); stack2.pop();
-                 if (tok.str == "sin") stack2.push(std::sin(a));
-                 else if (tok.str == "cos") stack2.push(std::cos(a));
-                 else if (tok.str == "tan") stack2.push(std::tan(a));
-                 else if (tok.str == "abs") stack2.push(std::abs(a));
-                 else if (tok.str == "sqrt") stack2.push(a>=0 ? std::sqrt(a) : 0);
-                 else if (tok.str == "log") stack2.push(a>0 ? std::log(a) : -100);
-                 else if (tok.str == "exp") stack2.push(std::exp(a));
-            }
+        double f = 0.0;
+        double df = 0.0;
+        auto table = std::atomic_load(&m_columnTable);
+        auto equation = std::atomic_load(&m_equation);
+        const int col = static_cast<int>(u);
+        if (table && table->equation == equation && u == static_cast<float>(col) &&
+            col >= 0 && col < static_cast<int>(table->x.size()) && table->x[col] == x) {
+            f = table->fx[col];
+            df = table->dfx[col];
+        } else {
+            equation->evaluate(x, f, df);
         }
-        float fxh = (!stack2.empty()) ? stack2.top() : 0.0f;
-        dfx = (fxh - fa) / h;
+        fx = static_cast<float>(f);
+        dfx = static_cast<float>(df); // Analytic derivative for AA
     }
         break;
     }
@@ -2,6 +2,9 @@
 #define GRAPHNODE_H
 
 #include "node.h"
+#include "equation.h"
+#include <memory>
+#include <vector>
 
 class GraphNode : public Node {
 public:
@@ -9,11 +12,14 @@ public:
 
     // QVector<NodeSocket*> inputSockets() const override { return m_inputSockets; } // Removed: Not virtual in base
     // QVector<NodeSocket*> outputSockets() const override { return m_outputSockets; } // Removed: Not virtual in base
-    QVector<ParameterInfo> parameters() const override;
 
     void evaluate() override; // Required pure virtual
+    void prepareRender(int width, int height) override;
     QVariant compute(const QVector3D& pos, NodeSocket* socket) override; // Correct signature
 
+protected:
+    QVector<ParameterInfo> describeParameters() const override;
+
 private:
     // QVector<NodeSocket*> m_inputSockets; // Removed: Base class handles this
     // QVector<NodeSocket*> m_outputSockets; // Removed: Base class handles this
@@ -38,14 +44,17 @@ private:
     // Custom Equation Support
     QString m_equationStr;
     
-    enum TokenType { Op, Number, Variable, Func };
-    struct Token {
-        TokenType type;
-        double val; // For Number
-        QString str; // For Op, Func
+    std::shared_ptr<const Equation> m_equation; // Compiled bytecode
+
+    // カスタム式の列ごとの値 (f, f')。UV 未接続ならピクセル列ごとに x が決まる
+    struct ColumnTable {
+        std::shared_ptr<const Equation> equation;
+        std::vector<float> x;
+        std::vector<double> fx;
+        std::vector<double> dfx;
     };
-    QVector<Token> m_rpn; // Reverse Polish Notation cache
-    
+    std::shared_ptr<const ColumnTable> m_columnTable;
+
     void compileEquation();
 };
 
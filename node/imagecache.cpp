@@ -0,0 +1,244 @@
+#include "imagecache.h"
+#include "miptexture.h"
+#include "virtualtexture.h"
+#include "trace.h"
+#include <QCryptographicHash>
+#include <QDateTime>
+#include <QDir>
+#include <QFileInfo>
+#include <QImage>
+#include <QImageReader>
+#include <QStandardPaths>
+#include <QMutexLocker>
+#include <QThread>
+
+ImageCache::ImageCache() {
+    // デコードはレンダーとは別のプールで行い、複数画像を並行して読み込む
+    m_decodePool.setMaxThreadCount(qMax(2, QThread::idealThreadCount() / 2));
+}
+
+ImageCache& ImageCache::instance() {
+    static ImageCache instance;
+    return instance;
+}
+
+QString ImageCache::makeKey(const QString& path) {
+    QFileInfo info(path);
+    if (!info.exists()) {
+        return QString();
+    }
+    QString canonical = info.canonicalFilePath();
+    if (canonical.isEmpty()) {
+        canonical = info.absoluteFilePath();
+    }
+    return QStringLiteral("%1|%2|%3")
+        .arg(canonical)
+        .arg(info.lastModified().toMSecsSinceEpoch())
+        .arg(info.size());
+}
+
+QString ImageCache::tiledCachePath(const QString& key) {
+    QString dir = QStandardPaths::writableLocation(QStandardPaths::CacheLocation) + "/vtex";
+    QDir().mkpath(dir);
+    // キーに更新日時とサイズを含むので、元画像が変わると別ファイルになる
+    QByteArray hash = QCryptographicHash::hash(key.toUtf8(), QCryptographicHash::Sha1).toHex();
+    return dir + "/" + QString::fromLatin1(hash) + ".vtex";
+}
+
+std::shared_ptr<const TextureSource> ImageCache::load(const QString& key, const QString& path) {
+    if (path.endsWith(".vtex", Qt::CaseInsensitive)) {
+        return VirtualTexture::open(path);
+    }
+
+    // 巨大な画像はタイル形式に1回だけ変換してストリーミングする
+    QSize size = QImageReader(path).size();
+    if (size.isValid() && qint64(size.width()) * size.height() >= VirtualTexture::StreamingThreshold) {
+        QString tiled = tiledCachePath(key);
+        if (!QFileInfo::exists(tiled)) {
+            QString error;
+            if (!VirtualTexture::convert(path, tiled, VirtualTexture::DefaultTileSize, &error)) {
+                traceWarning(Trace::IO) << "ImageCache: failed to convert" << path << error;
+                return nullptr;
+            }
+        }
+        return VirtualTexture::open(tiled);
+    }
+
+    QImage image;
+    if (!image.load(path)) {
+        traceWarning(Trace::IO) << "ImageCache: failed to decode" << path;
+        return nullptr;
+    }
+    return MipTexture::fromImage(image);
+}
+
+std::shared_ptr<const TextureSource> ImageCache::lookupLocked(const QString& key) {
+    auto it = m_index.find(key);
+    if (it == m_index.end()) {
+        return nullptr;
+    }
+    // 最近使用に移動
+    m_lru.splice(m_lru.begin(), m_lru, it.value());
+    return m_lru.front().texture;
+}
+
+std::shared_ptr<const TextureSource> ImageCache::acquire(const QString& path) {
+    const QString key = makeKey(path);
+    if (key.isEmpty()) {
+        return nullptr;
+    }
+
+    QMutexLocker locker(&m_mutex);
+    if (auto texture = lookupLocked(key)) {
+        ++m_hits;
+        return texture;
+    }
+    auto pending = m_pending.find(key);
+    if (pending != m_pending.end()) {
+        // 他のスレッドがデコード中なら、その結果を待つ
+        ++m_joins;
+        struct Waiter {
+            std::shared_ptr<const TextureSource> texture;
+            bool done = false;
+        };
+        auto waiter = std::make_shared<Waiter>();
+        pending.value().append([this, waiter](std::shared_ptr<const TextureSource> texture) {
+            QMutexLocker locker(&m_mutex);
+            waiter->texture = std::move(texture);
+            waiter->done = true;
+            m_decodeDone.wakeAll();
+        });
+        while (!waiter->done) {
+            m_decodeDone.wait(&m_mutex);
+        }
+        return waiter->texture;
+    }
+    ++m_misses;
+    m_pending.insert(key, QVector<Callback>());
+    locker.unlock();
+    return decodePending(key, path);
+}
+
+void ImageCache::acquireAsync(const QString& path, Callback done) {
+    const QString key = makeKey(path);
+    if (key.isEmpty()) {
+        done(nullptr);
+        return;
+    }
+
+    {
+        QMutexLocker locker(&m_mutex);
+        if (auto texture = lookupLocked(key)) {
+            ++m_hits;
+            locker.unlock();
+            done(texture);
+            return;
+        }
+        auto pending = m_pending.find(key);
+        if (pending != m_pending.end()) {
+            // 同じ画像のデコードが進行中なら相乗りする
+            ++m_joins;
+            pending.value().append(std::move(done));
+            return;
+        }
+        ++m_misses;
+        m_pending.insert(key, QVector<Callback>{std::move(done)});
+    }
+
+    m_decodePool.start([this, key, path]() {
+        decodePending(key, path);
+    });
+}
+
+// 'key' を m_pending に登録したスレッドがデコードし、相乗りした全員に結果を渡す
+std::shared_ptr<const TextureSource> ImageCache::decodePending(const QString& key, const QString& path) {
+    std::shared_ptr<const TextureSource> texture = decodeAndInsert(key, path);
+    QVector<Callback> callbacks;
+    {
+        QMutexLocker locker(&m_mutex);
+        callbacks = m_pending.take(key);
+    }
+    for (const Callback& callback : callbacks) {
+        callback(texture);
+    }
+    return texture;
+}
+
+std::shared_ptr<const TextureSource> ImageCache::decodeAndInsert(const QString& key, const QString& path) {
+    // デコードはロックの外で行う（他の画像の取得をブロックしない）
+    std::shared_ptr<const TextureSource> texture = load(key, path);
+    if (!texture) {
+        return nullptr;
+    }
+
+    QMutexLocker locker(&m_mutex);
+    if (auto existing = lookupLocked(key)) {
+        // 同じ画像を並行してデコードしていた場合は先に登録された方を使う
+        return existing;
+    }
+
+    const size_t bytes = texture->byteSize();
+    m_lru.push_front(Entry{key, texture, bytes});
+    m_index.insert(key, m_lru.begin());
+    m_bytes += bytes;
+    evictLocked();
+    return texture;
+}
+
+// ストリーミングテクスチャは使ったタイルの分だけ大きくなるので、登録時の値ではなく今の値で数える
+void ImageCache::refreshBytesLocked() {
+    m_bytes = 0;
+    for (Entry& entry : m_lru) {
+        entry.bytes = entry.texture->byteSize();
+        m_bytes += entry.bytes;
+    }
+}
+
+void ImageCache::evictLocked() {
+    refreshBytesLocked();
+    // ノードから参照されているエントリは解放してもメモリが減らないので残す
+    auto it = m_lru.end();
+    while (m_bytes > m_budget && it != m_lru.begin()) {
+        --it;
+        if (it->texture.use_count() > 1) {
+            continue;
+        }
+        m_bytes -= it->bytes;
+        m_index.remove(it->key);
+        it = m_lru.erase(it);
+        ++m_evictions;
+    }
+}
+
+size_t ImageCache::budget() const {
+    QMutexLocker locker(&m_mutex);
+    return m_budget;
+}
+
+void ImageCache::setBudget(size_t bytes) {
+    QMutexLocker locker(&m_mutex);
+    m_budget = bytes;
+    evictLocked();
+}
+
+ImageCache::Stats ImageCache::stats() const {
+    QMutexLocker locker(&m_mutex);
+    Stats s;
+    s.hits = m_hits;
+    s.misses = m_misses;
+    s.joins = m_joins;
+    s.evictions = m_evictions;
+    s.entries = static_cast<int>(m_lru.size());
+    for (const Entry& entry : m_lru) {
+        s.bytes += entry.texture->byteSize();
+    }
+    s.budget = m_budget;
+    return s;
+}
+
+void ImageCache::clear() {
+    QMutexLocker locker(&m_mutex);
+    m_lru.clear();
+    m_index.clear();
+    m_bytes = 0;
+}
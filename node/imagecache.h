@@ -0,0 +1,90 @@
+#ifndef IMAGECACHE_H
+#define IMAGECACHE_H
+
+#include "texturesource.h"
+#include <QHash>
+#include <QMutex>
+#include <QString>
+#include <QThreadPool>
+#include <QWaitCondition>
+#include <QVector>
+#include <functional>
+#include <list>
+#include <memory>
+
+// 画像デコード結果のプロセス共通キャッシュ
+// Decoded images shared by every ImageTextureNode. Entries are keyed by
+// canonical path + modification time + file size, so an edited file is
+// decoded again while the same file referenced by many nodes (or reloaded
+// by a material switch) is decoded once. Sources above
+// VirtualTexture::StreamingThreshold are converted once to a tiled file in
+// the cache directory and streamed instead of decoded into memory.
+class ImageCache {
+public:
+    struct Stats {
+        quint64 hits = 0;
+        quint64 misses = 0;
+        quint64 joins = 0;   // デコード中の要求に相乗りした回数（ヒットには含めない）
+        quint64 evictions = 0;
+        int entries = 0;
+        size_t bytes = 0;
+        size_t budget = 0;
+    };
+
+    using Callback = std::function<void(std::shared_ptr<const TextureSource>)>;
+
+    static ImageCache& instance();
+
+    // Returns the decoded texture for 'path', decoding it on a miss.
+    // Returns nullptr if the file is missing or cannot be decoded.
+    // If the file is already being decoded, waits for that decode.
+    std::shared_ptr<const TextureSource> acquire(const QString& path);
+
+    // 非同期版: キャッシュにあれば即座に、なければデコードスレッドで読み込んで
+    // 'done' を呼ぶ（ワーカースレッドから呼ばれることがある）。
+    // Requests for a file that is already being decoded share that decode.
+    void acquireAsync(const QString& path, Callback done);
+
+    // Memory budget for cached textures. Least recently used entries that
+    // no node references any more are evicted when it is exceeded.
+    size_t budget() const;
+    void setBudget(size_t bytes);
+
+    Stats stats() const;
+    void clear();
+
+private:
+    ImageCache();
+    ImageCache(const ImageCache&) = delete;
+    ImageCache& operator=(const ImageCache&) = delete;
+
+    struct Entry {
+        QString key;
+        std::shared_ptr<const TextureSource> texture;
+        size_t bytes;
+    };
+
+    static QString makeKey(const QString& path);
+    static QString tiledCachePath(const QString& key);
+    static std::shared_ptr<const TextureSource> load(const QString& key, const QString& path);
+    std::shared_ptr<const TextureSource> lookupLocked(const QString& key);
+    std::shared_ptr<const TextureSource> decodeAndInsert(const QString& key, const QString& path);
+    std::shared_ptr<const TextureSource> decodePending(const QString& key, const QString& path);
+    void refreshBytesLocked();
+    void evictLocked();
+
+    mutable QMutex m_mutex;
+    std::list<Entry> m_lru;  // 先頭が最近使用
+    QHash<QString, std::list<Entry>::iterator> m_index;
+    QHash<QString, QVector<Callback>> m_pending;  // デコード中のキー -> 完了待ち
+    QWaitCondition m_decodeDone;  // acquire() waiting on another thread's decode
+    QThreadPool m_decodePool;
+    size_t m_bytes = 0;
+    size_t m_budget = size_t(1024) * 1024 * 1024;  // 1 GiB
+    quint64 m_hits = 0;
+    quint64 m_misses = 0;
+    quint64 m_joins = 0;
+    quint64 m_evictions = 0;
+};
+
+#endif // IMAGECACHE_H
@@ -0,0 +1,97 @@
+#include "imagepyramid.h"
+#include <QPainter>
+#include <cmath>
+
+ImagePyramid::ImagePyramid() {
+    m_tiles.setMaxCost(96 * 1024);  // 96 MB
+}
+
+void ImagePyramid::setImage(const QImage& image) {
+    clear();
+    if (image.isNull()) return;
+
+    // 長辺が1タイルに収まるまで半分にしていく
+    int count = 1;
+    for (int extent = qMax(image.width(), image.height()); extent > TileSize; extent = (extent + 1) / 2) {
+        ++count;
+    }
+    m_levels.resize(count);
+    m_levels[0] = image;
+}
+
+void ImagePyramid::clear() {
+    m_levels.clear();
+    m_tiles.clear();
+}
+
+QSize ImagePyramid::levelSize(int index) const {
+    const QSize base = m_levels[0].size();
+    const int step = 1 << index;
+    return QSize(qMax(1, (base.width() + step - 1) / step), qMax(1, (base.height() + step - 1) / step));
+}
+
+int ImagePyramid::levelForScale(double scale) const {
+    if (isNull() || scale >= 1.0 || scale <= 0.0) return 0;
+    const int index = static_cast<int>(std::floor(std::log2(1.0 / scale)));
+    return qBound(0, index, levelCount() - 1);
+}
+
+const QImage& ImagePyramid::level(int index) {
+    QImage& image = m_levels[index];
+    if (image.isNull()) {
+        int from = index - 1;
+        while (from > 0 && m_levels[from].isNull()) {
+            --from;
+        }
+        image = m_levels[from].scaled(levelSize(index), Qt::IgnoreAspectRatio, Qt::SmoothTransformation)
+                    .convertToFormat(QImage::Format_ARGB32_Premultiplied);
+    }
+    return image;
+}
+
+QPixmap ImagePyramid::tile(int levelIndex, int tx, int ty) {
+    const quint64 key = (quint64(levelIndex) << 48) | (quint64(ty) << 24) | quint64(tx);
+    if (QPixmap* cached = m_tiles.object(key)) {
+        return *cached;
+    }
+    const QImage& image = level(levelIndex);
+    const QRect rect = QRect(tx * TileSize, ty * TileSize, TileSize, TileSize).intersected(image.rect());
+    QPixmap* pixmap = new QPixmap(QPixmap::fromImage(image.copy(rect)));
+    const QPixmap result = *pixmap;
+    m_tiles.insert(key, pixmap, qMax(1, rect.width() * rect.height() * 4 / 1024));
+    return result;
+}
+
+void ImagePyramid::draw(QPainter* painter, const QRectF& target, const QRectF& clip) {
+    if (isNull() || target.isEmpty()) return;
+    const QRectF visible = clip.intersected(target);
+    if (visible.isEmpty()) return;
+
+    // 高DPIでは物理ピクセルで比べる
+    const qreal dpr = painter->device() ? painter->device()->devicePixelRatio() : 1.0;
+    const int index = levelForScale(target.width() * dpr / m_levels[0].width());
+    const QSize size = levelSize(index);
+    const double sx = target.width() / size.width();
+    const double sy = target.height() / size.height();
+
+    const int tx0 = qMax(0, static_cast<int>((visible.left() - target.left()) / sx) / TileSize);
+    const int ty0 = qMax(0, static_cast<int>((visible.top() - target.top()) / sy) / TileSize);
+    const int tx1 = qMin((size.width() - 1) / TileSize, static_cast<int>((visible.right() - target.left()) / sx) / TileSize);
+    const int ty1 = qMin((size.height() - 1) / TileSize, static_cast<int>((visible.bottom() - target.top()) / sy) / TileSize);
+
+    // 縮小表示は滑らかに、拡大表示はピクセルがそのまま見えるように
+    painter->save();
+    painter->setRenderHint(QPainter::SmoothPixmapTransform, sx < 1.0);
+    for (int ty = ty0; ty <= ty1; ++ty) {
+        for (int tx = tx0; tx <= tx1; ++tx) {
+            const QPixmap pixmap = tile(index, tx, ty);
+            // 隣のタイルと端を共有するよう、両端を同じ丸めで求める
+            const int x0 = qRound(target.left() + tx * TileSize * sx);
+            const int y0 = qRound(target.top() + ty * TileSize * sy);
+            const int x1 = qRound(target.left() + (tx * TileSize + pixmap.width()) * sx);
+            const int y1 = qRound(target.top() + (ty * TileSize + pixmap.height()) * sy);
+            painter->drawPixmap(QRect(x0, y0, x1 - x0, y1 - y0), pixmap);
+        }
+    }
+    painter->restore();
+}
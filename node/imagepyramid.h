@@ -0,0 +1,47 @@
+#ifndef IMAGEPYRAMID_H
+#define IMAGEPYRAMID_H
+
+#include <QCache>
+#include <QImage>
+#include <QPixmap>
+#include <QRectF>
+#include <vector>
+
+class QPainter;
+
+// 表示用のタイル化された画像ピラミッド
+// Level 0 is the image itself and level n is 1/2^n of it. A level is built
+// the first time a view needs it, from the nearest finer level that
+// already exists. Levels are split into TileSize tiles, and a tile becomes
+// a QPixmap only when it is drawn. Converted tiles stay in an LRU cache.
+// Drawing a view therefore touches just the visible tiles of one level,
+// whatever the size of the image or the zoom.
+class ImagePyramid {
+public:
+    static constexpr int TileSize = 256;
+
+    ImagePyramid();
+
+    void setImage(const QImage& image);
+    void clear();
+    bool isNull() const { return m_levels.empty(); }
+    QSize size() const { return isNull() ? QSize() : m_levels[0].size(); }
+    int levelCount() const { return static_cast<int>(m_levels.size()); }
+
+    // 表示倍率（画面ピクセル / 画像ピクセル）に使うレベル:
+    // the coarsest level that still has at least one pixel per screen pixel
+    int levelForScale(double scale) const;
+
+    // 画像全体を 'target' に置いたとき、'clip' と重なるタイルだけを描く
+    void draw(QPainter* painter, const QRectF& target, const QRectF& clip);
+
+private:
+    QSize levelSize(int index) const;
+    const QImage& level(int index);
+    QPixmap tile(int level, int tx, int ty);
+
+    std::vector<QImage> m_levels;   // null = まだ作っていない
+    QCache<quint64, QPixmap> m_tiles;  // cost = KB
+};
+
+#endif // IMAGEPYRAMID_H
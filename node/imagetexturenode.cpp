@@ -1,12 +1,17 @@
 #include "imagetexturenode.h"
 #include "appsettings.h"
+#include "imagecache.h"
+#include "dual.h"
+#include "trace.h"
 #include <QColor>
-#include <QDebug>
+#include <QCoreApplication>
+#include <QThread>
 #include <cmath>
 
 ImageTextureNode::ImageTextureNode()
     : Node("Image Texture")
-    , m_imageLoaded(false)
+    , m_loadState(LoadState::Empty)
+    , m_interpolation(TextureSource::Filter::Mipmap)
     , m_scaleX(1.0)
     , m_scaleY(1.0)
     , m_stretchToFit(false)  // Default OFF - center image with original aspect
@@ -31,8 +36,12 @@ QVector<Node::ParameterInfo> ImageTextureNode::parameters() const {
     QVector<ParameterInfo> params;
     
     // File
+    QString status;
+    if (m_loadState == LoadState::Loading) status = "Loading...";
+    else if (m_loadState == LoadState::Failed) status = "Failed to load image";
     params.append(ParameterInfo("Image File", m_filePath, 
-        [this](const QVariant& v) { const_cast<ImageTextureNode*>(this)->setFilePath(v.toString()); }
+        [this](const QVariant& v) { const_cast<ImageTextureNode*>(this)->setFilePath(v.toString()); },
+        status
     ));
 
     // Scale X
@@ -60,100 +69,141 @@ QVector<Node::ParameterInfo> ImageTextureNode::parameters() const {
         "ON: 画像をタイル状に繰り返す\nOFF: 画像を1回だけ表示"
     ));
 
+    params.append(ParameterInfo("Interpolation", {"Closest", "Linear", "Mipmap"},
+        QVariant::fromValue(static_cast<int>(m_interpolation)),
+        [this](const QVariant& v) { const_cast<ImageTextureNode*>(this)->setInterpolation(static_cast<TextureSource::Filter>(v.toInt())); }
+    ));
+
     return params;
 }
 
+void ImageTextureNode::invalidate() {
+    std::atomic_store(&m_placement, std::shared_ptr<const Placement>());
+    Node::invalidate();
+}
+
+void ImageTextureNode::prepareRender(int width, int height) {
+    Node::prepareRender(width, height);
+    std::atomic_store(&m_placement, buildPlacement(width, height));
+}
+
 QVariant ImageTextureNode::compute(const QVector3D& pos, NodeSocket* socket) {
     QVector3D uv = pos;
+    // 1ピクセルあたりの UV の変化量（ミップレベル選択用）
+    double footprint = 1.0;
     if (m_vectorInput->isConnected()) {
-        uv = m_vectorInput->getValue(pos).value<QVector3D>();
+        DualVec d;
+        if (m_interpolation == TextureSource::Filter::Mipmap && m_vectorInput->getDual(pos, d)) {
+            uv = d.value();
+            footprint = qMax(std::hypot(d.x.du, d.y.du), std::hypot(d.x.dv, d.y.dv));
+        } else {
+            uv = m_vectorInput->getValue(pos).value<QVector3D>();
+            // 微分が取れない場合は UV がレンダー全体に広がっているとみなす
+            auto p = placement();
+            footprint = 1.0 / qMax(1, qMin(p->renderWidth, p->renderHeight));
+        }
     }
     
-    QColor c = getColorAt(uv.x(), uv.y());
+    QVector4D c = sampleAt(uv.x(), uv.y(), footprint);
     
     if (socket == m_colorOutput) {
         // Return as QVector4D (RGBA 0-1) to ensure consistent handling in OutputNode
-        return QVector4D(c.redF(), c.greenF(), c.blueF(), c.alphaF());
+        return c;
     } else if (socket == m_alphaOutput) {
-        return c.alphaF();
+        return static_cast<double>(c.w());
     }
     
     return QVariant();
 }
 
-QColor ImageTextureNode::getColorAt(double u, double v) const {
-    if (!m_imageLoaded || m_image.isNull()) {
-        return QColor(0, 0, 0, 255);
-    }
+std::shared_ptr<const ImageTextureNode::Placement> ImageTextureNode::buildPlacement(int renderWidth, int renderHeight) const {
+    auto p = std::make_shared<Placement>();
+    p->renderWidth = renderWidth;
+    p->renderHeight = renderHeight;
     
-    // Apply scale (from center)
-    u = (u - 0.5) * m_scaleX + 0.5;
-    v = (v - 0.5) * m_scaleY + 0.5;
-    
-    // Get render resolution
-    int renderW = AppSettings::instance().renderWidth();
-    int renderH = AppSettings::instance().renderHeight();
-    int imgW = m_image.width();
-    int imgH = m_image.height();
+    // Scale (from center): u' = (u - 0.5) * scaleX + 0.5
+    double imgUvMinU = 0.0, imgUvWidth = 1.0;
+    double imgUvMinV = 0.0, imgUvHeight = 1.0;
     
-    if (m_stretchToFit) {
-        // Stretch: UV 0-1 maps directly to image 0-1
-        // Image fills entire render, may be distorted
-    } else {
+    auto texture = std::atomic_load(&m_texture);
+    if (!m_stretchToFit && texture && renderWidth > 0 && renderHeight > 0) {
         // Center the image without distortion
-        // Calculate where the image should be placed in UV space
-        
-        // Image aspect vs render aspect
-        double imgAspect = (double)imgW / imgH;
-        double renderAspect = (double)renderW / renderH;
-        
-        // Calculate UV extent of image when centered
-        double imgUvWidth, imgUvHeight;
+        double imgAspect = (double)texture->width() / texture->height();
+        double renderAspect = (double)renderWidth / renderHeight;
         
         if (imgAspect > renderAspect) {
-            // Image is wider than render
-            // Fit by width, image will be shorter than render
-            imgUvWidth = 1.0;
+            // Image is wider than render - fit by width
             imgUvHeight = renderAspect / imgAspect;
         } else {
-            // Image is taller than render
-            // Fit by height, image will be narrower than render
-            imgUvHeight = 1.0;
+            // Image is taller than render - fit by height
             imgUvWidth = imgAspect / renderAspect;
         }
-        
-        // Center offsets
-        double imgUvMinU = (1.0 - imgUvWidth) / 2.0;
-        double imgUvMaxU = imgUvMinU + imgUvWidth;
-        double imgUvMinV = (1.0 - imgUvHeight) / 2.0;
-        double imgUvMaxV = imgUvMinV + imgUvHeight;
-        
-        // Check if UV is outside image bounds
-        if (u < imgUvMinU || u > imgUvMaxU || v < imgUvMinV || v > imgUvMaxV) {
-            return QColor(0, 0, 0, 255);  // Black outside
-        }
-        
-        // Remap UV from image bounds to 0-1
-        u = (u - imgUvMinU) / imgUvWidth;
-        v = (v - imgUvMinV) / imgUvHeight;
+        imgUvMinU = (1.0 - imgUvWidth) / 2.0;
+        imgUvMinV = (1.0 - imgUvHeight) / 2.0;
     }
     
-    if (m_repeat) {
-        u = u - std::floor(u);
-        v = v - std::floor(v);
-    } else {
-        if (u < 0.0 || u > 1.0 || v < 0.0 || v > 1.0) {
-            return QColor(0, 0, 0, 255);
-        }
+    // texU = (u' - imgUvMinU) / imgUvWidth を u の一次式にまとめる
+    p->scaleU = m_scaleX / imgUvWidth;
+    p->offsetU = (0.5 - 0.5 * m_scaleX - imgUvMinU) / imgUvWidth;
+    p->scaleV = m_scaleY / imgUvHeight;
+    p->offsetV = (0.5 - 0.5 * m_scaleY - imgUvMinV) / imgUvHeight;
+    
+    // センタリング時は画像の外側を黒にしてから繰り返すので、実質繰り返しはない
+    p->repeat = m_repeat && m_stretchToFit;
+    p->clip = !p->repeat;
+    return p;
+}
+
+std::shared_ptr<const ImageTextureNode::Placement> ImageTextureNode::placement() const {
+    int renderW = AppSettings::instance().renderWidth();
+    int renderH = AppSettings::instance().renderHeight();
+    
+    auto p = std::atomic_load(&m_placement);
+    if (!p || p->renderWidth != renderW || p->renderHeight != renderH) {
+        p = buildPlacement(renderW, renderH);
+        std::atomic_store(&m_placement, p);
+    }
+    return p;
+}
+
+QVector4D ImageTextureNode::sampleAt(double u, double v, double footprint) const {
+    if (m_loadState == LoadState::Loading) {
+        return QVector4D(0.5f, 0.5f, 0.5f, 1.0f);  // デコード完了までのプレースホルダー
     }
+    auto texture = std::atomic_load(&m_texture);
+    if (m_loadState != LoadState::Ready || !texture) {
+        return QVector4D(0, 0, 0, 1);
+    }
+    
+    auto p = placement();
+    u = u * p->scaleU + p->offsetU;
+    v = v * p->scaleV + p->offsetV;
     
-    int x = static_cast<int>(u * imgW);
-    int y = static_cast<int>(v * imgH);
+    if (p->clip && (u < 0.0 || u > 1.0 || v < 0.0 || v > 1.0)) {
+        return QVector4D(0, 0, 0, 1);  // Black outside
+    }
     
-    x = qBound(0, x, imgW - 1);
-    y = qBound(0, y, imgH - 1);
+    // フットプリントもテクスチャ空間に換算
+    footprint *= qMax(std::abs(p->scaleU), std::abs(p->scaleV));
     
-    return m_image.pixelColor(x, y);
+    float rgba[4];
+    texture->sample(u, v, footprint, m_interpolation, p->repeat, rgba);
+    return QVector4D(rgba[0], rgba[1], rgba[2], rgba[3]);
+}
+
+QColor ImageTextureNode::getColorAt(double u, double v) const {
+    QVector4D c = sampleAt(u, v, 0.0);
+    return QColor::fromRgbF(c.x(), c.y(), c.z(), c.w());
+}
+
+int ImageTextureNode::imageWidth() const {
+    auto texture = std::atomic_load(&m_texture);
+    return texture ? texture->width() : 0;
+}
+
+int ImageTextureNode::imageHeight() const {
+    auto texture = std::atomic_load(&m_texture);
+    return texture ? texture->height() : 0;
 }
 
 QString ImageTextureNode::filePath() const {
@@ -165,11 +215,6 @@ void ImageTextureNode::setFilePath(const QString& path) {
         m_filePath = path;
         loadImage();
         
-        // Re-apply aspect ratio if enabled
-        if (m_keepAspectRatio && m_imageLoaded && m_image.width() > 0 && m_image.height() > 0) {
-            applyAspectRatio();
-        }
-        
         setDirty(true);
         notifyStructureChanged();
     }
@@ -201,7 +246,7 @@ void ImageTextureNode::setKeepAspectRatio(bool keep) {
         m_keepAspectRatio = keep;
         
         // When enabled, adjust render resolution to match image aspect ratio
-        if (keep && m_imageLoaded && m_image.width() > 0 && m_image.height() > 0) {
+        if (keep && m_loadState == LoadState::Ready && imageWidth() > 0 && imageHeight() > 0) {
             applyAspectRatio();
         }
         
@@ -216,8 +261,15 @@ void ImageTextureNode::setRepeat(bool r) {
     }
 }
 
+void ImageTextureNode::setInterpolation(TextureSource::Filter filter) {
+    if (m_interpolation != filter) {
+        m_interpolation = filter;
+        setDirty(true);
+    }
+}
+
 void ImageTextureNode::applyAspectRatio() {
-    if (!m_imageLoaded || m_image.width() <= 0 || m_image.height() <= 0) {
+    if (m_loadState != LoadState::Ready || imageWidth() <= 0 || imageHeight() <= 0) {
         return;
     }
     
@@ -225,7 +277,7 @@ void ImageTextureNode::applyAspectRatio() {
     int renderH = AppSettings::instance().renderHeight();
     int totalPixels = renderW * renderH;
     
-    double imgAspect = (double)m_image.width() / m_image.height();
+    double imgAspect = (double)imageWidth() / imageHeight();
     
     // Calculate new dimensions that match image aspect
     // while keeping approximately the same total pixel count
@@ -237,25 +289,59 @@ void ImageTextureNode::applyAspectRatio() {
 }
 
 void ImageTextureNode::loadImage() {
+    // 以前の要求の完了通知は無効にする
+    m_loadTicket = std::make_shared<LoadTicket>(LoadTicket{this});
+    std::atomic_store(&m_texture, std::shared_ptr<const TextureSource>());
+    
     if (m_filePath.isEmpty()) {
-        m_image = QImage();
-        m_imageLoaded = false;
+        m_loadState = LoadState::Empty;
+        return;
+    }
+    
+    // イベントループがない場合（コマンドライン等）は同期読み込み
+    QCoreApplication* app = QCoreApplication::instance();
+    if (!app) {
+        onImageLoaded(ImageCache::instance().acquire(m_filePath));
         return;
     }
     
-    bool success = m_image.load(m_filePath);
-    if (success) {
-        // Force conversion to RGBA8888 (explicit byte order) to match OutputNode
-        // This ensures consistant R,G,B,A channel usage
-        if (m_image.format() != QImage::Format_RGBA8888) {
-            m_image = m_image.convertToFormat(QImage::Format_RGBA8888);
+    // 同じファイルは全ノードで共有（デコードとミップマップ生成は1回だけ）
+    // デコードはバックグラウンドで行い、完了を GUI スレッドに戻して反映する
+    m_loadState = LoadState::Loading;
+    std::weak_ptr<LoadTicket> ticket = m_loadTicket;
+    ImageCache::instance().acquireAsync(m_filePath, [app, ticket](std::shared_ptr<const TextureSource> texture) {
+        if (QThread::currentThread() == app->thread()) {
+            // キャッシュヒット: その場で反映
+            if (auto t = ticket.lock()) {
+                t->node->onImageLoaded(texture);
+            }
+            return;
+        }
+        QMetaObject::invokeMethod(app, [ticket, texture]() {
+            if (auto t = ticket.lock()) {
+                t->node->onImageLoaded(texture);
+            }
+        }, Qt::QueuedConnection);
+    });
+}
+
+void ImageTextureNode::onImageLoaded(std::shared_ptr<const TextureSource> texture) {
+    if (texture) {
+        std::atomic_store(&m_texture, texture);
+        m_loadState = LoadState::Ready;
+        
+        // Re-apply aspect ratio if enabled
+        if (m_keepAspectRatio) {
+            applyAspectRatio();
         }
-        m_imageLoaded = true;
     } else {
-        qDebug() << "Failed to load image:" << m_filePath;
-        m_image = QImage();
-        m_imageLoaded = false;
+        traceWarning(Trace::IO) << "Failed to load image:" << m_filePath;
+        m_loadState = LoadState::Failed;
     }
+    
+    // 再レンダーとUI（読み込み状態の表示）の更新
+    setDirty(true);
+    notifyStructureChanged();
 }
 
 QJsonObject ImageTextureNode::save() const {
@@ -266,6 +352,7 @@ QJsonObject ImageTextureNode::save() const {
     json["stretchToFit"] = m_stretchToFit;
     json["keepAspectRatio"] = m_keepAspectRatio;
     json["repeat"] = m_repeat;
+    json["interpolation"] = static_cast<int>(m_interpolation);
     return json;
 }
 
@@ -289,4 +376,11 @@ void ImageTextureNode::restore(const QJsonObject& json) {
     if (json.contains("repeat")) {
         m_repeat = json["repeat"].toBool();
     }
+    if (json.contains("interpolation")) {
+        m_interpolation = static_cast<TextureSource::Filter>(json["interpolation"].toInt());
+    } else {
+        // Scenes saved before the filter option sampled the nearest pixel
+        m_interpolation = TextureSource::Filter::Closest;
+    }
+    setDirty(true);
 }
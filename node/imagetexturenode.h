@@ -2,9 +2,13 @@
 #define IMAGETEXTURENODE_H
 
 #include "node.h"
+#include "texturesource.h"
 #include <QImage>
 #include <QString>
 #include <QJsonObject>
+#include <atomic>
+#include <QVector4D>
+#include <memory>
 
 class ImageTextureNode : public Node {
 public:
@@ -13,6 +17,7 @@ public:
     void evaluate() override;
     QVariant compute(const QVector3D& pos, NodeSocket* socket) override;
     QVector<ParameterInfo> parameters() const override;
+    void prepareRender(int width, int height) override;
     
     QJsonObject save() const override;
     void restore(const QJsonObject& json) override;
@@ -20,6 +25,17 @@ public:
     QString filePath() const;
     void setFilePath(const QString& path);
     
+    // 読み込み状態（デコードはバックグラウンドで行う）
+    enum class LoadState {
+        Empty,
+        Loading,    // デコード中 - プレースホルダーを描画
+        Ready,
+        Failed
+    };
+    LoadState loadState() const { return m_loadState.load(); }
+    bool isLoading() const { return m_loadState == LoadState::Loading; }
+    bool isContentReady() const override { return !isLoading(); }
+    
     // Scale (like Blender's UV scale)
     double scaleX() const { return m_scaleX; }
     double scaleY() const { return m_scaleY; }
@@ -38,21 +54,54 @@ public:
     bool repeat() const { return m_repeat; }
     void setRepeat(bool r);
     
+    // Texture filtering
+    TextureSource::Filter interpolation() const { return m_interpolation; }
+    void setInterpolation(TextureSource::Filter filter);
+    
     // Get image dimensions
-    int imageWidth() const { return m_image.width(); }
-    int imageHeight() const { return m_image.height(); }
+    int imageWidth() const;
+    int imageHeight() const;
     
     // Helper to get color at UV
     QColor getColorAt(double u, double v) const;
+    
+    // Filtered RGBA at UV. 'footprint' is the UV-space size of one render pixel
+    QVector4D sampleAt(double u, double v, double footprint) const;
+
+protected:
+    void invalidate() override;
 
 private:
     NodeSocket* m_vectorInput;
     NodeSocket* m_colorOutput;
     NodeSocket* m_alphaOutput;
     
+    // UV -> テクスチャ座標の変換（スケール・センタリング・アスペクト）を
+    // レンダー解像度ごとに1回だけ計算しておく
+    struct Placement {
+        int renderWidth;
+        int renderHeight;
+        double scaleU, offsetU;
+        double scaleV, offsetV;
+        bool clip;     // 画像の外は黒
+        bool repeat;   // タイル状に繰り返す
+    };
+    std::shared_ptr<const Placement> buildPlacement(int renderWidth, int renderHeight) const;
+    std::shared_ptr<const Placement> placement() const;
+    
     QString m_filePath;
-    QImage m_image;
-    bool m_imageLoaded;
+    std::shared_ptr<const TextureSource> m_texture;
+    mutable std::shared_ptr<const Placement> m_placement;
+    // GUI スレッドが書き、レンダースレッドが読む
+    std::atomic<LoadState> m_loadState;
+    
+    // 非同期読み込みの完了通知用。要求ごとに作り直すので、古い要求や
+    // 削除済みノードへの通知は weak_ptr の失効で捨てられる
+    struct LoadTicket {
+        ImageTextureNode* node;
+    };
+    std::shared_ptr<LoadTicket> m_loadTicket;
+    TextureSource::Filter m_interpolation;
     
     double m_scaleX;
     double m_scaleY;
@@ -61,6 +110,7 @@ private:
     bool m_repeat;
     
     void loadImage();
+    void onImageLoaded(std::shared_ptr<const TextureSource> texture);
     void applyAspectRatio();  // Apply aspect ratio to render settings
 };
 
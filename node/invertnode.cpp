@@ -20,7 +20,7 @@ InvertNode::InvertNode() : Node("Invert") {
 
 InvertNode::~InvertNode() {}
 
-QVector<Node::ParameterInfo> InvertNode::parameters() const {
+QVector<Node::ParameterInfo> InvertNode::describeParameters() const {
     return {
         ParameterInfo("Fac", 0.0, 1.0, 1.0)
     };
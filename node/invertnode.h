@@ -11,11 +11,12 @@ public:
     void evaluate() override;
     QVariant compute(const QVector3D& pos, NodeSocket* socket) override;
 
-    QVector<ParameterInfo> parameters() const override;
-
     double fac() const;
     void setFac(double v);
 
+protected:
+    QVector<ParameterInfo> describeParameters() const override;
+
 private:
     NodeSocket* m_colorInput;
     NodeSocket* m_facInput;
@@ -5,10 +5,15 @@
 #include <QDir>
 #include <QFile>
 #include "noderegistry.h"
+#include "trace.h"
 
 int main(int argc, char *argv[])
 {
     QApplication a(argc, argv);
+
+    // トレース: NODE_TRACE=graph,io でカテゴリを絞る、NODE_TRACE_ECHO=1 でコンソールにも出す
+    Trace::configure(qEnvironmentVariable("NODE_TRACE"));
+    Trace::setEcho(qEnvironmentVariableIntValue("NODE_TRACE_ECHO") != 0);
     
     // Set application icon (try multiple paths)
     QString iconPath = QCoreApplication::applicationDirPath() + "/icon/icon.png";
@@ -10,6 +10,8 @@
 #include "nodegraphbuilder.h"
 #include "appsettings.h"
 #include "outputviewerwidget.h"
+#include "trace.h"
+#include "previewservice.h"
 
 #include <QSplitter>
 #include <QTabWidget>
@@ -32,6 +34,11 @@
 #include <QComboBox>
 #include <QMenuBar>
 #include <QPushButton>
+#include <QDir>
+#include <QStandardPaths>
+#include <QFutureWatcher>
+#include <QProgressDialog>
+#include <QtConcurrent>
 
 MainWindow::MainWindow(QWidget *parent)
     : QMainWindow(parent)
@@ -377,6 +384,22 @@ MainWindow::MainWindow(QWidget *parent)
     });
     settingsLayout->addWidget(m_fpsCheckBox);
     
+    // Compress baked caches in .nscene files
+    m_compressBakeCheckBox = new QCheckBox("Compress Baked Caches", settingsTab);
+    m_compressBakeCheckBox->setChecked(AppSettings::instance().compressBakedCaches());
+    connect(m_compressBakeCheckBox, &QCheckBox::toggled, [](bool checked){
+        AppSettings::instance().setCompressBakedCaches(checked);
+    });
+    settingsLayout->addWidget(m_compressBakeCheckBox);
+    
+    // Pin render worker threads to CPU cores
+    m_pinThreadsCheckBox = new QCheckBox("Pin Render Threads to Cores", settingsTab);
+    m_pinThreadsCheckBox->setChecked(AppSettings::instance().pinRenderThreads());
+    connect(m_pinThreadsCheckBox, &QCheckBox::toggled, [](bool checked){
+        AppSettings::instance().setPinRenderThreads(checked);
+    });
+    settingsLayout->addWidget(m_pinThreadsCheckBox);
+    
     // Language
     QHBoxLayout* langLayout = new QHBoxLayout();
     m_langLabel = new QLabel("Language:", settingsTab);
@@ -459,6 +482,19 @@ MainWindow::MainWindow(QWidget *parent)
     ui->menufile->addAction(addNodesAction);
     connect(addNodesAction, &QAction::triggered, this, &MainWindow::onAddMultipleNodes);
 
+    // Dump Trace Action (全スレッドのトレースをファイルに書き出す)
+    QAction* dumpTraceAction = new QAction("Dump Trace Log", this);
+    ui->menufile->addAction(dumpTraceAction);
+    connect(dumpTraceAction, &QAction::triggered, this, [this]() {
+        const QString path = QDir(QStandardPaths::writableLocation(QStandardPaths::TempLocation))
+                                 .filePath("nodeeditor-trace.txt");
+        if (Trace::dumpToFile(path)) {
+            QMessageBox::information(this, "Trace", "Trace written to\n" + QDir::toNativeSeparators(path));
+        } else {
+            QMessageBox::warning(this, "Trace", "Failed to write " + path);
+        }
+    });
+
     // Exit Action
     if (ui->actionexit) {
         connect(ui->actionexit, &QAction::triggered, this, &MainWindow::close);
@@ -476,6 +512,13 @@ MainWindow::MainWindow(QWidget *parent)
     QAction* redoAction = m_nodeEditor->undoStack()->createRedoAction(this, tr("&Redo"));
     redoAction->setShortcuts(QKeySequence::Redo);
     
+    // The stack's actions keep their text / enabled state; the editor runs
+    // the step itself so a macro is replayed as one graph transaction
+    disconnect(undoAction, &QAction::triggered, m_nodeEditor->undoStack(), nullptr);
+    disconnect(redoAction, &QAction::triggered, m_nodeEditor->undoStack(), nullptr);
+    connect(undoAction, &QAction::triggered, m_nodeEditor, &NodeEditorWidget::undo);
+    connect(redoAction, &QAction::triggered, m_nodeEditor, &NodeEditorWidget::redo);
+    
     // Add to Edit menu
     QMenu* editMenu = menuBar()->addMenu(tr("&Edit"));
     editMenu->addAction(undoAction);
@@ -484,7 +527,7 @@ MainWindow::MainWindow(QWidget *parent)
     // Load default scene if exists
     loadStartupGraph();
     
-    qDebug() << "MainWindow: Connections done";
+    traceInfo(Trace::App) << "MainWindow: Connections done";
     
     // Connect parameter changes from node editor to auto-update
     connect(m_nodeEditor, &NodeEditorWidget::parameterChanged, 
@@ -495,13 +538,15 @@ MainWindow::MainWindow(QWidget *parent)
     QTimer::singleShot(100, this, &MainWindow::onRunClicked);
     
     // Initialize language
-    qDebug() << "MainWindow: Calling updateLanguage";
+    traceInfo(Trace::App) << "MainWindow: Calling updateLanguage";
     updateLanguage();
-    qDebug() << "MainWindow: updateLanguage done";
+    traceInfo(Trace::App) << "MainWindow: updateLanguage done";
 }
 
 MainWindow::~MainWindow()
 {
+    // 書き出し中のレンダーはノードを参照している
+    m_exportFuture.waitForFinished();
     delete ui;
 }
 
@@ -523,6 +568,8 @@ void MainWindow::onRunClicked() {
     timer.start();
     
     QImage result = outputNode->render(m_nodeEditor->nodes());
+    // 上流の prepare が揃ったので、待たせていたプレビューを進める
+    PreviewService::instance().renderPrepared();
     
     qint64 elapsed = timer.elapsed();
     if (elapsed > 0) {
@@ -547,24 +594,53 @@ void MainWindow::onRunClicked() {
 }
 
 void MainWindow::onExportClicked() {
-    QImage image = m_outputViewer->image();
-    if (image.isNull()) {
-        QMessageBox::warning(this, "Error", "No image to export. Please run the graph first.");
+    if (m_exportFuture.isRunning()) return;
+    
+    OutputNode* outputNode = nullptr;
+    for (Node* node : m_nodeEditor->nodes()) {
+        outputNode = dynamic_cast<OutputNode*>(node);
+        if (outputNode) break;
+    }
+    if (!outputNode) {
+        QMessageBox::warning(this, "Error", "Output Node not found!");
         return;
     }
     
     QString fileName = QFileDialog::getSaveFileName(this, "Export Image", "", "Images (*.png *.jpg *.bmp)");
-    if (!fileName.isEmpty()) {
-        if (image.save(fileName)) {
+    if (fileName.isEmpty()) return;
+    
+    // Render afresh on the Batch lane from a pool thread: the scheduler
+    // serves viewport and thumbnail jobs first, and the GUI thread stays
+    // free to paint. The window-modal dialog keeps the graph from being
+    // edited while the render reads it.
+    QProgressDialog* progress = new QProgressDialog("Exporting...", QString(), 0, 0, this);
+    progress->setWindowModality(Qt::WindowModal);
+    progress->setMinimumDuration(0);
+    progress->show();
+    
+    const QVector<Node*> nodes = m_nodeEditor->nodes();
+    m_exportFuture = QtConcurrent::run([outputNode, nodes]() {
+        return outputNode->render(nodes, RenderLane::Batch);
+    });
+    
+    auto* watcher = new QFutureWatcher<QImage>(this);
+    connect(watcher, &QFutureWatcher<QImage>::finished, this, [this, watcher, progress, fileName]() {
+        const QImage image = watcher->result();
+        watcher->deleteLater();
+        progress->close();
+        progress->deleteLater();
+        
+        if (!image.isNull() && image.save(fileName)) {
             QMessageBox::information(this, "Success", "Image saved successfully!");
         } else {
             QMessageBox::critical(this, "Error", "Failed to save image.");
         }
-    }
+    });
+    watcher->setFuture(m_exportFuture);
 }
 
 void MainWindow::onSaveClicked() {
-    QString fileName = QFileDialog::getSaveFileName(this, "Save Node Graph", "", "JSON Files (*.json)");
+    QString fileName = QFileDialog::getSaveFileName(this, "Save Node Graph", "", "Node Scene (*.nscene);;JSON Files (*.json)");
     if (!fileName.isEmpty()) {
         m_nodeEditor->saveToFile(fileName);
         QMessageBox::information(this, "Success", "Graph saved successfully!");
@@ -572,7 +648,7 @@ void MainWindow::onSaveClicked() {
 }
 
 void MainWindow::onLoadClicked() {
-    QString fileName = QFileDialog::getOpenFileName(this, "Load Node Graph", "", "JSON Files (*.json)");
+    QString fileName = QFileDialog::getOpenFileName(this, "Load Node Graph", "", "Node Graphs (*.nscene *.json);;Node Scene (*.nscene);;JSON Files (*.json)");
     if (!fileName.isEmpty()) {
         // Create new material from filename
         QFileInfo fileInfo(fileName);
@@ -626,6 +702,8 @@ void MainWindow::updateLanguage() {
     m_tabWidget->setTabText(1, settings.translate("Settings"));
     m_cpuLabel->setText(settings.translate("CPU Usage (Threads):"));
     m_fpsCheckBox->setText(settings.translate("Show FPS"));
+    m_compressBakeCheckBox->setText(settings.translate("Compress Baked Caches"));
+    m_pinThreadsCheckBox->setText(settings.translate("Pin Render Threads to Cores"));
     m_langLabel->setText(settings.translate("Language:"));
     m_themeLabel->setText(settings.translate("Theme:"));
     
@@ -747,7 +825,7 @@ void MainWindow::onMaterialChanged(int index) {
     if (!m_lastMaterialName.isEmpty() && m_lastMaterialName != newMaterialName) {
         QString savePath = QCoreApplication::applicationDirPath() + "/materials/" + m_lastMaterialName + ".json";
         m_nodeEditor->saveToFile(savePath);
-        qDebug() << "Saved previous material:" << m_lastMaterialName;
+        traceInfo(Trace::App) << "Saved previous material:" << m_lastMaterialName;
     }
     
     // Load new material
@@ -755,10 +833,10 @@ void MainWindow::onMaterialChanged(int index) {
     
     if (QFile::exists(path)) {
         m_nodeEditor->loadFromFile(path);
-        qDebug() << "Loaded material:" << newMaterialName;
+        traceInfo(Trace::App) << "Loaded material:" << newMaterialName;
     } else {
         // New material or missing file -> Load Default
-        qDebug() << "New/Missing material, loading default:" << newMaterialName;
+        traceInfo(Trace::App) << "New/Missing material, loading default:" << newMaterialName;
         // Check if it's a "fresh" start (not deleted file)
         // If we just added it, we want default graph.
         m_nodeEditor->clear(); 
@@ -1,6 +1,8 @@
 #ifndef MAINWINDOW_H
 #define MAINWINDOW_H
 
+#include <QFuture>
+#include <QImage>
 #include <QMainWindow>
 
 QT_BEGIN_NAMESPACE
@@ -59,6 +61,8 @@ private:
     QTabWidget* m_tabWidget;
     QLabel* m_cpuLabel;
     QCheckBox* m_fpsCheckBox;
+    QCheckBox* m_compressBakeCheckBox;
+    QCheckBox* m_pinThreadsCheckBox;
     QLabel* m_langLabel;
     QLabel* m_themeLabel;
     
@@ -72,5 +76,8 @@ private:
     
     void loadStartupGraph();
     void loadNewMaterialGraph();
+    
+    // 書き出し用のレンダー（Batch レーンで別スレッド実行）
+    QFuture<QImage> m_exportFuture;
 };
 #endif // MAINWINDOW_H
@@ -1,4 +1,5 @@
 #include "mappingnode.h"
+#include "dual.h"
 
 MappingNode::MappingNode() : Node("Mapping") {
     m_vectorInput = new NodeSocket("Vector", SocketType::Vector, SocketDirection::Input, this);
@@ -22,7 +23,7 @@ MappingNode::MappingNode() : Node("Mapping") {
 
 MappingNode::~MappingNode() {}
 
-QVector<Node::ParameterInfo> MappingNode::parameters() const {
+QVector<Node::ParameterInfo> MappingNode::describeParameters() const {
     return {
         ParameterInfo("Location", -100.0, 100.0, QVector3D(0, 0, 0)),
         ParameterInfo("Rotation", -360.0, 360.0, QVector3D(0, 0, 0)),
@@ -65,6 +66,32 @@ QVariant MappingNode::compute(const QVector3D& pos, NodeSocket* socket) {
     return mat.map(vec);
 }
 
+bool MappingNode::computeDual(const QVector3D& pos, NodeSocket* socket, DualVec& out) {
+    Q_UNUSED(socket);
+    // 回転・スケールが接続されていると行列自体が変化するので非対応
+    if (m_rotationInput->isConnected() || m_scaleInput->isConnected()) return false;
+
+    // 未接続ならピクセル座標そのもの (d/dx = (1,0,0), d/dy = (0,1,0))
+    DualVec vec(Dual(pos.x(), 1.0, 0.0), Dual(pos.y(), 0.0, 1.0), Dual(pos.z()));
+    if (m_vectorInput->isConnected() && !m_vectorInput->getDual(pos, vec)) return false;
+
+    DualVec loc(location());
+    if (m_locationInput->isConnected() && !m_locationInput->getDual(pos, loc)) return false;
+
+    QMatrix4x4 mat;
+    mat.rotate(rotation().x(), 1, 0, 0);
+    mat.rotate(rotation().y(), 0, 1, 0);
+    mat.rotate(rotation().z(), 0, 0, 1);
+    mat.scale(scale());
+
+    // 回転・スケールは線形なので値と微分それぞれに同じ行列を掛ける
+    QVector3D v = mat.mapVector(vec.value());
+    QVector3D du = mat.mapVector(QVector3D(vec.x.du, vec.y.du, vec.z.du));
+    QVector3D dv = mat.mapVector(QVector3D(vec.x.dv, vec.y.dv, vec.z.dv));
+    out = DualVec(Dual(v.x(), du.x(), dv.x()), Dual(v.y(), du.y(), dv.y()), Dual(v.z(), du.z(), dv.z())) + loc;
+    return true;
+}
+
 QVector3D MappingNode::location() const {
     return m_locationInput->defaultValue().value<QVector3D>();
 }
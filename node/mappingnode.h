@@ -12,8 +12,7 @@ public:
     
     void evaluate() override;
     QVariant compute(const QVector3D& pos, NodeSocket* socket) override;
-    
-    QVector<ParameterInfo> parameters() const override;
+    bool computeDual(const QVector3D& pos, NodeSocket* socket, DualVec& out) override;
 
     // パラメータ取得
     QVector3D location() const;
@@ -28,6 +27,9 @@ public:
     // 変換適用
     QVector3D mapVector(const QVector3D& vec) const;
 
+protected:
+    QVector<ParameterInfo> describeParameters() const override;
+
 private:
     NodeSocket* m_vectorInput;
     
@@ -1,4 +1,5 @@
 #include "maprangenode.h"
+#include "dual.h"
 #include <algorithm>
 
 MapRangeNode::MapRangeNode() : Node("Map Range"), m_clamp(false) {
@@ -38,12 +39,11 @@ void MapRangeNode::setClamp(bool c) {
     setDirty(true);
 }
 
-QVector<Node::ParameterInfo> MapRangeNode::parameters() const {
+QVector<Node::ParameterInfo> MapRangeNode::describeParameters() const {
     return {
-        ParameterInfo("Clamp", m_clamp, 
-            [this](const QVariant& v) { 
-                const_cast<MapRangeNode*>(this)->setClamp(v.toBool()); 
-            }),
+        ParameterInfo("Clamp", m_clamp)
+            .bind<MapRangeNode>([](const MapRangeNode& n) { return n.clamp(); },
+                                [](MapRangeNode& n, const QVariant& v) { n.setClamp(v.toBool()); }),
         ParameterInfo("Value", -10000.0, 10000.0, 0.5, 0.01),
         ParameterInfo("From Min", -1000.0, 1000.0, 0.0, 0.1),
         ParameterInfo("From Max", -1000.0, 1000.0, 1.0, 0.1),
@@ -76,6 +76,33 @@ QVariant MapRangeNode::compute(const QVector3D& pos, NodeSocket* socket) {
     return QVariant();
 }
 
+bool MapRangeNode::computeDual(const QVector3D& pos, NodeSocket* socket, DualVec& out) {
+    if (socket != m_resultOutput) return false;
+
+    DualVec val, fromMin, fromMax, toMin, toMax;
+    if (!m_valueInput->getDual(pos, val) || !m_fromMinInput->getDual(pos, fromMin) ||
+        !m_fromMaxInput->getDual(pos, fromMax) || !m_toMinInput->getDual(pos, toMin) ||
+        !m_toMaxInput->getDual(pos, toMax)) {
+        return false;
+    }
+
+    if (std::abs(fromMax.x.v - fromMin.x.v) < 0.000001) {
+        out = DualVec::scalar(toMin.x);
+        return true;
+    }
+
+    Dual result = toMin.x + (val.x - fromMin.x) / (fromMax.x - fromMin.x) * (toMax.x - toMin.x);
+
+    if (m_clamp) {
+        double rMin = std::min(toMin.x.v, toMax.x.v);
+        double rMax = std::max(toMin.x.v, toMax.x.v);
+        result = dualClamp(result, rMin, rMax);
+    }
+
+    out = DualVec::scalar(result);
+    return true;
+}
+
 QJsonObject MapRangeNode::save() const {
     QJsonObject json = Node::save();
     json["clamp"] = m_clamp;
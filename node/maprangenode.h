@@ -10,8 +10,7 @@ public:
 
     void evaluate() override;
     QVariant compute(const QVector3D& pos, NodeSocket* socket) override;
-    
-    QVector<ParameterInfo> parameters() const override;
+    bool computeDual(const QVector3D& pos, NodeSocket* socket, DualVec& out) override;
 
     bool clamp() const { return m_clamp; }
     void setClamp(bool c);
@@ -19,6 +18,9 @@ public:
     QJsonObject save() const override;
     void restore(const QJsonObject& json) override;
 
+protected:
+    QVector<ParameterInfo> describeParameters() const override;
+
 private:
     NodeSocket* m_valueInput;
     NodeSocket* m_fromMinInput;
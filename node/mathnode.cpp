@@ -1,4 +1,5 @@
 #include "mathnode.h"
+#include "dual.h"
 #include <cmath>
 #include <algorithm>
 #include <QtMath>
@@ -232,6 +233,107 @@ QVariant MathNode::compute(const QVector3D& pos, NodeSocket* socket) {
     return result;
 }
 
+bool MathNode::computeDual(const QVector3D& pos, NodeSocket* socket, DualVec& out) {
+    Q_UNUSED(socket);
+    DualVec a1, a2, a3;
+    if (!m_value1Input->getDual(pos, a1) || !m_value2Input->getDual(pos, a2) || !m_value3Input->getDual(pos, a3)) {
+        return false;
+    }
+    const Dual v1 = a1.x;
+    const Dual v2 = a2.x;
+    const Dual v3 = a3.x;
+
+    // compute() と同じ分岐を Dual で評価する。段差のある関数は微分 0
+    Dual result(0.0);
+
+    switch (m_operation) {
+        case MathOperation::Add: result = v1 + v2; break;
+        case MathOperation::Subtract: result = v1 - v2; break;
+        case MathOperation::Multiply: result = v1 * v2; break;
+        case MathOperation::Divide: result = (v2.v != 0.0) ? v1 / v2 : Dual(0.0); break;
+        case MathOperation::MultiplyAdd: result = v1 * v2 + v3; break;
+
+        case MathOperation::Logarithm: result = (v1.v > 0.0 && v2.v > 0.0 && v2.v != 1.0) ? log(v1) / log(v2) : Dual(0.0); break;
+        case MathOperation::Sqrt: result = (v1.v >= 0.0) ? sqrt(v1) : Dual(0.0); break;
+        case MathOperation::InverseSqrt: result = (v1.v > 0.0) ? Dual(1.0) / sqrt(v1) : Dual(0.0); break;
+        case MathOperation::Absolute: result = abs(v1); break;
+        case MathOperation::Exponent: result = pow(v1, v2); break;
+
+        case MathOperation::Minimum: result = dualMin(v1, v2); break;
+        case MathOperation::Maximum: result = dualMax(v1, v2); break;
+        case MathOperation::LessThan: result = Dual((v1.v < v2.v) ? 1.0 : 0.0); break;
+        case MathOperation::GreaterThan: result = Dual((v1.v > v2.v) ? 1.0 : 0.0); break;
+        case MathOperation::Sign: result = Dual((v1.v > 0.0) ? 1.0 : ((v1.v < 0.0) ? -1.0 : 0.0)); break;
+        case MathOperation::Compare: result = Dual((std::abs(v1.v - v2.v) <= 0.00001) ? 1.0 : 0.0); break;
+
+        case MathOperation::SmoothMin: {
+            Dual c = (v3.v != 0.0) ? v3 : Dual(0.0001);
+            Dual h = dualClamp((v2 - v1 + c) / (Dual(2.0) * c), 0.0, 1.0);
+            result = v1 * (Dual(1.0) - h) + v2 * h - c * h * (Dual(1.0) - h);
+            break;
+        }
+        case MathOperation::SmoothMax: {
+            Dual c = (v3.v != 0.0) ? v3 : Dual(0.0001);
+            Dual h = dualClamp((v1 - v2 + c) / (Dual(2.0) * c), 0.0, 1.0);
+            result = v1 * h + v2 * (Dual(1.0) - h) + c * h * (Dual(1.0) - h);
+            break;
+        }
+
+        case MathOperation::Round: result = round(v1); break;
+        case MathOperation::Ceil: result = ceil(v1); break;
+        case MathOperation::Floor: result = floor(v1); break;
+        case MathOperation::Fraction: result = v1 - floor(v1); break;
+        case MathOperation::Modulo:
+            result = (v2.v != 0.0) ? v1 - Dual(std::trunc(v1.v / v2.v)) * v2 : Dual(0.0);
+            break;
+        case MathOperation::FlooredModulo:
+            result = (v2.v != 0.0) ? v1 - floor(v1 / v2) * v2 : Dual(0.0);
+            break;
+        case MathOperation::Wrap: {
+            Dual range = v3 - v2;
+            if (range.v == 0.0) result = v2;
+            else result = v2 + (v1 - v2) - range * floor((v1 - v2) / range);
+            break;
+        }
+        case MathOperation::Snap:
+            result = (v2.v == 0.0) ? v1 : floor(v1 / v2 + Dual(0.5)) * v2;
+            break;
+        case MathOperation::PingPong: {
+            if (v2.v == 0.0) {
+                result = Dual(0.0);
+            } else {
+                Dual range = v2 * Dual(2.0);
+                Dual val = v1 - Dual(std::trunc(v1.v / range.v)) * range;
+                if (val.v < 0) val += range;
+                result = (val.v > v2.v) ? range - val : val;
+            }
+            break;
+        }
+
+        case MathOperation::Sine: result = sin(v1); break;
+        case MathOperation::Cosine: result = cos(v1); break;
+        case MathOperation::Tangent: result = tan(v1); break;
+        case MathOperation::Arcsine: result = (v1.v >= -1.0 && v1.v <= 1.0) ? asin(v1) : Dual(0.0); break;
+        case MathOperation::Arccosine: result = (v1.v >= -1.0 && v1.v <= 1.0) ? acos(v1) : Dual(0.0); break;
+        case MathOperation::Arctangent: result = atan(v1); break;
+        case MathOperation::Arctangent2: result = atan2(v1, v2); break;
+
+        case MathOperation::Sinh: result = sinh(v1); break;
+        case MathOperation::Cosh: result = cosh(v1); break;
+        case MathOperation::Tanh: result = tanh(v1); break;
+
+        case MathOperation::ToRadians: result = v1 * Dual(qDegreesToRadians(1.0)); break;
+        case MathOperation::ToDegrees: result = v1 * Dual(qRadiansToDegrees(1.0)); break;
+    }
+
+    if (m_useClamp) {
+        result = dualClamp(result, 0.0, 1.0);
+    }
+
+    out = DualVec::scalar(result);
+    return true;
+}
+
 void MathNode::setOperation(MathOperation op) {
     m_operation = op;
 
@@ -21,6 +21,7 @@ public:
 
     void evaluate() override;
     QVariant compute(const QVector3D& pos, NodeSocket* socket) override;
+    bool computeDual(const QVector3D& pos, NodeSocket* socket, DualVec& out) override;
 
     QVector<ParameterInfo> parameters() const override;
 
@@ -0,0 +1,148 @@
+#include "miptexture.h"
+#include <QtGlobal>
+#include <cmath>
+
+namespace {
+
+inline int wrapIndex(int i, int size, bool repeat) {
+    if (repeat) {
+        i %= size;
+        return i < 0 ? i + size : i;
+    }
+    return qBound(0, i, size - 1);
+}
+
+} // namespace
+
+std::shared_ptr<const MipTexture> MipTexture::fromImage(const QImage& image) {
+    if (image.isNull() || image.width() <= 0 || image.height() <= 0) {
+        return nullptr;
+    }
+
+    QImage rgba = image.format() == QImage::Format_RGBA8888
+        ? image
+        : image.convertToFormat(QImage::Format_RGBA8888);
+
+    std::shared_ptr<MipTexture> texture(new MipTexture());
+
+    // レベル0: インターリーブ RGBA をチャンネル別に分解
+    Level base;
+    base.width = rgba.width();
+    base.height = rgba.height();
+    const size_t count = static_cast<size_t>(base.width) * base.height;
+    for (auto& c : base.channels) c.resize(count);
+    for (int y = 0; y < base.height; ++y) {
+        const uchar* line = rgba.constScanLine(y);
+        const size_t row = static_cast<size_t>(y) * base.width;
+        for (int x = 0; x < base.width; ++x) {
+            for (int c = 0; c < 4; ++c) {
+                base.channels[c][row + x] = line[x * 4 + c];
+            }
+        }
+    }
+    texture->m_levels.push_back(std::move(base));
+
+    // 2x2 ボックスフィルタで 1x1 まで縮小（奇数サイズは端のテクセルを重複）
+    while (texture->m_levels.back().width > 1 || texture->m_levels.back().height > 1) {
+        const Level& src = texture->m_levels.back();
+        Level dst;
+        dst.width = qMax(1, src.width / 2);
+        dst.height = qMax(1, src.height / 2);
+        for (auto& c : dst.channels) c.resize(static_cast<size_t>(dst.width) * dst.height);
+
+        for (int y = 0; y < dst.height; ++y) {
+            const int y0 = qMin(2 * y, src.height - 1);
+            const int y1 = qMin(2 * y + 1, src.height - 1);
+            for (int x = 0; x < dst.width; ++x) {
+                const int x0 = qMin(2 * x, src.width - 1);
+                const int x1 = qMin(2 * x + 1, src.width - 1);
+                for (int c = 0; c < 4; ++c) {
+                    const std::vector<uint8_t>& s = src.channels[c];
+                    int sum = s[static_cast<size_t>(y0) * src.width + x0] + s[static_cast<size_t>(y0) * src.width + x1]
+                            + s[static_cast<size_t>(y1) * src.width + x0] + s[static_cast<size_t>(y1) * src.width + x1];
+                    dst.channels[c][static_cast<size_t>(y) * dst.width + x] = static_cast<uint8_t>((sum + 2) / 4);
+                }
+            }
+        }
+        texture->m_levels.push_back(std::move(dst));
+    }
+
+    return texture;
+}
+
+size_t MipTexture::byteSize() const {
+    size_t total = 0;
+    for (const Level& level : m_levels) {
+        total += static_cast<size_t>(level.width) * level.height * 4;
+    }
+    return total;
+}
+
+void MipTexture::sample(double u, double v, double footprint, Filter filter, bool repeat, float rgba[4]) const {
+    if (m_levels.empty()) {
+        rgba[0] = rgba[1] = rgba[2] = 0.0f;
+        rgba[3] = 1.0f;
+        return;
+    }
+
+    if (filter == Filter::Closest) {
+        fetchClosest(m_levels[0], u, v, repeat, rgba);
+        return;
+    }
+
+    // フットプリントをレベル0のテクセル数に換算して LOD を決める
+    double lod = 0.0;
+    if (filter == Filter::Mipmap && footprint > 0.0) {
+        double texels = footprint * qMax(width(), height());
+        if (texels > 1.0) {
+            lod = qMin(std::log2(texels), static_cast<double>(m_levels.size() - 1));
+        }
+    }
+
+    const int l0 = static_cast<int>(lod);
+    const float t = static_cast<float>(lod - l0);
+    fetchBilinear(m_levels[l0], u, v, repeat, rgba);
+
+    if (t > 0.0f && l0 + 1 < static_cast<int>(m_levels.size())) {
+        float next[4];
+        fetchBilinear(m_levels[l0 + 1], u, v, repeat, next);
+        for (int c = 0; c < 4; ++c) {
+            rgba[c] += (next[c] - rgba[c]) * t;
+        }
+    }
+}
+
+void MipTexture::fetchClosest(const Level& level, double u, double v, bool repeat, float rgba[4]) const {
+    if (repeat) {
+        u -= std::floor(u);
+        v -= std::floor(v);
+    }
+    const int x = qBound(0, static_cast<int>(u * level.width), level.width - 1);
+    const int y = qBound(0, static_cast<int>(v * level.height), level.height - 1);
+    const size_t i = static_cast<size_t>(y) * level.width + x;
+    for (int c = 0; c < 4; ++c) {
+        rgba[c] = level.channels[c][i] * (1.0f / 255.0f);
+    }
+}
+
+void MipTexture::fetchBilinear(const Level& level, double u, double v, bool repeat, float rgba[4]) const {
+    // テクセル中心基準の座標
+    const double fx = u * level.width - 0.5;
+    const double fy = v * level.height - 0.5;
+    const double flx = std::floor(fx);
+    const double fly = std::floor(fy);
+    const float tx = static_cast<float>(fx - flx);
+    const float ty = static_cast<float>(fy - fly);
+
+    const int x0 = wrapIndex(static_cast<int>(flx), level.width, repeat);
+    const int x1 = wrapIndex(static_cast<int>(flx) + 1, level.width, repeat);
+    const size_t row0 = static_cast<size_t>(wrapIndex(static_cast<int>(fly), level.height, repeat)) * level.width;
+    const size_t row1 = static_cast<size_t>(wrapIndex(static_cast<int>(fly) + 1, level.height, repeat)) * level.width;
+
+    for (int c = 0; c < 4; ++c) {
+        const uint8_t* p = level.channels[c].data();
+        const float top = p[row0 + x0] + (p[row0 + x1] - p[row0 + x0]) * tx;
+        const float bottom = p[row1 + x0] + (p[row1 + x1] - p[row1 + x0]) * tx;
+        rgba[c] = (top + (bottom - top) * ty) * (1.0f / 255.0f);
+    }
+}
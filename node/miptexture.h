@@ -0,0 +1,41 @@
+#ifndef MIPTEXTURE_H
+#define MIPTEXTURE_H
+
+#include "texturesource.h"
+#include <QImage>
+#include <cstdint>
+#include <memory>
+#include <vector>
+
+// Mip Texture - a decoded image stored as planar 8-bit R/G/B/A channels
+// with a box-filtered mip pyramid. Immutable once built, so render threads
+// can sample it without locking.
+class MipTexture : public TextureSource {
+public:
+    struct Level {
+        int width = 0;
+        int height = 0;
+        std::vector<uint8_t> channels[4];  // R, G, B, A
+    };
+
+    // Converts the image to RGBA8888 and builds the full pyramid down to 1x1
+    static std::shared_ptr<const MipTexture> fromImage(const QImage& image);
+
+    int width() const override { return m_levels.empty() ? 0 : m_levels[0].width; }
+    int height() const override { return m_levels.empty() ? 0 : m_levels[0].height; }
+    int levelCount() const { return static_cast<int>(m_levels.size()); }
+    const Level& level(int index) const { return m_levels[index]; }
+    size_t byteSize() const override;
+
+    void sample(double u, double v, double footprint, Filter filter, bool repeat, float rgba[4]) const override;
+
+private:
+    MipTexture() = default;
+
+    void fetchClosest(const Level& level, double u, double v, bool repeat, float rgba[4]) const;
+    void fetchBilinear(const Level& level, double u, double v, bool repeat, float rgba[4]) const;
+
+    std::vector<Level> m_levels;
+};
+
+#endif // MIPTEXTURE_H
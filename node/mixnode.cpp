@@ -1,4 +1,5 @@
 #include "mixnode.h"
+#include "dual.h"
 #include <algorithm>
 #include <cmath>
 #include <QColor>
@@ -179,6 +180,30 @@ QVariant MixNode::compute(const QVector3D& pos, NodeSocket* socket) {
     return QVariant();
 }
 
+bool MixNode::computeDual(const QVector3D& pos, NodeSocket* socket, DualVec& out) {
+    // Color モードのブレンドは微分しない
+    if (socket != m_output || m_dataType == DataType::Color) return false;
+
+    DualVec f, a, b;
+    if (!m_factorInput->getDual(pos, f) || !m_inputA->getDual(pos, a) || !m_inputB->getDual(pos, b)) {
+        return false;
+    }
+
+    if (m_dataType == DataType::Float) {
+        Dual res = a.x * (Dual(1.0) - f.x) + b.x * f.x;
+        if (m_clampResult) res = dualClamp(res, 0.0, 1.0);
+        out = DualVec::scalar(res);
+        return true;
+    }
+
+    if (m_vectorMixMode == VectorMixMode::Uniform) {
+        out = a * (Dual(1.0) - f.x) + b * f.x;
+    } else {
+        out = a * (DualVec::scalar(Dual(1.0)) - f) + b * f;
+    }
+    return true;
+}
+
 float MixNode::blendFloat(float a, float b, float t) const {
     return a * (1.0f - t) + b * t;
 }
@@ -24,7 +24,7 @@ void MixShaderNode::evaluate() {
     // Nothing to pre-calculate
 }
 
-QVector<Node::ParameterInfo> MixShaderNode::parameters() const {
+QVector<Node::ParameterInfo> MixShaderNode::describeParameters() const {
     return {
         ParameterInfo("Fac", 0.0, 1.0, 0.5, 0.01, "Mixing factor")
     };
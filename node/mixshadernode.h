@@ -10,8 +10,9 @@ public:
 
     void evaluate() override;
     QVariant compute(const QVector3D& pos, NodeSocket* socket) override;
-    
-    QVector<ParameterInfo> parameters() const override;
+
+protected:
+    QVector<ParameterInfo> describeParameters() const override;
 
 private:
     NodeSocket* m_facInput;
@@ -1,7 +1,17 @@
 #include "node.h"
+#include "stencilbuffer.h"
+#include "dual.h"
+#include "trace.h"
+#include <QCryptographicHash>
 #include <QJsonArray>
+#include <QJsonDocument>
 #include <QJsonObject>
 #include <QColor>
+#include <QtEndian>
+#include <QSet>
+#include <QDebug>
+#include <algorithm>
+#include <utility>
 
 // NodeSocket implementation
 NodeSocket::NodeSocket(const QString& name, SocketType type, SocketDirection direction, Node* parentNode)
@@ -26,11 +36,14 @@ NodeSocket::~NodeSocket() {
     m_connections.clear();
 }
 
-void NodeSocket::addConnection(NodeSocket* other) {
+void NodeSocket::addConnection(NodeSocket* other, bool notify) {
     if (!m_connections.contains(other)) {
         m_connections.append(other);
-        if (m_parentNode) {
-            qDebug() << "NodeSocket::addConnection" << m_name << "to" << other->name() << "Parent:" << m_parentNode->name();
+        if (m_direction == SocketDirection::Input && m_parentNode && other->parentNode()) {
+            Node::orderConnection(other->parentNode(), m_parentNode);
+        }
+        if (m_parentNode && notify) {
+            traceDebug(Trace::Graph) << "NodeSocket::addConnection" << m_name << "to" << other->name() << "Parent:" << m_parentNode->name();
             m_parentNode->setDirty(true);
             m_parentNode->notifyStructureChanged();
         }
@@ -40,7 +53,7 @@ void NodeSocket::addConnection(NodeSocket* other) {
 void NodeSocket::removeConnection(NodeSocket* other) {
     m_connections.removeAll(other);
     if (m_parentNode) {
-        qDebug() << "NodeSocket::removeConnection" << m_name << "from" << other->name() << "Parent:" << m_parentNode->name();
+        traceDebug(Trace::Graph) << "NodeSocket::removeConnection" << m_name << "from" << other->name() << "Parent:" << m_parentNode->name();
         m_parentNode->setDirty(true);
         m_parentNode->notifyStructureChanged();
     }
@@ -185,14 +198,55 @@ QVariant NodeSocket::getValue(const QVector3D& pos) const {
     return m_value;
 }
 
+bool NodeSocket::getDual(const QVector3D& pos, DualVec& out) const {
+    if (m_direction == SocketDirection::Input && !m_connections.isEmpty()) {
+        NodeSocket* sourceSocket = m_connections[0];
+        if (!sourceSocket || !sourceSocket->parentNode()) return false;
+        
+        Node* sourceNode = sourceSocket->parentNode();
+        if (sourceNode->isMuted()) return false;
+        if (!sourceNode->computeDual(pos, sourceSocket, out)) return false;
+        
+        // Type conversion (same rules as getValue)
+        if (sourceSocket->type() == m_type) return true;
+        
+        // Float -> Vector (already broadcast)
+        if (sourceSocket->type() == SocketType::Float && m_type == SocketType::Vector) {
+            out = DualVec::scalar(out.x);
+            return true;
+        }
+        
+        // Vector -> Float (Average)
+        if (sourceSocket->type() == SocketType::Vector && m_type == SocketType::Float) {
+            out = DualVec::scalar((out.x + out.y + out.z) * (1.0 / 3.0));
+            return true;
+        }
+        
+        // Colors are not differentiated
+        return false;
+    }
+    
+    // 接続がない場合は定数（微分は0）
+    QVariant val = m_value.isValid() ? m_value : m_defaultValue;
+    if (m_type == SocketType::Float || m_type == SocketType::Integer) {
+        out = DualVec::scalar(Dual(val.toDouble()));
+        return true;
+    }
+    if (m_type == SocketType::Vector) {
+        out = DualVec(val.value<QVector3D>());
+        return true;
+    }
+    return false;
+}
+
 // NodeConnection implementation
-NodeConnection::NodeConnection(NodeSocket* from, NodeSocket* to)
+NodeConnection::NodeConnection(NodeSocket* from, NodeSocket* to, bool notify)
     : m_from(from)
     , m_to(to)
 {
     if (from && to) {
-        from->addConnection(to);
-        to->addConnection(from);
+        from->addConnection(to, notify);
+        to->addConnection(from, notify);
     }
 }
 
@@ -201,42 +255,19 @@ bool NodeConnection::isValid() const {
 }
 
 bool NodeConnection::isValid(NodeSocket* from, NodeSocket* to) {
-    if (!from || !to) return false;
-    if (from->direction() != SocketDirection::Output) return false;
-    if (to->direction() != SocketDirection::Input) return false;
+    if (!isCompatible(from, to)) return false;
     
     // Check for cycles
-    // We are connecting Output (from) -> Input (to)
-    // Check if to's node is an ancestor of from's node
-    Node* sourceNode = from->parentNode();
-    Node* targetNode = to->parentNode();
-    
-    if (sourceNode == targetNode) return false; // Self connection
-    
-    // BFS to check if targetNode is reachable from sourceNode's inputs (upstream)
-    // Wait, connection is Source -> Target.
+    // We are connecting Output (from) -> Input (to).
     // Cycle exists if there is a path Target -> ... -> Source.
-    // So we need to check if Source is reachable from Target's outputs.
-    
-    QList<Node*> queue;
-    QSet<Node*> visited;
-    queue.append(targetNode);
-    visited.insert(targetNode);
-    
-    while (!queue.isEmpty()) {
-        Node* current = queue.takeFirst();
-        if (current == sourceNode) return false; // Cycle detected
-        
-        for (NodeSocket* output : current->outputSockets()) {
-            for (NodeSocket* input : output->connections()) {
-                Node* nextNode = input->parentNode();
-                if (nextNode && !visited.contains(nextNode)) {
-                    visited.insert(nextNode);
-                    queue.append(nextNode);
-                }
-            }
-        }
-    }
+    return !Node::reaches(to->parentNode(), from->parentNode());
+}
+
+bool NodeConnection::isCompatible(NodeSocket* from, NodeSocket* to) {
+    if (!from || !to) return false;
+    if (from->direction() != SocketDirection::Output) return false;
+    if (to->direction() != SocketDirection::Input) return false;
+    if (from->parentNode() == to->parentNode()) return false; // Self connection
 
     // Allow implicit conversions
     // Float -> Vector/Color
@@ -256,14 +287,22 @@ bool NodeConnection::isValid(NodeSocket* from, NodeSocket* to) {
 }
 
 // Node implementation
+namespace {
+// 新しいノードは最下流: 接続がないので順序は常に正しい
+qint64 s_nextTopoOrder = 0;
+quint64 s_topoVisit = 0;
+}
+
 Node::Node(const QString& name)
     : m_name(name)
     , m_position(0, 0)
     , m_dirty(true)
+    , m_topoOrder(s_nextTopoOrder++)
 {
 }
 
 Node::~Node() {
+    GraphTransaction::forget(this);
     // ソケットのクリーンアップ
     qDeleteAll(m_inputSockets);
     qDeleteAll(m_outputSockets);
@@ -278,7 +317,6 @@ void Node::addOutputSocket(NodeSocket* socket) {
 }
 
 NodeSocket* Node::findInputSocket(const QString& name) const {
-    qDebug() << "Node::findInputSocket" << m_name << name << "this:" << this << "sockets:" << m_inputSockets.size();
     for (NodeSocket* socket : m_inputSockets) {
         if (socket->name() == name) {
             return socket;
@@ -297,36 +335,215 @@ NodeSocket* Node::findOutputSocket(const QString& name) const {
 }
 
 void Node::setDirty(bool dirty) {
-    bool stateChanged = (m_dirty != dirty);
-    m_dirty = dirty;
-    
-    if (dirty) {
-        // Debug: trace excessive setDirty calls
-        static int callCount = 0;
-        static QString lastName;
-        callCount++;
-        if (callCount > 10 && m_name == lastName) {
-            qDebug() << "WARNING: Excessive setDirty calls for:" << m_name << "Count:" << callCount;
+    if (!dirty) {
+        m_dirty = false;
+        return;
+    }
+    
+    if (GraphTransaction::isOpen()) {
+        GraphTransaction::recordDirty(this);
+        return;
+    }
+    invalidateDownstream({this});
+}
+
+void Node::invalidateDownstream(const QVector<Node*>& roots) {
+    // Downstream nodes are always revisited, even if already dirty: they
+    // might have been cleaned (rendered) while this node remained dirty.
+    // The generation stamp makes it one visit per node per edit.
+    static quint64 generation = 0;
+    const quint64 current = ++generation;
+    
+    QVector<Node*> stack = roots;
+    QVector<Node*> visited;
+    while (!stack.isEmpty()) {
+        Node* node = stack.takeLast();
+        if (node->m_dirtyGeneration == current) continue;
+        node->m_dirtyGeneration = current;
+        node->invalidate();
+        visited.append(node);
+        
+        for (NodeSocket* output : std::as_const(node->m_outputSockets)) {
+            for (NodeSocket* input : output->connections()) {
+                Node* next = input ? input->parentNode() : nullptr;
+                if (next && next->m_dirtyGeneration != current) {
+                    stack.append(next);
+                }
+            }
         }
-        if (m_name != lastName) {
-            callCount = 1;
-            lastName = m_name;
+    }
+    
+    // Always notify UI when marking dirty (even if already dirty)
+    // This ensures repeated changes trigger UI updates. Done after the walk
+    // so callbacks see the whole graph invalidated.
+    for (Node* node : std::as_const(visited)) {
+        node->notifyDirty();
+    }
+}
+
+void Node::notifyStructureChanged() {
+    if (GraphTransaction::isOpen()) {
+        GraphTransaction::recordStructureChange(this);
+        return;
+    }
+    if (m_structureChangedCallback) m_structureChangedCallback();
+}
+
+void Node::invalidate() {
+    m_dirty = true;
+    m_contentKeyValid = false;
+    // Buffered upstream samples are stale
+    std::atomic_store(&m_stencilBuffer, std::shared_ptr<const StencilBuffer>());
+}
+
+bool Node::reaches(Node* from, Node* to) {
+    if (from == to) return true;
+    // Ranks only increase along connections, so nothing ranked above 'to'
+    // can lead to it
+    const qint64 bound = to->m_topoOrder;
+    if (from->m_topoOrder > bound) return false;
+    
+    const quint64 visit = ++s_topoVisit;
+    QVector<Node*> stack{from};
+    from->m_topoVisit = visit;
+    while (!stack.isEmpty()) {
+        Node* node = stack.takeLast();
+        for (NodeSocket* output : std::as_const(node->m_outputSockets)) {
+            for (NodeSocket* input : output->connections()) {
+                Node* next = input->parentNode();
+                if (!next || next->m_topoVisit == visit || next->m_topoOrder > bound) continue;
+                if (next == to) return true;
+                next->m_topoVisit = visit;
+                stack.append(next);
+            }
         }
-        
-        // Always notify UI when marking dirty (even if already dirty)
-        // This ensures repeated changes trigger UI updates
-        notifyDirty();
-        
-        // Always propagate to downstream nodes, even if state didn't change.
-        // Downstream nodes might have been cleaned (rendered) while this node remained dirty.
-        for (NodeSocket* output : m_outputSockets) {
+    }
+    return false;
+}
+
+void Node::orderConnection(Node* from, Node* to) {
+    if (!from || !to || from->m_topoOrder < to->m_topoOrder) return;
+    
+    // Pearce–Kelly: only nodes ranked between the two ends can be out of
+    // order. Collect those downstream of 'to' (deltaF) and upstream of
+    // 'from' (deltaB), then hand their ranks back out with deltaB first.
+    const qint64 lower = to->m_topoOrder;
+    const qint64 upper = from->m_topoOrder;
+    const quint64 visit = ++s_topoVisit;
+    
+    QVector<Node*> deltaF{to};
+    to->m_topoVisit = visit;
+    for (int i = 0; i < deltaF.size(); ++i) {
+        for (NodeSocket* output : std::as_const(deltaF[i]->m_outputSockets)) {
             for (NodeSocket* input : output->connections()) {
-                if (input && input->parentNode()) {
-                    input->parentNode()->setDirty(true);
+                Node* next = input->parentNode();
+                if (!next || next->m_topoVisit == visit || next->m_topoOrder > upper) continue;
+                if (next == from) {
+                    // 循環: 呼び出し側で isValid を確認していない接続
+                    qWarning() << "Node::orderConnection: connection closes a cycle:" << from->name() << "->" << to->name();
+                    return;
                 }
+                next->m_topoVisit = visit;
+                deltaF.append(next);
+            }
+        }
+    }
+    
+    QVector<Node*> deltaB{from};
+    from->m_topoVisit = visit;
+    for (int i = 0; i < deltaB.size(); ++i) {
+        for (NodeSocket* input : std::as_const(deltaB[i]->m_inputSockets)) {
+            for (NodeSocket* output : input->connections()) {
+                Node* prev = output->parentNode();
+                if (!prev || prev->m_topoVisit == visit || prev->m_topoOrder < lower) continue;
+                prev->m_topoVisit = visit;
+                deltaB.append(prev);
             }
         }
     }
+    
+    auto byOrder = [](const Node* a, const Node* b) { return a->m_topoOrder < b->m_topoOrder; };
+    std::sort(deltaB.begin(), deltaB.end(), byOrder);
+    std::sort(deltaF.begin(), deltaF.end(), byOrder);
+    
+    QVector<qint64> ranks;
+    ranks.reserve(deltaB.size() + deltaF.size());
+    for (const Node* node : std::as_const(deltaB)) ranks.append(node->m_topoOrder);
+    for (const Node* node : std::as_const(deltaF)) ranks.append(node->m_topoOrder);
+    std::sort(ranks.begin(), ranks.end());
+    
+    int next = 0;
+    for (Node* node : std::as_const(deltaB)) node->m_topoOrder = ranks[next++];
+    for (Node* node : std::as_const(deltaF)) node->m_topoOrder = ranks[next++];
+}
+
+void Node::sortTopologically(QVector<Node*>& nodes) {
+    std::sort(nodes.begin(), nodes.end(), [](const Node* a, const Node* b) {
+        return a->m_topoOrder < b->m_topoOrder;
+    });
+}
+
+quint64 Node::contentKey(Node* node, QHash<Node*, quint64>& keys) {
+    if (node->m_contentKeyValid) return node->m_contentKey;
+    auto it = keys.constFind(node);
+    if (it != keys.constEnd()) return it.value();
+    keys.insert(node, 0); // 循環の保険
+    
+    QJsonObject json = node->save();
+    json.remove("x");
+    json.remove("y");
+    
+    QCryptographicHash hash(QCryptographicHash::Sha1);
+    hash.addData(QJsonDocument(json).toJson(QJsonDocument::Compact));
+    for (NodeSocket* input : node->inputSockets()) {
+        for (NodeSocket* from : input->connections()) {
+            const quint64 upstream = qToLittleEndian(contentKey(from->parentNode(), keys));
+            hash.addData(input->name().toUtf8());
+            hash.addData(from->name().toUtf8());
+            hash.addData(QByteArray::fromRawData(reinterpret_cast<const char*>(&upstream), sizeof(upstream)));
+        }
+    }
+    
+    const quint64 key = qFromLittleEndian<quint64>(hash.result().constData());
+    keys.insert(node, key);
+    node->m_contentKey = key;
+    node->m_contentKeyValid = true;
+    return key;
+}
+
+void Node::prepareRender(int width, int height) {
+    const int radius = stencilRadius();
+    NodeSocket* input = stencilInput();
+    if (radius <= 0 || !input || !input->isConnected()) {
+        std::atomic_store(&m_stencilBuffer, std::shared_ptr<const StencilBuffer>());
+        return;
+    }
+    
+    auto buffer = std::atomic_load(&m_stencilBuffer);
+    if (buffer && buffer->width() == width && buffer->height() == height && buffer->radius() == radius) {
+        return;
+    }
+    std::atomic_store(&m_stencilBuffer, StencilBuffer::build(input, width, height, radius));
+}
+
+bool Node::isPrepared(int width, int height) const {
+    const int radius = stencilRadius();
+    NodeSocket* input = stencilInput();
+    if (radius <= 0 || !input || !input->isConnected()) return true;
+
+    auto buffer = std::atomic_load(&m_stencilBuffer);
+    return buffer && buffer->width() == width && buffer->height() == height && buffer->radius() == radius;
+}
+
+double Node::stencilSample(const QVector3D& pos) const {
+    auto buffer = std::atomic_load(&m_stencilBuffer);
+    double value;
+    if (buffer && buffer->fetch(pos, value)) {
+        return value;
+    }
+    NodeSocket* input = stencilInput();
+    if (!input) return 0.0;
+    return StencilBuffer::toScalar(input->getValue(pos));
 }
 
 QVariant Node::compute(const QVector3D& pos, NodeSocket* socket) {
@@ -351,12 +568,13 @@ QJsonObject Node::save() const {
     json["inputs"] = inputsArray;
     
     // Save Parameters (Settings)
+    // 共有定義があればアクセサで値だけ読む（クロージャを作らない）
+    const QVector<ParameterInfo> params = parameterSchema().isEmpty() ? parameters() : parameterSchema();
     QJsonObject paramsJson;
-    for (const auto& param : parameters()) {
+    for (const auto& param : params) {
         // Save using the parameter name as key
         // Note: This assumes parameters have unique names
-        // defaultValue in ParameterInfo MUST contain the CURRENT value for this to work
-        paramsJson[param.name] = QJsonValue::fromVariant(param.defaultValue);
+        paramsJson[param.name] = QJsonValue::fromVariant(parameterValue(param));
     }
     json["parameters"] = paramsJson;
     
@@ -381,19 +599,53 @@ void Node::restore(const QJsonObject& json) {
     // Restore Parameters
     if (json.contains("parameters")) {
         QJsonObject paramsJson = json["parameters"].toObject();
-        QVector<ParameterInfo> params = parameters();
+        const QVector<ParameterInfo> params = parameterSchema().isEmpty() ? parameters() : parameterSchema();
         
         for (const auto& param : params) {
             if (paramsJson.contains(param.name)) {
-                QJsonValue val = paramsJson[param.name];
-                if (param.setter) {
-                    param.setter(val.toVariant());
-                }
+                setParameterValue(param, paramsJson[param.name].toVariant());
             }
         }
     }
 }
 
+QVector<Node::ParameterInfo> Node::parameters() const {
+    QVector<ParameterInfo> params = parameterSchema();
+    Node* self = const_cast<Node*>(this);
+    for (ParameterInfo& param : params) {
+        param.defaultValue = parameterValue(param);
+        if (param.set) {
+            param.setter = self->parameterSetter(param);
+        }
+    }
+    return params;
+}
+
+const QVector<Node::ParameterInfo>& Node::parameterSchema() const {
+    if (!m_parameterSchema) {
+        m_parameterSchema = std::make_shared<const QVector<ParameterInfo>>(describeParameters());
+    }
+    return *m_parameterSchema;
+}
+
+QVariant Node::parameterValue(const ParameterInfo& param) const {
+    return param.get ? param.get(this) : param.defaultValue;
+}
+
+void Node::setParameterValue(const ParameterInfo& param, const QVariant& value) {
+    if (param.set) {
+        param.set(this, value);
+    } else if (param.setter) {
+        param.setter(value);
+    }
+}
+
+std::function<void(const QVariant&)> Node::parameterSetter(const ParameterInfo& param) {
+    if (!param.set) return param.setter;
+    auto set = param.set;
+    return [this, set](const QVariant& v) { set(this, v); };
+}
+
 // NodeSocket Serialization
 QJsonObject NodeSocket::save() const {
     QJsonObject json;
@@ -450,3 +702,47 @@ void NodeSocket::restore(const QJsonObject& json) {
         );
     }
 }
+
+// GraphTransaction implementation
+namespace {
+int s_transactionDepth = 0;
+QSet<Node*> s_pendingDirty;
+QSet<Node*> s_pendingStructure;
+}
+
+void GraphTransaction::begin() {
+    ++s_transactionDepth;
+}
+
+bool GraphTransaction::isOpen() {
+    return s_transactionDepth > 0;
+}
+
+void GraphTransaction::recordDirty(Node* node) {
+    s_pendingDirty.insert(node);
+}
+
+void GraphTransaction::recordStructureChange(Node* node) {
+    s_pendingStructure.insert(node);
+}
+
+void GraphTransaction::forget(Node* node) {
+    if (s_transactionDepth == 0) return;
+    s_pendingDirty.remove(node);
+    s_pendingStructure.remove(node);
+}
+
+void GraphTransaction::commit() {
+    Q_ASSERT(s_transactionDepth > 0);
+    if (s_transactionDepth <= 0 || --s_transactionDepth > 0) return;
+    
+    // Callbacks may start a new edit, so take the lists first
+    const QSet<Node*> dirty = std::exchange(s_pendingDirty, {});
+    const QSet<Node*> structure = std::exchange(s_pendingStructure, {});
+    if (!dirty.isEmpty()) {
+        Node::invalidateDownstream(QVector<Node*>(dirty.cbegin(), dirty.cend()));
+    }
+    for (Node* node : structure) {
+        node->notifyStructureChanged();
+    }
+}
@@ -4,6 +4,7 @@
 #include <QString>
 #include <QVariant>
 #include <QVector>
+#include <QHash>
 #include <QVector3D>
 #include <QColor>
 #include <QPointF>
@@ -13,6 +14,8 @@
 
 class Node;
 class QPainter;
+class StencilBuffer;
+struct DualVec;
 
 // ソケットの型
 enum class SocketType {
@@ -43,11 +46,15 @@ public:
     // 値の取得/設定
     QVariant value() const;
     QVariant getValue(const QVector3D& pos) const; // 座標ベースの値取得
+    // 値 + ピクセル座標に対する偏微分 (Float は x/y/z に同じ値)
+    // Returns false when some upstream node has no analytic derivative rule
+    bool getDual(const QVector3D& pos, DualVec& out) const;
     void setValue(const QVariant& value) { m_value = value; }
     void setType(SocketType type) { m_type = type; }
     
     // 接続管理
-    void addConnection(NodeSocket* other);
+    // notify = false: 一括読み込み用（dirty / 構造変更の通知をしない）
+    void addConnection(NodeSocket* other, bool notify = true);
     void removeConnection(NodeSocket* other);
     QVector<NodeSocket*> connections() const { return m_connections; }
     bool isConnected() const { return !m_connections.isEmpty(); }
@@ -82,13 +89,17 @@ private:
 // ノード接続
 class NodeConnection {
 public:
-    NodeConnection(NodeSocket* from, NodeSocket* to);
+    // notify = false wires the sockets without dirty / structure-changed
+    // callbacks; used by bulk loading, which notifies once at the end
+    NodeConnection(NodeSocket* from, NodeSocket* to, bool notify = true);
     
     NodeSocket* from() const { return m_from; }
     NodeSocket* to() const { return m_to; }
     
     bool isValid() const;
     static bool isValid(NodeSocket* from, NodeSocket* to);
+    // 向き・自己接続・型のみの検査（循環は調べない）
+    static bool isCompatible(NodeSocket* from, NodeSocket* to);
 
 private:
     NodeSocket* m_from;
@@ -124,13 +135,38 @@ public:
     // 座標ベースの計算 - デフォルトはevaluateの結果を返す
     virtual QVariant compute(const QVector3D& pos, NodeSocket* socket);
     
+    // Forward-mode differentiation - value plus d/dx, d/dy (render pixels) of
+    // an output socket. Nodes without an analytic rule return false and
+    // callers fall back to finite differences.
+    virtual bool computeDual(const QVector3D& pos, NodeSocket* socket, DualVec& out) {
+        Q_UNUSED(pos); Q_UNUSED(socket); Q_UNUSED(out);
+        return false;
+    }
+    
+    // Render-level pass - called once per render (upstream nodes first) before
+    // any compute(). Nodes needing whole-image data build it here.
+    // The default builds the stencil buffer when stencilRadius() > 0.
+    virtual void prepareRender(int width, int height);
+    // Whether the whole-image part of prepareRender(width, height) is already
+    // built, so running the pass again costs little
+    virtual bool isPrepared(int width, int height) const;
+    
+    // Stencil evaluation - nodes reading neighbouring pixels of one input
+    // declare the footprint radius (pixels, 0 = none) and that input.
+    virtual int stencilRadius() const { return 0; }
+    virtual NodeSocket* stencilInput() const { return nullptr; }
+    
     // ダーティフラグ - 再計算が必要かどうか
+    // setDirty(true) marks this node and everything downstream in a single
+    // traversal (each node once, even through diamonds), then sends the UI
+    // dirty notifications.
     bool isDirty() const { return m_dirty; }
-    virtual void setDirty(bool dirty);
+    void setDirty(bool dirty);
 
     // Structure Change Callback
     void setStructureChangedCallback(std::function<void()> callback) { m_structureChangedCallback = callback; }
-    void notifyStructureChanged() { if (m_structureChangedCallback) m_structureChangedCallback(); }
+    // Deferred to the commit while a GraphTransaction is open
+    void notifyStructureChanged();
 
     // Dirty Callback (for UI update)
     void setDirtyCallback(std::function<void()> callback) { m_dirtyCallback = callback; }
@@ -140,6 +176,36 @@ public:
     virtual QJsonObject save() const;
     virtual void restore(const QJsonObject& json);
 
+    // Baked caches - expensive generator state (maps, volumes, point sets)
+    // stored next to the graph by the binary scene format. Restoring is only
+    // attempted when the node and everything upstream are unchanged, so the
+    // payload can be adopted as-is. Empty / false = nothing to bake.
+    virtual QByteArray saveBakedCache() const { return QByteArray(); }
+    virtual bool restoreBakedCache(const uchar* data, qint64 size) { Q_UNUSED(data); Q_UNUSED(size); return false; }
+
+    // Hash of the node's saved state (position excluded) and of everything
+    // upstream. Equal keys mean equal output, except that external files
+    // referenced by nodes are keyed by path only. The result is kept on the
+    // node until it is invalidated; 'keys' guards against cycles.
+    static quint64 contentKey(Node* node, QHash<Node*, quint64>& keys);
+
+    // 出力がまだ暫定か（画像のデコード待ちなど）。false の間の結果は
+    // contentKey で キャッシュしてはいけない
+    virtual bool isContentReady() const { return true; }
+
+    // トポロジカル順序 (Pearce–Kelly)
+    // Every node carries a rank such that for each connection
+    // upstream < downstream. It is repaired locally whenever a connection is
+    // added, so cycle checks only search the nodes ranked between the two
+    // ends, and sorting by rank gives a valid evaluation order.
+    qint64 topologicalOrder() const { return m_topoOrder; }
+    // 'to' が 'from' の下流にあるか（同じノードも true）
+    static bool reaches(Node* from, Node* to);
+    // 上流から順に並べ替える
+    static void sortTopologically(QVector<Node*>& nodes);
+    // 接続 from -> to が追加された（NodeSocket から呼ばれる）
+    static void orderConnection(Node* from, Node* to);
+
     // Parameter definition for UI generation
     // Parameter definition for UI generation
     struct ParameterInfo {
@@ -154,6 +220,13 @@ public:
         QStringList enumNames;  // For Enum
         QStringList options;    // For Combo (Alias for enumNames mostly, but distinct for clarity)
         std::function<void(const QVariant&)> setter; // Callback for value change
+
+        // 型付きアクセサ（describeParameters 用）
+        // They take the node instead of capturing 'this', so one descriptor
+        // list can be shared by every instance of a node type. 'get' returns
+        // the current value (defaultValue is then only the type's default).
+        std::function<QVariant(const Node*)> get;
+        std::function<void(Node*, const QVariant&)> set;
         
         // Constructor for convenience (Float)
         ParameterInfo() : type(Float), min(0), max(0), defaultValue(0), step(0.1) {}
@@ -200,26 +273,100 @@ public:
             max = opts.size() - 1;
             return *this;
         }
+
+        // get/set を N 型のノードに対する関数で設定する
+        template <typename N, typename Get>
+        ParameterInfo& bind(Get getValue) {
+            get = [getValue](const Node* node) { return QVariant::fromValue(getValue(*static_cast<const N*>(node))); };
+            return *this;
+        }
+        template <typename N, typename Get, typename Set>
+        ParameterInfo& bind(Get getValue, Set setValue) {
+            bind<N>(getValue);
+            set = [setValue](Node* node, const QVariant& v) { setValue(*static_cast<N*>(node), v); };
+            return *this;
+        }
     };
 
-    // Override this to define parameters for automatic UI generation
-    virtual QVector<ParameterInfo> parameters() const { return QVector<ParameterInfo>(); }
+    // Parameters with their current values and setters bound to this node.
+    // Nodes whose parameter list depends on their state override this;
+    // the default binds parameterSchema().
+    virtual QVector<ParameterInfo> parameters() const;
+
+    // 型ごとに共有されるパラメータ定義（空 = parameters() を使う）
+    // Built once per type by NodeRegistry (or once per instance for nodes
+    // created directly). Read values with parameterValue() and write them
+    // with setParameterValue()/parameterSetter() instead of building a
+    // fresh closure list.
+    const QVector<ParameterInfo>& parameterSchema() const;
+    QVariant parameterValue(const ParameterInfo& param) const;
+    void setParameterValue(const ParameterInfo& param, const QVariant& value);
+    std::function<void(const QVariant&)> parameterSetter(const ParameterInfo& param);
 
     // Muted (bypass) state
     bool isMuted() const { return m_muted; }
     void setMuted(bool muted) { m_muted = muted; setDirty(true); }
 
 protected:
+    // setDirty(true) からノードごとに1回呼ばれる: 派生クラスはキャッシュを破棄して
+    // Node::invalidate() を呼ぶ。下流への伝播は setDirty が行う。
+    virtual void invalidate();
+    // roots とその下流を1回ずつ無効化し、dirty コールバックを送る
+    static void invalidateDownstream(const QVector<Node*>& roots);
+    friend class GraphTransaction;
 
+    // 状態に依存しないパラメータ定義を返す（アクセサは ParameterInfo::bind で設定）
+    // Called once per type on a freshly created node; the result must not
+    // depend on the instance.
+    virtual QVector<ParameterInfo> describeParameters() const { return QVector<ParameterInfo>(); }
+    friend class NodeRegistry;
+
+    // Stencil input value at pos - read from the render's stencil buffer when
+    // covered, otherwise evaluated upstream
+    double stencilSample(const QVector3D& pos) const;
 
     QString m_name;
     QPointF m_position;
     QVector<NodeSocket*> m_inputSockets;
     QVector<NodeSocket*> m_outputSockets;
     bool m_dirty;
+    quint64 m_dirtyGeneration = 0;  // 最後に訪問された setDirty の世代
+    qint64 m_topoOrder;
+    quint64 m_topoVisit = 0;        // 順序の探索用の訪問印
     bool m_muted = false;
+    quint64 m_contentKey = 0;           // contentKey() のメモ（invalidate で破棄）
+    bool m_contentKeyValid = false;
     std::function<void()> m_structureChangedCallback;
     std::function<void()> m_dirtyCallback;
+    std::shared_ptr<const StencilBuffer> m_stencilBuffer;
+    mutable std::shared_ptr<const QVector<ParameterInfo>> m_parameterSchema;
+};
+
+// グラフ編集のトランザクション
+// While one is open, setDirty(true) and structure-change notifications are
+// only recorded. The outermost commit invalidates everything downstream of
+// the recorded nodes in a single pass (each node once) and then sends each
+// node's dirty and structure callbacks once, so a compound edit costs one
+// invalidation and one UI refresh. GUI thread only.
+class GraphTransaction {
+public:
+    static void begin();
+    static void commit();
+    static bool isOpen();
+
+    class Scope {
+    public:
+        Scope() { begin(); }
+        ~Scope() { commit(); }
+        Scope(const Scope&) = delete;
+        Scope& operator=(const Scope&) = delete;
+    };
+
+private:
+    friend class Node;
+    static void recordDirty(Node* node);
+    static void recordStructureChange(Node* node);
+    static void forget(Node* node);  // ノードの破棄
 };
 
 #endif // NODE_H
@@ -12,6 +12,8 @@
 #include "noderegistry.h"
 #include "commands.h"
 #include "imagetexturenode.h"
+#include "scenefile.h"
+#include "trace.h"
 #include <QPainter>
 #include <QGraphicsSceneMouseEvent>
 #include <QKeyEvent>
@@ -38,6 +40,8 @@
 #include <QFile>
 #include <QFileInfo>
 #include <QDir>
+#include <QDebug>
+#include <QSet>
 #include <QMimeData>
 #include <QUrl>
 #include <QDragEnterEvent>
@@ -68,6 +72,8 @@ NodeEditorWidget::~NodeEditorWidget() {
 
 void NodeEditorWidget::setupScene() {
     // シーンの設定
+    // 表示範囲の絞り込みはシーンの BSP インデックスに任せる
+    m_scene->setItemIndexMethod(QGraphicsScene::BspTreeIndex);
     m_scene->setSceneRect(-5000, -5000, 10000, 10000);
     setScene(m_scene);
     
@@ -95,10 +101,11 @@ void NodeEditorWidget::addNode(Node* node, const QPointF& position) {
     
     NodeGraphicsItem* item = new NodeGraphicsItem(node);
     item->setPos(position);
+    item->setDetailLevel(m_detailLevel);
     m_scene->addItem(item);
     m_nodeItems.append(item);
     
-    connect(item, &NodeGraphicsItem::parameterChanged, this, &NodeEditorWidget::parameterChanged);
+    connect(item, &NodeGraphicsItem::parameterChanged, this, &NodeEditorWidget::emitParameterChanged);
 }
 
 void NodeEditorWidget::removeNode(Node* node) {
@@ -142,6 +149,45 @@ void NodeEditorWidget::updateNodePosition(Node* node) {
     }
 }
 
+void NodeEditorWidget::beginTransaction(const QString& undoText) {
+    const bool macro = !undoText.isEmpty();
+    if (macro) m_undoStack->beginMacro(undoText);
+    m_transactions.append(macro);
+    GraphTransaction::begin();
+}
+
+void NodeEditorWidget::commitTransaction() {
+    Q_ASSERT(!m_transactions.isEmpty());
+    if (m_transactions.isEmpty()) return;
+    if (m_transactions.takeLast()) m_undoStack->endMacro();
+    GraphTransaction::commit();
+    
+    if (m_transactions.isEmpty() && m_parameterChangePending) {
+        m_parameterChangePending = false;
+        emit parameterChanged();
+    }
+}
+
+void NodeEditorWidget::emitParameterChanged() {
+    if (!m_transactions.isEmpty()) {
+        m_parameterChangePending = true;
+        return;
+    }
+    emit parameterChanged();
+}
+
+void NodeEditorWidget::undo() {
+    beginTransaction();
+    m_undoStack->undo();
+    commitTransaction();
+}
+
+void NodeEditorWidget::redo() {
+    beginTransaction();
+    m_undoStack->redo();
+    commitTransaction();
+}
+
 void NodeEditorWidget::createConnection(NodeSocket* from, NodeSocket* to) {
     if (!from || !to) return;
     
@@ -150,8 +196,9 @@ void NodeEditorWidget::createConnection(NodeSocket* from, NodeSocket* to) {
         std::swap(from, to);
     }
     
-    // Validate connection
-    if (from->direction() == to->direction()) return;
+    // Validate connection before wiring anything (the sockets are connected
+    // as soon as a NodeConnection exists)
+    if (!NodeConnection::isValid(from, to)) return;
     
     // Disconnect existing connections on input socket (input can only have one connection)
     if (to->isConnected()) {
@@ -162,43 +209,29 @@ void NodeEditorWidget::createConnection(NodeSocket* from, NodeSocket* to) {
     }
     
     NodeConnection* connection = new NodeConnection(from, to);
-    if (connection->isValid()) {
-        m_connections.append(connection);
-        
-        // Find graphics items
-        NodeGraphicsItem* fromItem = nullptr;
-        NodeGraphicsItem* toItem = nullptr;
+    m_connections.append(connection);
+    
+    // Find graphics items
+    NodeGraphicsItem* fromItem = nullptr;
+    NodeGraphicsItem* toItem = nullptr;
+    
+    for (auto item : m_nodeItems) {
+        if (item->node() == from->parentNode()) fromItem = item;
+        if (item->node() == to->parentNode()) toItem = item;
+    }
+    
+    if (fromItem && toItem) {
+        NodeGraphicsSocket* fromSocketItem = fromItem->socketItem(from);
+        NodeGraphicsSocket* toSocketItem = toItem->socketItem(to);
         
-        for (auto item : m_nodeItems) {
-            if (item->node() == from->parentNode()) fromItem = item;
-            if (item->node() == to->parentNode()) toItem = item;
+        if (fromSocketItem && toSocketItem) {
+            ConnectionGraphicsItem* item = new ConnectionGraphicsItem(fromSocketItem, toSocketItem);
+            m_scene->addItem(item);
         }
-        
-        if (fromItem && toItem) {
-            // Helper to find socket item
-            auto findSocketItem = [](NodeGraphicsItem* nodeItem, NodeSocket* s) -> NodeGraphicsSocket* {
-                for (QGraphicsItem* child : nodeItem->childItems()) {
-                    if (NodeGraphicsSocket* gs = dynamic_cast<NodeGraphicsSocket*>(child)) {
-                        if (gs->socket() == s) return gs;
-                    }
-                }
-                return nullptr;
-            };
-            
-            NodeGraphicsSocket* fromSocketItem = findSocketItem(fromItem, from);
-            NodeGraphicsSocket* toSocketItem = findSocketItem(toItem, to);
-            
-            if (fromSocketItem && toSocketItem) {
-                ConnectionGraphicsItem* item = new ConnectionGraphicsItem(fromSocketItem, toSocketItem);
-                m_scene->addItem(item);
-            }
-        }
-        
-        to->parentNode()->setDirty(true);
-        to->parentNode()->evaluate();
-    } else {
-        delete connection;
     }
+    
+    to->parentNode()->setDirty(true);
+    to->parentNode()->evaluate();
 }
 
 void NodeEditorWidget::removeConnection(NodeSocket* from, NodeSocket* to) {
@@ -274,6 +307,8 @@ void NodeEditorWidget::wheelEvent(QWheelEvent* event) {
             m_zoomFactor *= zoomOutFactor;
         }
     }
+    
+    updateDetailLevel();
 }
 
 void NodeEditorWidget::mousePressEvent(QMouseEvent* event) {
@@ -293,7 +328,7 @@ void NodeEditorWidget::mousePressEvent(QMouseEvent* event) {
     if (event->button() == Qt::LeftButton && (event->modifiers() & Qt::ShiftModifier) && 
         !(event->modifiers() & Qt::ControlModifier)) {
         NodeGraphicsSocket* socket = socketAt(event->pos());
-        qDebug() << "Shift+Click detected, socket at pos:" << (socket ? socket->socket()->name() : "null");
+        traceDebug(Trace::Editor) << "Shift+Click detected, socket at pos:" << (socket ? socket->socket()->name() : "null");
         if (socket) {
             // Clear previous highlight
             if (m_selectedSocket && m_selectedSocket != socket) {
@@ -301,7 +336,7 @@ void NodeEditorWidget::mousePressEvent(QMouseEvent* event) {
             }
             m_selectedSocket = socket;
             m_selectedSocket->setHighlighted(true);
-            qDebug() << "Selected socket:" << socket->socket()->name() << "on" << socket->socket()->parentNode()->name();
+            traceDebug(Trace::Editor) << "Selected socket:" << socket->socket()->name() << "on" << socket->socket()->parentNode()->name();
             event->accept();
             return;
         }
@@ -311,8 +346,8 @@ void NodeEditorWidget::mousePressEvent(QMouseEvent* event) {
     if (event->button() == Qt::LeftButton && (event->modifiers() & Qt::ControlModifier) && 
         !(event->modifiers() & Qt::ShiftModifier)) {
         NodeGraphicsSocket* socket = socketAt(event->pos());
-        qDebug() << "Ctrl+Click detected, socket at pos:" << (socket ? socket->socket()->name() : "null") 
-                 << "selected socket:" << (m_selectedSocket ? m_selectedSocket->socket()->name() : "null");
+        traceDebug(Trace::Editor) << "Ctrl+Click detected, socket at pos:" << (socket ? socket->socket()->name() : "null")
+                                  << "selected socket:" << (m_selectedSocket ? m_selectedSocket->socket()->name() : "null");
         if (socket && m_selectedSocket) {
             NodeSocket* socket1 = m_selectedSocket->socket();
             NodeSocket* socket2 = socket->socket();
@@ -331,13 +366,13 @@ void NodeEditorWidget::mousePressEvent(QMouseEvent* event) {
                 toSocket = socket1;
             }
             
-            qDebug() << "fromSocket:" << (fromSocket ? fromSocket->name() : "null") 
-                     << "toSocket:" << (toSocket ? toSocket->name() : "null");
+            traceDebug(Trace::Editor) << "fromSocket:" << (fromSocket ? fromSocket->name() : "null")
+                                      << "toSocket:" << (toSocket ? toSocket->name() : "null");
             
             if (fromSocket && toSocket && NodeConnection::isValid(fromSocket, toSocket)) {
                 // Disconnect existing connections on target input
                 if (toSocket->isConnected()) {
-                    qDebug() << "Disconnecting existing connections on" << toSocket->name();
+                    traceDebug(Trace::Editor) << "Disconnecting existing connections on" << toSocket->name();
                     QList<NodeSocket*> connsCopy = toSocket->connections();
                     for (NodeSocket* conn : connsCopy) {
                         removeConnection(conn, toSocket);
@@ -350,10 +385,10 @@ void NodeEditorWidget::mousePressEvent(QMouseEvent* event) {
                 m_scene->update();
                 viewport()->update();
                 
-                emit parameterChanged();
-                qDebug() << "Connected" << fromSocket->name() << "->" << toSocket->name();
+                emitParameterChanged();
+                traceDebug(Trace::Editor) << "Connected" << fromSocket->name() << "->" << toSocket->name();
             } else {
-                qDebug() << "Connection invalid or sockets don't match directions";
+                traceDebug(Trace::Editor) << "Connection invalid or sockets don't match directions";
             }
             
             // Clear highlight and selection
@@ -404,7 +439,7 @@ void NodeEditorWidget::mousePressEvent(QMouseEvent* event) {
                         }
                     }
                     createConnection(fromSocket, toSocket);
-                    emit parameterChanged();
+                    emitParameterChanged();
                 }
             }
         }
@@ -536,14 +571,9 @@ void NodeEditorWidget::mouseReleaseEvent(QMouseEvent* event) {
                 return;
             }
             
-            NodeConnection* connection = new NodeConnection(from, to);
-            if (connection->isValid()) {
-                delete connection; // We just checked validity, command will recreate
-                
+            if (NodeConnection::isValid(from, to)) {
                 // Use UndoStack
                 m_undoStack->push(new ConnectCommand(this, from, to));
-            } else {
-                delete connection;
             }
         } else if (!targetSocket) {
             // Connection dropped on empty space - show search and auto-connect
@@ -577,7 +607,7 @@ void NodeEditorWidget::mouseReleaseEvent(QMouseEvent* event) {
                             }
                         }
                     }
-                    emit parameterChanged();
+                    emitParameterChanged();
                 }
             }
         }
@@ -688,6 +718,9 @@ void NodeEditorWidget::keyPressEvent(QKeyEvent* event) {
             }
         }
 
+        // One undo step and one invalidation for the whole selection
+        beginTransaction("Delete");
+        
         // Delete connections first
         for (ConnectionGraphicsItem* conn : connections) {
             // Check if still valid (though should be if we process first)
@@ -726,6 +759,7 @@ void NodeEditorWidget::keyPressEvent(QKeyEvent* event) {
         for (auto item : m_nodeItems) {
             item->updatePreview();
         }
+        commitTransaction();
         
         event->accept();
         return;
@@ -734,6 +768,7 @@ void NodeEditorWidget::keyPressEvent(QKeyEvent* event) {
     // Ctrl+T: Add Texture Coordinate + Mapping nodes before selected texture node
     if (event->key() == Qt::Key_T && (event->modifiers() & Qt::ControlModifier)) {
         QList<QGraphicsItem*> selected = m_scene->selectedItems();
+        beginTransaction();
         for (QGraphicsItem* item : selected) {
             if (NodeGraphicsItem* nodeItem = dynamic_cast<NodeGraphicsItem*>(item)) {
                 Node* node = nodeItem->node();
@@ -762,10 +797,11 @@ void NodeEditorWidget::keyPressEvent(QKeyEvent* event) {
                     createConnection(texCoordNode->outputSockets().first(), mappingNode->inputSockets().first());
                     createConnection(mappingNode->outputSockets().first(), vectorInput);
                     
-                    emit parameterChanged();
+                    emitParameterChanged();
                 }
             }
         }
+        commitTransaction();
         event->accept();
         return;
     }
@@ -775,6 +811,7 @@ void NodeEditorWidget::keyPressEvent(QKeyEvent* event) {
         QList<QGraphicsItem*> selected = m_scene->selectedItems();
         QList<Node*> newNodes;
         QMap<Node*, Node*> nodeMapping;  // old -> new
+        beginTransaction();
         
         // First pass: create duplicates
         for (QGraphicsItem* item : selected) {
@@ -805,7 +842,8 @@ void NodeEditorWidget::keyPressEvent(QKeyEvent* event) {
             }
         }
         
-        emit parameterChanged();
+        emitParameterChanged();
+        commitTransaction();
         event->accept();
         return;
     }
@@ -820,7 +858,7 @@ void NodeEditorWidget::keyPressEvent(QKeyEvent* event) {
                 nodeItem->update();
             }
         }
-        emit parameterChanged();
+        emitParameterChanged();
         event->accept();
         return;
     }
@@ -897,7 +935,7 @@ void NodeEditorWidget::keyPressEvent(QKeyEvent* event) {
                 
                 // Create new connection
                 createConnection(fromSocket, toSocket);
-                emit parameterChanged();
+                emitParameterChanged();
             }
         }
         event->accept();
@@ -937,14 +975,14 @@ void NodeEditorWidget::keyPressEvent(QKeyEvent* event) {
                         nodeItem->update();
                         changed = true;
                     } else {
-                        qDebug() << "Failed to create default node for type:" << type;
+                        traceDebug(Trace::Editor) << "Failed to create default node for type:" << type;
                     }
                 }
             }
         }
         
         if (changed) {
-            emit parameterChanged();
+            emitParameterChanged();
         }
         event->accept();
         return;
@@ -1135,13 +1173,16 @@ void NodeEditorWidget::updateTheme() {
     update();
 }
 
-void NodeEditorWidget::saveToFile(const QString& filename) {
+QJsonObject NodeEditorWidget::graphToJson() const {
     QJsonObject root;
     
     // Save Nodes
     QJsonArray nodesArray;
+    QHash<Node*, int> nodeIndex;
+    nodeIndex.reserve(m_nodes.size());
     for (int i = 0; i < m_nodes.size(); ++i) {
         Node* node = m_nodes[i];
+        nodeIndex.insert(node, i);
         QJsonObject nodeJson = node->save();
         nodeJson["type"] = node->name(); // Use name as type identifier (assuming unique names in registry)
         nodesArray.append(nodeJson);
@@ -1154,8 +1195,8 @@ void NodeEditorWidget::saveToFile(const QString& filename) {
         QJsonObject connJson;
         
         // Find indices
-        int fromIndex = m_nodes.indexOf(conn->from()->parentNode());
-        int toIndex = m_nodes.indexOf(conn->to()->parentNode());
+        int fromIndex = nodeIndex.value(conn->from()->parentNode(), -1);
+        int toIndex = nodeIndex.value(conn->to()->parentNode(), -1);
         
         if (fromIndex != -1 && toIndex != -1) {
             connJson["fromNode"] = fromIndex;
@@ -1166,7 +1207,10 @@ void NodeEditorWidget::saveToFile(const QString& filename) {
         }
     }
     root["connections"] = connectionsArray;
-    
+    return root;
+}
+
+void NodeEditorWidget::saveToFile(const QString& filename) {
     // Ensure directory exists
     QFileInfo fileInfo(filename);
     QDir dir = fileInfo.absoluteDir();
@@ -1174,10 +1218,32 @@ void NodeEditorWidget::saveToFile(const QString& filename) {
         dir.mkpath(".");
     }
     
+    if (fileInfo.suffix().compare("nscene", Qt::CaseInsensitive) == 0) {
+        // Binary scene: graph plus whatever generator state is already built
+        QVector<SceneFile::Payload> payloads;
+        QHash<Node*, quint64> keys;
+        QSet<quint64> written;
+        for (Node* node : m_nodes) {
+            QByteArray baked = node->saveBakedCache();
+            if (baked.isEmpty()) continue;
+            const quint64 key = Node::contentKey(node, keys);
+            if (written.contains(key)) continue;
+            written.insert(key);
+            payloads.append({key, baked});
+        }
+        
+        QString error;
+        if (!SceneFile::write(filename, graphToJson(), payloads,
+                              AppSettings::instance().compressBakedCaches(), &error)) {
+            qWarning() << "Failed to save scene" << filename << error;
+        }
+        return;
+    }
+    
     // Write to file
     QFile file(filename);
     if (file.open(QIODevice::WriteOnly)) {
-        QJsonDocument doc(root);
+        QJsonDocument doc(graphToJson());
         file.write(doc.toJson());
     }
 }
@@ -1186,14 +1252,57 @@ void NodeEditorWidget::loadFromFile(const QString& filename) {
     QFile file(filename);
     if (!file.open(QIODevice::ReadOnly)) return;
     
+    if (SceneFile::isSceneFile(file.peek(4))) {
+        file.close();
+        QString error;
+        auto scene = SceneFile::open(filename, &error);
+        if (!scene) {
+            qWarning() << "Failed to load scene" << filename << error;
+            return;
+        }
+        loadFromJson(scene->graph());
+        restoreBakedCaches(*scene);
+        emitParameterChanged();
+        return;
+    }
+    
     QByteArray data = file.readAll();
     loadFromData(data);
 }
 
 void NodeEditorWidget::loadFromData(const QByteArray& data) {
-    QJsonDocument doc = QJsonDocument::fromJson(data);
-    QJsonObject root = doc.object();
+    if (SceneFile::isSceneFile(data)) {
+        QString error;
+        auto scene = SceneFile::fromData(data, &error);
+        if (!scene) {
+            qWarning() << "Failed to load scene" << error;
+            return;
+        }
+        loadFromJson(scene->graph());
+        restoreBakedCaches(*scene);
+    } else {
+        loadFromJson(QJsonDocument::fromJson(data).object());
+    }
+    
+    // Trigger update
+    emitParameterChanged();
+}
+
+void NodeEditorWidget::restoreBakedCaches(const SceneFile& scene) {
+    if (scene.payloadCount() == 0) return;
     
+    // 接続まで復元した後で計算するので、保存時と同じキーになる
+    QHash<Node*, quint64> keys;
+    for (Node* node : m_nodes) {
+        const uchar* data = nullptr;
+        qint64 size = 0;
+        if (scene.payload(Node::contentKey(node, keys), &data, &size)) {
+            node->restoreBakedCache(data, size);
+        }
+    }
+}
+
+void NodeEditorWidget::loadFromJson(const QJsonObject& root) {
     // Clear current scene
     // Note: We need to be careful about deleting items that might be in use or have signals
     // Safest way is to remove everything from scene first
@@ -1209,83 +1318,127 @@ void NodeEditorWidget::loadFromData(const QByteArray& data) {
     // Re-setup scene (grid etc)
     setupScene();
     
+    // Bulk load: build the whole model first (nodes, then connections wired
+    // without per-edge notifications), then create the graphics in one pass
+    // so every item is laid out once with its final connection state.
+    
     // Load Nodes
-    QJsonArray nodesArray = root["nodes"].toArray();
-    for (const QJsonValue& val : nodesArray) {
-        QJsonObject nodeJson = val.toObject();
-        QString type = nodeJson["type"].toString();
-        
-        Node* node = NodeRegistry::instance().createNode(type);
+    // Index = position in the file; unknown types stay nullptr so the
+    // connection indices still line up
+    const QJsonArray nodesArray = root["nodes"].toArray();
+    QVector<Node*> loaded(nodesArray.size(), nullptr);
+    for (int i = 0; i < nodesArray.size(); ++i) {
+        const QJsonObject nodeJson = nodesArray[i].toObject();
+        Node* node = NodeRegistry::instance().createNode(nodeJson["type"].toString());
         if (node) {
-            node->restore(nodeJson);
-            // Assuming node->restore() restores the position. 
-            // If not, we need to manually read x/y again, but restore usually does.
-            // Wait, the original code called `addNode(node, node->position())`.
-            // node->restore likely sets m_position.
-            // Let's verify if `restore` reads x/y. Usually yes.
-            // In original code:
-            // node->restore(nodeJson);
-            // addNode(node, node->position());
-            // So I should keep that pattern.
-            addNode(node, node->position());
-        } else {
-             // Skip unknown node types
+            node->restore(nodeJson); // restores the position as well
+            loaded[i] = node;
         }
     }
     
     // Load Connections
-    QJsonArray connectionsArray = root["connections"].toArray();
+    struct PendingConnection {
+        int fromIndex;
+        int toIndex;
+        NodeSocket* from;
+        NodeSocket* to;
+    };
+    QVector<PendingConnection> pending;
+    const QJsonArray connectionsArray = root["connections"].toArray();
+    pending.reserve(connectionsArray.size());
+    QSet<NodeSocket*> usedInputs;
     for (const QJsonValue& val : connectionsArray) {
-        QJsonObject connJson = val.toObject();
-        
-        int fromIndex = connJson["fromNode"].toInt();
-        int toIndex = connJson["toNode"].toInt();
-        QString fromSocketName = connJson["fromSocket"].toString();
-        QString toSocketName = connJson["toSocket"].toString();
+        const QJsonObject connJson = val.toObject();
+        const int fromIndex = connJson["fromNode"].toInt(-1);
+        const int toIndex = connJson["toNode"].toInt(-1);
+        if (fromIndex < 0 || fromIndex >= loaded.size() || !loaded[fromIndex] ||
+            toIndex < 0 || toIndex >= loaded.size() || !loaded[toIndex]) {
+            continue;
+        }
         
-        if (fromIndex >= 0 && fromIndex < m_nodes.size() &&
-            toIndex >= 0 && toIndex < m_nodes.size()) {
-            
-            Node* fromNode = m_nodes[fromIndex];
-            Node* toNode = m_nodes[toIndex];
-            
-            NodeSocket* fromSocket = fromNode->findOutputSocket(fromSocketName);
-            NodeSocket* toSocket = toNode->findInputSocket(toSocketName);
-            
-            if (fromSocket && toSocket) {
-                NodeConnection* connection = new NodeConnection(fromSocket, toSocket);
-                if (connection->isValid()) {
-                    m_connections.append(connection);
-                    
-                    // Visual connection
-                    NodeGraphicsItem* fromItem = m_nodeItems[fromIndex];
-                    NodeGraphicsItem* toItem = m_nodeItems[toIndex];
-                    
-                    auto findSocketItem = [](NodeGraphicsItem* nodeItem, NodeSocket* s) -> NodeGraphicsSocket* {
-                        for (QGraphicsItem* child : nodeItem->childItems()) {
-                            if (NodeGraphicsSocket* gs = dynamic_cast<NodeGraphicsSocket*>(child)) {
-                                if (gs->socket() == s) return gs;
-                            }
-                        }
-                        return nullptr;
-                    };
-                    
-                    NodeGraphicsSocket* fromSocketItem = findSocketItem(fromItem, fromSocket);
-                    NodeGraphicsSocket* toSocketItem = findSocketItem(toItem, toSocket);
-                    
-                    if (fromSocketItem && toSocketItem) {
-                        ConnectionGraphicsItem* connItem = new ConnectionGraphicsItem(fromSocketItem, toSocketItem);
-                        m_scene->addItem(connItem);
-                    }
-                } else {
-                    delete connection;
-                }
-            }
+        NodeSocket* fromSocket = loaded[fromIndex]->findOutputSocket(connJson["fromSocket"].toString());
+        NodeSocket* toSocket = loaded[toIndex]->findInputSocket(connJson["toSocket"].toString());
+        // 入力ソケットは接続1本まで
+        if (!NodeConnection::isCompatible(fromSocket, toSocket) || usedInputs.contains(toSocket)) {
+            continue;
+        }
+        usedInputs.insert(toSocket);
+        pending.append({fromIndex, toIndex, fromSocket, toSocket});
+    }
+    
+    // 循環チェックはグラフ全体で1回（Kahn 法, O(V+E)）
+    // Checking each edge with NodeConnection::isValid would walk the graph
+    // once per connection. Saved graphs are acyclic; a damaged file loses
+    // the edges between the nodes that could not be ordered.
+    QVector<int> inDegree(loaded.size(), 0);
+    QVector<QVector<int>> downstream(loaded.size());
+    for (const PendingConnection& c : std::as_const(pending)) {
+        ++inDegree[c.toIndex];
+        downstream[c.fromIndex].append(c.toIndex);
+    }
+    QVector<int> ready;
+    for (int i = 0; i < loaded.size(); ++i) {
+        if (inDegree[i] == 0) ready.append(i);
+    }
+    QVector<bool> ordered(loaded.size(), false);
+    while (!ready.isEmpty()) {
+        const int i = ready.takeLast();
+        ordered[i] = true;
+        for (int next : std::as_const(downstream[i])) {
+            if (--inDegree[next] == 0) ready.append(next);
         }
     }
     
-    // Trigger update
-    emit parameterChanged();
+    for (const PendingConnection& c : std::as_const(pending)) {
+        if (!ordered[c.fromIndex] && !ordered[c.toIndex]) {
+            qWarning() << "Skipping connection in a cycle:" << c.from->name() << "->" << c.to->name();
+            continue;
+        }
+        m_connections.append(new NodeConnection(c.from, c.to, false));
+    }
+    
+    // Graphics
+    // Without an index every addItem is O(1); the BSP tree is rebuilt
+    // once when the index method is restored.
+    m_scene->setItemIndexMethod(QGraphicsScene::NoIndex);
+    
+    QHash<Node*, NodeGraphicsItem*> itemForNode;
+    itemForNode.reserve(loaded.size());
+    for (Node* node : std::as_const(loaded)) {
+        if (!node) continue;
+        addNode(node, node->position());
+        itemForNode.insert(node, m_nodeItems.last());
+    }
+    
+    for (NodeConnection* connection : std::as_const(m_connections)) {
+        NodeGraphicsItem* fromItem = itemForNode.value(connection->from()->parentNode());
+        NodeGraphicsItem* toItem = itemForNode.value(connection->to()->parentNode());
+        NodeGraphicsSocket* fromSocketItem = fromItem ? fromItem->socketItem(connection->from()) : nullptr;
+        NodeGraphicsSocket* toSocketItem = toItem ? toItem->socketItem(connection->to()) : nullptr;
+        if (fromSocketItem && toSocketItem) {
+            m_scene->addItem(new ConnectionGraphicsItem(fromSocketItem, toSocketItem));
+        }
+    }
+    
+    m_scene->setItemIndexMethod(QGraphicsScene::BspTreeIndex);
+    
+    updateSceneRect();
+}
+
+void NodeEditorWidget::updateSceneRect() {
+    // Large generated graphs can extend past the default scene rect; the
+    // scene's BSP index only covers the scene rect, so grow it to the items.
+    const QRectF items = m_scene->itemsBoundingRect().adjusted(-2000, -2000, 2000, 2000);
+    m_scene->setSceneRect(m_scene->sceneRect().united(items));
+}
+
+void NodeEditorWidget::updateDetailLevel() {
+    const NodeGraphicsItem::DetailLevel level = NodeGraphicsItem::detailLevelForZoom(m_zoomFactor);
+    if (level == m_detailLevel) return;
+    m_detailLevel = level;
+    for (NodeGraphicsItem* item : std::as_const(m_nodeItems)) {
+        item->setDetailLevel(level);
+    }
 }
 
 void NodeEditorWidget::tryAutoConnect(Node* node) {
@@ -1345,7 +1498,7 @@ void NodeEditorWidget::tryAutoConnect(Node* node) {
             
             if (candidateInput && candidateOutput) {
                 // Perform Auto-Connect
-                m_undoStack->beginMacro("Auto-Connect");
+                beginTransaction("Auto-Connect");
                 
                 // 1. Disconnect original
                 m_undoStack->push(new DisconnectCommand(this, fromSocket, toSocket));
@@ -1356,7 +1509,7 @@ void NodeEditorWidget::tryAutoConnect(Node* node) {
                 // 3. Connect Node Output -> To
                 m_undoStack->push(new ConnectCommand(this, candidateOutput, toSocket));
                 
-                m_undoStack->endMacro();
+                commitTransaction();
                 
                 // Only do one auto-connect per drop
                 return;
@@ -1384,7 +1537,7 @@ void NodeEditorWidget::showNodeCategoryMenu(const QPoint& pos) {
                 Node* newNode = NodeRegistry::instance().createNode(nodeName);
                 if (newNode) {
                     addNode(newNode, scenePos);
-                    emit parameterChanged();
+                    emitParameterChanged();
                 }
             });
         }
@@ -1477,7 +1630,7 @@ void NodeEditorWidget::showNodeSearchMenu(const QPoint& pos) {
         Node* newNode = NodeRegistry::instance().createNode(selectedNodeName);
         if (newNode) {
             addNode(newNode, scenePos);
-            emit parameterChanged();
+            emitParameterChanged();
         }
     }
     
@@ -1630,7 +1783,7 @@ void NodeEditorWidget::addMultipleImageNodes(const QStringList& filePaths) {
     }
     
     // Emit parameter changed to update output if auto-update is on
-    emit parameterChanged();
+    emitParameterChanged();
 }
 
 void NodeEditorWidget::showBulkNodeAddDialog() {
@@ -1737,5 +1890,5 @@ void NodeEditorWidget::addBulkNodes(const QStringList& nodeNames, const QPointF&
             }
         }
     }
-    emit parameterChanged();
+    emitParameterChanged();
 }
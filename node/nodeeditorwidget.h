@@ -9,6 +9,8 @@
 #include "node.h"
 #include "nodegraphicsitem.h"
 
+class SceneFile;
+
 // ノードエディタのメインウィジェット
 class NodeEditorWidget : public QGraphicsView {
     Q_OBJECT
@@ -32,8 +34,21 @@ public:
 
     // Undo/Redo
     QUndoStack* undoStack() const { return m_undoStack; }
+    // Undo/redo as one graph transaction (a macro replays as one edit)
+    void undo();
+    void redo();
+
+    // 複合編集のトランザクション
+    // Everything between begin and commit is one undo step (a QUndoStack
+    // macro; pass an empty text for edits that are not undoable) and one
+    // graph transaction: node invalidation, UI refresh and parameterChanged
+    // happen once, at the outermost commit. Commands pushed in between run
+    // immediately, as with any macro.
+    void beginTransaction(const QString& undoText = QString());
+    void commitTransaction();
 
     // Serialization
+    // .nscene = binary scene with baked caches, anything else = JSON
     void saveToFile(const QString& filename);
     void loadFromFile(const QString& filename);
     void loadFromData(const QByteArray& data);
@@ -69,19 +84,31 @@ protected:
     void dropEvent(QDropEvent* event) override;
 
 private:
+    // トランザクション中は parameterChanged をコミットまで保留する
+    void emitParameterChanged();
     void setupScene();
+    void updateSceneRect();
+    // ズームに応じてノードの描画の詳細度を切り替える
+    void updateDetailLevel();
     void drawGrid(QPainter* painter, const QRectF& rect);
     NodeGraphicsSocket* socketAt(const QPoint& pos);
     void tryAutoConnect(Node* node);
     void showNodeSearchMenu(const QPoint& pos);
     void showNodeCategoryMenu(const QPoint& pos);
     QString showNodeSearchMenuForConnection(const QPoint& pos, NodeSocket* dragSocket);
+
+    // Serialization helpers
+    QJsonObject graphToJson() const;
+    void loadFromJson(const QJsonObject& root);
+    void restoreBakedCaches(const SceneFile& scene);
     
     QGraphicsScene* m_scene;
     QList<Node*> m_nodes;
     QList<NodeConnection*> m_connections;
     QList<NodeGraphicsItem*> m_nodeItems;
     QUndoStack* m_undoStack;
+    QVector<bool> m_transactions;      // 開いているトランザクション（true = マクロあり）
+    bool m_parameterChangePending = false;
     
     // Interaction state
     class ConnectionGraphicsItem* m_tempConnection;
@@ -90,6 +117,7 @@ private:
     bool m_spacePressed;
     QPoint m_lastPanPoint;
     qreal m_zoomFactor;
+    NodeGraphicsItem::DetailLevel m_detailLevel = NodeGraphicsItem::DetailLevel::Full;
     const qreal MIN_ZOOM = 0.1;
     const qreal MAX_ZOOM = 2.0;
 
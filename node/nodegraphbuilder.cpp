@@ -6,6 +6,7 @@
 #include "mixnode.h"
 #include "maprangenode.h"
 #include "noisetexturenode.h"
+#include "trace.h"
 #include <QDebug>
 
 NodeGraphBuilder::NodeGraphBuilder(NodeEditorWidget* editor, QObject* parent)
@@ -27,7 +28,7 @@ Node* NodeGraphBuilder::createNode(const QString& type, const QString& name, dou
 void NodeGraphBuilder::setSocketValue(const QString& nodeName, const QString& socketName, const QVariant& value) {
     if (m_nodes.contains(nodeName)) {
         Node* node = m_nodes[nodeName];
-        qDebug() << "NodeGraphBuilder::setSocketValue" << nodeName << socketName << "node:" << node;
+        traceDebug(Trace::Graph) << "NodeGraphBuilder::setSocketValue" << nodeName << socketName << "node:" << node;
         if (!node) {
             qWarning() << "Node pointer is null for" << nodeName;
             return;
@@ -62,6 +63,8 @@ void NodeGraphBuilder::connectNodes(const QString& fromNode, const QString& from
 void NodeGraphBuilder::buildDemoGraph() {
     m_nodes.clear();
     m_editor->clear(); // Assuming clear() exists or we implement it
+    // Build the whole graph as one edit: one invalidation pass at the end
+    m_editor->beginTransaction();
 
     // Replicating the Blender script
     
@@ -194,4 +197,6 @@ void NodeGraphBuilder::buildDemoGraph() {
     connectNodes("ノイズテクスチャ.001", "Fac", "カラーランプ.002", "Fac");
     connectNodes("カラーランプ.002", "Color", "プリンシプルBSDF.001", "Roughness");
     connectNodes("シェーダーミックス", "Shader", "マテリアル出力", "Surface"); // Surface is usually input 0
+    
+    m_editor->commitTransaction();
 }
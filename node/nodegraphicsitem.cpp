@@ -4,8 +4,6 @@
 #include "rivernode.h"
 #include "outputnode.h"
 #include "watersourcenode.h"
-#include "invertnode.h"
-#include "voronoinode.h"
 #include "imagetexturenode.h"
 #include "mappingnode.h"
 #include "maprangenode.h"
@@ -23,14 +21,17 @@
 #include "colorrampnode.h"
 #include "colorrampwidget.h"
 #include "watersourcerampwidget.h"
-#include "sliderspinbox.h"
+#include "parametercontrol.h"
 #include "connectiongraphicsitem.h"
 #include "appsettings.h"
+#include "previewservice.h"
+#include "trace.h"
 #include <QPushButton>
 #include <QVBoxLayout>
 #include <QHBoxLayout>
 #include <QLabel>
 #include <QGraphicsSceneMouseEvent>
+#include <QGraphicsSceneHoverEvent>
 #include <QMenu>
 #include <QAction>
 #include <QColorDialog>
@@ -80,6 +81,7 @@ NodeGraphicsItem::NodeGraphicsItem(Node* node, QGraphicsItem* parent)
     setFlag(ItemIsMovable);
     setFlag(ItemIsSelectable);
     setFlag(ItemSendsGeometryChanges);
+    setAcceptHoverEvents(true);
     
     m_titleItem = new QGraphicsTextItem(AppSettings::instance().translate(node->name()), this);
     m_titleItem->setDefaultTextColor(Qt::white);
@@ -90,6 +92,8 @@ NodeGraphicsItem::NodeGraphicsItem(Node* node, QGraphicsItem* parent)
     
     // Register callback for structure changes
     m_node->setStructureChangedCallback([this]() {
+        // Queued previews may point at sockets that are going away
+        PreviewService::instance().cancel(m_node);
         // Defer layout update to avoid deleting widgets/sockets during event handling
         QTimer::singleShot(0, this, [this]() {
             updateLayout();
@@ -98,6 +102,9 @@ NodeGraphicsItem::NodeGraphicsItem(Node* node, QGraphicsItem* parent)
 
     // Register callback for dirty/data changes
     m_node->setDirtyCallback([this]() {
+        // A preview being generated would mix old and new parameters
+        PreviewService::instance().cancel(m_node);
+        
         // Rate limiting: use a short delay to coalesce rapid changes
         // This prevents infinite loops from accumulated updates
         if (!m_updatePending) {
@@ -115,9 +122,29 @@ NodeGraphicsItem::NodeGraphicsItem(Node* node, QGraphicsItem* parent)
         updateLayout();
         update(); // For sockets
     });
+
+    // Previews
+    PreviewService& previews = PreviewService::instance();
+    connect(&previews, &PreviewService::previewReady, this, [this](NodeSocket* socket, quint64 key, const QImage& image) {
+        if (socket != previewSocket() || key != m_previewKey) return;
+        m_previewPixmap = QPixmap::fromImage(image);
+        update();
+    });
+    connect(&previews, &PreviewService::previewSkipped, this, [this](NodeSocket* socket) {
+        // 画面外に出た: 次に描画されたときに再要求する
+        if (socket == previewSocket()) m_previewStale = true;
+    });
+    connect(&previews, &PreviewService::invalidated, this, [this]() {
+        m_previewStale = true;
+        update();
+    });
 }
 
 NodeGraphicsItem::~NodeGraphicsItem() {
+    if (m_editor && m_editor->widget()) {
+        m_editor->widget()->disconnect(this);
+    }
+    
     // Disconnect all widgets to prevent callbacks during destruction (e.g. popup closed triggers setZValue)
     for (auto* proxy : m_parameterWidgets) {
         if (proxy && proxy->widget()) {
@@ -137,20 +164,21 @@ NodeGraphicsItem::~NodeGraphicsItem() {
         // Unregister callbacks to prevent use-after-free if Node outlives GraphicsItem
         m_node->setStructureChangedCallback(nullptr);
         m_node->setDirtyCallback(nullptr);
+        PreviewService::instance().cancel(m_node);
     }
 }
 
 bool NodeGraphicsItem::sceneEvent(QEvent *event) {
     if (event->type() == QEvent::GraphicsSceneMousePress) {
         QGraphicsSceneMouseEvent *me = static_cast<QGraphicsSceneMouseEvent*>(event);
-        qDebug() << "NodeGraphicsItem::sceneEvent MousePress at" << me->pos() << "ScenePos:" << me->scenePos();
+        traceDebug(Trace::Editor) << "NodeGraphicsItem::sceneEvent MousePress at" << me->pos() << "ScenePos:" << me->scenePos();
         
         // Check if we hit a proxy widget
         for (auto proxy : m_parameterWidgets) {
             if (proxy->geometry().contains(me->pos())) {
-                qDebug() << "  -> Hit proxy widget!" << proxy->widget()->metaObject()->className();
-                qDebug() << "     Proxy Z:" << proxy->zValue() << "Item Z:" << zValue();
-                qDebug() << "     Proxy Visible:" << proxy->isVisible() << "Enabled:" << proxy->isEnabled();
+                traceDebug(Trace::Editor) << "  -> Hit proxy widget!" << proxy->widget()->metaObject()->className();
+                traceDebug(Trace::Editor) << "     Proxy Z:" << proxy->zValue() << "Item Z:" << zValue();
+                traceDebug(Trace::Editor) << "     Proxy Visible:" << proxy->isVisible() << "Enabled:" << proxy->isEnabled();
             }
         }
     }
@@ -192,11 +220,18 @@ void NodeGraphicsItem::paint(QPainter* painter, const QStyleOptionGraphicsItem*
     QBrush brushBackground(bgColor);
     QBrush brushTitle(titleColor);
     
-    // ノードの背景
     QRectF rect = boundingRect();
-    QPainterPath path;
-    path.addRoundedRect(rect, 5, 5);
     
+    // 縮小表示: 角丸やプレビューを省いた箱だけ
+    if (m_detailLevel == DetailLevel::Minimal) {
+        painter->setRenderHint(QPainter::Antialiasing, false);
+        painter->setPen(isSelected() ? PEN_SELECTED : Qt::NoPen);
+        painter->setBrush(brushTitle);
+        painter->drawRect(rect);
+        return;
+    }
+    
+    // ノードの背景
     // 選択状態で色を変える
     if (isSelected()) {
         painter->setPen(PEN_SELECTED);
@@ -205,27 +240,39 @@ void NodeGraphicsItem::paint(QPainter* painter, const QStyleOptionGraphicsItem*
     }
     
     painter->setBrush(brushBackground);
-    painter->drawPath(path);
+    painter->drawPath(m_bodyPath);
     
     // タイトルバー
-    QPainterPath titlePath;
-    titlePath.addRoundedRect(QRectF(0, 0, m_width, m_titleHeight), 5, 5);
-    QPainterPath titleRect;
-    titleRect.addRect(QRectF(0, m_titleHeight / 2, m_width, m_titleHeight / 2));
-    titlePath = titlePath.united(titleRect);
-    
     painter->setBrush(brushTitle);
     painter->setPen(Qt::NoPen);
-    painter->drawPath(titlePath);
+    painter->drawPath(m_titlePath);
     
     // プレビュー描画
-    if (!m_previewPixmap.isNull()) {
+    // paint() is only called for exposed items, which makes it the place to
+    // ask for previews of on-screen nodes. Zoomed out, the cached pixmap is
+    // shown but no new previews are rendered.
+    if (m_hasPreview && m_previewStale && m_detailLevel == DetailLevel::Full) {
+        m_previewStale = false;
+        QImage cached;
+        if (PreviewService::instance().request(previewSocket(), static_cast<int>(m_previewSize),
+                                               [this]() { return isInViewport(); },
+                                               &m_previewKey, &cached)) {
+            m_previewPixmap = QPixmap::fromImage(cached);
+        }
+    }
+    if (m_hasPreview && !m_previewPixmap.isNull()) {
         qreal previewY = m_titleHeight + 10;
         painter->drawPixmap(QRectF(10, previewY, m_previewSize, m_previewSize), 
                           m_previewPixmap, 
                           m_previewPixmap.rect());
     }
     
+    // パラメータ操作部（縮小表示では枠のみ）
+    const bool detailed = m_detailLevel == DetailLevel::Full;
+    for (int i = 0; i < m_controls.size(); ++i) {
+        m_controls[i].paint(painter, i == m_hoverControl, detailed);
+    }
+    
     // Draw mute indicator (X mark)
     if (isMuted) {
         painter->setOpacity(1.0);  // Reset opacity for X
@@ -245,6 +292,11 @@ void NodeGraphicsItem::updateLayout() {
     auto oldWidgets = m_parameterWidgets;
     m_parameterWidgets.clear();
     qDeleteAll(oldWidgets);
+    closeEditor();
+    m_controls.clear();
+    m_activeControl = -1;
+    m_hoverControl = -1;
+    m_controlDragging = false;
 
     // Update Title
     m_titleItem->setPlainText(AppSettings::instance().translate(m_node->name()));
@@ -252,16 +304,14 @@ void NodeGraphicsItem::updateLayout() {
     // Set default width (wider to accommodate widgets)
     m_width = 220;
     
-    // Determine if this node type uses the standard preview
-    bool hasPreview = false;
-    if (dynamic_cast<NoiseTextureNode*>(m_node) || 
-        dynamic_cast<InvertNode*>(m_node) ||
-        dynamic_cast<VoronoiNode*>(m_node)) {
-        hasPreview = true;
+    // Every node with an output shows a preview of its first output
+    m_hasPreview = previewSocket() != nullptr;
+    if (m_hasPreview) {
+        m_previewStale = true;
     }
 
     qreal yPos = m_titleHeight + 20;
-    if (hasPreview) {
+    if (m_hasPreview) {
         yPos += m_previewSize;
     }
     
@@ -290,19 +340,17 @@ void NodeGraphicsItem::updateLayout() {
 
 
     // Generic API Parameters (Global/Options)
-    // Checks for parameters that don't match input sockets and creates widgets for them
-    QVector<Node::ParameterInfo> allParams = m_node->parameters();
-    qDebug() << "NodeGraphicsItem::updateLayout - Node:" << m_node->name() << "has" << allParams.size() << "parameters";
+    // Parameters that don't match input sockets become painted controls
+    // 型ごとの共有定義があればそのまま使う（値と変更はアクセサ経由）
+    const QVector<Node::ParameterInfo> allParams =
+        m_node->parameterSchema().isEmpty() ? m_node->parameters() : m_node->parameterSchema();
     
     for (const auto& param : allParams) {
-        qDebug() << "  Processing param:" << param.name << "type:" << param.type << "enumNames count:" << param.enumNames.size();
-        
         // Skip if this parameter controls an input socket (handled later)
         // Skip Float/Int params - they are rendered in input socket section
         // Only process Enum, Bool, File, Color here (global options)
         if (param.type == Node::ParameterInfo::Float || 
             param.type == Node::ParameterInfo::Int) {
-            qDebug() << "    SKIPPED (Float/Int - rendered in socket section)";
             continue;
         }
         
@@ -312,381 +360,86 @@ void NodeGraphicsItem::updateLayout() {
             param.type != Node::ParameterInfo::Color &&
             param.type != Node::ParameterInfo::Combo && 
             m_node->findInputSocket(param.name)) {
-            qDebug() << "    SKIPPED (socket match)";
             continue; 
         }
+        
+        ParameterControl control;
+        control.label = AppSettings::instance().translate(param.name);
+        control.tooltip = param.tooltip;
+        control.cached = m_node->parameterValue(param);
+        auto setter = m_node->parameterSetter(param);
 
         if (param.type == Node::ParameterInfo::Enum || param.type == Node::ParameterInfo::Combo) {
-            qDebug() << "    Creating Enum/Combo widget for:" << param.name << "with items:" << param.enumNames;
-            QWidget* container = new QWidget();
-            container->setFixedWidth(180);
-            QVBoxLayout* layout = new QVBoxLayout(container);
-            layout->setContentsMargins(5, 2, 5, 2);
-            layout->setSpacing(2);
-            
-            QLabel* label = new QLabel(AppSettings::instance().translate(param.name));
-            label->setStyleSheet("color: #aaaaaa; font-size: 8pt;");
-            
-            PopupAwareComboBox* combo = new PopupAwareComboBox();
-            
-            // Apply Fusion style for reliable cross-platform rendering
-            combo->setStyle(QStyleFactory::create("Fusion"));
-            
-            // Use palette for reliable dropdown colors
-            QPalette pal = combo->palette();
-            pal.setColor(QPalette::Base, QColor(0x2d, 0x2d, 0x2d));
-            pal.setColor(QPalette::Text, Qt::white);
-            pal.setColor(QPalette::Button, QColor(0x38, 0x38, 0x38));
-            pal.setColor(QPalette::ButtonText, Qt::white);
-            pal.setColor(QPalette::Highlight, QColor(0x4a, 0x90, 0xd9));
-            pal.setColor(QPalette::HighlightedText, Qt::white);
-            pal.setColor(QPalette::Window, QColor(0x2d, 0x2d, 0x2d));
-            pal.setColor(QPalette::WindowText, Qt::white);
-            combo->setPalette(pal);
-            
-            // Ensure view uses the same palette and style
-            combo->view()->setStyle(QStyleFactory::create("Fusion"));
-            combo->view()->setPalette(pal);
-            
-            // Minimal stylesheet - let Fusion handle most rendering
-            combo->setStyleSheet(
-                "QComboBox { background-color: #383838; color: white; border: 1px solid #555; border-radius: 3px; padding: 3px 5px; min-height: 18px; }"
-            );
-            
-            for (const QString& item : param.enumNames) {
-                combo->addItem(AppSettings::instance().translate(item));
-            }
-            
-            // Set current value
-            int currentIndex = param.defaultValue.toInt();
-            if (currentIndex >= 0 && currentIndex < combo->count()) {
-                combo->setCurrentIndex(currentIndex);
+            control.kind = ParameterControl::Kind::Enum;
+            // Combo の区切り線 "-" もインデックスに数える（ノード側の番号と合わせる）
+            const QStringList& names = param.enumNames.isEmpty() ? param.options : param.enumNames;
+            for (const QString& item : names) {
+                control.items.append(item == "-" ? item : AppSettings::instance().translate(item));
             }
-            
-            // Connect
-            auto setter = param.setter; // Copy std::function
-            // Use QComboBox::currentIndexChanged(int)
-            // Note: In Qt 6, void currentIndexChanged(int) is the standard signal
-            connect(combo, &QComboBox::currentIndexChanged, 
-                    this, [setter, this](int index) {
-                if (index < 0) return;
+            control.labelRect = QRectF(15, yPos + 2, 170, 14);
+            control.rect = QRectF(15, yPos + 18, 170, 22);
+            control.apply = [setter, this](const QVariant& v) {
                 if (setter) {
-                    setter(index);
+                    setter(v.toInt());
                     // Defer layout update
                     QTimer::singleShot(0, this, [this]() { updateLayout(); });
                     updatePreview();
                 }
-            });
-
-            layout->addWidget(label);
-            layout->addWidget(combo);
-            
-            if (!param.tooltip.isEmpty()) {
-                container->setToolTip(param.tooltip);
-            }
-            
-            container->setAttribute(Qt::WA_TranslucentBackground);
-            container->resize(container->sizeHint());
-            
-            QGraphicsProxyWidget* proxy = new QGraphicsProxyWidget(this);
-            proxy->setWidget(container);
-            proxy->setPos(10, yPos);
-            proxy->setZValue(100);
-            m_parameterWidgets.append(proxy);
-            
-            // Manage Z-Order when popup opens/closes
-            auto restoreZOrder = [this]() {
-                for (auto* p : m_parameterWidgets) {
-                    p->setZValue(100); // Restore default Z
-                }
             };
-            
-            // Open: Lower others, raise this
-            connect(combo, &PopupAwareComboBox::popupOpened, this, [proxy, this]() {
-                 for (auto* p : m_parameterWidgets) {
-                    if (p != proxy) {
-                        p->setZValue(-100); // Background others
-                    }
-                }
-                proxy->setZValue(10000); // Foreground this
-            });
-            
-            // Close: Restore
-            connect(combo, &PopupAwareComboBox::popupClosed, this, [restoreZOrder]() {
-                restoreZOrder();
-            });
-            
-            // Also connect to the combobox's hiding signal if possible, but standard QComboBox doesn't have a specific "popupHidden" signal easily accessible without subclassing.
-            // But "activated" covers selection. What if they click away?
-            // The popup closing usually triggers loss of focus or similar.
-            // Let's rely on the fact that if they click another widget, that widget will receive focus?
-            // Actually, for a robust reset, it's better to reset all to 100 at the start of any interaction?
-            // No, that's complex. Let's start with this.
-            
-            yPos += container->sizeHint().height() + 5;
-        } else if (param.type == Node::ParameterInfo::Combo) {
-            // Same as Enum but with options from 'options' list
-            QWidget* container = new QWidget();
-            container->setFixedWidth(200);
-            QHBoxLayout* layout = new QHBoxLayout(container);
-            layout->setContentsMargins(5, 2, 5, 2);
-            layout->setSpacing(5);
-            
-            QLabel* label = new QLabel(AppSettings::instance().translate(param.name));
-            label->setStyleSheet("color: #aaaaaa; font-size: 8pt;");
-            
-            PopupAwareComboBox* combo = new PopupAwareComboBox();
-            combo->setStyle(QStyleFactory::create("Fusion")); 
-            combo->setFixedWidth(120);
-            
-            // Filter wheel events on the combo itself to prevent scene zooming and handle value change
-            combo->installEventFilter(new WheelEventFilter([combo](int delta) {
-                int count = combo->count();
-                if (count == 0) return;
-                int index = std::clamp(combo->currentIndex() + delta, 0, count - 1);
-                combo->setCurrentIndex(index);
-            }, combo));
-            
-            // Also install on view to prevent bubbling if necessary, though view usually handles it.
-            // Actually, keep view default behavior (scrolling list) is better when popup is open.
-            // So ONLY install on combo.
-            
-            QPalette pal = combo->palette();
-            pal.setColor(QPalette::Base, QColor(0x2d, 0x2d, 0x2d));
-            pal.setColor(QPalette::Text, Qt::white);
-            pal.setColor(QPalette::Button, QColor(0x38, 0x38, 0x38)); // Darker button
-            pal.setColor(QPalette::ButtonText, Qt::white);
-            combo->setPalette(pal);
-            // Ensure view uses the same palette
-            combo->view()->setPalette(pal);
-
-            combo->setStyleSheet(
-                "QComboBox { background-color: #383838; color: white; border: 1px solid #555; border-radius: 3px; padding: 3px 5px; min-height: 18px; }"
-                "QComboBox QAbstractItemView { background-color: #383838; color: white; selection-background-color: #505050; selection-color: white; border: 1px solid #555; outline: none; }"
-                "QComboBox::item { color: white; }"
-                "QComboBox::item:selected { background-color: #505050; }"
-            );
-            
-            for (const QString& item : param.options) {
-                if (item == "-") {
-                    combo->insertSeparator(combo->count());
-                } else {
-                    combo->addItem(AppSettings::instance().translate(item));
-                }
-            }
-            
-            int currentIndex = param.defaultValue.toInt();
-            if (currentIndex >= 0 && currentIndex < combo->count()) {
-                combo->setCurrentIndex(currentIndex);
-            }
-            
-            auto setter = param.setter;
-            connect(combo, &QComboBox::currentIndexChanged, this, [setter, this](int index) {
-                if (index < 0) return;
-                if (setter) {
-                    setter(index);
-                    QTimer::singleShot(0, this, [this]() { updateLayout(); });
-                    updatePreview();
-                }
-            });
-            
-            layout->addWidget(label);
-            layout->addWidget(combo);
-            
-            if (!param.tooltip.isEmpty()) container->setToolTip(param.tooltip);
-            container->setAttribute(Qt::WA_TranslucentBackground);
-            container->resize(container->sizeHint());
-            
-            QGraphicsProxyWidget* proxy = new QGraphicsProxyWidget(this);
-            proxy->setWidget(container);
-            proxy->setPos(10, yPos);
-            proxy->setZValue(100);
-            m_parameterWidgets.append(proxy);
-            
-            // Manage Z-Order
-            connect(combo, &PopupAwareComboBox::popupOpened, this, [proxy, this]() {
-                 for (auto* p : m_parameterWidgets) if (p != proxy) p->setZValue(-100);
-                 proxy->setZValue(10000);
-            });
-            connect(combo, &PopupAwareComboBox::popupClosed, this, [this]() {
-                for (auto* p : m_parameterWidgets) p->setZValue(100);
-            });
-            
-            yPos += container->sizeHint().height() + 5;
+            yPos += 49;
         } else if (param.type == Node::ParameterInfo::Bool) {
-            QCheckBox* check = new QCheckBox(AppSettings::instance().translate(param.name));
-            check->setStyleSheet("QCheckBox { color: #aaaaaa; font-size: 8pt; }");
-            check->setChecked(param.defaultValue.toBool());
-            
-            auto setter = param.setter;
-            connect(check, &QCheckBox::toggled, this, [setter, this](bool checked) {
+            control.kind = ParameterControl::Kind::Checkbox;
+            control.rect = QRectF(10, yPos, 200, 20);
+            control.apply = [setter, this](const QVariant& v) {
                 if (setter) {
-                    setter(checked);
+                    setter(v.toBool());
                     // Defer layout update
                     QTimer::singleShot(0, this, [this]() { updateLayout(); });
                     updatePreview();
                 }
-            });
-            
-            if (!param.tooltip.isEmpty()) {
-                check->setToolTip(param.tooltip);
-            }
-            
-            check->resize(check->sizeHint());
-            
-            QGraphicsProxyWidget* proxy = new QGraphicsProxyWidget(this);
-            proxy->setWidget(check);
-            proxy->setPos(10, yPos);
-            proxy->setZValue(100);
-            m_parameterWidgets.append(proxy);
-            
-            yPos += check->sizeHint().height() + 2;
-            
+            };
+            yPos += 22;
         } else if (param.type == Node::ParameterInfo::File) {
-            QWidget* container = new QWidget();
-            container->setFixedWidth(200); // Slightly wider for file paths
-            QVBoxLayout* layout = new QVBoxLayout(container);
-            layout->setContentsMargins(5, 2, 5, 2);
-            layout->setSpacing(2);
-            
-            // Open Button
-            QPushButton* openBtn = new QPushButton(AppSettings::instance().translate("Open " + param.name)); // Or just "Open Image"
-            if (param.name == "Image File") openBtn->setText(AppSettings::instance().translate("Open Image"));
-            
-            openBtn->setStyleSheet(
-                "QPushButton { background-color: #383838; color: white; border: 1px solid #555; border-radius: 3px; padding: 4px; }"
-                "QPushButton:hover { border: 1px solid #777; }"
-            );
-            
-            // Path Label
-            QString currentPath = param.defaultValue.toString();
-            QLabel* pathLabel = new QLabel(currentPath.isEmpty() ? AppSettings::instance().translate("No file") : QFileInfo(currentPath).fileName());
-            pathLabel->setStyleSheet("color: #aaaaaa; font-size: 8pt;");
-            pathLabel->setWordWrap(true);
-            
-            auto setter = param.setter;
-            connect(openBtn, &QPushButton::clicked, this, [setter, pathLabel, this]() {
-                QString path = QFileDialog::getOpenFileName(nullptr, "Open File", "", "Images (*.png *.jpg *.jpeg *.bmp *.tga);;All Files (*.*)");
-                if (!path.isEmpty()) {
-                    if (setter) {
-                        setter(path);
-                        pathLabel->setText(QFileInfo(path).fileName());
-                        updatePreview();
-                    }
+            control.kind = ParameterControl::Kind::File;
+            control.label = AppSettings::instance().translate(param.name == "Image File" ? QString("Open Image") : "Open " + param.name);
+            control.rect = QRectF(15, yPos + 2, 190, 24);
+            control.labelRect = QRectF(15, yPos + 28, 190, 14);
+            control.apply = [setter, this](const QVariant& v) {
+                if (setter) {
+                    setter(v.toString());
+                    updatePreview();
                 }
-            });
-            
-            layout->addWidget(openBtn);
-            layout->addWidget(pathLabel);
-            
-            if (!param.tooltip.isEmpty()) {
-                container->setToolTip(param.tooltip);
-            }
-            
-            container->setAttribute(Qt::WA_TranslucentBackground);
-            container->resize(container->sizeHint());
-            
-            QGraphicsProxyWidget* proxy = new QGraphicsProxyWidget(this);
-            proxy->setWidget(container);
-            proxy->setPos(10, yPos);
-            proxy->setZValue(100);
-            m_parameterWidgets.append(proxy);
-            
-            yPos += container->sizeHint().height() + 5;
+            };
+            yPos += 49;
         } else if (param.type == Node::ParameterInfo::String) {
-            QWidget* container = new QWidget();
-            container->setFixedWidth(180);
-            QVBoxLayout* layout = new QVBoxLayout(container);
-            layout->setContentsMargins(5, 2, 5, 2);
-            layout->setSpacing(2);
-            
-            QLabel* label = new QLabel(AppSettings::instance().translate(param.name));
-            label->setStyleSheet("color: #aaaaaa; font-size: 8pt;");
-            
-            QLineEdit* edit = new QLineEdit(param.defaultValue.toString());
-            edit->setStyleSheet(
-                "QLineEdit { background-color: #383838; color: white; border: 1px solid #555; border-radius: 3px; padding: 3px; }"
-                "QLineEdit:focus { border: 1px solid #4a90d9; }"
-            );
-            
-            auto setter = param.setter;
-            connect(edit, &QLineEdit::textChanged, this, [setter, this](const QString& text) {
+            control.kind = ParameterControl::Kind::Text;
+            control.labelRect = QRectF(15, yPos + 2, 170, 14);
+            control.rect = QRectF(15, yPos + 18, 170, 22);
+            control.apply = [setter, this](const QVariant& v) {
                 if (setter) {
-                    setter(text);
-                    // Defer layout update if necessary, but for text usually not unless size changes?
+                    setter(v.toString());
                     // TextNode rerenders on change, so updatePreview is needed.
                     updatePreview();
                 }
-            });
-            
-            layout->addWidget(label);
-            layout->addWidget(edit);
-            
-            if (!param.tooltip.isEmpty()) container->setToolTip(param.tooltip);
-            container->setAttribute(Qt::WA_TranslucentBackground);
-            container->resize(container->sizeHint());
-            
-            QGraphicsProxyWidget* proxy = new QGraphicsProxyWidget(this);
-            proxy->setWidget(container);
-            proxy->setPos(10, yPos);
-            proxy->setZValue(100);
-            m_parameterWidgets.append(proxy);
-            
-            yPos += container->sizeHint().height() + 5;
-            
+            };
+            yPos += 49;
         } else if (param.type == Node::ParameterInfo::Color) {
-            // Color picker button
-            QWidget* container = new QWidget();
-            container->setFixedWidth(220);
-            QHBoxLayout* layout = new QHBoxLayout(container);
-            layout->setContentsMargins(5, 2, 5, 2);
-            layout->setSpacing(5);
-            
-            QLabel* label = new QLabel(AppSettings::instance().translate(param.name));
-            label->setStyleSheet("color: #aaaaaa; font-size: 9pt;");
-            
-            QPushButton* colorBtn = new QPushButton();
-            colorBtn->setFixedSize(60, 24);
-            QColor initialColor = param.defaultValue.value<QColor>();
-            colorBtn->setStyleSheet(QString("background-color: %1; border: 1px solid #555; border-radius: 3px;").arg(initialColor.name()));
-            
-            auto setter = param.setter;
-            connect(colorBtn, &QPushButton::clicked, this, [setter, colorBtn, this]() {
-                QColor current;
-                // Fix for deprecated setNamedColor: Use QColor::fromString if 6.4+, or explicit constructor
-                #if QT_VERSION >= QT_VERSION_CHECK(6, 4, 0)
-                    current = QColor::fromString(colorBtn->styleSheet().section("background-color: ", 1, 1).section(";", 0, 0));
-                #else
-                    current = QColor(colorBtn->styleSheet().section("background-color: ", 1, 1).section(";", 0, 0)); // String constructor
-                #endif
-                QColor newColor = QColorDialog::getColor(current, nullptr, "Select Color", QColorDialog::DontUseNativeDialog);
-                if (newColor.isValid() && setter) {
-                    setter(newColor);
-                    colorBtn->setStyleSheet(QString("background-color: %1; border: 1px solid #555; border-radius: 3px;").arg(newColor.name()));
+            control.kind = ParameterControl::Kind::Color;
+            control.labelRect = QRectF(15, yPos + 2, 90, 24);
+            control.rect = QRectF(110, yPos + 2, 60, 24);
+            control.apply = [setter, this](const QVariant& v) {
+                if (setter) {
+                    setter(v.value<QColor>());
                     m_node->setDirty(true);
                     updatePreview();
                 }
-            });
-            
-            layout->addWidget(label);
-            layout->addWidget(colorBtn);
-            layout->addStretch();
-            
-            if (!param.tooltip.isEmpty()) {
-                container->setToolTip(param.tooltip);
-            }
-            
-            container->setAttribute(Qt::WA_TranslucentBackground);
-            container->resize(container->sizeHint());
-            
-            QGraphicsProxyWidget* proxy = new QGraphicsProxyWidget(this);
-            proxy->setWidget(container);
-            proxy->setPos(10, yPos);
-            proxy->setZValue(100);
-            m_parameterWidgets.append(proxy);
-            
-            yPos += container->sizeHint().height() + 2;
+            };
+            yPos += 30;
+        } else {
+            continue;
         }
+        
+        m_controls.append(control);
     }
 
     // REMOVED HARDCODED UI BLOCKS FOR:
@@ -756,7 +509,7 @@ void NodeGraphicsItem::updateLayout() {
         yPos += 95;
     }
 
-    // 3. Input Sockets (Interleaved with Widgets)
+    // 3. Input Sockets (Interleaved with Controls)
     QVector<NodeGraphicsSocket*> newInputItems;
     QVector<NodeSocket*> inputSockets = m_node->inputSockets(); // Store in local variable to avoid temporary
     
@@ -782,16 +535,15 @@ void NodeGraphicsItem::updateLayout() {
         // Move yPos down for the socket label (socket dot is rendered at this Y)
         yPos += 20; // Height for socket label line
         
-        // Check if we need a widget for this socket
+        // Check if we need a control for this socket
         bool hasWidget = false;
-        Node::ParameterInfo paramInfo;
+        const Node::ParameterInfo* paramInfo = nullptr;
         
         // Dynamic Parameter Lookup
-        QVector<Node::ParameterInfo> params = m_node->parameters();
-        for (const auto& p : params) {
+        for (const auto& p : std::as_const(allParams)) {
             if (p.name == socket->name()) {
                 hasWidget = true;
-                paramInfo = p;
+                paramInfo = &p;
                 break;
             }
         }
@@ -802,122 +554,79 @@ void NodeGraphicsItem::updateLayout() {
         }
 
         if (hasWidget) {
-            // Widget is placed directly below socket label
-            QWidget* container = new QWidget();
-            container->setFixedWidth(m_width - 20); // Full width minus margins
-            QVBoxLayout* layout = new QVBoxLayout(container);
-            layout->setContentsMargins(0, 0, 0, 0);
-            layout->setSpacing(0);
+            // Control is placed directly below socket label
+            const QRectF row(10, yPos, m_width - 20, 22);
             
             if (socket->type() == SocketType::Float || socket->type() == SocketType::Integer) {
-                SliderSpinBox* spinBox = new SliderSpinBox();
-                
-                spinBox->setSoftRange(paramInfo.min, paramInfo.max);
-                spinBox->setSpinBoxRange(-100000.0, 100000.0);
-                
+                ParameterControl control;
+                control.kind = ParameterControl::Kind::Slider;
+                control.tooltip = paramInfo->tooltip;
+                control.rect = row;
+                control.socket = socket;
+                control.softMin = paramInfo->min;
+                control.softMax = paramInfo->max;
                 if (socket->type() == SocketType::Integer) {
-                    spinBox->setSingleStep(std::max(1.0, paramInfo.step));
-                    spinBox->setDecimals(0);
+                    control.step = std::max(1.0, paramInfo->step);
+                    control.decimals = 0;
                 } else {
-                    spinBox->setSingleStep(paramInfo.step > 0 ? paramInfo.step : 0.1);
-                    spinBox->setDecimals(3); 
+                    control.step = paramInfo->step > 0 ? paramInfo->step : 0.1;
+                    control.decimals = 3;
                 }
-                
-                spinBox->setValue(socket->defaultValue().toDouble());
-                
-                connect(spinBox, &SliderSpinBox::valueChanged, this, [socket, this](double val) {
+                control.apply = [socket, this](const QVariant& v) {
+                    const double val = v.toDouble();
                     if (!qFuzzyCompare(socket->defaultValue().toDouble(), val)) {
-                        qDebug() << "UI: SliderSpinBox Changed" << socket->name() << val;
                         socket->setDefaultValue(val);
                         m_node->setDirty(true);
                         updatePreview();
                     }
-                });
-                
-                layout->addWidget(spinBox);
+                };
+                m_controls.append(control);
             } 
             else if (socket->type() == SocketType::Vector) {
-                 QHBoxLayout* vectorLayout = new QHBoxLayout();
-                 vectorLayout->setSpacing(2);
-                 vectorLayout->setContentsMargins(0,0,0,0);
-                 QVector3D currentVal = socket->defaultValue().value<QVector3D>();
-                 
-                 auto createSpinBox = [&](double val, std::function<void(double)> setter) {
-                    QDoubleSpinBox* sb = new QDoubleSpinBox();
-                    sb->setRange(paramInfo.min, paramInfo.max); 
-                    sb->setValue(val);
-                    sb->setSingleStep(paramInfo.step > 0 ? paramInfo.step : 0.1);
-                    sb->setButtonSymbols(QAbstractSpinBox::NoButtons);
-                    sb->setStyleSheet("background-color: #404040; color: white; border: 1px solid #555;");
-                    sb->setFixedWidth(50);
-                    connect(sb, QOverload<double>::of(&QDoubleSpinBox::valueChanged), this, [setter, this](double v) {
-                        setter(v);
-                        updatePreview();
-                    });
-                    return sb;
-                 };
-                 
-                 vectorLayout->addWidget(createSpinBox(currentVal.x(), [socket, this](double v){
-                     QVector3D vec = socket->defaultValue().value<QVector3D>();
-                     if (!qFuzzyCompare(static_cast<double>(vec.x()), v)) {
-                         qDebug() << "UI: Vector X Changed" << socket->name() << v;
-                         vec.setX(v); socket->setDefaultValue(vec); m_node->setDirty(true);
-                     }
-                 }));
-                 vectorLayout->addWidget(createSpinBox(currentVal.y(), [socket, this](double v){
-                     QVector3D vec = socket->defaultValue().value<QVector3D>();
-                     if (!qFuzzyCompare(static_cast<double>(vec.y()), v)) {
-                         qDebug() << "UI: Vector Y Changed" << socket->name() << v;
-                         vec.setY(v); socket->setDefaultValue(vec); m_node->setDirty(true);
-                     }
-                 }));
-                 vectorLayout->addWidget(createSpinBox(currentVal.z(), [socket, this](double v){
-                     QVector3D vec = socket->defaultValue().value<QVector3D>();
-                     if (!qFuzzyCompare(static_cast<double>(vec.z()), v)) {
-                         qDebug() << "UI: Vector Z Changed" << socket->name() << v;
-                         vec.setZ(v); socket->setDefaultValue(vec); m_node->setDirty(true);
-                     }
-                 }));
-                 layout->addLayout(vectorLayout);
+                static const char* const kComponents[] = {"X", "Y", "Z"};
+                const qreal width = (row.width() - 4) / 3;
+                for (int c = 0; c < 3; ++c) {
+                    ParameterControl control;
+                    control.kind = ParameterControl::Kind::Slider;
+                    control.label = kComponents[c];
+                    control.tooltip = paramInfo->tooltip;
+                    control.rect = QRectF(row.left() + c * (width + 2), row.top(), width, row.height());
+                    control.socket = socket;
+                    control.component = c;
+                    control.softMin = paramInfo->min;
+                    control.softMax = paramInfo->max;
+                    control.step = paramInfo->step > 0 ? paramInfo->step : 0.1;
+                    control.decimals = 2;
+                    control.apply = [socket, c, this](const QVariant& v) {
+                        QVector3D vec = socket->defaultValue().value<QVector3D>();
+                        if (!qFuzzyCompare(static_cast<double>(vec[c]), v.toDouble())) {
+                            vec[c] = v.toFloat();
+                            socket->setDefaultValue(vec);
+                            m_node->setDirty(true);
+                            updatePreview();
+                        }
+                    };
+                    m_controls.append(control);
+                }
             }
             else if (socket->type() == SocketType::Color) {
-                QPushButton* colorBtn = new QPushButton();
-                colorBtn->setFixedHeight(20);
-                
-                auto updateBtnColor = [colorBtn, socket]() {
-                    QColor c = socket->defaultValue().value<QColor>();
-                    QString style = QString("background-color: %1; border: 1px solid #555; border-radius: 3px;").arg(c.name());
-                    colorBtn->setStyleSheet(style);
-                };
-                updateBtnColor();
-                
-                connect(colorBtn, &QPushButton::clicked, this, [colorBtn, socket, updateBtnColor, this]() {
-                    QColor c = socket->defaultValue().value<QColor>();
-                    QColor newColor = QColorDialog::getColor(c, nullptr, "Select Color");
-                    if (newColor.isValid() && newColor != c) {
-                        qDebug() << "UI: Color Changed" << socket->name() << newColor;
+                ParameterControl control;
+                control.kind = ParameterControl::Kind::Color;
+                control.tooltip = paramInfo->tooltip;
+                control.rect = row.adjusted(0, 0, 0, -2);
+                control.socket = socket;
+                control.apply = [socket, this](const QVariant& v) {
+                    const QColor newColor = v.value<QColor>();
+                    if (newColor.isValid() && newColor != socket->defaultValue().value<QColor>()) {
                         socket->setDefaultValue(newColor);
-                        updateBtnColor();
                         m_node->setDirty(true);
                         updatePreview();
                     }
-                });
-                
-                layout->addWidget(colorBtn);
+                };
+                m_controls.append(control);
             }
             
-            QGraphicsProxyWidget* proxy = new QGraphicsProxyWidget(this);
-            proxy->setWidget(container);
-            proxy->setPos(10, yPos); // Left aligned with node body
-            proxy->setFlag(QGraphicsItem::ItemIsSelectable, false);
-            proxy->setFlag(QGraphicsItem::ItemIsFocusable, true);
-            proxy->setZValue(100);
-            m_parameterWidgets.append(proxy);
-            
-            yPos += 30; // Widget height
-            if (socket->type() == SocketType::Vector) yPos += 30; // Extra for vector
-        } else {
-            // No widget, just add regular socket spacing
+            yPos += 30; // Control height
         }
         
         yPos += m_socketSpacing - 20; // Subtract the 20 we already added for label
@@ -933,8 +642,7 @@ void NodeGraphicsItem::updateLayout() {
 
     // 4. Float/Int Parameters (rendered like input sockets, but without socket dot)
     // These are parameters that don't have corresponding input sockets
-    QVector<Node::ParameterInfo> floatIntParams = m_node->parameters();
-    for (const auto& param : floatIntParams) {
+    for (const auto& param : std::as_const(allParams)) {
         if (param.type != Node::ParameterInfo::Float && param.type != Node::ParameterInfo::Int) {
             continue; // Only process Float/Int here
         }
@@ -944,98 +652,72 @@ void NodeGraphicsItem::updateLayout() {
             continue;
         }
         
-        // Draw parameter label (like a socket label but without the dot)
-        QGraphicsTextItem* label = new QGraphicsTextItem(AppSettings::instance().translate(param.name), this);
-        label->setDefaultTextColor(QColor(170, 170, 170));
-        label->setFont(QFont("Arial", 9));
-        label->setPos(15, yPos);
-        label->setZValue(50);
-        
-        yPos += 20; // Label height
-        
-        // Create widget below label
-        QWidget* container = new QWidget();
-        container->setFixedWidth(m_width - 20);
-        QVBoxLayout* layout = new QVBoxLayout(container);
-        layout->setContentsMargins(0, 0, 0, 0);
-        layout->setSpacing(0);
-        
-        SliderSpinBox* spinBox = new SliderSpinBox();
-        spinBox->setSoftRange(param.min, param.max);
-        spinBox->setSpinBoxRange(-100000.0, 100000.0);
-        
+        // Parameter label (like a socket label but without the dot) above the slider
+        ParameterControl control;
+        control.kind = ParameterControl::Kind::Slider;
+        control.label = AppSettings::instance().translate(param.name);
+        control.tooltip = param.tooltip;
+        control.labelRect = QRectF(15, yPos, m_width - 30, 20);
+        control.rect = QRectF(10, yPos + 20, m_width - 20, 22);
+        control.cached = m_node->parameterValue(param);
+        control.softMin = param.min;
+        control.softMax = param.max;
         if (param.type == Node::ParameterInfo::Int) {
-            spinBox->setSingleStep(std::max(1.0, param.step));
-            spinBox->setDecimals(0);
+            control.step = std::max(1.0, param.step);
+            control.decimals = 0;
         } else {
-            spinBox->setSingleStep(param.step > 0 ? param.step : 0.1);
-            spinBox->setDecimals(3);
+            control.step = param.step > 0 ? param.step : 0.1;
+            control.decimals = 3;
         }
-        
-        spinBox->setValue(param.defaultValue.toDouble());
-        
-        auto setter = param.setter;
-        connect(spinBox, &SliderSpinBox::valueChanged, this, [setter, this](double val) {
+        auto setter = m_node->parameterSetter(param);
+        control.apply = [setter, this](const QVariant& v) {
             if (setter) {
-                setter(val);
+                setter(v.toDouble());
                 m_node->setDirty(true);
                 updatePreview();
             }
-        });
+        };
+        m_controls.append(control);
         
-        layout->addWidget(spinBox);
-        
-        if (!param.tooltip.isEmpty()) container->setToolTip(param.tooltip);
-        
-        QGraphicsProxyWidget* proxy = new QGraphicsProxyWidget(this);
-        proxy->setWidget(container);
-        proxy->setPos(10, yPos);
-        proxy->setZValue(100);
-        m_parameterWidgets.append(proxy);
-        
-        yPos += 32; // Widget height + spacing
+        yPos += 52; // Label + control height + spacing
     }
 
     // River Node Edge Connection Checkbox
     if (RiverNode* riverNode = dynamic_cast<RiverNode*>(m_node)) {
-        QCheckBox* edgeCheck = new QCheckBox("Edge Connection");
-        edgeCheck->setChecked(riverNode->edgeConnection());
-        edgeCheck->setStyleSheet("color: #e0e0e0;");
-        
-        connect(edgeCheck, &QCheckBox::toggled, this, [riverNode, this](bool checked) {
+        ParameterControl control;
+        control.kind = ParameterControl::Kind::Checkbox;
+        control.label = "Edge Connection";
+        control.rect = QRectF(10, yPos, 200, 20);
+        control.cached = riverNode->edgeConnection();
+        control.apply = [riverNode, this](const QVariant& v) {
+            const bool checked = v.toBool();
             // Defer update to avoid crash (rebuilds UI to update button text)
             QTimer::singleShot(0, this, [riverNode, this, checked]() {
                 riverNode->setEdgeConnection(checked);
                 riverNode->setDirty(true);
                 updatePreview();
             });
-        });
-        
-        QGraphicsProxyWidget* proxy = new QGraphicsProxyWidget(this);
-        proxy->setWidget(edgeCheck);
-        proxy->setPos(10, yPos);
+        };
+        m_controls.append(control);
         yPos += 25;
-        m_parameterWidgets.append(proxy);
     }
 
     // Output Node Auto Update Checkbox
     if (OutputNode* outputNode = dynamic_cast<OutputNode*>(m_node)) {
-        QCheckBox* autoUpdateCheck = new QCheckBox("Auto Update");
-        autoUpdateCheck->setChecked(outputNode->autoUpdate());
-        autoUpdateCheck->setStyleSheet("color: #e0e0e0;");
-        
-        connect(autoUpdateCheck, &QCheckBox::toggled, this, [outputNode, this](bool checked) {
+        ParameterControl control;
+        control.kind = ParameterControl::Kind::Checkbox;
+        control.label = "Auto Update";
+        control.rect = QRectF(10, yPos, 200, 20);
+        control.cached = outputNode->autoUpdate();
+        control.apply = [outputNode, this](const QVariant& v) {
+            const bool checked = v.toBool();
             outputNode->setAutoUpdate(checked);
             // No need to trigger update immediately, just set the flag
             // But if enabled, maybe we should trigger one?
             if (checked) updatePreview();
-        });
-        
-        QGraphicsProxyWidget* proxy = new QGraphicsProxyWidget(this);
-        proxy->setWidget(autoUpdateCheck);
-        proxy->setPos(10, yPos);
+        };
+        m_controls.append(control);
         yPos += 25;
-        m_parameterWidgets.append(proxy);
     }
 
     // 4. Output Sockets
@@ -1068,56 +750,279 @@ void NodeGraphicsItem::updateLayout() {
     m_outputSocketItems = newOutputItems;
     
     m_height = yPos + 10;
+    
+    // 描画用のパスはサイズが変わったときだけ作る
+    m_bodyPath = QPainterPath();
+    m_bodyPath.addRoundedRect(QRectF(0, 0, m_width, m_height), 5, 5);
+    QPainterPath titlePath;
+    titlePath.addRoundedRect(QRectF(0, 0, m_width, m_titleHeight), 5, 5);
+    QPainterPath titleRect;
+    titleRect.addRect(QRectF(0, m_titleHeight / 2, m_width, m_titleHeight / 2));
+    m_titlePath = titlePath.united(titleRect);
+    
+    // New widgets and sockets start visible
+    applyDetailLevel();
     update();
 }
 
-void NodeGraphicsItem::updatePreview() {
-    emit parameterChanged();
-    int size = static_cast<int>(m_previewSize);
-    QImage image(size, size, QImage::Format_RGB32);
+NodeGraphicsItem::DetailLevel NodeGraphicsItem::detailLevelForZoom(qreal zoom) {
+    if (zoom >= 0.5) return DetailLevel::Full;
+    if (zoom >= 0.25) return DetailLevel::Simplified;
+    return DetailLevel::Minimal;
+}
+
+void NodeGraphicsItem::setDetailLevel(DetailLevel level) {
+    if (m_detailLevel == level) return;
+    m_detailLevel = level;
+    applyDetailLevel();
+    update();
+}
+
+void NodeGraphicsItem::applyDetailLevel() {
+    // Hidden proxies are skipped by the scene entirely, which is where
+    // most of the cost of a zoomed-out graph goes
+    const bool widgets = m_detailLevel == DetailLevel::Full;
+    for (QGraphicsProxyWidget* proxy : std::as_const(m_parameterWidgets)) {
+        proxy->setVisible(widgets);
+    }
+    if (!widgets) {
+        closeEditor();
+    }
     
-    // NoiseTextureNode の場合
-    NoiseTextureNode* noiseNode = dynamic_cast<NoiseTextureNode*>(m_node);
-    if (noiseNode) {
-        for (int y = 0; y < size; y++) {
-            for (int x = 0; x < size; x++) {
-                double nx = static_cast<double>(x) / size;
-                double ny = static_cast<double>(y) / size;
-                
-                QColor color = noiseNode->getColorValue(nx, ny, 0.0);
-                image.setPixelColor(x, y, color);
-            }
-        }
-        
-        m_previewPixmap = QPixmap::fromImage(image);
-        update();
+    const bool details = m_detailLevel != DetailLevel::Minimal;
+    m_titleItem->setVisible(details);
+    for (NodeGraphicsSocket* socket : std::as_const(m_inputSocketItems)) {
+        socket->setVisible(details);
+    }
+    for (NodeGraphicsSocket* socket : std::as_const(m_outputSocketItems)) {
+        socket->setVisible(details);
+    }
+}
+
+int NodeGraphicsItem::controlAt(const QPointF& pos) const {
+    // 縮小表示では操作させない（ノードの移動を優先）
+    if (m_detailLevel != DetailLevel::Full) return -1;
+    for (int i = 0; i < m_controls.size(); ++i) {
+        if (m_controls[i].rect.contains(pos)) return i;
+    }
+    return -1;
+}
+
+void NodeGraphicsItem::mousePressEvent(QGraphicsSceneMouseEvent* event) {
+    const int index = event->button() == Qt::LeftButton ? controlAt(event->pos()) : -1;
+    if (index < 0) {
+        closeEditor();
+        QGraphicsObject::mousePressEvent(event);
+        return;
+    }
+    closeEditor();
+    m_activeControl = index;
+    m_pressPos = event->pos();
+    m_controlDragging = false;
+    event->accept();
+}
+
+void NodeGraphicsItem::mouseMoveEvent(QGraphicsSceneMouseEvent* event) {
+    if (m_activeControl < 0) {
+        QGraphicsObject::mouseMoveEvent(event);
         return;
     }
+    ParameterControl& control = m_controls[m_activeControl];
+    if (control.kind != ParameterControl::Kind::Slider) return;
     
-    // InvertNode の場合
-    InvertNode* invertNode = dynamic_cast<InvertNode*>(m_node);
-    if (invertNode) {
-        for (int y = 0; y < size; y++) {
-            for (int x = 0; x < size; x++) {
-                QVector3D pos(static_cast<double>(x) / size, static_cast<double>(y) / size, 0.0);
-                
-                // compute()メソッドを呼び出して色を取得
-                QVector<NodeSocket*> outputs = invertNode->outputSockets();
-                if (!outputs.isEmpty()) {
-                    QVariant result = invertNode->compute(pos, outputs[0]);
-                    QColor color = result.value<QColor>();
-                    image.setPixelColor(x, y, color);
-                }
+    // 少し動かしてからドラッグ扱い（クリックでの数値入力と区別）
+    if (!m_controlDragging && qAbs(event->pos().x() - m_pressPos.x()) > 3) {
+        m_controlDragging = true;
+    }
+    if (m_controlDragging) {
+        control.setValue(control.sliderValueAt(event->pos().x()));
+        update(control.rect);
+    }
+}
+
+void NodeGraphicsItem::mouseReleaseEvent(QGraphicsSceneMouseEvent* event) {
+    if (m_activeControl < 0) {
+        QGraphicsObject::mouseReleaseEvent(event);
+        return;
+    }
+    const int index = m_activeControl;
+    const bool dragged = m_controlDragging;
+    m_activeControl = -1;
+    m_controlDragging = false;
+    if (!dragged && m_controls[index].rect.contains(event->pos())) {
+        beginEdit(index, event->screenPos());
+    }
+}
+
+void NodeGraphicsItem::hoverMoveEvent(QGraphicsSceneHoverEvent* event) {
+    const int index = controlAt(event->pos());
+    if (index != m_hoverControl) {
+        if (m_hoverControl >= 0) update(m_controls[m_hoverControl].rect);
+        m_hoverControl = index;
+        setToolTip(index >= 0 ? m_controls[index].tooltip : QString());
+        if (index >= 0) update(m_controls[index].rect);
+    }
+    QGraphicsObject::hoverMoveEvent(event);
+}
+
+void NodeGraphicsItem::hoverLeaveEvent(QGraphicsSceneHoverEvent* event) {
+    if (m_hoverControl >= 0) {
+        update(m_controls[m_hoverControl].rect);
+        m_hoverControl = -1;
+        setToolTip(QString());
+    }
+    QGraphicsObject::hoverLeaveEvent(event);
+}
+
+void NodeGraphicsItem::beginEdit(int index, const QPoint& screenPos) {
+    // Menus and dialogs run a nested event loop in which a deferred
+    // updateLayout may rebuild m_controls, so work on a copy and only write
+    // the cached value back if the control is still there.
+    const ParameterControl control = m_controls[index];
+    auto commit = [this, index, control](const QVariant& v) {
+        ParameterControl copy = control;
+        copy.setValue(v);
+        if (index < m_controls.size() && m_controls[index].kind == control.kind
+                && m_controls[index].label == control.label) {
+            m_controls[index].cached = copy.cached;
+            update(m_controls[index].rect);
+        }
+    };
+    
+    switch (control.kind) {
+    case ParameterControl::Kind::Checkbox:
+        commit(!control.value().toBool());
+        break;
+    case ParameterControl::Kind::Enum: {
+        QMenu menu;
+        const int current = control.value().toInt();
+        for (int i = 0; i < control.items.size(); ++i) {
+            if (control.items[i] == "-") {
+                menu.addSeparator();
+                continue;
             }
+            QAction* action = menu.addAction(control.items[i]);
+            action->setData(i);
+            action->setCheckable(true);
+            action->setChecked(i == current);
+        }
+        QAction* chosen = menu.exec(screenPos);
+        if (chosen && chosen->data().toInt() != current) {
+            commit(chosen->data().toInt());
         }
+        break;
+    }
+    case ParameterControl::Kind::Color: {
+        const QColor current = control.value().value<QColor>();
+        // パラメータ色は従来どおり Qt のダイアログ
+        const QColor newColor = control.socket
+            ? QColorDialog::getColor(current, nullptr, "Select Color")
+            : QColorDialog::getColor(current, nullptr, "Select Color", QColorDialog::DontUseNativeDialog);
+        if (newColor.isValid() && newColor != current) {
+            commit(newColor);
+        }
+        break;
+    }
+    case ParameterControl::Kind::File: {
+        const QString path = QFileDialog::getOpenFileName(nullptr, "Open File", "", "Images (*.png *.jpg *.jpeg *.bmp *.tga *.tif *.tiff *.vtex);;All Files (*.*)");
+        if (!path.isEmpty()) {
+            commit(path);
+        }
+        break;
+    }
+    case ParameterControl::Kind::Slider: {
+        // クリック: 数値を直接入力（ソフトレンジ外も可）
+        QDoubleSpinBox* spinBox = new QDoubleSpinBox();
+        spinBox->setRange(-100000.0, 100000.0);
+        spinBox->setDecimals(control.decimals);
+        spinBox->setSingleStep(control.step);
+        spinBox->setValue(control.value().toDouble());
+        spinBox->setButtonSymbols(QAbstractSpinBox::NoButtons);
+        spinBox->setStyleSheet("background-color: #404040; color: white; border: 1px solid #4a90d9;");
+        spinBox->setFixedSize(control.rect.size().toSize());
         
-        m_previewPixmap = QPixmap::fromImage(image);
-        update();
-        return;
+        connect(spinBox, QOverload<double>::of(&QDoubleSpinBox::valueChanged), this, [this, index](double v) {
+            if (index < m_controls.size()) {
+                m_controls[index].setValue(v);
+            }
+        });
+        connect(spinBox, &QDoubleSpinBox::editingFinished, this, [this]() {
+            // Closing from inside the widget's own signal: defer
+            QTimer::singleShot(0, this, [this]() { closeEditor(); });
+        });
+        
+        m_editor = new QGraphicsProxyWidget(this);
+        m_editor->setWidget(spinBox);
+        m_editor->setPos(control.rect.topLeft());
+        m_editor->setZValue(100);
+        spinBox->selectAll();
+        spinBox->setFocus();
+        break;
+    }
+    case ParameterControl::Kind::Text: {
+        QLineEdit* edit = new QLineEdit(control.value().toString());
+        edit->setStyleSheet(
+            "QLineEdit { background-color: #383838; color: white; border: 1px solid #4a90d9; border-radius: 3px; padding: 2px; }"
+        );
+        edit->setFixedSize(control.rect.size().toSize());
+        
+        connect(edit, &QLineEdit::textChanged, this, [this, index](const QString& text) {
+            if (index < m_controls.size()) {
+                m_controls[index].setValue(text);
+            }
+        });
+        connect(edit, &QLineEdit::editingFinished, this, [this]() {
+            QTimer::singleShot(0, this, [this]() { closeEditor(); });
+        });
+        
+        m_editor = new QGraphicsProxyWidget(this);
+        m_editor->setWidget(edit);
+        m_editor->setPos(control.rect.topLeft());
+        m_editor->setZValue(100);
+        edit->selectAll();
+        edit->setFocus();
+        break;
+    }
     }
+}
+
+void NodeGraphicsItem::closeEditor() {
+    if (!m_editor) return;
+    QGraphicsProxyWidget* editor = m_editor;
+    m_editor = nullptr;
+    if (editor->widget()) {
+        editor->widget()->disconnect(this);
+    }
+    editor->hide();
+    editor->deleteLater();
+    update();
+}
+
+void NodeGraphicsItem::updatePreview() {
+    emit parameterChanged();
     
-    // RiverNode preview removed (too heavy and non-functional)
-    // River texture will only be visible in the main result view
+    // 生成中のプレビューは古くなったので破棄し、次の描画で再要求
+    PreviewService::instance().cancel(m_node);
+    m_previewStale = true;
+    update();
+}
+
+NodeSocket* NodeGraphicsItem::previewSocket() const {
+    const QVector<NodeSocket*> outputs = m_node->outputSockets();
+    return outputs.isEmpty() ? nullptr : outputs.first();
+}
+
+bool NodeGraphicsItem::isInViewport() const {
+    if (!scene()) return false;
+    const QRectF bounds = sceneBoundingRect();
+    const QList<QGraphicsView*> views = scene()->views();
+    for (QGraphicsView* view : views) {
+        if (!view->isVisible()) continue;
+        if (view->mapToScene(view->viewport()->rect()).boundingRect().intersects(bounds)) {
+            return true;
+        }
+    }
+    return false;
 }
 
 QPointF NodeGraphicsItem::getSocketPosition(NodeSocket* socket) const {
@@ -1142,14 +1047,22 @@ QPointF NodeGraphicsItem::getSocketPosition(NodeSocket* socket) const {
 
 
 
+NodeGraphicsSocket* NodeGraphicsItem::socketItem(NodeSocket* socket) const {
+    const auto& items = socket->direction() == SocketDirection::Input ? m_inputSocketItems : m_outputSocketItems;
+    for (NodeGraphicsSocket* item : items) {
+        if (item->socket() == socket) return item;
+    }
+    return nullptr;
+}
+
 QVariant NodeGraphicsItem::itemChange(GraphicsItemChange change, const QVariant& value) {
     if (change == ItemPositionChange && scene()) {
         // ノードの位置を更新
         if (m_node) {
             m_node->setPosition(value.toPointF());
         }
-        
-        // 接続されているワイヤーの表示を更新
+    } else if (change == ItemPositionHasChanged && scene()) {
+        // 接続されているワイヤーの表示を更新（動いたノードのワイヤーだけ）
         for (NodeGraphicsSocket* socket : std::as_const(m_inputSocketItems)) {
             socket->updateConnectionPositions();
         }
@@ -1217,8 +1130,10 @@ void NodeGraphicsSocket::paint(QPainter* painter, const QStyleOptionGraphicsItem
         painter->drawEllipse(boundingRect().adjusted(-3, -3, 3, 3));
     }
     
-    // ソケット名
-    if (m_socket->isLabelVisible()) {
+    // ソケット名（縮小表示では省略）
+    NodeGraphicsItem* nodeItem = dynamic_cast<NodeGraphicsItem*>(parentItem());
+    const bool fullDetail = !nodeItem || nodeItem->detailLevel() == NodeGraphicsItem::DetailLevel::Full;
+    if (fullDetail && m_socket->isLabelVisible()) {
         QColor textColor = isLight ? Qt::black : Qt::white;
         painter->setPen(textColor);
         
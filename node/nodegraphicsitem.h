@@ -6,9 +6,12 @@
 #include <QGraphicsItem>
 #include <QGraphicsTextItem>
 #include <QPainter>
+#include <QPainterPath>
 #include <QStyleOptionGraphicsItem>
 #include <QWidget>
+#include <QPointer>
 #include "node.h"
+#include "parametercontrol.h"
 
 class NodeGraphicsSocket;
 class ConnectionGraphicsItem;
@@ -20,6 +23,14 @@ class QDoubleSpinBox;
 class NodeGraphicsItem : public QGraphicsObject {
     Q_OBJECT
 public:
+    // Level of detail, chosen by the editor from its zoom factor
+    enum class DetailLevel {
+        Full,        // すべて表示
+        Simplified,  // パラメータウィジェット・ソケット名なし
+        Minimal      // タイトル色の箱のみ（ソケットも非表示）
+    };
+    static DetailLevel detailLevelForZoom(qreal zoom);
+
     explicit NodeGraphicsItem(Node* node, QGraphicsItem* parent = nullptr);
     ~NodeGraphicsItem() override;
     
@@ -32,21 +43,43 @@ public:
     // ソケットの位置を取得
     QPointF getSocketPosition(NodeSocket* socket) const;
     
-    // プレビュー更新
+    // ソケットのビジュアル（非表示ソケットは nullptr）
+    NodeGraphicsSocket* socketItem(NodeSocket* socket) const;
+    const QVector<NodeGraphicsSocket*>& inputSocketItems() const { return m_inputSocketItems; }
+    const QVector<NodeGraphicsSocket*>& outputSocketItems() const { return m_outputSocketItems; }
+    
+    // プレビュー更新（パラメータ変更の通知も兼ねる）
+    // Marks the preview stale; it is requested again the next time the
+    // item is painted, so off-screen nodes cost nothing.
     void updatePreview();
 
     // レイアウト更新
     void updateLayout();
 
+    void setDetailLevel(DetailLevel level);
+    DetailLevel detailLevel() const { return m_detailLevel; }
+
 signals:
     void parameterChanged();
 
 protected:
     QVariant itemChange(GraphicsItemChange change, const QVariant& value) override;
     bool sceneEvent(QEvent *event) override;
+    void mousePressEvent(QGraphicsSceneMouseEvent* event) override;
+    void mouseMoveEvent(QGraphicsSceneMouseEvent* event) override;
+    void mouseReleaseEvent(QGraphicsSceneMouseEvent* event) override;
+    void hoverMoveEvent(QGraphicsSceneHoverEvent* event) override;
+    void hoverLeaveEvent(QGraphicsSceneHoverEvent* event) override;
 
 private:
     void updateGeometry();
+    void applyDetailLevel();
+    NodeSocket* previewSocket() const;
+    bool isInViewport() const;
+    int controlAt(const QPointF& pos) const;
+    // クリックされた操作部の編集を開始（入力欄・メニュー・ダイアログ）
+    void beginEdit(int index, const QPoint& screenPos);
+    void closeEditor();
     
     Node* m_node;
     QGraphicsTextItem* m_titleItem;
@@ -54,11 +87,27 @@ private:
     QVector<NodeGraphicsSocket*> m_inputSocketItems;
     QVector<NodeGraphicsSocket*> m_outputSocketItems;
     
-    // パラメータウィジェット
+    // パラメータ操作部（描画のみ）
+    QVector<ParameterControl> m_controls;
+    int m_activeControl = -1;   // 押下中
+    int m_hoverControl = -1;
+    QPointF m_pressPos;
+    bool m_controlDragging = false;
+    // 編集中だけ存在する入力欄
+    QPointer<QGraphicsProxyWidget> m_editor;
+    
+    // 描画では代替できない複合ウィジェット（カラーランプ）
     QVector<QGraphicsProxyWidget*> m_parameterWidgets;
     
     // プレビュー画像
     QPixmap m_previewPixmap;
+    bool m_hasPreview = false;
+    bool m_previewStale = true;
+    quint64 m_previewKey = 0;  // 要求中のプレビューのキー
+    
+    DetailLevel m_detailLevel = DetailLevel::Full;
+    QPainterPath m_bodyPath;   // updateLayout で更新
+    QPainterPath m_titlePath;
     
     // サイズ
     qreal m_width;
@@ -55,10 +55,16 @@ void NodeRegistry::registerNode(const QString& category, const QString& name, No
 }
 
 Node* NodeRegistry::createNode(const QString& name) {
-    if (m_nodes.contains(name)) {
-        return m_nodes[name].factory();
+    auto it = m_nodes.find(name);
+    if (it == m_nodes.end()) {
+        return nullptr;
     }
-    return nullptr;
+    Node* node = it->factory();
+    if (!it->parameterSchema) {
+        it->parameterSchema = std::make_shared<const QVector<Node::ParameterInfo>>(node->describeParameters());
+    }
+    node->m_parameterSchema = it->parameterSchema;
+    return node;
 }
 
 QStringList NodeRegistry::getCategories() const {
@@ -15,6 +15,8 @@ struct NodeRegistration {
     QString name;
     QString category;
     NodeFactory factory;
+    // 最初の生成時に作り、同じ型のノードすべてで共有する
+    std::shared_ptr<const QVector<Node::ParameterInfo>> parameterSchema;
 };
 
 class NodeRegistry {
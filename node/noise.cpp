@@ -1,5 +1,6 @@
 #include "noise.h"
 #include "OpenSimplex2.hpp"
+#include <cstring>
 
 PerlinNoise::PerlinNoise(unsigned int seed) : m_rng(seed) {
     // パーミュテーションテーブルの初期化
@@ -88,6 +89,86 @@ double PerlinNoise::noise(double x, double y, double z) const {
     return (res + 1.0) / 2.0;
 }
 
+void PerlinNoise::gradVector(int hash, double g[3]) {
+    // grad() の勾配ベクトル（±u ± v の係数）
+    int h = hash & 15;
+    g[0] = g[1] = g[2] = 0.0;
+    int uAxis = h < 8 ? 0 : 1;
+    int vAxis = h < 4 ? 1 : (h == 12 || h == 14 ? 0 : 2);
+    g[uAxis] += (h & 1) == 0 ? 1.0 : -1.0;
+    g[vAxis] += (h & 2) == 0 ? 1.0 : -1.0;
+}
+
+double PerlinNoise::noise(double x, double y, double z, double grad[3]) const {
+    int X = static_cast<int>(std::floor(x)) & 255;
+    int Y = static_cast<int>(std::floor(y)) & 255;
+    int Z = static_cast<int>(std::floor(z)) & 255;
+    
+    x -= std::floor(x);
+    y -= std::floor(y);
+    z -= std::floor(z);
+    
+    double u = fade(x);
+    double v = fade(y);
+    double w = fade(z);
+    // fade'(t) = 30t^2(t-1)^2
+    double du = 30.0 * x * x * (x - 1.0) * (x - 1.0);
+    double dv = 30.0 * y * y * (y - 1.0) * (y - 1.0);
+    double dw = 30.0 * z * z * (z - 1.0) * (z - 1.0);
+    
+    int A = p[X] + Y;
+    int AA = p[A] + Z;
+    int AB = p[A + 1] + Z;
+    int B = p[X + 1] + Y;
+    int BA = p[B] + Z;
+    int BB = p[B + 1] + Z;
+    
+    // 8つの角: ハッシュとセル内オフセット
+    const int hashes[8] = { p[AA], p[BA], p[AB], p[BB], p[AA + 1], p[BA + 1], p[AB + 1], p[BB + 1] };
+    double n[8];
+    double g[8][3];
+    for (int i = 0; i < 8; ++i) {
+        double ox = x - (i & 1);
+        double oy = y - ((i >> 1) & 1);
+        double oz = z - ((i >> 2) & 1);
+        gradVector(hashes[i], g[i]);
+        n[i] = g[i][0] * ox + g[i][1] * oy + g[i][2] * oz;
+    }
+    
+    // 三線形補間を展開: k0 + k1 u + k2 v + k3 w + k4 uv + k5 vw + k6 wu + k7 uvw
+    double k0 = n[0];
+    double k1 = n[1] - n[0];
+    double k2 = n[2] - n[0];
+    double k3 = n[4] - n[0];
+    double k4 = n[0] - n[1] - n[2] + n[3];
+    double k5 = n[0] - n[2] - n[4] + n[6];
+    double k6 = n[0] - n[1] - n[4] + n[5];
+    double k7 = -n[0] + n[1] + n[2] - n[3] + n[4] - n[5] - n[6] + n[7];
+    
+    double res = k0 + k1 * u + k2 * v + k3 * w + k4 * u * v + k5 * v * w + k6 * w * u + k7 * u * v * w;
+    
+    // 補間重みの微分 + 各角の勾配の重み付き和
+    for (int axis = 0; axis < 3; ++axis) {
+        double sum = 0.0;
+        for (int i = 0; i < 8; ++i) {
+            double wx = (i & 1) ? u : 1.0 - u;
+            double wy = ((i >> 1) & 1) ? v : 1.0 - v;
+            double wz = ((i >> 2) & 1) ? w : 1.0 - w;
+            sum += wx * wy * wz * g[i][axis];
+        }
+        grad[axis] = sum;
+    }
+    grad[0] += du * (k1 + k4 * v + k6 * w + k7 * v * w);
+    grad[1] += dv * (k2 + k5 * w + k4 * u + k7 * w * u);
+    grad[2] += dw * (k3 + k6 * u + k5 * v + k7 * u * v);
+    
+    // -1.0 ~ 1.0 を 0.0 ~ 1.0 に変換
+    grad[0] *= 0.5;
+    grad[1] *= 0.5;
+    grad[2] *= 0.5;
+    return (res + 1.0) / 2.0;
+}
+
 double PerlinNoise::noise(double x, double y) const {
     return noise(x, y, 0.0);
 }
@@ -236,6 +317,15 @@ double PerlinNoise::openSimplex2S(double x, double y, double z) const {
     return OpenSimplex2S::noise3_ImproveXZ(m_seed64, x, y, z) * 0.5 + 0.5;
 }
 
+double PerlinNoise::openSimplex2S(double x, double y, double z, double grad[3]) const {
+    float g[3];
+    double value = OpenSimplex2S::noise3_ImproveXZ(m_seed64, x, y, z, g) * 0.5 + 0.5;
+    grad[0] = g[0] * 0.5;
+    grad[1] = g[1] * 0.5;
+    grad[2] = g[2] * 0.5;
+    return value;
+}
+
 // OpenSimplex2F (Fast/SuperSimplex) - 3D Implementation (Rotated BCC)
 double PerlinNoise::openSimplex2F(double x, double y, double z) const {
     // Call integrated OpenSimplex2 library (SuperSimplex)
@@ -243,6 +333,15 @@ double PerlinNoise::openSimplex2F(double x, double y, double z) const {
     return OpenSimplex2::noise3_ImproveXZ(m_seed64, x, y, z) * 0.5 + 0.5;
 }
 
+double PerlinNoise::openSimplex2F(double x, double y, double z, double grad[3]) const {
+    float g[3];
+    double value = OpenSimplex2::noise3_ImproveXZ(m_seed64, x, y, z, g) * 0.5 + 0.5;
+    grad[0] = g[0] * 0.5;
+    grad[1] = g[1] * 0.5;
+    grad[2] = g[2] * 0.5;
+    return value;
+}
+
 
 // Ridged Multifractal
 double PerlinNoise::ridgedMultifractal(double x, double y, double z, int octaves, double lacunarity, double gain, double offset) const {
@@ -632,3 +731,43 @@ void PerlinNoise::clearEverlingCache() const {
     m_everlingBuffer.clear();
     m_cachedMean = -9999.0;
 }
+
+// Layout: size | accessMethod (i32), mean | stddev | clusterSpread (f64),
+// then size^3 doubles in host byte order (little endian on all targets)
+QByteArray PerlinNoise::saveEverlingCache() const {
+    if (m_everlingBuffer.isEmpty()) return QByteArray();
+
+    const qint32 header[2] = { m_cachedSize, static_cast<qint32>(m_cachedAccessMethod) };
+    const double params[3] = { m_cachedMean, m_cachedStdDev, m_cachedClusterSpread };
+    QByteArray data;
+    data.reserve(sizeof(header) + sizeof(params) + m_everlingBuffer.size() * sizeof(double));
+    data.append(reinterpret_cast<const char*>(header), sizeof(header));
+    data.append(reinterpret_cast<const char*>(params), sizeof(params));
+    data.append(reinterpret_cast<const char*>(m_everlingBuffer.constData()),
+                m_everlingBuffer.size() * sizeof(double));
+    return data;
+}
+
+bool PerlinNoise::restoreEverlingCache(const uchar* data, qint64 size) const {
+    const qint64 headerBytes = 2 * sizeof(qint32) + 3 * sizeof(double);
+    if (size < headerBytes) return false;
+
+    qint32 header[2];
+    double params[3];
+    std::memcpy(header, data, sizeof(header));
+    std::memcpy(params, data + sizeof(header), sizeof(params));
+    // 交換されたシーンファイルから来るので、サイズを計算する前に範囲を確かめる
+    if (header[0] <= 0 || header[0] > 1024) return false;
+    if (header[1] < int(EverlingAccessMethod::Stack) || header[1] > int(EverlingAccessMethod::Mixed)) return false;
+    const qint64 count = qint64(header[0]) * header[0] * header[0];
+    if (size != headerBytes + count * qint64(sizeof(double))) return false;
+
+    m_everlingBuffer.resize(count);
+    std::memcpy(m_everlingBuffer.data(), data + headerBytes, count * sizeof(double));
+    m_cachedSize = header[0];
+    m_cachedAccessMethod = static_cast<EverlingAccessMethod>(header[1]);
+    m_cachedMean = params[0];
+    m_cachedStdDev = params[1];
+    m_cachedClusterSpread = params[2];
+    return true;
+}
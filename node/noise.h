@@ -1,6 +1,7 @@
 #ifndef NOISE_H
 #define NOISE_H
 
+#include <QByteArray>
 #include <QVector>
 #include <QVector3D>
 #include <cmath>
@@ -54,6 +55,8 @@ public:
     
     // 3Dノイズ生成 (0.0 ~ 1.0)
     double noise(double x, double y, double z) const;
+    // 3Dノイズ + 解析的勾配 (grad = d/dx, d/dy, d/dz)
+    double noise(double x, double y, double z, double grad[3]) const;
     
     // オクターブノイズ - 複数の周波数を重ね合わせる
     double octaveNoise(double x, double y, int octaves, double persistence = 0.5) const;
@@ -67,9 +70,11 @@ public:
     
     // OpenSimplex2S (Smooth, default)
     double openSimplex2S(double x, double y, double z) const;
+    double openSimplex2S(double x, double y, double z, double grad[3]) const;
     
     // OpenSimplex2F (Fast/SuperSimplex)
     double openSimplex2F(double x, double y, double z) const;
+    double openSimplex2F(double x, double y, double z, double grad[3]) const;
     
     // Everling Noise (Procedural Texture via Integration)
     // mean: Gaussian Mean (controls bias/tendency)
@@ -86,6 +91,10 @@ public:
                          double distortion = 0.0, int octaves = 1, double lacunarity = 2.0, double gain = 0.5) const;
     void clearEverlingCache() const;
 
+    // シーンファイルにベイクするための Everling バッファの保存・復元
+    QByteArray saveEverlingCache() const;
+    bool restoreEverlingCache(const uchar* data, qint64 size) const;
+
     // Ridged Multifractal
     double ridgedMultifractal(double x, double y, double z, int octaves, double lacunarity = 2.0, double gain = 0.5, double offset = 1.0) const;
     
@@ -119,6 +128,7 @@ private:
     static double fade(double t);
     static double lerp(double t, double a, double b);
     static double grad(int hash, double x, double y, double z);
+    static void gradVector(int hash, double g[3]);
     
     // Simplex用
     static double dot(const int g[], double x, double y, double z);
@@ -1,4 +1,5 @@
 #include "noisetexturenode.h"
+#include "dual.h"
 #include <QVector3D>
 #include <QJsonObject>
 
@@ -64,34 +65,29 @@ NoiseTextureNode::NoiseTextureNode()
 
 NoiseTextureNode::~NoiseTextureNode() {}
 
-QVector<Node::ParameterInfo> NoiseTextureNode::parameters() const {
+QVector<Node::ParameterInfo> NoiseTextureNode::describeParameters() const {
     return {
         ParameterInfo("Dimensions", {"2D", "3D", "4D"}, 
-            QVariant::fromValue(static_cast<int>(m_dimensions)),
-            [this](const QVariant& v) { 
-                const_cast<NoiseTextureNode*>(this)->setDimensions(static_cast<Dimensions>(v.toInt())); 
-            }),
+            QVariant::fromValue(static_cast<int>(m_dimensions)))
+            .bind<NoiseTextureNode>([](const NoiseTextureNode& n) { return static_cast<int>(n.m_dimensions); },
+                                    [](NoiseTextureNode& n, const QVariant& v) { n.setDimensions(static_cast<Dimensions>(v.toInt())); }),
         ParameterInfo("Noise Type", 
             {"OpenSimplex2S", "OpenSimplex2F", "Perlin", "Simplex", "RidgedMultifractal", "White", "Ridged", "Gabor", "Everling"},
-            QVariant::fromValue(static_cast<int>(m_noiseType)),
-            [this](const QVariant& v) {
-                const_cast<NoiseTextureNode*>(this)->setNoiseType(static_cast<NoiseType>(v.toInt()));
-            }),
+            QVariant::fromValue(static_cast<int>(m_noiseType)))
+            .bind<NoiseTextureNode>([](const NoiseTextureNode& n) { return static_cast<int>(n.m_noiseType); },
+                                    [](NoiseTextureNode& n, const QVariant& v) { n.setNoiseType(static_cast<NoiseType>(v.toInt())); }),
         ParameterInfo("Fractal Type", 
             {"None", "FBM", "Multifractal", "Hybrid Multifractal", "Hetero Terrain", "Ridged Multifractal", "Division", "Linear Light"},
-            QVariant::fromValue(static_cast<int>(m_fractalType)),
-            [this](const QVariant& v) {
-                const_cast<NoiseTextureNode*>(this)->setFractalType(static_cast<FractalType>(v.toInt()));
-            }),
+            QVariant::fromValue(static_cast<int>(m_fractalType)))
+            .bind<NoiseTextureNode>([](const NoiseTextureNode& n) { return static_cast<int>(n.m_fractalType); },
+                                    [](NoiseTextureNode& n, const QVariant& v) { n.setFractalType(static_cast<FractalType>(v.toInt())); }),
         ParameterInfo("Distortion Type", {"Legacy", "Blender"},
-            QVariant::fromValue(static_cast<int>(m_distortionType)),
-            [this](const QVariant& v) {
-                const_cast<NoiseTextureNode*>(this)->setDistortionType(static_cast<DistortionType>(v.toInt()));
-            }),
-        ParameterInfo("Normalize", m_normalize,
-            [this](const QVariant& v) {
-                const_cast<NoiseTextureNode*>(this)->setNormalize(v.toBool());
-            }),
+            QVariant::fromValue(static_cast<int>(m_distortionType)))
+            .bind<NoiseTextureNode>([](const NoiseTextureNode& n) { return static_cast<int>(n.m_distortionType); },
+                                    [](NoiseTextureNode& n, const QVariant& v) { n.setDistortionType(static_cast<DistortionType>(v.toInt())); }),
+        ParameterInfo("Normalize", m_normalize)
+            .bind<NoiseTextureNode>([](const NoiseTextureNode& n) { return n.m_normalize; },
+                                    [](NoiseTextureNode& n, const QVariant& v) { n.setNormalize(v.toBool()); }),
         ParameterInfo("Scale", 0.0, 100.0, 5.0),
         ParameterInfo("Detail", 0.0, 15.0, 2.0),
         ParameterInfo("Roughness", 0.0, 1.0, 0.5),
@@ -549,6 +545,159 @@ QVariant NoiseTextureNode::compute(const QVector3D &pos, NodeSocket *socket)
     return QVariant();
 }
 
+bool NoiseTextureNode::computeDual(const QVector3D &pos, NodeSocket *socket, DualVec &out)
+{
+    // Fac 出力のみ。パラメータが画素ごとに変わる場合や、解析的勾配のない
+    // ノイズ / ディストーションは有限差分にフォールバックする
+    if (socket != m_facOutput) return false;
+    if (m_scaleInput->isConnected() || m_detailInput->isConnected() || m_roughnessInput->isConnected() ||
+        m_distortionInput->isConnected() || m_lacunarityInput->isConnected() || m_offsetInput->isConnected() ||
+        m_wInput->isConnected() || m_noiseTypeInput->isConnected()) {
+        return false;
+    }
+    if (m_distortionInput->defaultValue().toDouble() > 0.0) return false;
+    if (m_noiseType != NoiseType::OpenSimplex2S && m_noiseType != NoiseType::OpenSimplex2F &&
+        m_noiseType != NoiseType::Perlin && m_noiseType != NoiseType::Ridged) {
+        return false;
+    }
+
+    QMutexLocker locker(&m_mutex);
+    DualVec vec;
+    if (m_vectorInput->isConnected()) {
+        if (!m_vectorInput->getDual(pos, vec)) return false;
+    } else {
+        vec = DualVec(Dual(pos.x() / 512.0, 1.0 / 512.0, 0.0), Dual(pos.y() / 512.0, 0.0, 1.0 / 512.0), Dual(0.0));
+    }
+
+    const double scaleVal = m_scaleInput->defaultValue().toDouble();
+    const double detailVal = m_detailInput->defaultValue().toDouble();
+    const double roughnessVal = m_roughnessInput->defaultValue().toDouble();
+    const double lacunarityVal = m_lacunarityInput->defaultValue().toDouble();
+    const double offsetVal = m_offsetInput->defaultValue().toDouble();
+    const double wVal = m_wInput->defaultValue().toDouble();
+
+    // compute() と同じ座標変換
+    const double NOISE_OFFSET = 100.0;
+    DualVec p = vec * Dual(scaleVal) + DualVec(QVector3D(NOISE_OFFSET, NOISE_OFFSET, 0.0));
+    if (m_dimensions == Dimensions::D2) {
+        p.z = Dual(0.0);
+    }
+    if (m_dimensions == Dimensions::D4) {
+        p = p + DualVec::scalar(Dual(wVal * scaleVal));
+    }
+
+    const int octaves = static_cast<int>(detailVal);
+
+    // 基底ノイズ (-1..1) と勾配を Dual にまとめる
+    auto getBasis = [&](const DualVec& b) -> Dual {
+        double g[3];
+        double n = 0.0;
+        switch (m_noiseType) {
+            case NoiseType::OpenSimplex2S: n = m_noise->openSimplex2S(b.x.v, b.y.v, b.z.v, g); break;
+            case NoiseType::OpenSimplex2F: n = m_noise->openSimplex2F(b.x.v, b.y.v, b.z.v, g); break;
+            default: n = m_noise->noise(b.x.v, b.y.v, b.z.v, g); break;
+        }
+        Dual d(n * 2.0 - 1.0,
+               2.0 * (g[0] * b.x.du + g[1] * b.y.du + g[2] * b.z.du),
+               2.0 * (g[0] * b.x.dv + g[1] * b.y.dv + g[2] * b.z.dv));
+        if (m_noiseType == NoiseType::Ridged) {
+            d = (Dual(1.0) - abs(d)) * Dual(2.0) - Dual(1.0);
+        }
+        return d;
+    };
+
+    Dual val(0.0);
+    switch (m_fractalType) {
+        case FractalType::None:
+            val = getBasis(p);
+            break;
+        case FractalType::FBM: {
+            double freq = 1.0;
+            double amp = 1.0;
+            double maxAmp = 0.0;
+            for (int i = 0; i < octaves; ++i) {
+                val += getBasis(p * Dual(freq)) * Dual(amp);
+                maxAmp += amp;
+                freq *= lacunarityVal;
+                amp *= roughnessVal;
+            }
+            if (maxAmp > 0.0) val = val / Dual(maxAmp);
+            break;
+        }
+        case FractalType::Multifractal: {
+            val = Dual(1.0);
+            double freq = 1.0;
+            double pwr = 1.0;
+            for (int i = 0; i < octaves; ++i) {
+                val *= (Dual(offsetVal) + getBasis(p * Dual(freq))) * Dual(pwr);
+                freq *= lacunarityVal;
+                pwr *= roughnessVal;
+            }
+            break;
+        }
+        case FractalType::HybridMultifractal: {
+            double freq = lacunarityVal;
+            Dual result = getBasis(p) + Dual(offsetVal - 1.0);
+            Dual weight = result;
+            double pwr = roughnessVal;
+            double maxAmp = 1.0;
+            for (int i = 1; i < octaves; ++i) {
+                weight = dualClamp(weight, 0.0, 1.0);
+                Dual signal = getBasis(p * Dual(freq)) + Dual(offsetVal - 1.0);
+                result += weight * signal * Dual(pwr);
+                weight *= signal;
+                freq *= lacunarityVal;
+                maxAmp += pwr;
+                pwr *= roughnessVal;
+            }
+            val = result / Dual(maxAmp);
+            break;
+        }
+        case FractalType::HeteroTerrain: {
+            double freq = lacunarityVal;
+            Dual result = getBasis(p) + Dual(offsetVal - 1.0);
+            double pwr = roughnessVal;
+            double maxAmp = 1.0;
+            for (int i = 1; i < octaves; ++i) {
+                result += (getBasis(p * Dual(freq)) + Dual(offsetVal - 1.0)) * Dual(pwr);
+                freq *= lacunarityVal;
+                maxAmp += pwr;
+                pwr *= roughnessVal;
+            }
+            val = result / Dual(maxAmp);
+            break;
+        }
+        case FractalType::RidgedMultifractal: {
+            double freq = 1.0;
+            double amp = 1.0;
+            for (int i = 0; i < octaves; ++i) {
+                Dual signal = Dual(offsetVal) - abs(getBasis(p * Dual(freq)));
+                val += signal * signal * Dual(amp);
+                freq *= lacunarityVal;
+                amp *= roughnessVal;
+            }
+            break;
+        }
+        case FractalType::Division: {
+            Dual n01 = getBasis(p) * Dual(0.5) + Dual(0.5);
+            val = Dual(1.0) / (n01 + Dual(0.1));
+            break;
+        }
+        case FractalType::LinearLight: {
+            Dual n01 = getBasis(p) * Dual(0.5) + Dual(0.5);
+            val = Dual(2.0) * n01 - Dual(0.5);
+            break;
+        }
+    }
+
+    if (m_normalize) {
+        val = dualClamp(val * Dual(0.5) + Dual(0.5), 0.0, 1.0);
+    }
+
+    out = DualVec::scalar(val);
+    return true;
+}
+
 // Getters
 double NoiseTextureNode::scale() const { return m_scaleInput->defaultValue().toDouble(); }
 double NoiseTextureNode::detail() const { return m_detailInput->defaultValue().toDouble(); }
@@ -655,116 +804,6 @@ double NoiseTextureNode::getNoiseValue(double x, double y, double z) const {
     return noiseValue;
 }
 
-QColor NoiseTextureNode::getColorValue(double x, double y, double z) const {
-    QMutexLocker locker(&m_mutex);
-    // We need to compute full color here for preview
-    // This is a bit inefficient as we duplicate logic, but for preview it's fine
-    // Ideally we should refactor compute/evaluate to use a common noise generation method
-    
-    // For now, let's just call compute with a dummy socket if possible, or duplicate logic
-    // Since compute() is public and handles null socket gracefully (returns QVariant), 
-    // but we need specific socket to get specific output.
-    // Let's use the helper getNoiseValue for Fac (R) and calculate G/B similarly.
-    
-    double r = getNoiseValue(x, y, z);
-    
-    // We need to replicate the offsets used in evaluate/compute
-    // But getNoiseValue takes raw coordinates before scale/distortion? 
-    // No, getNoiseValue applies scale/distortion internally.
-    // So we can't just add offset to x,y,z passed to getNoiseValue because it would be scaled again.
-    // We need to add offset AFTER scale/distortion but BEFORE noise function.
-    // getNoiseValue doesn't expose that.
-    
-    // Simplest fix: Just use compute()!
-    // We need to construct a position vector.
-    // But compute() expects world position and applies scale/distortion.
-    // getColorValue is called with 0-1 UV coordinates.
-    // compute() handles this if vector input is not connected.
-    
-    // However, getColorValue is const, compute is not (in base class? No, compute is virtual).
-    // compute is not const in base class.
-    // We can cast away constness or fix design.
-    // For now, let's duplicate the offset logic inside getColorValue by copying getNoiseValue body and adding offsets.
-    
-    double scaleVal = scale();
-    double detailVal = detail();
-    double roughnessVal = roughness();
-    double distortionVal = distortion();
-    double lacunarityVal = lacunarity();
-    double offsetVal = offset();
-    double wVal = (m_dimensions == Dimensions::D4) ? w() : 0.0;
-    
-    auto calc = [&](double ox, double oy, double oz) {
-        double nx = x * scaleVal + ox;
-        double ny = y * scaleVal + oy;
-        double nz = z * scaleVal + oz;
-        
-        if (distortionVal > 0.0) {
-            nx += m_noise->noise(ny, nz) * distortionVal;
-            ny += m_noise->noise(nz, nx) * distortionVal;
-            nz += m_noise->noise(nx, ny) * distortionVal;
-        }
-        
-        if (m_dimensions == Dimensions::D4) {
-            nx += wVal;
-        }
-        
-        int octaves = static_cast<int>(detailVal);
-        switch (m_noiseType) {
-            case NoiseType::OpenSimplex2S: {
-                double val = 0.0;
-                double freq = 1.0;
-                double amp = 1.0;
-                double maxAmp = 0.0;
-                for (int i = 0; i < octaves; ++i) {
-                    val += m_noise->openSimplex2S(nx * freq, ny * freq, nz * freq) * amp;
-                    maxAmp += amp;
-                    freq *= lacunarityVal;
-                    amp *= roughnessVal;
-                }
-                return maxAmp > 0.0 ? val / maxAmp : 0.0;
-            }
-            case NoiseType::OpenSimplex2F: {
-                double val = 0.0;
-                double freq = 1.0;
-                double amp = 1.0;
-                double maxAmp = 0.0;
-                for (int i = 0; i < octaves; ++i) {
-                    val += m_noise->openSimplex2F(nx * freq, ny * freq, nz * freq) * amp;
-                    maxAmp += amp;
-                    freq *= lacunarityVal;
-                    amp *= roughnessVal;
-                }
-                return maxAmp > 0.0 ? val / maxAmp : 0.0;
-            }
-           case NoiseType::Perlin: return m_noise->octaveNoise(nx, ny, nz, octaves, roughnessVal);
-            case NoiseType::Simplex: return m_noise->simplexNoise(nx, ny, nz); // Simplex in getNoiseValue was simplified?
-            case NoiseType::RidgedMultifractal: return m_noise->ridgedMultifractal(nx, ny, nz, octaves, lacunarityVal, roughnessVal, offsetVal);
-            case NoiseType::White: return m_noise->whiteNoise(nx, ny, nz);
-            case NoiseType::Gabor: return m_noise->gaborNoise(nx, ny, nz, lacunarityVal, detailVal, roughnessVal);
-
-        }
-        return 0.0;
-    };
-    
-    // Note: Offsets here must match evaluate/compute. 
-    // In evaluate/compute, we added offsets to scaled coordinates.
-    // Here we add offsets to scaled coordinates too.
-    // But wait, in evaluate: x = vec.x * scale.
-    // Then calcNoise(x + ox, ...).
-    // So ox is added to scaled coordinate.
-    // Here: nx = x * scale + ox. Correct.
-    
-    // Offsets from evaluate:
-    // g: 123.45, 678.90, 42.0
-    // b: -42.0, 987.65, -123.45
-    
-    double g = calc(123.45, 678.90, 42.0);
-    double b = calc(-42.0, 987.65, -123.45);
-    
-    return QColor::fromRgbF(qBound(0.0, r, 1.0), qBound(0.0, g, 1.0), qBound(0.0, b, 1.0));
-}
-
 QJsonObject NoiseTextureNode::save() const {
     QJsonObject json = Node::save();
     json["noiseType"] = static_cast<int>(m_noiseType);
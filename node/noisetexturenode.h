@@ -17,6 +17,7 @@ public:
     // ノード評価
     void evaluate() override;
     QVariant compute(const QVector3D& pos, NodeSocket* socket) override;
+    bool computeDual(const QVector3D& pos, NodeSocket* socket, DualVec& out) override;
     
     // Serialization
     QJsonObject save() const override;
@@ -65,10 +66,10 @@ public:
     void setDistortionType(DistortionType t);
     void setNormalize(bool b);
 
-    QVector<ParameterInfo> parameters() const override;
-
     double getNoiseValue(double x, double y, double z) const;
-    QColor getColorValue(double x, double y, double z) const;
+
+protected:
+    QVector<ParameterInfo> describeParameters() const override;
 
 private:
     std::unique_ptr<PerlinNoise> m_noise;
@@ -4,8 +4,7 @@
 #include "appsettings.h"
 #include <QVector>
 #include <QVector4D>
-#include <QSemaphore>
-#include <QThreadPool>
+#include <QSet>
 
 OutputNode::OutputNode()
     : Node("Material Output")
@@ -26,7 +25,46 @@ void OutputNode::evaluate() {
     setDirty(false);
 }
 
-QImage OutputNode::render(const QVector<Node*>& nodes) const {
+// Collects every node feeding 'node' in dependency order (upstream first).
+// The graph keeps a topological rank per node, so an iterative walk plus a
+// sort replaces the recursive post-order (deep chains no longer recurse).
+static QVector<Node*> collectUpstream(Node* node) {
+    QVector<Node*> order;
+    QSet<Node*> visited;
+    if (!node) return order;
+    order.append(node);
+    visited.insert(node);
+    for (int i = 0; i < order.size(); ++i) {
+        for (NodeSocket* input : order[i]->inputSockets()) {
+            for (NodeSocket* source : input->connections()) {
+                Node* upstream = source->parentNode();
+                if (upstream && !visited.contains(upstream)) {
+                    visited.insert(upstream);
+                    order.append(upstream);
+                }
+            }
+        }
+    }
+    Node::sortTopologically(order);
+    return order;
+}
+
+void OutputNode::prepareUpstream(Node* node, int width, int height) {
+    const QVector<Node*> upstream = collectUpstream(node);
+    for (Node* n : upstream) {
+        n->prepareRender(width, height);
+    }
+}
+
+bool OutputNode::isUpstreamPrepared(Node* node, int width, int height) {
+    const QVector<Node*> upstream = collectUpstream(node);
+    for (Node* n : upstream) {
+        if (!n->isPrepared(width, height)) return false;
+    }
+    return true;
+}
+
+QImage OutputNode::render(const QVector<Node*>& nodes, RenderLane lane) const {
     // Get resolution from global AppSettings
     int width = AppSettings::instance().renderWidth();
     int height = AppSettings::instance().renderHeight();
@@ -61,12 +99,11 @@ QImage OutputNode::render(const QVector<Node*>& nodes) const {
     NodeSocket* sourceSocket = connections[0];
     Node* sourceNode = sourceSocket->parentNode();
     
-    // Parallel rendering processing rows
-    QVector<int> rows;
-    rows.reserve(height);
-    for (int y = 0; y < height; ++y) {
-        rows.append(y);
-    }
+    RenderScheduler::LaneScope laneScope(lane);
+
+    // Render-level passes (prefix sums, stencil buffers, ...) run once,
+    // upstream first, before any pixel is evaluated
+    prepareUpstream(sourceNode, width, height);
 
     auto processRow = [&](int y) {
         // Get raw byte pointer for RGBA8888
@@ -74,62 +111,49 @@ QImage OutputNode::render(const QVector<Node*>& nodes) const {
         for (int x = 0; x < width; ++x) {
             QVector3D pixelPos(x, y, 0.0);
             QVariant result = sourceNode->compute(pixelPos, sourceSocket);
-            
-            // Standardize color extraction
-            int r = 0, g = 0, b = 0, a = 255;
-            
-            if (result.canConvert<QVector4D>()) {
-                QVector4D vec = result.value<QVector4D>();
-                r = qBound(0, static_cast<int>(vec.x() * 255.0f), 255);
-                g = qBound(0, static_cast<int>(vec.y() * 255.0f), 255);
-                b = qBound(0, static_cast<int>(vec.z() * 255.0f), 255);
-                a = qBound(0, static_cast<int>(vec.w() * 255.0f), 255);
-            } else if (result.canConvert<QColor>()) {
-                QColor c = result.value<QColor>();
-                if (c.isValid()) {
-                    r = c.red(); g = c.green(); b = c.blue(); a = c.alpha();
-                }
-            } else if (result.canConvert<QVector3D>()) {
-                QVector3D vec = result.value<QVector3D>();
-                r = qBound(0, static_cast<int>((vec.x() * 0.5f + 0.5f) * 255.0f), 255);
-                g = qBound(0, static_cast<int>((vec.y() * 0.5f + 0.5f) * 255.0f), 255);
-                b = qBound(0, static_cast<int>((vec.z() * 0.5f + 0.5f) * 255.0f), 255);
-            } else if (result.canConvert<double>()) {
-                double val = result.toDouble();
-                if (!std::isnan(val)) {
-                    int gray = qBound(0, static_cast<int>(val * 255), 255);
-                    r = g = b = gray;
-                }
-            }
-            
-            // Explicit byte assignment: RGBA8888 = R, G, B, A
-            int offset = x * 4;
-            scanLine[offset + 0] = static_cast<uchar>(r);
-            scanLine[offset + 1] = static_cast<uchar>(g);
-            scanLine[offset + 2] = static_cast<uchar>(b);
-            scanLine[offset + 3] = static_cast<uchar>(a);
+            writePixel(result, scanLine + x * 4);
         }
     };
 
-    // Set thread count
-    int maxThreads = AppSettings::instance().maxThreads();
-    QThreadPool::globalInstance()->setMaxThreadCount(maxThreads);
-
-    // Parallel rendering using QThreadPool directly
-    // This avoids the 'astd' compilation error in QtConcurrent headers
-    QSemaphore sem(0);
+    // Parallel rendering processing rows
+    RenderContext::parallelFor(height, processRow, lane);
+    
+    return image;
+}
 
-    for (int y : rows) {
-        QThreadPool::globalInstance()->start([&, y]() {
-            processRow(y);
-            sem.release();
-        });
-    }
+// Standardize color extraction
+void OutputNode::writePixel(const QVariant& result, uchar* rgba) {
+    int r = 0, g = 0, b = 0, a = 255;
     
-    // Wait for all rows to finish
-    sem.acquire(height);
+    if (result.canConvert<QVector4D>()) {
+        QVector4D vec = result.value<QVector4D>();
+        r = qBound(0, static_cast<int>(vec.x() * 255.0f), 255);
+        g = qBound(0, static_cast<int>(vec.y() * 255.0f), 255);
+        b = qBound(0, static_cast<int>(vec.z() * 255.0f), 255);
+        a = qBound(0, static_cast<int>(vec.w() * 255.0f), 255);
+    } else if (result.canConvert<QColor>()) {
+        QColor c = result.value<QColor>();
+        if (c.isValid()) {
+            r = c.red(); g = c.green(); b = c.blue(); a = c.alpha();
+        }
+    } else if (result.canConvert<QVector3D>()) {
+        QVector3D vec = result.value<QVector3D>();
+        r = qBound(0, static_cast<int>((vec.x() * 0.5f + 0.5f) * 255.0f), 255);
+        g = qBound(0, static_cast<int>((vec.y() * 0.5f + 0.5f) * 255.0f), 255);
+        b = qBound(0, static_cast<int>((vec.z() * 0.5f + 0.5f) * 255.0f), 255);
+    } else if (result.canConvert<double>()) {
+        double val = result.toDouble();
+        if (!std::isnan(val)) {
+            int gray = qBound(0, static_cast<int>(val * 255), 255);
+            r = g = b = gray;
+        }
+    }
     
-    return image;
+    // Explicit byte assignment: RGBA8888 = R, G, B, A
+    rgba[0] = static_cast<uchar>(r);
+    rgba[1] = static_cast<uchar>(g);
+    rgba[2] = static_cast<uchar>(b);
+    rgba[3] = static_cast<uchar>(a);
 }
 
 QColor OutputNode::surfaceColor() const {
@@ -2,6 +2,7 @@
 #define OUTPUTNODE_H
 
 #include "node.h"
+#include "renderscheduler.h"
 #include <QColor>
 #include <QImage>
 
@@ -14,7 +15,17 @@ public:
     
     
     // 画像生成（ノードリストからTextureCoordinateNodeを探して解像度を取得）
-    QImage render(const QVector<Node*>& nodes) const;
+    // The lane decides the priority of the pixel work and of every
+    // parallel pass started from prepareRender.
+    QImage render(const QVector<Node*>& nodes, RenderLane lane = RenderLane::Interactive) const;
+    
+    // Runs prepareRender on 'node' and everything upstream of it, upstream first
+    static void prepareUpstream(Node* node, int width, int height);
+    // 'node' と上流の全ノードが isPrepared(width, height) か
+    static bool isUpstreamPrepared(Node* node, int width, int height);
+    
+    // compute() の結果を RGBA8888 の1ピクセルに変換
+    static void writePixel(const QVariant& result, uchar* rgba);
     
     // パラメータ取得
     QColor surfaceColor() const;
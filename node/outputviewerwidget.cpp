@@ -9,8 +9,10 @@
 OutputViewerWidget::OutputViewerWidget(QWidget* parent)
     : QWidget(parent)
     , m_dragEdge(None)
+    , m_hoverEdge(None)
     , m_isDragging(false)
     , m_isPanning(false)
+    , m_isViewPanning(false)
     , m_zoom(1.0)
 {
     setMouseTracking(true);
@@ -24,17 +26,25 @@ OutputViewerWidget::OutputViewerWidget(QWidget* parent)
 }
 
 void OutputViewerWidget::setImage(const QImage& image) {
+    if (image.size() != m_image.size()) {
+        // 解像度が変わったら表示倍率を合わせ直す
+        m_zoom = 1.0;
+        m_viewOffset = QPointF();
+    }
     m_image = image;
+    m_pyramid.setImage(image);
+    invalidateView();
     update();
 }
 
 void OutputViewerWidget::setSourceImage(const QImage& image) {
     m_sourceImage = image;
+    invalidateView();
     update();
 }
 
-QRect OutputViewerWidget::imageRect() const {
-    if (m_image.isNull()) return QRect();
+QRectF OutputViewerWidget::fitRect() const {
+    if (m_image.isNull()) return QRectF();
     
     // Fit image to widget while maintaining aspect ratio
     double widgetAspect = (double)width() / height();
@@ -51,20 +61,49 @@ QRect OutputViewerWidget::imageRect() const {
         imgW = imgH * imageAspect;
     }
     
-    imgW *= m_zoom;
-    imgH *= m_zoom;
-    
     int x = (width() - imgW) / 2;
     int y = (height() - imgH) / 2;
     
-    return QRect(x, y, imgW, imgH);
+    return QRectF(x, y, imgW, imgH);
+}
+
+QRectF OutputViewerWidget::imageRectF() const {
+    QRectF fit = fitRect();
+    if (fit.isNull()) return fit;
+    
+    QSizeF size = fit.size() * m_zoom;
+    QPointF center = fit.center() + m_viewOffset;
+    return QRectF(center.x() - size.width() / 2, center.y() - size.height() / 2, size.width(), size.height());
+}
+
+QRect OutputViewerWidget::imageRect() const {
+    return imageRectF().toRect();
+}
+
+void OutputViewerWidget::updateViewCache() {
+    const qreal dpr = devicePixelRatioF();
+    m_viewCache = QPixmap(size() * dpr);
+    m_viewCache.setDevicePixelRatio(dpr);
+    m_viewCache.fill(Qt::transparent);
+    
+    QPainter p(&m_viewCache);
+    
+    // Draw source image as background if available (darker)
+    if (!m_sourceImage.isNull()) {
+        p.setRenderHint(QPainter::SmoothPixmapTransform);
+        p.setOpacity(0.3);
+        p.drawImage(rect(), m_sourceImage);
+        p.setOpacity(1.0);
+    }
+    
+    // Draw the rendered output image (visible tiles only)
+    m_pyramid.draw(&p, imageRectF(), rect());
 }
 
 void OutputViewerWidget::paintEvent(QPaintEvent* event) {
     Q_UNUSED(event);
     
     QPainter p(this);
-    p.setRenderHint(QPainter::SmoothPixmapTransform);
     
     if (m_image.isNull()) {
         p.setPen(QColor(100, 100, 100));
@@ -74,19 +113,14 @@ void OutputViewerWidget::paintEvent(QPaintEvent* event) {
     
     QRect imgRect = imageRect();
     
-    // Draw source image as background if available (darker)
-    if (!m_sourceImage.isNull()) {
-        p.setOpacity(0.3);
-        p.drawImage(rect(), m_sourceImage);
-        p.setOpacity(1.0);
+    // 画像部分は表示サイズが変わったときだけ作り直す
+    if (m_viewCache.isNull() || m_viewCache.devicePixelRatio() != devicePixelRatioF()) {
+        updateViewCache();
     }
-    
-    // Draw the rendered output image
-    p.drawImage(imgRect, m_image);
+    p.drawPixmap(0, 0, m_viewCache);
     
     // Draw border around the image (this is what you can drag)
-    QPoint mousePos = mapFromGlobal(QCursor::pos());
-    DragEdge hoverEdge = hitTest(mousePos);
+    DragEdge hoverEdge = m_isDragging ? m_dragEdge : m_hoverEdge;
     
     const int handleSize = 8;
     QColor normalColor(100, 150, 255);
@@ -120,6 +154,9 @@ void OutputViewerWidget::paintEvent(QPaintEvent* event) {
         .arg(AppSettings::instance().viewportMinV(), 0, 'f', 2)
         .arg(AppSettings::instance().viewportMaxU(), 0, 'f', 2)
         .arg(AppSettings::instance().viewportMaxV(), 0, 'f', 2);
+    if (m_zoom != 1.0) {
+        info += QString(" | 表示 %1%").arg(qRound(imageRectF().width() / m_image.width() * 100.0));
+    }
     
     QRect infoRect(5, height() - 22, width() - 10, 18);
     p.fillRect(infoRect, QColor(0, 0, 0, 180));
@@ -176,7 +213,11 @@ void OutputViewerWidget::mousePressEvent(QMouseEvent* event) {
             m_dragStart = event->pos();
         }
     } else if (event->button() == Qt::MiddleButton) {
-        m_isPanning = true;
+        if (event->modifiers() & Qt::ControlModifier) {
+            m_isViewPanning = true;
+        } else {
+            m_isPanning = true;
+        }
         m_panStart = event->pos();
         setCursor(Qt::ClosedHandCursor);
     }
@@ -185,6 +226,9 @@ void OutputViewerWidget::mousePressEvent(QMouseEvent* event) {
 void OutputViewerWidget::mouseDoubleClickEvent(QMouseEvent* event) {
     Q_UNUSED(event);
     // Double-click to reset viewport to 0-1
+    m_zoom = 1.0;
+    m_viewOffset = QPointF();
+    invalidateView();
     AppSettings::instance().setViewportMinU(0.0);
     AppSettings::instance().setViewportMinV(0.0);
     AppSettings::instance().setViewportMaxU(1.0);
@@ -258,10 +302,19 @@ void OutputViewerWidget::mouseMoveEvent(QMouseEvent* event) {
         // Real-time update
         emit viewportChanged();
         update();
+    } else if (m_isViewPanning) {
+        m_viewOffset += event->pos() - m_panStart;
+        m_panStart = event->pos();
+        invalidateView();
+        update();
     } else {
+        // ハイライトが変わるときだけ再描画
         DragEdge edge = hitTest(event->pos());
-        updateCursor(edge);
-        update();
+        if (edge != m_hoverEdge) {
+            m_hoverEdge = edge;
+            updateCursor(edge);
+            update();
+        }
     }
 }
 
@@ -271,12 +324,44 @@ void OutputViewerWidget::mouseReleaseEvent(QMouseEvent* event) {
         m_dragEdge = None;
     } else if (event->button() == Qt::MiddleButton) {
         m_isPanning = false;
+        m_isViewPanning = false;
         setCursor(Qt::ArrowCursor);
     }
 }
 
+void OutputViewerWidget::leaveEvent(QEvent* event) {
+    Q_UNUSED(event);
+    if (m_hoverEdge != None) {
+        m_hoverEdge = None;
+        update();
+    }
+}
+
 void OutputViewerWidget::wheelEvent(QWheelEvent* event) {
     double delta = event->angleDelta().y() / 120.0;
+    
+    if ((event->modifiers() & Qt::ControlModifier) && !m_image.isNull()) {
+        // 表示だけの拡大縮小: keep the image point under the cursor in place
+        QRectF before = imageRectF();
+        QPointF cursor = event->position();
+        QPointF rel((cursor.x() - before.left()) / before.width(),
+                    (cursor.y() - before.top()) / before.height());
+        
+        // Up to 32 screen pixels per image pixel
+        double maxZoom = qMax(1.0, 32.0 * m_image.width() / fitRect().width());
+        m_zoom = qBound(1.0, m_zoom * std::pow(1.25, delta), maxZoom);
+        if (m_zoom == 1.0) {
+            m_viewOffset = QPointF();
+        } else {
+            QRectF after = imageRectF();
+            m_viewOffset += cursor - QPointF(after.left() + rel.x() * after.width(),
+                                             after.top() + rel.y() * after.height());
+        }
+        invalidateView();
+        update();
+        return;
+    }
+    
     double factor = 1.0 - delta * 0.1;
     
     double minU = AppSettings::instance().viewportMinU();
@@ -300,5 +385,6 @@ void OutputViewerWidget::wheelEvent(QWheelEvent* event) {
 
 void OutputViewerWidget::resizeEvent(QResizeEvent* event) {
     Q_UNUSED(event);
+    invalidateView();
     update();
 }
@@ -3,10 +3,13 @@
 
 #include <QWidget>
 #include <QImage>
+#include <QPixmap>
 #include <QPoint>
+#include "imagepyramid.h"
 
 // 出力ビューアーウィジェット
 // 端をドラッグしてビューポート範囲を変更可能
+// Ctrl+ホイールで表示だけを拡大（再レンダリングなし）、Ctrl+中ボタンで表示を移動
 class OutputViewerWidget : public QWidget {
     Q_OBJECT
     
@@ -28,6 +31,7 @@ protected:
     void mouseDoubleClickEvent(QMouseEvent* event) override;  // Reset on double-click
     void wheelEvent(QWheelEvent* event) override;
     void resizeEvent(QResizeEvent* event) override;
+    void leaveEvent(QEvent* event) override;
 
 private:
     enum DragEdge {
@@ -41,20 +45,30 @@ private:
     DragEdge hitTest(const QPoint& pos);
     void updateCursor(DragEdge edge);
     QRect imageRect() const;  // Get the rect where image is drawn
+    QRectF imageRectF() const;
+    QRectF fitRect() const;  // imageRectF() at zoom 1 without view offset
+    void invalidateView() { m_viewCache = QPixmap(); }
+    void updateViewCache();
     
     QImage m_image;
     QImage m_sourceImage;  // Original source image for background
+    ImagePyramid m_pyramid;  // m_image をタイル分割したもの
+    // 背景と画像を表示サイズで合成したもの。ホバーなどの再描画はこれを貼るだけ
+    QPixmap m_viewCache;
     QPoint m_dragStart;
     DragEdge m_dragEdge;
+    DragEdge m_hoverEdge;
     bool m_isDragging;
     
     // Panning support
     bool m_isPanning;
     QPoint m_panStart;
     QPointF m_panOffset;  // Current pan offset in UV space
+    bool m_isViewPanning;  // Ctrl+middle: moves the display only
     
-    // Zoom
+    // Display zoom (1 = fit to widget) and offset of the image centre in widget pixels
     double m_zoom;
+    QPointF m_viewOffset;
     
     // Edge detection margin
     static const int EDGE_MARGIN = 10;
@@ -0,0 +1,186 @@
+#include "parametercontrol.h"
+#include "appsettings.h"
+#include "node.h"
+#include <QColor>
+#include <QFileInfo>
+#include <QFontMetrics>
+#include <QPainter>
+#include <QPainterPath>
+#include <QVector3D>
+#include <cmath>
+
+namespace {
+
+const QColor kFrame(0x38, 0x38, 0x38);
+const QColor kFrameHover(0x44, 0x44, 0x44);
+const QColor kBorder(0x55, 0x55, 0x55);
+const QColor kFill(0x4a, 0x90, 0xd9, 150);
+const QColor kLabel(0xaa, 0xaa, 0xaa);
+
+void drawFrame(QPainter* painter, const QRectF& rect, bool hovered) {
+    painter->setPen(QPen(kBorder, 1));
+    painter->setBrush(hovered ? kFrameHover : kFrame);
+    painter->drawRoundedRect(rect, 3, 3);
+}
+
+QFont smallFont(const QPainter* painter, qreal pointSize) {
+    QFont font = painter->font();
+    font.setPointSizeF(pointSize);
+    return font;
+}
+
+} // namespace
+
+QVariant ParameterControl::value() const {
+    if (!socket) return cached;
+    const QVariant v = socket->defaultValue();
+    if (component >= 0 && component < 3) {
+        return v.value<QVector3D>()[component];
+    }
+    return v;
+}
+
+void ParameterControl::setValue(const QVariant& v) {
+    if (!socket) cached = v;
+    if (apply) apply(v);
+}
+
+double ParameterControl::sliderValueAt(qreal x) const {
+    const qreal t = rect.width() > 0 ? qBound<qreal>(0.0, (x - rect.left()) / rect.width(), 1.0) : 0.0;
+    double v = softMin + t * (softMax - softMin);
+    if (decimals == 0) {
+        v = std::round(v);
+    } else if (step > 0.0) {
+        // 細かすぎる値にならないよう step の 1/10 に丸める
+        const double snap = step * 0.1;
+        v = std::round(v / snap) * snap;
+    }
+    return v;
+}
+
+QString ParameterControl::valueText() const {
+    const QVariant v = value();
+    switch (kind) {
+    case Kind::Slider:
+        return QString::number(v.toDouble(), 'f', decimals);
+    case Kind::Enum: {
+        const int index = v.toInt();
+        return index >= 0 && index < items.size() ? items[index] : QString();
+    }
+    case Kind::File: {
+        const QString path = v.toString();
+        return path.isEmpty() ? QString() : QFileInfo(path).fileName();
+    }
+    case Kind::Text:
+        return v.toString();
+    default:
+        return QString();
+    }
+}
+
+void ParameterControl::paint(QPainter* painter, bool hovered, bool detailed) const {
+    painter->save();
+
+    // 外側のラベル
+    if (detailed && !labelRect.isEmpty() && !label.isEmpty() && kind != Kind::File) {
+        painter->setFont(smallFont(painter, 8));
+        painter->setPen(kLabel);
+        painter->drawText(labelRect, Qt::AlignLeft | Qt::AlignVCenter,
+                          painter->fontMetrics().elidedText(label, Qt::ElideRight, int(labelRect.width())));
+    }
+
+    switch (kind) {
+    case Kind::Slider: {
+        drawFrame(painter, rect, hovered);
+        if (softMax > softMin) {
+            const double t = qBound(0.0, (value().toDouble() - softMin) / (softMax - softMin), 1.0);
+            if (t > 0.0) {
+                QPainterPath clip;
+                clip.addRoundedRect(rect, 3, 3);
+                painter->setClipPath(clip);
+                painter->fillRect(QRectF(rect.left(), rect.top(), rect.width() * t, rect.height()), kFill);
+                painter->setClipping(false);
+            }
+        }
+        if (!detailed) break;
+        painter->setFont(smallFont(painter, 8));
+        painter->setPen(Qt::white);
+        const QRectF text = rect.adjusted(5, 0, -5, 0);
+        if (labelRect.isEmpty() && !label.isEmpty()) {
+            painter->drawText(text, Qt::AlignLeft | Qt::AlignVCenter, label);
+            painter->drawText(text, Qt::AlignRight | Qt::AlignVCenter, valueText());
+        } else {
+            painter->drawText(text, Qt::AlignCenter, valueText());
+        }
+        break;
+    }
+    case Kind::Enum: {
+        drawFrame(painter, rect, hovered);
+        // ▼
+        const qreal cx = rect.right() - 9;
+        const qreal cy = rect.center().y();
+        QPainterPath arrow;
+        arrow.moveTo(cx - 4, cy - 2);
+        arrow.lineTo(cx + 4, cy - 2);
+        arrow.lineTo(cx, cy + 3);
+        arrow.closeSubpath();
+        painter->setPen(Qt::NoPen);
+        painter->setBrush(detailed ? Qt::white : kLabel);
+        painter->drawPath(arrow);
+        if (!detailed) break;
+        painter->setFont(smallFont(painter, 8));
+        painter->setPen(Qt::white);
+        const QRectF text = rect.adjusted(5, 0, -20, 0);
+        painter->drawText(text, Qt::AlignLeft | Qt::AlignVCenter,
+                          painter->fontMetrics().elidedText(valueText(), Qt::ElideRight, int(text.width())));
+        break;
+    }
+    case Kind::Checkbox: {
+        const QRectF box(rect.left() + 2, rect.center().y() - 6, 12, 12);
+        drawFrame(painter, box, hovered);
+        if (value().toBool()) {
+            painter->setPen(QPen(QColor(0x4a, 0x90, 0xd9), 2));
+            painter->drawLine(QPointF(box.left() + 2.5, box.center().y()), QPointF(box.left() + 5, box.bottom() - 3));
+            painter->drawLine(QPointF(box.left() + 5, box.bottom() - 3), QPointF(box.right() - 2.5, box.top() + 3));
+        }
+        if (!detailed) break;
+        painter->setFont(smallFont(painter, 8));
+        painter->setPen(kLabel);
+        painter->drawText(rect.adjusted(20, 0, 0, 0), Qt::AlignLeft | Qt::AlignVCenter, label);
+        break;
+    }
+    case Kind::Color: {
+        painter->setPen(QPen(hovered ? QColor(0x77, 0x77, 0x77) : kBorder, 1));
+        painter->setBrush(value().value<QColor>());
+        painter->drawRoundedRect(rect, 3, 3);
+        break;
+    }
+    case Kind::File: {
+        drawFrame(painter, rect, hovered);
+        if (!detailed) break;
+        painter->setFont(smallFont(painter, 8));
+        painter->setPen(Qt::white);
+        painter->drawText(rect, Qt::AlignCenter, label);
+        if (!labelRect.isEmpty()) {
+            const QString name = valueText();
+            painter->setPen(kLabel);
+            painter->drawText(labelRect, Qt::AlignLeft | Qt::AlignVCenter,
+                              painter->fontMetrics().elidedText(name.isEmpty() ? AppSettings::instance().translate("No file") : name,
+                                                                Qt::ElideMiddle, int(labelRect.width())));
+        }
+        break;
+    }
+    case Kind::Text: {
+        drawFrame(painter, rect, hovered);
+        if (!detailed) break;
+        painter->setFont(smallFont(painter, 8));
+        painter->setPen(Qt::white);
+        const QRectF text = rect.adjusted(4, 0, -4, 0);
+        painter->drawText(text, Qt::AlignLeft | Qt::AlignVCenter,
+                          painter->fontMetrics().elidedText(valueText(), Qt::ElideRight, int(text.width())));
+        break;
+    }
+    }
+
+    painter->restore();
+}
@@ -0,0 +1,66 @@
+#ifndef PARAMETERCONTROL_H
+#define PARAMETERCONTROL_H
+
+#include <QRectF>
+#include <QString>
+#include <QStringList>
+#include <QVariant>
+#include <functional>
+
+class QPainter;
+class NodeSocket;
+
+// ノード上に直接描画するパラメータ操作部品
+// Painted by NodeGraphicsItem and hit-tested against 'rect'. A real widget
+// (spin box, line edit, menu, dialog) only exists while the control is
+// being edited, so a node costs a few rectangles instead of a tree of
+// proxied widgets.
+//
+// The value is read from the bound socket's default value (optionally one
+// vector component) or, for plain parameters, from 'cached'. Changes go
+// through 'apply', which updates the node the same way the old widgets did.
+class ParameterControl {
+public:
+    enum class Kind {
+        Slider,    // ドラッグで変更、クリックで数値入力
+        Enum,      // クリックでメニュー
+        Checkbox,
+        Color,     // クリックで色選択ダイアログ
+        File,      // クリックでファイル選択ダイアログ
+        Text       // クリックで1行入力
+    };
+
+    Kind kind = Kind::Slider;
+    QString label;       // 翻訳済みの表示名（空なら描かない）
+    QString tooltip;
+    QRectF labelRect;    // ラベルを操作部の外に描く場合の位置（空なら操作部の中）
+    QRectF rect;         // 操作部の矩形（ノード座標）
+
+    // Slider: the soft range is what dragging covers; typed values may
+    // go beyond it
+    double softMin = 0.0;
+    double softMax = 1.0;
+    double step = 0.1;
+    int decimals = 3;
+
+    // Enum: 表示名（"-" は区切り線で、インデックスには数える）
+    QStringList items;
+
+    NodeSocket* socket = nullptr;
+    int component = -1;   // ベクトルソケットの成分 (0..2)、-1 = 値全体
+    QVariant cached;      // socket が無い場合の現在値
+    std::function<void(const QVariant&)> apply;
+
+    QVariant value() const;
+    // 値を反映して 'apply' を呼ぶ
+    void setValue(const QVariant& v);
+
+    // スライダー上の x 座標に対応する値（ソフトレンジでクランプ、整数は丸め）
+    double sliderValueAt(qreal x) const;
+    QString valueText() const;
+
+    // 'detailed' = false draws only the frames (zoomed-out nodes)
+    void paint(QPainter* painter, bool hovered, bool detailed) const;
+};
+
+#endif // PARAMETERCONTROL_H
@@ -1,5 +1,6 @@
 #include "pointcreatenode.h"
 #include <cmath>
+#include <cstring>
 #include <algorithm>
 
 PointCreateNode::PointCreateNode()
@@ -226,19 +227,19 @@ QVariant PointCreateNode::compute(const QVector3D& pos, NodeSocket* socket) {
     return 0.0;
 }
 
-QVector<Node::ParameterInfo> PointCreateNode::parameters() const {
+QVector<Node::ParameterInfo> PointCreateNode::describeParameters() const {
     QVector<ParameterInfo> params;
     
     params.append(ParameterInfo(
         "Distribution", 
         {"Grid", "Random", "Poisson"},
-        QVariant::fromValue(static_cast<int>(m_distribution)),
-        [this](const QVariant& v) {
-            auto* node = const_cast<PointCreateNode*>(this);
-            node->m_distribution = static_cast<Distribution>(v.toInt());
-            node->setDirty(true);
-        },
-        "Point distribution type"));
+        QVariant::fromValue(static_cast<int>(m_distribution)), nullptr,
+        "Point distribution type")
+        .bind<PointCreateNode>([](const PointCreateNode& n) { return static_cast<int>(n.m_distribution); },
+                               [](PointCreateNode& n, const QVariant& v) {
+                                   n.m_distribution = static_cast<Distribution>(v.toInt());
+                                   n.setDirty(true);
+                               }));
     
     // These names MUST match the Input Sockets added above for alignment
     params.append(ParameterInfo("Count X", 1.0, 20.0, (double)m_countX, 1.0, "Grid columns"));
@@ -254,11 +255,11 @@ QVector<Node::ParameterInfo> PointCreateNode::parameters() const {
     seedInfo.defaultValue = m_seed;
     seedInfo.step = 1;
     seedInfo.tooltip = "Random seed";
-    seedInfo.setter = [this](const QVariant& v) {
-        auto* node = const_cast<PointCreateNode*>(this);
-        node->m_seed = v.toInt();
-        node->setDirty(true);
-    };
+    seedInfo.bind<PointCreateNode>([](const PointCreateNode& n) { return n.m_seed; },
+                                   [](PointCreateNode& n, const QVariant& v) {
+                                       n.m_seed = v.toInt();
+                                       n.setDirty(true);
+                                   });
     params.append(seedInfo);
     
     return params;
@@ -285,3 +286,38 @@ void PointCreateNode::restore(const QJsonObject& json) {
     if (json.contains("jitter")) m_jitter = json["jitter"].toDouble();
     if (json.contains("seed")) m_seed = json["seed"].toInt();
 }
+
+// Layout: seed | distribution | count | pointCount (i32), then x/y floats
+QByteArray PointCreateNode::saveBakedCache() const {
+    QMutexLocker locker(&m_mutex);
+    if (m_points.isEmpty()) return QByteArray();
+
+    const qint32 header[4] = { m_cachedSeed, static_cast<qint32>(m_cachedDist), m_cachedCount,
+                               static_cast<qint32>(m_points.size()) };
+    QByteArray data;
+    data.reserve(sizeof(header) + m_points.size() * 2 * sizeof(float));
+    data.append(reinterpret_cast<const char*>(header), sizeof(header));
+    for (const QVector2D& p : m_points) {
+        const float xy[2] = { p.x(), p.y() };
+        data.append(reinterpret_cast<const char*>(xy), sizeof(xy));
+    }
+    return data;
+}
+
+bool PointCreateNode::restoreBakedCache(const uchar* data, qint64 size) {
+    qint32 header[4];
+    if (size < qint64(sizeof(header))) return false;
+    std::memcpy(header, data, sizeof(header));
+    if (header[3] < 0 || size != qint64(sizeof(header)) + qint64(header[3]) * 2 * qint64(sizeof(float))) return false;
+
+    QMutexLocker locker(&m_mutex);
+    const float* xy = reinterpret_cast<const float*>(data + sizeof(header));
+    m_points.resize(header[3]);
+    for (int i = 0; i < header[3]; ++i) {
+        m_points[i] = QVector2D(xy[2 * i], xy[2 * i + 1]);
+    }
+    m_cachedSeed = header[0];
+    m_cachedDist = static_cast<Distribution>(header[1]);
+    m_cachedCount = header[2];
+    return true;
+}
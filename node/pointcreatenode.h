@@ -15,9 +15,10 @@ public:
     void evaluate() override;
     QVariant compute(const QVector3D& pos, NodeSocket* socket) override;
     
-    QVector<ParameterInfo> parameters() const override;
     QJsonObject save() const override;
     void restore(const QJsonObject& json) override;
+    QByteArray saveBakedCache() const override;
+    bool restoreBakedCache(const uchar* data, qint64 size) override;
     
     enum class Distribution {
         Grid,
@@ -25,6 +26,9 @@ public:
         Poisson
     };
     
+protected:
+    QVector<ParameterInfo> describeParameters() const override;
+
 private:
     // Input sockets
     NodeSocket* m_vectorInput;
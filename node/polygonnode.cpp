@@ -1,4 +1,5 @@
 #include "polygonnode.h"
+#include <algorithm>
 #include <cmath>
 
 #ifndef M_PI
@@ -19,65 +20,28 @@ PolygonNode::PolygonNode()
     
     m_distanceOutput = new NodeSocket("Distance", SocketType::Float, SocketDirection::Output, this);
     addOutputSocket(m_distanceOutput);
+    
+    rebuildGeometry();
 }
 
 PolygonNode::~PolygonNode() {}
 
 void PolygonNode::evaluate() {
-    // Stateless - computation in compute()
+    // Stateless - geometry is rebuilt by the setters
 }
 
-// Signed distance function for regular polygon
-double PolygonNode::polygonSDF(double x, double y, double sides, double radius, double rotation) const {
-    // Determine effective sides. 
-    // If sides < 2.0, clamp to 2 (digon/line) to avoid division by zero or negative.
-    // User wants 2.5 to be star. Standard formula works for fractional.
-    if (sides < 1.0) sides = 1.0;
-    
-    // Apply rotation
-    double rotRad = rotation * M_PI / 180.0;
-    double cosR = std::cos(rotRad);
-    double sinR = std::sin(rotRad);
-    double rx = x * cosR - y * sinR;
-    double ry = x * sinR + y * cosR;
-    
-    // Convert to polar coordinates
-    double angle = std::atan2(ry, rx);
-    double dist = std::sqrt(rx * rx + ry * ry);
-    
-    // Angle per side
-    double sideAngle = 2.0 * M_PI / sides;
-    
-    // Map angle to one sector
-    double sectorAngle = std::fmod(angle + M_PI, sideAngle) - sideAngle * 0.5;
-    
-    // Distance to polygon edge in this sector
-    double edgeDist = radius * std::cos(sideAngle * 0.5);
-    double projDist = dist * std::cos(sectorAngle);
-    
-    // Signed distance (negative inside, positive outside)
-    return projDist - edgeDist;
+void PolygonNode::rebuildGeometry() {
+    std::atomic_store(&m_geometry, buildGeometry());
 }
 
-// Helper logic for fractional sides implemented in compute/generate
-// sdStar removed to rely on robust sdArbitraryPolygon with reordered vertices
-
-
-QVariant PolygonNode::compute(const QVector3D& pos, NodeSocket* socket) {
-    QMutexLocker locker(&m_mutex);
-    
-    QVector3D vec;
-    if (m_vectorInput->isConnected()) {
-        vec = m_vectorInput->getValue(pos).value<QVector3D>();
-    } else {
-        vec = QVector3D(pos.x() / 512.0 - 0.5, pos.y() / 512.0 - 0.5, 0.0);
-    }
+std::shared_ptr<const PolygonNode::Geometry> PolygonNode::buildGeometry() const {
+    auto g = std::make_shared<Geometry>();
     
     double sides = qBound(2.0, m_sides, 32.0);
     double radius = qBound(0.01, m_radius, 1.0);
     double rotation = m_rotation;
     
-    double sdf;
+    QList<QVector2D> verts;
     
     if (m_seed == 0) {
         // Star Detection: Check if sides is fractional P/Q
@@ -104,37 +68,90 @@ QVariant PolygonNode::compute(const QVector3D& pos, NodeSocket* socket) {
             
             // Reorder vertices based on stride Q
             // e.g. 5/2: 0 -> 2 -> 4 -> 1 -> 3 -> (0)
-            QList<QVector2D> starVerts;
             int currentIdx = 0;
-            // We need to visit all vertices. 
-            // For standard star polygons (P, Q coprime), this loops P times.
-            bool *visited = new bool[bestP]; // Simple safety
-            for(int i=0; i<bestP; ++i) visited[i] = false;
-            
             for (int i = 0; i < bestP; ++i) {
-                starVerts.append(polyVerts[currentIdx]);
-                visited[currentIdx] = true;
+                verts.append(polyVerts[currentIdx]);
                 currentIdx = (currentIdx + bestQ) % bestP;
             }
-            delete[] visited;
-            
-            // Render using arbitrary polygon logic which handles self-intersection (Odd-Even rule)
-            sdf = sdArbitraryPolygon(starVerts, QVector2D(vec.x(), vec.y()));
-            
         } else {
             // Regular Polygon
-            sdf = polygonSDF(vec.x(), vec.y(), sides, radius, rotation);
+            // If sides < 2.0, clamp to 2 (digon/line) to avoid division by zero or negative.
+            if (sides < 1.0) sides = 1.0;
+            double rotRad = rotation * M_PI / 180.0;
+            g->regular = true;
+            g->sides = sides;
+            g->radius = radius;
+            g->cosR = std::cos(rotRad);
+            g->sinR = std::sin(rotRad);
+            g->sideAngle = 2.0 * M_PI / sides;
+            g->edgeDist = radius * std::cos(g->sideAngle * 0.5);
+            return g;
         }
     } else {
         // Irregular polygon (Seed != 0)
         int sidesInt = static_cast<int>(std::round(sides));
         if (sidesInt < 3) sidesInt = 3;
-        
-        QVector2D p(vec.x(), vec.y());
-        QList<QVector2D> v = generateVertices(sidesInt, radius, rotation, m_seed);
-        sdf = sdArbitraryPolygon(v, p);
+        verts = generateVertices(sidesInt, radius, rotation, m_seed);
+    }
+    
+    // 辺 (v[j] -> v[i]) を配列に展開
+    g->regular = false;
+    const int n = verts.size();
+    g->vx.resize(n); g->vy.resize(n);
+    g->ex.resize(n); g->ey.resize(n);
+    g->invLen2.resize(n); g->ey1.resize(n);
+    for (int i = 0, j = n - 1; i < n; j = i, i++) {
+        QVector2D e = verts[j] - verts[i];
+        g->vx[i] = verts[i].x();
+        g->vy[i] = verts[i].y();
+        g->ex[i] = e.x();
+        g->ey[i] = e.y();
+        g->invLen2[i] = 1.0f / QVector2D::dotProduct(e, e);
+        g->ey1[i] = verts[j].y();
+    }
+    return g;
+}
+
+// Signed distance function for regular polygon
+double PolygonNode::polygonSDF(const Geometry& g, double x, double y) {
+    // Apply rotation
+    double rx = x * g.cosR - y * g.sinR;
+    double ry = x * g.sinR + y * g.cosR;
+    
+    // Convert to polar coordinates
+    double angle = std::atan2(ry, rx);
+    double dist = std::sqrt(rx * rx + ry * ry);
+    
+    // Map angle to one sector
+    double sectorAngle = std::fmod(angle + M_PI, g.sideAngle) - g.sideAngle * 0.5;
+    
+    // Distance to polygon edge in this sector
+    double projDist = dist * std::cos(sectorAngle);
+    
+    // Signed distance (negative inside, positive outside)
+    return projDist - g.edgeDist;
+}
+
+double PolygonNode::Geometry::distance(float x, float y) const {
+    return regular ? polygonSDF(*this, x, y) : sdArbitraryPolygon(*this, x, y);
+}
+
+void PolygonNode::Geometry::distance(const float* x, const float* y, double* out, int count) const {
+    for (int k = 0; k < count; ++k) {
+        out[k] = distance(x[k], y[k]);
+    }
+}
+
+QVariant PolygonNode::compute(const QVector3D& pos, NodeSocket* socket) {
+    QVector3D vec;
+    if (m_vectorInput->isConnected()) {
+        vec = m_vectorInput->getValue(pos).value<QVector3D>();
+    } else {
+        vec = QVector3D(pos.x() / 512.0 - 0.5, pos.y() / 512.0 - 0.5, 0.0);
     }
     
+    double sdf = std::atomic_load(&m_geometry)->distance(vec.x(), vec.y());
+    
     if (socket == m_distanceOutput) return sdf;
     
     if (m_fill) {
@@ -144,7 +161,7 @@ QVariant PolygonNode::compute(const QVector3D& pos, NodeSocket* socket) {
     }
 }
 
-QVector<Node::ParameterInfo> PolygonNode::parameters() const {
+QVector<Node::ParameterInfo> PolygonNode::describeParameters() const {
     QVector<ParameterInfo> params;
     
     // Sides with setter (Float now)
@@ -156,9 +173,8 @@ QVector<Node::ParameterInfo> PolygonNode::parameters() const {
     sidesInfo.defaultValue = m_sides;
     sidesInfo.step = 0.1; // Finer step for smooth transition
     sidesInfo.tooltip = "Number of sides (fractional supported)";
-    sidesInfo.setter = [this](const QVariant& v) {
-        const_cast<PolygonNode*>(this)->setSides(v.toDouble());
-    };
+    sidesInfo.bind<PolygonNode>([](const PolygonNode& n) { return n.m_sides; },
+                                [](PolygonNode& n, const QVariant& v) { n.setSides(v.toDouble()); });
     params.append(sidesInfo);
     
     // Radius with setter
@@ -170,9 +186,8 @@ QVector<Node::ParameterInfo> PolygonNode::parameters() const {
     radiusInfo.defaultValue = m_radius;
     radiusInfo.step = 0.01;
     radiusInfo.tooltip = "Polygon radius";
-    radiusInfo.setter = [this](const QVariant& v) {
-        const_cast<PolygonNode*>(this)->setRadius(v.toDouble());
-    };
+    radiusInfo.bind<PolygonNode>([](const PolygonNode& n) { return n.m_radius; },
+                                 [](PolygonNode& n, const QVariant& v) { n.setRadius(v.toDouble()); });
     params.append(radiusInfo);
     
     // Rotation with setter
@@ -184,16 +199,14 @@ QVector<Node::ParameterInfo> PolygonNode::parameters() const {
     rotInfo.defaultValue = m_rotation;
     rotInfo.step = 1.0;
     rotInfo.tooltip = "Rotation in degrees";
-    rotInfo.setter = [this](const QVariant& v) {
-        const_cast<PolygonNode*>(this)->setRotation(v.toDouble());
-    };
+    rotInfo.bind<PolygonNode>([](const PolygonNode& n) { return n.m_rotation; },
+                              [](PolygonNode& n, const QVariant& v) { n.setRotation(v.toDouble()); });
     params.append(rotInfo);
     
-    params.append(ParameterInfo("Fill", m_fill,
-        [this](const QVariant& v) {
-            const_cast<PolygonNode*>(this)->setFill(v.toBool());
-        },
-        "Fill interior (off = edge only)"));
+    params.append(ParameterInfo("Fill", m_fill, nullptr,
+        "Fill interior (off = edge only)")
+        .bind<PolygonNode>([](const PolygonNode& n) { return n.m_fill; },
+                           [](PolygonNode& n, const QVariant& v) { n.setFill(v.toBool()); }));
     
     // Edge Width with setter
     ParameterInfo edgeInfo;
@@ -204,9 +217,8 @@ QVector<Node::ParameterInfo> PolygonNode::parameters() const {
     edgeInfo.defaultValue = m_edgeWidth;
     edgeInfo.step = 0.001;
     edgeInfo.tooltip = "Edge line width";
-    edgeInfo.setter = [this](const QVariant& v) {
-        const_cast<PolygonNode*>(this)->setEdgeWidth(v.toDouble());
-    };
+    edgeInfo.bind<PolygonNode>([](const PolygonNode& n) { return n.m_edgeWidth; },
+                               [](PolygonNode& n, const QVariant& v) { n.setEdgeWidth(v.toDouble()); });
     params.append(edgeInfo);
     
     // Seed parameter
@@ -217,17 +229,16 @@ QVector<Node::ParameterInfo> PolygonNode::parameters() const {
     seedInfo.max = 10000;
     seedInfo.defaultValue = m_seed;
     seedInfo.tooltip = "Random seed (0 = regular polygon)";
-    seedInfo.setter = [this](const QVariant& v) {
-        const_cast<PolygonNode*>(this)->setSeed(v.toInt());
-    };
+    seedInfo.bind<PolygonNode>([](const PolygonNode& n) { return n.m_seed; },
+                               [](PolygonNode& n, const QVariant& v) { n.setSeed(v.toInt()); });
     params.append(seedInfo);
     
     return params;
 }
 
-void PolygonNode::setSides(double v) { m_sides = v; setDirty(true); }
-void PolygonNode::setRadius(double v) { m_radius = v; setDirty(true); }
-void PolygonNode::setRotation(double v) { m_rotation = v; setDirty(true); }
+void PolygonNode::setSides(double v) { m_sides = v; rebuildGeometry(); setDirty(true); }
+void PolygonNode::setRadius(double v) { m_radius = v; rebuildGeometry(); setDirty(true); }
+void PolygonNode::setRotation(double v) { m_rotation = v; rebuildGeometry(); setDirty(true); }
 void PolygonNode::setFill(bool v) { m_fill = v; setDirty(true); }
 void PolygonNode::setEdgeWidth(double v) { m_edgeWidth = v; setDirty(true); }
 QJsonObject PolygonNode::save() const {
@@ -250,44 +261,43 @@ void PolygonNode::restore(const QJsonObject& json) {
     if (json.contains("fill")) m_fill = json["fill"].toBool();
     if (json.contains("edgeWidth")) m_edgeWidth = json["edgeWidth"].toDouble();
     if (json.contains("seed")) m_seed = json["seed"].toInt();
+    rebuildGeometry();
 }
 
-void PolygonNode::setSeed(int v) { m_seed = v; setDirty(true); }
+void PolygonNode::setSeed(int v) { m_seed = v; rebuildGeometry(); setDirty(true); }
 
-double PolygonNode::sdArbitraryPolygon(const QList<QVector2D>& v, const QVector2D& p) const {
-    double d = QVector2D::dotProduct(p - v[0], p - v[0]);
-    double s = 1.0;
-    int winding = 0;
+double PolygonNode::sdArbitraryPolygon(const Geometry& g, float px, float py) {
+    const int n = static_cast<int>(g.vx.size());
+    const float* vx = g.vx.data();
+    const float* vy = g.vy.data();
+    const float* ex = g.ex.data();
+    const float* ey = g.ey.data();
+    const float* invLen2 = g.invLen2.data();
+    const float* ey1 = g.ey1.data();
     
-    for (int i = 0, j = v.size() - 1; i < v.size(); j = i, i++) {
-        QVector2D e = v[j] - v[i];
-        QVector2D w = p - v[i];
-        QVector2D b = w - e * std::clamp(QVector2D::dotProduct(w, e) / QVector2D::dotProduct(e, e), 0.0f, 1.0f);
+    // 分岐なしのループ（辺方向にベクトル化される）
+    float d = (px - vx[0]) * (px - vx[0]) + (py - vy[0]) * (py - vy[0]);
+    int winding = 0;
+    for (int i = 0; i < n; ++i) {
+        const float wx = px - vx[i];
+        const float wy = py - vy[i];
+        const float t = std::clamp((wx * ex[i] + wy * ey[i]) * invLen2[i], 0.0f, 1.0f);
+        const float bx = wx - ex[i] * t;
+        const float by = wy - ey[i] * t;
         
         // Exact distance to segment
-        d = std::min(d, static_cast<double>(QVector2D::dotProduct(b, b)));
-        
-        // Winding Number Calculation
-        bool cond1 = p.y() >= v[i].y();
-        bool cond2 = p.y() < v[j].y();
+        d = std::min(d, bx * bx + by * by);
         
-        if (cond1 && cond2) {
-             // Upward crossing
-             // Check if P is to the left of edge
-             if (e.x() * w.y() - e.y() * w.x() > 0) winding++;
-        } else if (!cond1 && !cond2) {
-             // Downward crossing (v[j].y <= p.y < v[i].y)
-             // Check if P is to the right? No, standard algorithm:
-             // if (v[i].y > p.y && v[j].y <= p.y)
-             if (e.x() * w.y() - e.y() * w.x() < 0) winding--;
-        }
+        // Winding Number Calculation (Non-Zero Rule)
+        const bool cond1 = py >= vy[i];
+        const bool cond2 = py < ey1[i];
+        const float cross = ex[i] * wy - ey[i] * wx;
+        winding += int(cond1 && cond2 && cross > 0) - int(!cond1 && !cond2 && cross < 0);
     }
     
-    // Determine sign based on winding number (Non-Zero Rule)
     // If winding != 0, we are inside.
-    if (winding != 0) s = -1.0;
-    
-    return s * std::sqrt(d);
+    double s = winding != 0 ? -1.0 : 1.0;
+    return s * std::sqrt(static_cast<double>(d));
 }
 
 QList<QVector2D> PolygonNode::generateVertices(int sides, double radius, double rotation, int seed) const {
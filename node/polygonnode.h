@@ -2,7 +2,8 @@
 #define POLYGONNODE_H
 
 #include "node.h"
-#include <QRecursiveMutex>
+#include <memory>
+#include <vector>
 
 // Polygon Node - Generates regular polygon shapes
 class PolygonNode : public Node {
@@ -13,10 +14,12 @@ public:
     void evaluate() override;
     QVariant compute(const QVector3D& pos, NodeSocket* socket) override;
     
-    QVector<ParameterInfo> parameters() const override;
     QJsonObject save() const override;
     void restore(const QJsonObject& json) override;
     
+protected:
+    QVector<ParameterInfo> describeParameters() const override;
+
 private:
     // Input sockets (only Vector for coordinates)
     NodeSocket* m_vectorInput;
@@ -41,13 +44,36 @@ private:
     void setEdgeWidth(double v);
     void setSeed(int v);
     
-    mutable QRecursiveMutex m_mutex;
+    // パラメータ変更ごとに作り直す不変の形状データ（compute はロック不要）
+    // Either the regular-polygon constants or the edge list of a star /
+    // irregular polygon, stored as arrays so the edge loop vectorizes.
+    struct Geometry {
+        bool regular = true;
+        double sides = 0.0;
+        double radius = 0.0;
+        double cosR = 1.0;
+        double sinR = 0.0;
+        double sideAngle = 0.0;
+        double edgeDist = 0.0;
+
+        std::vector<float> vx, vy;   // edge start (v[i])
+        std::vector<float> ex, ey;   // v[j] - v[i]
+        std::vector<float> invLen2;  // 1 / dot(e, e)
+        std::vector<float> ey1;      // v[j].y (winding test)
+
+        double distance(float x, float y) const;
+        void distance(const float* x, const float* y, double* out, int count) const;
+    };
+    std::shared_ptr<const Geometry> m_geometry;
+
+    void rebuildGeometry();
+    std::shared_ptr<const Geometry> buildGeometry() const;
     
     // Helper: compute signed distance to polygon edge
-    double polygonSDF(double x, double y, double sides, double radius, double rotation) const;
+    static double polygonSDF(const Geometry& g, double x, double y);
     
     // Helper: compute signed distance to arbitrary polygon
-    double sdArbitraryPolygon(const QList<QVector2D>& v, const QVector2D& p) const;
+    static double sdArbitraryPolygon(const Geometry& g, float px, float py);
     
     // Helper: generate vertices with optional randomization
     QList<QVector2D> generateVertices(int sides, double radius, double rotation, int seed) const;
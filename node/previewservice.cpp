@@ -0,0 +1,209 @@
+#include "previewservice.h"
+#include "appsettings.h"
+#include "node.h"
+#include "outputnode.h"
+#include "rendercontext.h"
+#include "renderscheduler.h"
+#include <QElapsedTimer>
+#include <QSet>
+
+namespace {
+
+constexpr int kCacheBudgetKB = 32 * 1024;   // 32 MiB
+constexpr qint64 kSliceBudgetNs = 6000000;  // 1スライスあたり約 6ms
+
+void renderSize(int& width, int& height) {
+    width = qBound(1, AppSettings::instance().renderWidth(), 8192);
+    height = qBound(1, AppSettings::instance().renderHeight(), 8192);
+}
+
+// ノードと上流の全ノードの出力が確定しているか
+bool contentReady(Node* node) {
+    QVector<Node*> stack{node};
+    QSet<Node*> visited{node};
+    while (!stack.isEmpty()) {
+        Node* current = stack.takeLast();
+        if (!current->isContentReady()) return false;
+        for (NodeSocket* input : current->inputSockets()) {
+            for (NodeSocket* source : input->connections()) {
+                Node* upstream = source->parentNode();
+                if (upstream && !visited.contains(upstream)) {
+                    visited.insert(upstream);
+                    stack.append(upstream);
+                }
+            }
+        }
+    }
+    return true;
+}
+
+} // namespace
+
+PreviewService& PreviewService::instance() {
+    static PreviewService service;
+    return service;
+}
+
+PreviewService::PreviewService() {
+    m_cache.setMaxCost(kCacheBudgetKB);
+
+    m_timer.setSingleShot(true);
+    m_timer.setInterval(0);
+    connect(&m_timer, &QTimer::timeout, this, &PreviewService::processSlice);
+
+    // The cache key includes the render settings, so old entries simply stop
+    // matching; only the queued work has to go.
+    auto settingsChanged = [this]() {
+        m_queue.clear();
+        m_waiting.clear();
+        emit invalidated();
+    };
+    connect(&AppSettings::instance(), &AppSettings::renderResolutionChanged, this, settingsChanged);
+    connect(&AppSettings::instance(), &AppSettings::viewportRangeChanged, this, settingsChanged);
+}
+
+quint64 PreviewService::keyFor(NodeSocket* socket, int size) {
+    // The content key is memoized on each node until it is invalidated
+    Node* node = socket->parentNode();
+    QHash<Node*, quint64> keys;
+    const quint64 content = Node::contentKey(node, keys);
+
+    int width, height;
+    renderSize(width, height);
+    const AppSettings& settings = AppSettings::instance();
+    return qHashMulti(size_t(content), node->outputSockets().indexOf(socket), size, width, height,
+                      settings.viewportMinU(), settings.viewportMinV(),
+                      settings.viewportMaxU(), settings.viewportMaxV());
+}
+
+bool PreviewService::request(NodeSocket* socket, int size, std::function<bool()> visible,
+                             quint64* key, QImage* image) {
+    if (!socket || !socket->parentNode() || size <= 0) return false;
+
+    const quint64 k = keyFor(socket, size);
+    if (key) *key = k;
+    if (QImage* cached = m_cache.object(k)) {
+        if (image) *image = *cached;
+        return true;
+    }
+
+    for (int i = 0; i < m_queue.size(); ++i) {
+        if (m_queue[i].socket == socket) {
+            if (m_queue[i].key == k) return false;  // 同じ内容を生成中
+            m_queue.removeAt(i);
+            break;
+        }
+    }
+    for (int i = 0; i < m_waiting.size(); ++i) {
+        if (m_waiting[i].socket == socket) {
+            if (m_waiting[i].key == k) return false;  // レンダー待ち
+            m_waiting.removeAt(i);
+            break;
+        }
+    }
+
+    Job job;
+    job.socket = socket;
+    job.size = size;
+    job.key = k;
+    job.visible = std::move(visible);
+    m_queue.append(job);
+    schedule();
+    return false;
+}
+
+void PreviewService::cancel(Node* node) {
+    for (int i = m_queue.size() - 1; i >= 0; --i) {
+        if (m_queue[i].socket->parentNode() == node) {
+            m_queue.removeAt(i);
+        }
+    }
+    for (int i = m_waiting.size() - 1; i >= 0; --i) {
+        if (m_waiting[i].socket->parentNode() == node) {
+            m_waiting.removeAt(i);
+        }
+    }
+}
+
+void PreviewService::renderPrepared() {
+    if (m_waiting.isEmpty()) return;
+    m_queue.append(m_waiting);
+    m_waiting.clear();
+    schedule();
+}
+
+void PreviewService::schedule() {
+    if (!m_queue.isEmpty() && !m_timer.isActive()) {
+        m_timer.start();
+    }
+}
+
+void PreviewService::processSlice() {
+    if (m_queue.isEmpty()) return;
+
+    Job& job = m_queue.first();
+    NodeSocket* socket = job.socket;
+    Node* node = socket->parentNode();
+
+    int width, height;
+    renderSize(width, height);
+    RenderScheduler::LaneScope laneScope(RenderLane::Thumbnail);
+
+    if (job.nextRow < 0) {
+        if (job.visible && !job.visible()) {
+            m_queue.removeFirst();
+            emit previewSkipped(socket);
+            schedule();
+            return;
+        }
+        // Same render-level passes as the main render. Building whole-image
+        // data at the render size would block the GUI thread far beyond the
+        // slice budget, so such requests wait for the next main render.
+        if (!OutputNode::isUpstreamPrepared(node, width, height)) {
+            m_waiting.append(m_queue.takeFirst());
+            schedule();
+            return;
+        }
+        OutputNode::prepareUpstream(node, width, height);
+        job.cacheable = contentReady(node);
+        job.image = QImage(job.size, job.size, QImage::Format_RGBA8888);
+        job.nextRow = 0;
+    }
+
+    const int size = job.size;
+    const int rows = qMin(m_rowsPerSlice, size - job.nextRow);
+    const int firstRow = job.nextRow;
+    QImage& image = job.image;
+
+    QElapsedTimer timer;
+    timer.start();
+    RenderContext::parallelFor(rows, [&](int r) {
+        const int y = firstRow + r;
+        // プレビューの画素中心をレンダーのピクセル格子に合わせる
+        const int py = qMin(height - 1, static_cast<int>((y + 0.5) * height / size));
+        uchar* scanLine = image.scanLine(y);
+        for (int x = 0; x < size; ++x) {
+            const int px = qMin(width - 1, static_cast<int>((x + 0.5) * width / size));
+            OutputNode::writePixel(node->compute(QVector3D(px, py, 0.0), socket), scanLine + x * 4);
+        }
+    }, RenderLane::Thumbnail);
+
+    // 1スライスが予算に収まるよう行数を調整
+    const qint64 elapsed = qMax<qint64>(1, timer.nsecsElapsed());
+    const double perRow = double(elapsed) / rows;
+    m_rowsPerSlice = qBound(1, static_cast<int>(kSliceBudgetNs / perRow), size);
+
+    job.nextRow += rows;
+    if (job.nextRow >= size) {
+        const quint64 key = job.key;
+        const QImage result = job.image;
+        // 画像のデコード待ちなどで暫定の結果はキャッシュしない（完了時に再要求される）
+        const bool cacheable = job.cacheable && contentReady(node);
+        m_queue.removeFirst();
+        if (cacheable) {
+            m_cache.insert(key, new QImage(result), qMax<qsizetype>(1, result.sizeInBytes() / 1024));
+        }
+        emit previewReady(socket, key, result);
+    }
+    schedule();
+}
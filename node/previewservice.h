@@ -0,0 +1,80 @@
+#ifndef PREVIEWSERVICE_H
+#define PREVIEWSERVICE_H
+
+#include <QCache>
+#include <QHash>
+#include <QImage>
+#include <QList>
+#include <QObject>
+#include <QTimer>
+#include <functional>
+
+class Node;
+class NodeSocket;
+
+// ノードのプレビュー（サムネイル）生成サービス
+// Thumbnails for any output socket, rendered through the same compute()
+// path as the main render by sampling the render's pixel grid. Work runs on
+// the scheduler's thumbnail lane in short time-sliced batches started from
+// the GUI thread, so parameter edits (which also happen on the GUI thread)
+// never race with a preview and the editor stays responsive.
+//
+// Finished previews are cached by Node::contentKey of the socket's node
+// plus the render settings, so undo, toggling a parameter back or showing
+// the same subgraph twice costs nothing. Previews rendered while an
+// upstream node is not Node::isContentReady() are shown but not cached.
+//
+// The render-level prepare pass runs on the GUI thread, so a preview only
+// starts once every upstream node is Node::isPrepared() at the render size
+// and the pass is cheap. Other requests wait until a main render has built
+// that data (renderPrepared()) instead of stalling the editor.
+class PreviewService : public QObject {
+    Q_OBJECT
+public:
+    static PreviewService& instance();
+
+    // Returns true and fills 'image' on a cache hit. Otherwise the socket
+    // is queued (replacing an older request for it) and previewReady follows.
+    // 'visible' is asked right before rendering starts; requests that are
+    // no longer on screen are dropped with previewSkipped. 'key' receives
+    // the key the result will carry.
+    bool request(NodeSocket* socket, int size, std::function<bool()> visible,
+                 quint64* key, QImage* image);
+
+    // ノードが変更された / 削除される: 進行中・待機中の要求を破棄
+    void cancel(Node* node);
+
+    // メインレンダーが prepareRender を済ませた: 待たせていた要求を再開
+    void renderPrepared();
+
+signals:
+    void previewReady(NodeSocket* socket, quint64 key, const QImage& image);
+    void previewSkipped(NodeSocket* socket);
+    // レンダー解像度・表示範囲が変わり、全プレビューが古くなった
+    void invalidated();
+
+private:
+    struct Job {
+        NodeSocket* socket;
+        int size;
+        quint64 key;
+        std::function<bool()> visible;
+        QImage image;
+        int nextRow = -1;  // -1 = まだ prepareRender 前
+        bool cacheable = false;  // 開始時に上流がすべて確定していた
+    };
+
+    PreviewService();
+
+    quint64 keyFor(NodeSocket* socket, int size);
+    void schedule();
+    void processSlice();
+
+    QList<Job> m_queue;
+    QList<Job> m_waiting;  // 上流の prepare 待ち
+    QCache<quint64, QImage> m_cache;
+    QTimer m_timer;
+    int m_rowsPerSlice = 4;
+};
+
+#endif // PREVIEWSERVICE_H
@@ -37,7 +37,7 @@ void PrincipledBSDFNode::evaluate() {
     // Nothing to pre-calculate
 }
 
-QVector<Node::ParameterInfo> PrincipledBSDFNode::parameters() const {
+QVector<Node::ParameterInfo> PrincipledBSDFNode::describeParameters() const {
     return {
         ParameterInfo("Metallic", 0.0, 1.0, 0.0, 0.01),
         ParameterInfo("Roughness", 0.0, 1.0, 0.5, 0.01),
@@ -20,7 +20,7 @@ RadialTilingNode::RadialTilingNode() : Node("Radial Tiling") {
 
 RadialTilingNode::~RadialTilingNode() {}
 
-QVector<Node::ParameterInfo> RadialTilingNode::parameters() const {
+QVector<Node::ParameterInfo> RadialTilingNode::describeParameters() const {
     return {
         ParameterInfo("Sides", 1.0, 32.0, 5.0),
         ParameterInfo("Roundness", 0.0, 1.0, 1.0)
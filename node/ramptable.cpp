@@ -0,0 +1,81 @@
+#include "ramptable.h"
+#include <algorithm>
+#include <cmath>
+
+namespace {
+
+// 従来の evaluateRamp と同じ区間探索と線形補間
+void evaluateStops(const QVector<RampTable::Stop>& stops, double t, float rgba[4]) {
+    auto store = [rgba](const QColor& c) {
+        rgba[0] = static_cast<float>(c.redF());
+        rgba[1] = static_cast<float>(c.greenF());
+        rgba[2] = static_cast<float>(c.blueF());
+        rgba[3] = static_cast<float>(c.alphaF());
+    };
+
+    if (stops.isEmpty()) {
+        store(Qt::black);
+        return;
+    }
+    if (stops.size() == 1) {
+        store(stops[0].color);
+        return;
+    }
+
+    for (int i = 0; i < stops.size() - 1; ++i) {
+        if (t >= stops[i].position && t <= stops[i+1].position) {
+            double range = stops[i+1].position - stops[i].position;
+            if (range < 0.0001) {
+                store(stops[i].color);
+                return;
+            }
+
+            double localT = (t - stops[i].position) / range;
+            const QColor& a = stops[i].color;
+            const QColor& b = stops[i+1].color;
+            rgba[0] = static_cast<float>(a.redF() * (1.0 - localT) + b.redF() * localT);
+            rgba[1] = static_cast<float>(a.greenF() * (1.0 - localT) + b.greenF() * localT);
+            rgba[2] = static_cast<float>(a.blueF() * (1.0 - localT) + b.blueF() * localT);
+            rgba[3] = static_cast<float>(a.alphaF() * (1.0 - localT) + b.alphaF() * localT);
+            return;
+        }
+    }
+
+    // Handle out of bounds (clamping)
+    store(t < stops.first().position ? stops.first().color : stops.last().color);
+}
+
+} // namespace
+
+std::shared_ptr<const RampTable> RampTable::bake(const QVector<Stop>& stops) {
+    std::shared_ptr<RampTable> table(new RampTable());
+    table->m_table.resize(static_cast<size_t>(Size) * 4);
+    for (int i = 0; i < Size; ++i) {
+        evaluateStops(stops, static_cast<double>(i) / (Size - 1), &table->m_table[static_cast<size_t>(i) * 4]);
+    }
+    return table;
+}
+
+void RampTable::sample(double t, float rgba[4]) const {
+    // NaN は従来通り 1 側に寄せる
+    const double x = std::max(0.0, std::min(1.0, t)) * (Size - 1);
+    const int i = std::min(static_cast<int>(x), Size - 2);
+    const float f = static_cast<float>(x - i);
+    const float* a = &m_table[static_cast<size_t>(i) * 4];
+    const float* b = a + 4;
+    for (int c = 0; c < 4; ++c) {
+        rgba[c] = a[c] + (b[c] - a[c]) * f;
+    }
+}
+
+void RampTable::sample(const double* t, float* rgba, int count) const {
+    for (int k = 0; k < count; ++k) {
+        sample(t[k], rgba + static_cast<size_t>(k) * 4);
+    }
+}
+
+QColor RampTable::color(double t) const {
+    float rgba[4];
+    sample(t, rgba);
+    return QColor::fromRgbF(rgba[0], rgba[1], rgba[2], rgba[3]);
+}
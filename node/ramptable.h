@@ -0,0 +1,47 @@
+#ifndef RAMPTABLE_H
+#define RAMPTABLE_H
+
+#include <QColor>
+#include <QVector>
+#include <memory>
+#include <vector>
+
+// Ramp Table - a color ramp baked into a float RGBA lookup table.
+// Rebuilt whenever the stops change; sampling is a clamped lookup plus one
+// lerp, with no search over the stops and no QColor per sample. The ramp
+// is piecewise linear, so the table reproduces it up to the one cell that
+// contains each stop.
+class RampTable {
+public:
+    static constexpr int Size = 4096;
+
+    struct Stop {
+        double position;
+        QColor color;
+    };
+
+    // stops はソート済み（位置の昇順）であること
+    static std::shared_ptr<const RampTable> bake(const QVector<Stop>& stops);
+
+    // Convenience for nodes that keep their own Stop type with the same fields
+    template <typename Stops>
+    static std::shared_ptr<const RampTable> bakeFrom(const Stops& stops) {
+        QVector<Stop> keys;
+        keys.reserve(stops.size());
+        for (const auto& stop : stops) keys.append({stop.position, stop.color});
+        return bake(keys);
+    }
+
+    // t は [0,1] にクランプされる
+    void sample(double t, float rgba[4]) const;
+    void sample(const double* t, float* rgba, int count) const;  // rgba: count * 4
+
+    QColor color(double t) const;
+
+private:
+    RampTable() = default;
+
+    std::vector<float> m_table;  // Size * RGBA
+};
+
+#endif // RAMPTABLE_H
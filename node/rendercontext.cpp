@@ -1,4 +1,5 @@
 #include "rendercontext.h"
+#include "appsettings.h"
 
 RenderContext& RenderContext::instance() {
     static thread_local RenderContext ctx;
@@ -13,3 +14,25 @@ void RenderContext::setRenderSize(int width, int height) {
 void RenderContext::setCurrentPixel(const QVector3D& pixel) {
     m_currentPixel = pixel;
 }
+
+void RenderContext::parallelFor(int count, const std::function<void(int)>& body) {
+    parallelFor(count, body, RenderScheduler::currentLane());
+}
+
+void RenderContext::parallelFor(int count, const std::function<void(int)>& body, RenderLane lane) {
+    if (count <= 0) return;
+    
+    // CPU 使用数の設定はジョブ単位の上限として扱う（スレッドは作り直さない）
+    // Thumbnails get half of it so they never take the whole machine.
+    int maxWorkers = AppSettings::instance().maxThreads();
+    if (lane == RenderLane::Thumbnail) {
+        maxWorkers = qMax(1, maxWorkers / 2);
+    }
+    
+    RenderScheduler& scheduler = RenderScheduler::instance();
+    const bool pin = AppSettings::instance().pinRenderThreads();
+    if (scheduler.affinityEnabled() != pin) {
+        scheduler.setAffinityEnabled(pin);
+    }
+    scheduler.parallelFor(lane, count, maxWorkers, body);
+}
@@ -1,7 +1,9 @@
 #ifndef RENDERCONTEXT_H
 #define RENDERCONTEXT_H
 
+#include "renderscheduler.h"
 #include <QVector3D>
+#include <functional>
 
 // Global rendering context accessible by all nodes
 class RenderContext {
@@ -15,6 +17,12 @@ public:
     void setCurrentPixel(const QVector3D& pixel);
     QVector3D currentPixel() const { return m_currentPixel; }
     
+    // Runs body(0 .. count-1) on the render scheduler and waits for completion.
+    // The calling thread works on the job too, so this may be nested.
+    // Without a lane the work inherits the lane of the calling thread.
+    static void parallelFor(int count, const std::function<void(int)>& body);
+    static void parallelFor(int count, const std::function<void(int)>& body, RenderLane lane);
+    
 private:
     RenderContext() : m_renderWidth(512), m_renderHeight(512) {}
     
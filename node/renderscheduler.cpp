@@ -0,0 +1,342 @@
+#include "renderscheduler.h"
+#include <QFile>
+#include <QMutexLocker>
+#include <QSet>
+#include <QThread>
+#include <algorithm>
+#include <cstdint>
+
+#if defined(Q_OS_WIN)
+#ifndef NOMINMAX
+#define NOMINMAX
+#endif
+#include <windows.h>
+#elif defined(Q_OS_LINUX)
+#include <pthread.h>
+#include <sched.h>
+#endif
+
+namespace {
+
+constexpr size_t kArenaBlockSize = size_t(1) << 20;  // 1 MiB
+
+thread_local RenderLane t_lane = RenderLane::Interactive;
+
+inline size_t alignUp(size_t value, size_t alignment) {
+    return (value + alignment - 1) / alignment * alignment;
+}
+
+// 物理コアを先に埋める: each core's first allowed CPU, then the remaining
+// SMT siblings. 'coreOf' maps a CPU to an id shared by its siblings.
+template <typename CoreOf>
+std::vector<int> orderBySiblings(const std::vector<int>& allowed, CoreOf coreOf) {
+    std::vector<int> first;
+    std::vector<int> rest;
+    QSet<int> seenCores;
+    for (int cpu : allowed) {
+        const int core = coreOf(cpu);
+        if (seenCores.contains(core)) {
+            rest.push_back(cpu);
+        } else {
+            seenCores.insert(core);
+            first.push_back(cpu);
+        }
+    }
+    first.insert(first.end(), rest.begin(), rest.end());
+    return first;
+}
+
+#if defined(Q_OS_LINUX)
+// "0-3,8,10-11" 形式（sysfs の CPU リスト）の先頭の CPU 番号
+int firstCpuInList(const QByteArray& list, int fallback) {
+    bool ok = false;
+    const int cpu = list.trimmed().split(',').value(0).split('-').value(0).toInt(&ok);
+    return ok ? cpu : fallback;
+}
+#endif
+
+} // namespace
+
+// ---------------------------------------------------------------------------
+// ScratchArena
+
+ScratchArena& ScratchArena::current() {
+    static thread_local ScratchArena arena;
+    return arena;
+}
+
+void* ScratchArena::allocate(size_t bytes, size_t alignment) {
+    while (m_block < m_blocks.size()) {
+        Block& block = m_blocks[m_block];
+        const uintptr_t base = reinterpret_cast<uintptr_t>(block.data.get());
+        const size_t start = alignUp(base + m_offset, alignment) - base;
+        if (start + bytes <= block.size) {
+            m_offset = start + bytes;
+            return block.data.get() + start;
+        }
+        if (m_block + 1 >= m_blocks.size()) break;
+        ++m_block;
+        m_offset = 0;
+    }
+
+    // 足りなければ新しいブロックを現在位置の後ろに追加（以後は再利用される）
+    Block block;
+    block.size = std::max(kArenaBlockSize, bytes + alignment);
+    block.data.reset(new char[block.size]);
+    const size_t insertAt = m_blocks.empty() ? 0 : m_block + 1;
+    m_blocks.insert(m_blocks.begin() + insertAt, std::move(block));
+    m_block = insertAt;
+    m_offset = 0;
+
+    Block& fresh = m_blocks[m_block];
+    const uintptr_t base = reinterpret_cast<uintptr_t>(fresh.data.get());
+    const size_t start = alignUp(base, alignment) - base;
+    m_offset = start + bytes;
+    return fresh.data.get() + start;
+}
+
+// ---------------------------------------------------------------------------
+// RenderScheduler
+
+RenderScheduler& RenderScheduler::instance() {
+    static RenderScheduler scheduler;
+    return scheduler;
+}
+
+RenderScheduler::RenderScheduler() {
+    for (std::atomic<int>& queued : m_queued) {
+        queued.store(0);
+    }
+
+    initAffinityTopology();
+
+    // The caller participates in its own jobs, so one thread fewer than the
+    // core count keeps the machine fully used without oversubscribing it.
+    const int count = std::max(1, QThread::idealThreadCount() - 1);
+    m_workers.reserve(count);
+    for (int i = 0; i < count; ++i) {
+        // With three or more workers the last one serves the background
+        // lanes first, so thumbnails and exports progress during long
+        // interactive renders.
+        const bool backgroundFirst = count >= 3 && i == count - 1;
+        m_workers.emplace_back([this, i, backgroundFirst]() { workerLoop(i, backgroundFirst); });
+    }
+}
+
+RenderScheduler::~RenderScheduler() {
+    {
+        QMutexLocker locker(&m_mutex);
+        m_stopping = true;
+        m_workAvailable.wakeAll();
+    }
+    for (std::thread& worker : m_workers) {
+        worker.join();
+    }
+}
+
+RenderLane RenderScheduler::currentLane() {
+    return t_lane;
+}
+
+RenderScheduler::LaneScope::LaneScope(RenderLane lane)
+    : m_previous(t_lane)
+{
+    t_lane = lane;
+}
+
+RenderScheduler::LaneScope::~LaneScope() {
+    t_lane = m_previous;
+}
+
+void RenderScheduler::setAffinityEnabled(bool enabled) {
+    if (m_affinity.exchange(enabled) != enabled) {
+        m_affinityGeneration.fetch_add(1);
+        QMutexLocker locker(&m_mutex);
+        m_workAvailable.wakeAll();
+    }
+}
+
+void RenderScheduler::parallelFor(RenderLane lane, int count, int maxWorkers, const std::function<void(int)>& body) {
+    if (count <= 0) return;
+
+    if (count == 1 || maxWorkers <= 1 || m_workers.empty()) {
+        LaneScope scope(lane);
+        for (int i = 0; i < count; ++i) body(i);
+        return;
+    }
+
+    auto job = std::make_shared<Job>();
+    job->lane = lane;
+    job->body = &body;
+    job->count = count;
+    job->maxWorkers = maxWorkers;
+    job->active = 1;  // 呼び出し元
+
+    const int laneIndex = static_cast<int>(lane);
+    {
+        QMutexLocker locker(&m_mutex);
+        m_queues[laneIndex].push_back(job);
+        m_queued[laneIndex].fetch_add(1);
+        m_workAvailable.wakeAll();
+    }
+
+    // The caller never yields its own job: it is blocked on it anyway.
+    runItems(*job, false);
+
+    QMutexLocker locker(&m_mutex);
+    --job->active;
+    while (job->done.load(std::memory_order_acquire) < count) {
+        m_jobFinished.wait(&m_mutex);
+    }
+    std::vector<std::shared_ptr<Job>>& queue = m_queues[laneIndex];
+    auto it = std::find(queue.begin(), queue.end(), job);
+    if (it != queue.end()) {
+        queue.erase(it);
+        m_queued[laneIndex].fetch_sub(1);
+    }
+}
+
+void RenderScheduler::runItems(Job& job, bool yieldToUrgent) {
+    LaneScope scope(job.lane);
+    for (;;) {
+        const int i = job.next.fetch_add(1, std::memory_order_relaxed);
+        if (i >= job.count) return;
+        (*job.body)(i);
+        job.done.fetch_add(1, std::memory_order_release);
+        if (yieldToUrgent && urgentWorkPending(job.lane)) return;
+    }
+}
+
+bool RenderScheduler::urgentWorkPending(RenderLane lane) const {
+    for (int l = 0; l < static_cast<int>(lane); ++l) {
+        if (m_queued[l].load(std::memory_order_relaxed) > 0) return true;
+    }
+    return false;
+}
+
+// m_mutex を保持した状態で呼ぶ
+std::shared_ptr<RenderScheduler::Job> RenderScheduler::pickJob(bool backgroundFirst) {
+    for (int n = 0; n < LaneCount; ++n) {
+        const int lane = backgroundFirst ? LaneCount - 1 - n : n;
+        std::vector<std::shared_ptr<Job>>& queue = m_queues[lane];
+        for (size_t i = 0; i < queue.size();) {
+            const std::shared_ptr<Job>& job = queue[i];
+            if (job->next.load(std::memory_order_relaxed) >= job->count) {
+                // 全項目が取得済み。待っている呼び出し元はキューを参照しない
+                queue.erase(queue.begin() + i);
+                m_queued[lane].fetch_sub(1);
+                continue;
+            }
+            if (job->active < job->maxWorkers) {
+                return job;
+            }
+            ++i;
+        }
+    }
+    return nullptr;
+}
+
+void RenderScheduler::workerLoop(int index, bool backgroundFirst) {
+    int affinityGeneration = 0;
+
+    for (;;) {
+        std::shared_ptr<Job> job;
+        {
+            QMutexLocker locker(&m_mutex);
+            for (;;) {
+                if (m_stopping) return;
+                if (affinityGeneration != m_affinityGeneration.load()) break;
+                job = pickJob(backgroundFirst);
+                if (job) break;
+                m_workAvailable.wait(&m_mutex);
+            }
+            if (job) ++job->active;
+        }
+
+        const int generation = m_affinityGeneration.load();
+        if (affinityGeneration != generation) {
+            affinityGeneration = generation;
+            applyAffinity(index, m_affinity.load());
+        }
+        if (!job) continue;
+
+        runItems(*job, !backgroundFirst);
+
+        QMutexLocker locker(&m_mutex);
+        --job->active;
+        if (job->done.load(std::memory_order_acquire) >= job->count) {
+            m_jobFinished.wakeAll();
+        }
+    }
+}
+
+// ワーカーは生成元スレッドのマスクを引き継ぐので、ここで読んだ CPU 集合が
+// 各ワーカーの元のマスクになる
+void RenderScheduler::initAffinityTopology() {
+#if defined(Q_OS_WIN)
+    DWORD_PTR processMask = 0;
+    DWORD_PTR systemMask = 0;
+    if (!GetProcessAffinityMask(GetCurrentProcess(), &processMask, &systemMask)) return;
+    for (int cpu = 0; cpu < int(sizeof(DWORD_PTR) * 8); ++cpu) {
+        if (processMask & (DWORD_PTR(1) << cpu)) m_allowedCpus.push_back(cpu);
+    }
+
+    // Logical processors of one core share a RelationProcessorCore mask
+    std::vector<DWORD_PTR> coreMasks;
+    DWORD length = 0;
+    GetLogicalProcessorInformation(nullptr, &length);
+    std::vector<SYSTEM_LOGICAL_PROCESSOR_INFORMATION> info(length / sizeof(SYSTEM_LOGICAL_PROCESSOR_INFORMATION));
+    if (!info.empty() && GetLogicalProcessorInformation(info.data(), &length)) {
+        for (const SYSTEM_LOGICAL_PROCESSOR_INFORMATION& entry : info) {
+            if (entry.Relationship == RelationProcessorCore) coreMasks.push_back(entry.ProcessorMask);
+        }
+    }
+    m_cpuOrder = orderBySiblings(m_allowedCpus, [&coreMasks](int cpu) {
+        for (size_t core = 0; core < coreMasks.size(); ++core) {
+            if (coreMasks[core] & (DWORD_PTR(1) << cpu)) return int(core);
+        }
+        return -1 - cpu;  // 不明なら単独のコアとして扱う
+    });
+#elif defined(Q_OS_LINUX)
+    cpu_set_t set;
+    CPU_ZERO(&set);
+    if (sched_getaffinity(0, sizeof(set), &set) != 0) return;
+    for (int cpu = 0; cpu < CPU_SETSIZE; ++cpu) {
+        if (CPU_ISSET(cpu, &set)) m_allowedCpus.push_back(cpu);
+    }
+
+    // Siblings are often n and n + N/2, so read them instead of guessing
+    m_cpuOrder = orderBySiblings(m_allowedCpus, [](int cpu) {
+        QFile file(QStringLiteral("/sys/devices/system/cpu/cpu%1/topology/thread_siblings_list").arg(cpu));
+        if (!file.open(QIODevice::ReadOnly)) return cpu;
+        return firstCpuInList(file.readAll(), cpu);
+    });
+#endif
+}
+
+void RenderScheduler::applyAffinity(int index, bool enabled) {
+    if (m_cpuOrder.empty()) return;  // トポロジーが取れない環境では何もしない
+#if defined(Q_OS_WIN)
+    DWORD_PTR mask = 0;
+    if (enabled) {
+        mask = DWORD_PTR(1) << m_cpuOrder[size_t(index) % m_cpuOrder.size()];
+    } else {
+        for (int cpu : m_allowedCpus) mask |= DWORD_PTR(1) << cpu;
+    }
+    SetThreadAffinityMask(GetCurrentThread(), mask);
+#elif defined(Q_OS_LINUX)
+    cpu_set_t set;
+    CPU_ZERO(&set);
+    if (enabled) {
+        CPU_SET(m_cpuOrder[size_t(index) % m_cpuOrder.size()], &set);
+    } else {
+        // 元のマスクに戻す
+        for (int cpu : m_allowedCpus) CPU_SET(cpu, &set);
+    }
+    pthread_setaffinity_np(pthread_self(), sizeof(set), &set);
+#else
+    // 他のプラットフォームでは OS のスケジューリングに任せる
+    Q_UNUSED(index);
+    Q_UNUSED(enabled);
+#endif
+}
@@ -0,0 +1,148 @@
+#ifndef RENDERSCHEDULER_H
+#define RENDERSCHEDULER_H
+
+#include <QMutex>
+#include <QWaitCondition>
+#include <atomic>
+#include <cstddef>
+#include <functional>
+#include <memory>
+#include <thread>
+#include <vector>
+
+// 優先度レーン（数値が小さいほど優先）
+enum class RenderLane {
+    Interactive = 0,  // ビューポートのプレビュー
+    Thumbnail = 1,    // ノードのサムネイル
+    Batch = 2         // 書き出し
+};
+
+// Scratch Arena - per-thread bump allocator for render-time temporaries.
+//
+// Blocks are kept for the lifetime of the thread, so after the first few
+// renders a worker no longer touches the heap for scratch space. Callers
+// take a Scope; everything allocated inside it is released when the scope
+// ends. Memory is not constructed or zeroed.
+class ScratchArena {
+public:
+    static ScratchArena& current();
+
+    void* allocate(size_t bytes, size_t alignment = 64);
+
+    template<typename T>
+    T* allocate(size_t count) {
+        return static_cast<T*>(allocate(count * sizeof(T), alignof(T) < 64 ? 64 : alignof(T)));
+    }
+
+    class Scope {
+    public:
+        Scope() : m_arena(ScratchArena::current()), m_block(m_arena.m_block), m_offset(m_arena.m_offset) {}
+        ~Scope() { m_arena.m_block = m_block; m_arena.m_offset = m_offset; }
+        Scope(const Scope&) = delete;
+        Scope& operator=(const Scope&) = delete;
+
+        ScratchArena& arena() { return m_arena; }
+        template<typename T>
+        T* allocate(size_t count) { return m_arena.allocate<T>(count); }
+
+    private:
+        ScratchArena& m_arena;
+        size_t m_block;
+        size_t m_offset;
+    };
+
+private:
+    struct Block {
+        std::unique_ptr<char[]> data;
+        size_t size;
+    };
+
+    ScratchArena() = default;
+
+    std::vector<Block> m_blocks;
+    size_t m_block = 0;   // 現在のブロック
+    size_t m_offset = 0;  // 現在のブロック内の使用量
+};
+
+// Render Scheduler - dedicated worker threads for pixel work.
+//
+// Replaces the shared QThreadPool::globalInstance(). Work is submitted as
+// index ranges on one of three priority lanes; idle workers always take
+// the most urgent lane first and give up a lower-lane job between items
+// as soon as something more urgent arrives, so a running export or
+// thumbnail refresh never delays the viewport by more than one item.
+// One worker (when there are enough) looks at the lanes in reverse order,
+// which keeps background lanes moving while the viewport is busy.
+//
+// The calling thread always works on its own job too, so nested
+// parallelFor calls (e.g. from prepareRender inside a job) cannot deadlock.
+class RenderScheduler {
+public:
+    static RenderScheduler& instance();
+    ~RenderScheduler();
+
+    // body(0 .. count-1) を実行し、終わるまで待つ
+    // At most maxWorkers threads (including the caller) work on the job.
+    void parallelFor(RenderLane lane, int count, int maxWorkers, const std::function<void(int)>& body);
+
+    int workerCount() const { return static_cast<int>(m_workers.size()); }
+
+    // Lane of the work the current thread is doing (Interactive outside of
+    // jobs unless a LaneScope says otherwise). Nested parallelFor calls
+    // inherit it.
+    static RenderLane currentLane();
+
+    class LaneScope {
+    public:
+        explicit LaneScope(RenderLane lane);
+        ~LaneScope();
+        LaneScope(const LaneScope&) = delete;
+        LaneScope& operator=(const LaneScope&) = delete;
+    private:
+        RenderLane m_previous;
+    };
+
+    // Pin worker i to one logical CPU. Workers take one CPU of every core
+    // first and the SMT siblings after, using the sibling topology reported
+    // by the OS. Disabling restores the mask the workers started with.
+    // Off by default; follows AppSettings::pinRenderThreads().
+    void setAffinityEnabled(bool enabled);
+    bool affinityEnabled() const { return m_affinity.load(std::memory_order_relaxed); }
+
+private:
+    static constexpr int LaneCount = 3;
+
+    struct Job {
+        RenderLane lane;
+        const std::function<void(int)>* body;
+        int count;
+        int maxWorkers;
+        int active = 0;  // m_mutex で保護
+        std::atomic<int> next{0};
+        std::atomic<int> done{0};
+    };
+
+    RenderScheduler();
+
+    void workerLoop(int index, bool backgroundFirst);
+    std::shared_ptr<Job> pickJob(bool backgroundFirst);
+    void runItems(Job& job, bool yieldToUrgent);
+    bool urgentWorkPending(RenderLane lane) const;
+    void initAffinityTopology();
+    void applyAffinity(int index, bool enabled);
+
+    QMutex m_mutex;
+    QWaitCondition m_workAvailable;
+    QWaitCondition m_jobFinished;
+    std::vector<std::shared_ptr<Job>> m_queues[LaneCount];
+    std::atomic<int> m_queued[LaneCount];
+    bool m_stopping = false;
+
+    std::vector<std::thread> m_workers;
+    std::atomic<bool> m_affinity{false};
+    std::atomic<int> m_affinityGeneration{0};
+    std::vector<int> m_allowedCpus;  // ワーカー起動時のマスク
+    std::vector<int> m_cpuOrder;     // ピン留めの順番（コアごとに1つ、その後に兄弟）
+};
+
+#endif // RENDERSCHEDULER_H
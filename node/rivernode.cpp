@@ -2,6 +2,7 @@
 #include "appsettings.h"
 #include <QDebug>
 #include <cmath>
+#include <cstring>
 #include <algorithm>
 #include <QColor>
 #include <QVector2D>
@@ -104,14 +105,13 @@ RiverNode::RiverNode() : Node("River Texture"), m_isCached(false), m_noiseType(N
 
 RiverNode::~RiverNode() {}
 
-QVector<Node::ParameterInfo> RiverNode::parameters() const {
+QVector<Node::ParameterInfo> RiverNode::describeParameters() const {
     return {
         ParameterInfo("Noise Type", 
             {"OpenSimplex2S", "OpenSimplex2F", "Perlin", "Simplex", "RidgedMultifractal", "White", "Ridged", "Gabor", "Everling"},
-            QVariant::fromValue(static_cast<int>(m_noiseType)),
-            [this](const QVariant& v) {
-                const_cast<RiverNode*>(this)->setNoiseType(static_cast<NoiseType>(v.toInt()));
-            }),
+            QVariant::fromValue(static_cast<int>(m_noiseType)))
+            .bind<RiverNode>([](const RiverNode& n) { return static_cast<int>(n.m_noiseType); },
+                             [](RiverNode& n, const QVariant& v) { n.setNoiseType(static_cast<NoiseType>(v.toInt())); }),
         ParameterInfo("Scale", 0.0, 100.0, 5.0, 0.1, "Noise frequency"),
         ParameterInfo("Distortion", 0.0, 100.0, 20.0, 0.1, "Distortion strength"),
         ParameterInfo("Width", 0.001, 0.5, 0.02, 0.001, "River width"),
@@ -203,11 +203,9 @@ void RiverNode::setMapSize(int v) {
     m_isCached = false; 
 }
 
-void RiverNode::setDirty(bool dirty) {
-    if (dirty) {
-        m_isCached = false;
-    }
-    Node::setDirty(dirty);
+void RiverNode::invalidate() {
+    m_isCached = false;
+    Node::invalidate();
 }
 
 void RiverNode::evaluate() {
@@ -683,3 +681,49 @@ QVariant RiverNode::compute(const QVector3D& pos, NodeSocket* socket) {
     
     return QVariant();
 }
+
+// Layout: width | height | render width | render height (u32), then RGB32
+// pixels row by row. The map samples the mask at the render resolution, so
+// a bake made at another resolution is not adopted.
+QByteArray RiverNode::saveBakedCache() const {
+    QMutexLocker locker(&const_cast<RiverNode*>(this)->m_mutex);
+    if (!m_isCached || m_cachedMap.isNull()) return QByteArray();
+
+    const quint32 header[4] = { quint32(m_cachedMap.width()), quint32(m_cachedMap.height()),
+                                quint32(AppSettings::instance().renderWidth()),
+                                quint32(AppSettings::instance().renderHeight()) };
+    const int rowBytes = m_cachedMap.width() * 4;
+    QByteArray data;
+    data.reserve(sizeof(header) + qsizetype(rowBytes) * m_cachedMap.height());
+    data.append(reinterpret_cast<const char*>(header), sizeof(header));
+    for (int y = 0; y < m_cachedMap.height(); ++y) {
+        data.append(reinterpret_cast<const char*>(m_cachedMap.constScanLine(y)), rowBytes);
+    }
+    return data;
+}
+
+bool RiverNode::restoreBakedCache(const uchar* data, qint64 size) {
+    quint32 header[4];
+    if (size < qint64(sizeof(header))) return false;
+    std::memcpy(header, data, sizeof(header));
+    // マップは最大 4096 四方。範囲外はサイズ計算の前に弾く
+    if (header[0] == 0 || header[1] == 0 || header[0] > 4096 || header[1] > 4096) return false;
+    const qint64 rowBytes = qint64(header[0]) * 4;
+    if (size != qint64(sizeof(header)) + rowBytes * header[1]) return false;
+    if (header[2] != quint32(AppSettings::instance().renderWidth()) ||
+        header[3] != quint32(AppSettings::instance().renderHeight())) {
+        return false;  // 別の解像度でベイクされた
+    }
+
+    QImage map(int(header[0]), int(header[1]), QImage::Format_RGB32);
+    if (map.isNull()) return false;
+    for (int y = 0; y < map.height(); ++y) {
+        std::memcpy(map.scanLine(y), data + sizeof(header) + rowBytes * y, rowBytes);
+    }
+
+    QMutexLocker locker(&m_mutex);
+    m_cachedMap = map;
+    m_isCached = true;
+    m_dirty = false;
+    return true;
+}
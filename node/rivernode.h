@@ -16,8 +16,8 @@ public:
     
     void evaluate() override;
     QVariant compute(const QVector3D& pos, NodeSocket* socket) override;
-    void setDirty(bool dirty) override;
-    QVector<ParameterInfo> parameters() const override;
+    QByteArray saveBakedCache() const override;
+    bool restoreBakedCache(const uchar* data, qint64 size) override;
 
     // Getters and Setters
     double scale() const;
@@ -119,6 +119,10 @@ public:
     // Internal state for parameters
     NoiseType m_noiseType;
     bool m_edgeConnection;
+
+protected:
+    QVector<ParameterInfo> describeParameters() const override;
+    void invalidate() override;
 };
 
 #endif // RIVERNODE_H
@@ -1,6 +1,7 @@
 #include "scatteronpointsnode.h"
 #include <cmath>
-#include <random>
+#include <algorithm>
+#include <cstdint>
 
 #ifndef M_PI
 #define M_PI 3.14159265358979323846
@@ -33,97 +34,223 @@ ScatterOnPointsNode::ScatterOnPointsNode()
 ScatterOnPointsNode::~ScatterOnPointsNode() {}
 
 void ScatterOnPointsNode::evaluate() {
-    // Stateless
+    // Stateless (instance table is rebuilt lazily in compute)
 }
 
-QVariant ScatterOnPointsNode::compute(const QVector3D& pos, NodeSocket* socket) {
-    QMutexLocker locker(&m_mutex);
+void ScatterOnPointsNode::invalidate() {
+    // Upstream density or parameters changed - drop the instance table
+    std::atomic_store(&m_table, std::shared_ptr<const InstanceTable>());
+    Node::invalidate();
+}
+
+// Cheap per-cell random stream (SplitMix64); avoids seeding a full
+// std::mt19937 state for every cell.
+namespace {
+struct CellRandom {
+    uint64_t state;
     
-    // Get input coordinates
-    QVector3D vec;
-    if (m_vectorInput->isConnected()) {
-        vec = m_vectorInput->getValue(pos).value<QVector3D>();
-    } else {
-        vec = QVector3D(pos.x() / 512.0, pos.y() / 512.0, 0.0);
-    }
+    CellRandom(int seed, int cx, int cy)
+        : state((static_cast<uint64_t>(static_cast<uint32_t>(seed)) << 40)
+                ^ (static_cast<uint64_t>(cx) << 20)
+                ^ static_cast<uint64_t>(cy)) {}
     
-    double x = vec.x();
-    double y = vec.y();
+    // Uniform in [-0.5, 0.5)
+    double next() {
+        state += 0x9E3779B97F4A7C15ULL;
+        uint64_t z = state;
+        z = (z ^ (z >> 30)) * 0xBF58476D1CE4E5B9ULL;
+        z = (z ^ (z >> 27)) * 0x94D049BB133111EBULL;
+        z ^= z >> 31;
+        return (z >> 11) * (1.0 / 9007199254740992.0) - 0.5;
+    }
+};
+}
+
+std::shared_ptr<const ScatterOnPointsNode::InstanceTable> ScatterOnPointsNode::instanceTable() {
+    std::shared_ptr<const InstanceTable> table = std::atomic_load(&m_table);
+    if (table) return table;
     
-    // Generate grid points and check each
-    std::mt19937 rng(m_seed);
-    std::uniform_real_distribution<double> dist(-0.5, 0.5);
+    QMutexLocker locker(&m_mutex);
+    table = std::atomic_load(&m_table);
+    if (!table) {
+        table = buildInstanceTable();
+        std::atomic_store(&m_table, table);
+    }
+    return table;
+}
+
+std::shared_ptr<const ScatterOnPointsNode::InstanceTable> ScatterOnPointsNode::buildInstanceTable() const {
+    auto table = std::make_shared<InstanceTable>();
     
-    QVector4D resultColor(0, 0, 0, 0);
-    double resultValue = 0.0;
+    const int pointsX = qBound(1, m_pointsX, 1000);
+    const int pointsY = qBound(1, m_pointsY, 1000);
+    const double cellWidth = 1.0 / pointsX;
+    const double cellHeight = 1.0 / pointsY;
+    const bool useDensity = m_densityInput->isConnected();
     
-    double cellWidth = 1.0 / m_pointsX;
-    double cellHeight = 1.0 / m_pointsY;
+    // Per-instance bounding half extents (parallel to table->instances)
+    std::vector<float> halfExtents;
+    table->instances.reserve(static_cast<size_t>(pointsX) * pointsY);
+    halfExtents.reserve(static_cast<size_t>(pointsX) * pointsY);
     
-    // Check nearby cells
-    int cellX = static_cast<int>(x * m_pointsX);
-    int cellY = static_cast<int>(y * m_pointsY);
+    double minX = 1e30, minY = 1e30, maxX = -1e30, maxY = -1e30;
+    double maxHalf = 0.0;
     
-    for (int dy = -1; dy <= 1; ++dy) {
-        for (int dx = -1; dx <= 1; ++dx) {
-            int cx = cellX + dx;
-            int cy = cellY + dy;
-            
-            if (cx < 0 || cx >= m_pointsX || cy < 0 || cy >= m_pointsY) continue;
+    for (int cy = 0; cy < pointsY; ++cy) {
+        for (int cx = 0; cx < pointsX; ++cx) {
+            CellRandom rng(m_seed, cx, cy);
             
-            // Seed RNG for this cell
-            rng.seed(m_seed + cx * 1000 + cy);
-            
-            // Check density mask
             double centerX = (cx + 0.5) * cellWidth;
             double centerY = (cy + 0.5) * cellHeight;
             
-            if (m_densityInput->isConnected()) {
+            // Density mask is sampled once per instance, not per pixel
+            if (useDensity) {
                 QVector3D densityPos(centerX * 512.0, centerY * 512.0, 0);
                 double density = m_densityInput->getValue(densityPos).toDouble();
-                if (dist(rng) + 0.5 > density) continue;
+                if (rng.next() + 0.5 > density) continue;
             }
             
-            // Random variations for this instance
-            double instanceScale = m_scale * (1.0 + dist(rng) * m_scaleVariation * 2.0);
-            double instanceRotation = m_rotation + dist(rng) * m_rotationVariation * 2.0;
-            
-            // Transform coordinates relative to cell center
-            double localX = (x - centerX) / instanceScale;
-            double localY = (y - centerY) / instanceScale;
+            double instanceScale = m_scale * (1.0 + rng.next() * m_scaleVariation * 2.0);
+            double instanceRotation = m_rotation + rng.next() * m_rotationVariation * 2.0;
+            if (instanceScale <= 1e-6) continue;
             
-            // Apply rotation
             double rotRad = instanceRotation * M_PI / 180.0;
             double cosR = std::cos(rotRad);
             double sinR = std::sin(rotRad);
-            double rotX = localX * cosR - localY * sinR;
-            double rotY = localX * sinR + localY * cosR;
+            
+            // Axis-aligned half extent of the rotated unit square
+            double half = 0.5 * instanceScale * (std::abs(cosR) + std::abs(sinR));
+            
+            Instance inst;
+            inst.centerX = static_cast<float>(centerX);
+            inst.centerY = static_cast<float>(centerY);
+            inst.invScale = static_cast<float>(1.0 / instanceScale);
+            inst.cosR = static_cast<float>(cosR);
+            inst.sinR = static_cast<float>(sinR);
+            table->instances.push_back(inst);
+            halfExtents.push_back(static_cast<float>(half));
+            
+            minX = std::min(minX, centerX - half);
+            minY = std::min(minY, centerY - half);
+            maxX = std::max(maxX, centerX + half);
+            maxY = std::max(maxY, centerY + half);
+            maxHalf = std::max(maxHalf, half);
+        }
+    }
+    
+    const int count = static_cast<int>(table->instances.size());
+    if (count == 0) {
+        table->binStart.assign(1, 0);
+        return table;
+    }
+    
+    // Bin size follows the largest instance so each instance lands in at most
+    // 2x2 bins; capped so the bin array stays bounded.
+    const double extentX = std::max(maxX - minX, 1e-9);
+    const double extentY = std::max(maxY - minY, 1e-9);
+    const int maxBins = std::max(1, std::min(1024, 2 * std::max(pointsX, pointsY)));
+    table->binsX = qBound(1, static_cast<int>(std::ceil(extentX / (2.0 * maxHalf))), maxBins);
+    table->binsY = qBound(1, static_cast<int>(std::ceil(extentY / (2.0 * maxHalf))), maxBins);
+    table->minX = minX;
+    table->minY = minY;
+    table->binWidth = extentX / table->binsX;
+    table->binHeight = extentY / table->binsY;
+    
+    auto binRange = [&](int i, int& x0, int& y0, int& x1, int& y1) {
+        const Instance& inst = table->instances[i];
+        const double h = halfExtents[i];
+        x0 = qBound(0, static_cast<int>((inst.centerX - h - minX) / table->binWidth), table->binsX - 1);
+        x1 = qBound(0, static_cast<int>((inst.centerX + h - minX) / table->binWidth), table->binsX - 1);
+        y0 = qBound(0, static_cast<int>((inst.centerY - h - minY) / table->binHeight), table->binsY - 1);
+        y1 = qBound(0, static_cast<int>((inst.centerY + h - minY) / table->binHeight), table->binsY - 1);
+    };
+    
+    // Counting pass, prefix sum, then fill (CSR layout)
+    const int binCount = table->binsX * table->binsY;
+    table->binStart.assign(binCount + 1, 0);
+    for (int i = 0; i < count; ++i) {
+        int x0, y0, x1, y1;
+        binRange(i, x0, y0, x1, y1);
+        for (int by = y0; by <= y1; ++by)
+            for (int bx = x0; bx <= x1; ++bx)
+                table->binStart[by * table->binsX + bx + 1]++;
+    }
+    for (int b = 0; b < binCount; ++b) {
+        table->binStart[b + 1] += table->binStart[b];
+    }
+    
+    table->binItems.resize(table->binStart[binCount]);
+    std::vector<int> cursor(table->binStart.begin(), table->binStart.end() - 1);
+    for (int i = 0; i < count; ++i) {
+        int x0, y0, x1, y1;
+        binRange(i, x0, y0, x1, y1);
+        for (int by = y0; by <= y1; ++by)
+            for (int bx = x0; bx <= x1; ++bx)
+                table->binItems[cursor[by * table->binsX + bx]++] = i;
+    }
+    
+    return table;
+}
+
+QVariant ScatterOnPointsNode::compute(const QVector3D& pos, NodeSocket* socket) {
+    std::shared_ptr<const InstanceTable> table = instanceTable();
+    
+    // Get input coordinates
+    QVector3D vec;
+    if (m_vectorInput->isConnected()) {
+        vec = m_vectorInput->getValue(pos).value<QVector3D>();
+    } else {
+        vec = QVector3D(pos.x() / 512.0, pos.y() / 512.0, 0.0);
+    }
+    
+    double x = vec.x();
+    double y = vec.y();
+    
+    QVector4D resultColor(0, 0, 0, 0);
+    double resultValue = 0.0;
+    
+    // Locate the bin; every instance whose bounds cover it is listed there
+    double fx = (x - table->minX) / table->binWidth;
+    double fy = (y - table->minY) / table->binHeight;
+    if (table->binsX > 0 && fx >= 0.0 && fy >= 0.0 && fx < table->binsX && fy < table->binsY) {
+        int bin = static_cast<int>(fy) * table->binsX + static_cast<int>(fx);
+        const bool textureConnected = m_textureInput->isConnected();
+        
+        for (int k = table->binStart[bin]; k < table->binStart[bin + 1]; ++k) {
+            const Instance& inst = table->instances[table->binItems[k]];
+            
+            // Transform coordinates relative to instance center
+            double localX = (x - inst.centerX) * inst.invScale;
+            double localY = (y - inst.centerY) * inst.invScale;
+            double rotX = localX * inst.cosR - localY * inst.sinR;
+            double rotY = localX * inst.sinR + localY * inst.cosR;
             
             // Check if inside instance bounds
             if (std::abs(rotX) > 0.5 || std::abs(rotY) > 0.5) continue;
             
-            // Sample texture at transformed coordinates
-            if (m_textureInput->isConnected()) {
-                QVector3D texPos((rotX + 0.5) * 512.0, (rotY + 0.5) * 512.0, 0);
-                QVariant texVal = m_textureInput->getValue(texPos);
-                
-                if (texVal.canConvert<QVector4D>()) {
-                    QVector4D color = texVal.value<QVector4D>();
-                    if (color.w() > resultColor.w()) {
-                        resultColor = color;
-                        resultValue = (color.x() + color.y() + color.z()) / 3.0;
-                    }
-                } else {
-                    double v = texVal.toDouble();
-                    if (v > resultValue) {
-                        resultValue = v;
-                        resultColor = QVector4D(v, v, v, 1.0);
-                    }
-                }
-            } else {
+            if (!textureConnected) {
                 // No texture connected, just show point
                 resultColor = QVector4D(1, 1, 1, 1);
                 resultValue = 1.0;
+                break;
+            }
+            
+            // Sample texture at transformed coordinates
+            QVector3D texPos((rotX + 0.5) * 512.0, (rotY + 0.5) * 512.0, 0);
+            QVariant texVal = m_textureInput->getValue(texPos);
+            
+            if (texVal.canConvert<QVector4D>()) {
+                QVector4D color = texVal.value<QVector4D>();
+                if (color.w() > resultColor.w()) {
+                    resultColor = color;
+                    resultValue = (color.x() + color.y() + color.z()) / 3.0;
+                }
+            } else {
+                double v = texVal.toDouble();
+                if (v > resultValue) {
+                    resultValue = v;
+                    resultColor = QVector4D(v, v, v, 1.0);
+                }
             }
         }
     }
@@ -134,15 +261,28 @@ QVariant ScatterOnPointsNode::compute(const QVector3D& pos, NodeSocket* socket)
     return resultValue;
 }
 
-QVector<Node::ParameterInfo> ScatterOnPointsNode::parameters() const {
+QVector<Node::ParameterInfo> ScatterOnPointsNode::describeParameters() const {
+    using Self = ScatterOnPointsNode;
     QVector<ParameterInfo> params;
     
-    params.append(ParameterInfo("Points X", 1.0, 20.0, (double)m_pointsX, 1.0, "Grid columns"));
-    params.append(ParameterInfo("Points Y", 1.0, 20.0, (double)m_pointsY, 1.0, "Grid rows"));
-    params.append(ParameterInfo("Scale", 0.01, 1.0, m_scale, 0.01, "Instance scale"));
-    params.append(ParameterInfo("Scale Var", 0.0, 1.0, m_scaleVariation, 0.01, "Random scale variation"));
-    params.append(ParameterInfo("Rotation", 0.0, 360.0, m_rotation, 1.0, "Base rotation"));
-    params.append(ParameterInfo("Rotation Var", 0.0, 180.0, m_rotationVariation, 1.0, "Random rotation variation"));
+    params.append(ParameterInfo("Points X", 1.0, 1000.0, (double)m_pointsX, 1.0, "Grid columns")
+        .bind<Self>([](const Self& n) { return n.m_pointsX; },
+                    [](Self& n, const QVariant& v) { n.m_pointsX = qBound(1, v.toInt(), 1000); n.setDirty(true); }));
+    params.append(ParameterInfo("Points Y", 1.0, 1000.0, (double)m_pointsY, 1.0, "Grid rows")
+        .bind<Self>([](const Self& n) { return n.m_pointsY; },
+                    [](Self& n, const QVariant& v) { n.m_pointsY = qBound(1, v.toInt(), 1000); n.setDirty(true); }));
+    params.append(ParameterInfo("Scale", 0.01, 1.0, m_scale, 0.01, "Instance scale")
+        .bind<Self>([](const Self& n) { return n.m_scale; },
+                    [](Self& n, const QVariant& v) { n.m_scale = v.toDouble(); n.setDirty(true); }));
+    params.append(ParameterInfo("Scale Var", 0.0, 1.0, m_scaleVariation, 0.01, "Random scale variation")
+        .bind<Self>([](const Self& n) { return n.m_scaleVariation; },
+                    [](Self& n, const QVariant& v) { n.m_scaleVariation = v.toDouble(); n.setDirty(true); }));
+    params.append(ParameterInfo("Rotation", 0.0, 360.0, m_rotation, 1.0, "Base rotation")
+        .bind<Self>([](const Self& n) { return n.m_rotation; },
+                    [](Self& n, const QVariant& v) { n.m_rotation = v.toDouble(); n.setDirty(true); }));
+    params.append(ParameterInfo("Rotation Var", 0.0, 180.0, m_rotationVariation, 1.0, "Random rotation variation")
+        .bind<Self>([](const Self& n) { return n.m_rotationVariation; },
+                    [](Self& n, const QVariant& v) { n.m_rotationVariation = v.toDouble(); n.setDirty(true); }));
     
     ParameterInfo seedInfo;
     seedInfo.type = ParameterInfo::Int;
@@ -152,10 +292,8 @@ QVector<Node::ParameterInfo> ScatterOnPointsNode::parameters() const {
     seedInfo.defaultValue = m_seed;
     seedInfo.step = 1;
     seedInfo.tooltip = "Random seed";
-    seedInfo.setter = [this](const QVariant& v) {
-        const_cast<ScatterOnPointsNode*>(this)->m_seed = v.toInt();
-        const_cast<ScatterOnPointsNode*>(this)->setDirty(true);
-    };
+    seedInfo.bind<Self>([](const Self& n) { return n.m_seed; },
+                        [](Self& n, const QVariant& v) { n.m_seed = v.toInt(); n.setDirty(true); });
     params.append(seedInfo);
     
     return params;
@@ -183,4 +321,5 @@ void ScatterOnPointsNode::restore(const QJsonObject& json) {
     if (json.contains("rotation")) m_rotation = json["rotation"].toDouble();
     if (json.contains("rotationVariation")) m_rotationVariation = json["rotationVariation"].toDouble();
     if (json.contains("seed")) m_seed = json["seed"].toInt();
+    setDirty(true);
 }
@@ -3,6 +3,8 @@
 
 #include "node.h"
 #include <QRecursiveMutex>
+#include <memory>
+#include <vector>
 
 // Scatter on Points Node - Places texture instances at point locations
 class ScatterOnPointsNode : public Node {
@@ -13,11 +15,41 @@ public:
     void evaluate() override;
     QVariant compute(const QVector3D& pos, NodeSocket* socket) override;
     
-    QVector<ParameterInfo> parameters() const override;
     QJsonObject save() const override;
     void restore(const QJsonObject& json) override;
     
+protected:
+    QVector<ParameterInfo> describeParameters() const override;
+    void invalidate() override;
+
 private:
+    // One placed instance (UV space), generated once per parameter change
+    struct Instance {
+        float centerX;
+        float centerY;
+        float invScale;   // 1 / instance scale
+        float cosR;
+        float sinR;
+    };
+    
+    // Flat instance table binned into a uniform grid by bounding box.
+    // binStart has (binsX * binsY + 1) entries; the instances overlapping
+    // bin i are binItems[binStart[i] .. binStart[i + 1]).
+    struct InstanceTable {
+        std::vector<Instance> instances;
+        std::vector<int> binStart;
+        std::vector<int> binItems;
+        int binsX = 0;
+        int binsY = 0;
+        double minX = 0.0;
+        double minY = 0.0;
+        double binWidth = 1.0;
+        double binHeight = 1.0;
+    };
+    
+    std::shared_ptr<const InstanceTable> instanceTable();
+    std::shared_ptr<const InstanceTable> buildInstanceTable() const;
+    
     // Input sockets
     NodeSocket* m_vectorInput;
     NodeSocket* m_textureInput;   // Texture to scatter
@@ -36,6 +68,8 @@ private:
     int m_pointsX = 5;              // Grid points X
     int m_pointsY = 5;              // Grid points Y
     
+    // Cached instances (null when dirty); swapped atomically so compute() never locks
+    std::shared_ptr<const InstanceTable> m_table;
     mutable QRecursiveMutex m_mutex;
 };
 
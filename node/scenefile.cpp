@@ -0,0 +1,206 @@
+#include "scenefile.h"
+#include <QCborValue>
+#include <QDataStream>
+#include <QFile>
+#include <QSaveFile>
+#include <QtEndian>
+
+namespace {
+
+constexpr quint32 kMagic = 0x4E43534E;  // "NSCN"
+constexpr quint32 kGraphChunk = 0x48505247;  // "GRPH"
+constexpr quint32 kBakeChunk = 0x454B4142;   // "BAKE"
+constexpr quint32 kCompressed = 0x1;
+
+constexpr qint64 kHeaderBytes = 16;
+constexpr qint64 kEntryBytes = 40;
+constexpr qint64 kAlignment = 64;
+
+struct ChunkEntry {
+    quint32 type;
+    quint32 flags;
+    quint64 key;
+    quint64 offset;
+    quint64 size;
+    quint64 rawSize;
+    QByteArray data;
+};
+
+inline qint64 alignUp(qint64 value) {
+    return (value + kAlignment - 1) / kAlignment * kAlignment;
+}
+
+} // namespace
+
+bool SceneFile::isSceneFile(const QByteArray& head) {
+    return head.size() >= 4 &&
+           qFromLittleEndian<quint32>(reinterpret_cast<const uchar*>(head.constData())) == kMagic;
+}
+
+bool SceneFile::write(const QString& path, const QJsonObject& graph,
+                      const QVector<Payload>& payloads, bool compressPayloads, QString* error) {
+    auto fail = [error](const QString& message) {
+        if (error) *error = message;
+        return false;
+    };
+
+    QVector<ChunkEntry> chunks;
+    {
+        const QByteArray cbor = QCborValue::fromJsonValue(graph).toCbor();
+        chunks.append({kGraphChunk, kCompressed, 0, 0, 0, quint64(cbor.size()), qCompress(cbor)});
+    }
+    for (const Payload& payload : payloads) {
+        if (payload.data.isEmpty()) continue;
+        if (compressPayloads) {
+            chunks.append({kBakeChunk, kCompressed, payload.key, 0, 0, quint64(payload.data.size()), qCompress(payload.data)});
+        } else {
+            chunks.append({kBakeChunk, 0, payload.key, 0, 0, quint64(payload.data.size()), payload.data});
+        }
+    }
+
+    qint64 offset = alignUp(kHeaderBytes + kEntryBytes * chunks.size());
+    for (ChunkEntry& chunk : chunks) {
+        chunk.offset = quint64(offset);
+        chunk.size = quint64(chunk.data.size());
+        offset = alignUp(offset + chunk.data.size());
+    }
+
+    QSaveFile file(path);
+    if (!file.open(QIODevice::WriteOnly)) {
+        return fail(file.errorString());
+    }
+
+    QDataStream header(&file);
+    header.setByteOrder(QDataStream::LittleEndian);
+    header << kMagic << Version << quint32(chunks.size()) << quint32(0);
+    for (const ChunkEntry& chunk : chunks) {
+        header << chunk.type << chunk.flags << chunk.key << chunk.offset << chunk.size << chunk.rawSize;
+    }
+
+    for (const ChunkEntry& chunk : chunks) {
+        const qint64 padding = qint64(chunk.offset) - file.pos();
+        if (padding > 0) file.write(QByteArray(padding, '\0'));
+        if (file.write(chunk.data) != chunk.data.size()) {
+            file.cancelWriting();
+            return fail(file.errorString());
+        }
+    }
+
+    if (!file.commit()) {
+        return fail(file.errorString());
+    }
+    return true;
+}
+
+std::shared_ptr<const SceneFile> SceneFile::open(const QString& path, QString* error) {
+    std::shared_ptr<SceneFile> scene(new SceneFile());
+    scene->m_file = std::make_unique<QFile>(path);
+    if (!scene->m_file->open(QIODevice::ReadOnly)) {
+        if (error) *error = scene->m_file->errorString();
+        return nullptr;
+    }
+
+    const qint64 size = scene->m_file->size();
+    scene->m_map = scene->m_file->map(0, size);
+    if (!scene->m_map) {
+        // マップできない場合（一部のファイルシステム等）は読み込みで代用
+        scene->m_data = scene->m_file->readAll();
+        scene->m_file.reset();
+        if (!scene->parse(reinterpret_cast<const uchar*>(scene->m_data.constData()), scene->m_data.size(), error)) {
+            return nullptr;
+        }
+        return scene;
+    }
+
+    if (!scene->parse(scene->m_map, size, error)) {
+        return nullptr;
+    }
+    return scene;
+}
+
+std::shared_ptr<const SceneFile> SceneFile::fromData(const QByteArray& data, QString* error) {
+    std::shared_ptr<SceneFile> scene(new SceneFile());
+    scene->m_data = data;
+    if (!scene->parse(reinterpret_cast<const uchar*>(scene->m_data.constData()), scene->m_data.size(), error)) {
+        return nullptr;
+    }
+    return scene;
+}
+
+SceneFile::~SceneFile() {
+    if (m_file && m_map) {
+        m_file->unmap(m_map);
+    }
+}
+
+bool SceneFile::parse(const uchar* base, qint64 size, QString* error) {
+    auto fail = [error](const QString& message) {
+        if (error) *error = message;
+        return false;
+    };
+
+    if (size < kHeaderBytes || qFromLittleEndian<quint32>(base) != kMagic) {
+        return fail(QStringLiteral("Not a scene file"));
+    }
+    const quint32 version = qFromLittleEndian<quint32>(base + 4);
+    if (version != Version) {
+        return fail(QStringLiteral("Unsupported scene file version %1").arg(version));
+    }
+    const quint32 count = qFromLittleEndian<quint32>(base + 8);
+    if (kHeaderBytes + kEntryBytes * qint64(count) > size) {
+        return fail(QStringLiteral("Truncated scene file"));
+    }
+
+    bool haveGraph = false;
+    for (quint32 i = 0; i < count; ++i) {
+        const uchar* entry = base + kHeaderBytes + kEntryBytes * i;
+        const quint32 type = qFromLittleEndian<quint32>(entry);
+        const quint32 flags = qFromLittleEndian<quint32>(entry + 4);
+        const quint64 key = qFromLittleEndian<quint64>(entry + 8);
+        const quint64 offset = qFromLittleEndian<quint64>(entry + 16);
+        const quint64 stored = qFromLittleEndian<quint64>(entry + 24);
+        const quint64 rawSize = qFromLittleEndian<quint64>(entry + 32);
+        if (offset > quint64(size) || stored > quint64(size) - offset) {
+            return fail(QStringLiteral("Truncated scene file"));
+        }
+
+        const uchar* data = base + offset;
+        qint64 length = qint64(stored);
+        if (flags & kCompressed) {
+            QByteArray inflated = qUncompress(data, qsizetype(stored));
+            if (quint64(inflated.size()) != rawSize) {
+                return fail(QStringLiteral("Corrupt chunk in scene file"));
+            }
+            m_inflated.append(inflated);
+            data = reinterpret_cast<const uchar*>(m_inflated.last().constData());
+            length = m_inflated.last().size();
+        }
+
+        if (type == kGraphChunk) {
+            QCborParserError parseError;
+            const QCborValue value = QCborValue::fromCbor(
+                QByteArray::fromRawData(reinterpret_cast<const char*>(data), length), &parseError);
+            if (parseError.error != QCborError::NoError) {
+                return fail(parseError.errorString());
+            }
+            m_graph = value.toJsonValue().toObject();
+            haveGraph = true;
+        } else if (type == kBakeChunk) {
+            m_payloads.insert(key, {data, length});
+        }
+        // 未知のチャンクは読み飛ばす（後方互換）
+    }
+
+    if (!haveGraph) {
+        return fail(QStringLiteral("Scene file has no graph"));
+    }
+    return true;
+}
+
+bool SceneFile::payload(quint64 key, const uchar** data, qint64* size) const {
+    auto it = m_payloads.find(key);
+    if (it == m_payloads.end()) return false;
+    *data = it->data;
+    *size = it->size;
+    return true;
+}
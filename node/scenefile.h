@@ -0,0 +1,74 @@
+#ifndef SCENEFILE_H
+#define SCENEFILE_H
+
+#include <QByteArray>
+#include <QHash>
+#include <QJsonObject>
+#include <QString>
+#include <QVector>
+#include <QtGlobal>
+#include <memory>
+
+class QFile;
+
+// Scene File - versioned binary container for a node graph (.nscene).
+// JSON stays the interchange format; this one is for fast project load.
+//
+// Besides the graph, the file can carry baked payloads: expensive generator
+// state (river maps, Everling volumes, point sets) keyed by a hash of the
+// producing node's parameters and upstream graph. The file is memory-mapped
+// on load, and payloads are handed to nodes straight from the mapping.
+//
+// File layout (little endian):
+//   "NSCN" | version | chunkCount | reserved                      (u32)
+//   per chunk: type | flags (u32), key | offset | size | rawSize  (u64)
+//   chunk data, each aligned to 64 bytes
+class SceneFile {
+public:
+    static constexpr quint32 Version = 1;
+
+    struct Payload {
+        quint64 key;
+        QByteArray data;
+    };
+
+    // 先頭数バイトでバイナリ形式かどうかを判定
+    static bool isSceneFile(const QByteArray& head);
+
+    // The graph chunk is always compressed; payloads only when asked, since
+    // compressed payloads have to be inflated instead of mapped on load.
+    static bool write(const QString& path, const QJsonObject& graph,
+                      const QVector<Payload>& payloads, bool compressPayloads = false,
+                      QString* error = nullptr);
+
+    static std::shared_ptr<const SceneFile> open(const QString& path, QString* error = nullptr);
+    static std::shared_ptr<const SceneFile> fromData(const QByteArray& data, QString* error = nullptr);
+
+    ~SceneFile();
+
+    const QJsonObject& graph() const { return m_graph; }
+
+    // Baked payload for a key. The pointer stays valid while this object
+    // lives. Returns false if the file has no payload for the key.
+    bool payload(quint64 key, const uchar** data, qint64* size) const;
+    int payloadCount() const { return m_payloads.size(); }
+
+private:
+    struct Entry {
+        const uchar* data;
+        qint64 size;
+    };
+
+    SceneFile() = default;
+    bool parse(const uchar* base, qint64 size, QString* error);
+
+    QJsonObject m_graph;
+    QHash<quint64, Entry> m_payloads;
+    QVector<QByteArray> m_inflated;  // 圧縮されていたペイロードの展開先
+
+    std::unique_ptr<QFile> m_file;
+    uchar* m_map = nullptr;
+    QByteArray m_data;
+};
+
+#endif // SCENEFILE_H
@@ -15,7 +15,7 @@ SeparateXYZNode::SeparateXYZNode() : Node("Separate XYZ") {
 
 SeparateXYZNode::~SeparateXYZNode() {}
 
-QVector<Node::ParameterInfo> SeparateXYZNode::parameters() const {
+QVector<Node::ParameterInfo> SeparateXYZNode::describeParameters() const {
     return {
         ParameterInfo("Vector", -10000.0, 10000.0, 0.0)
     };
@@ -0,0 +1,53 @@
+#include "stencilbuffer.h"
+#include "node.h"
+#include "rendercontext.h"
+#include <QColor>
+#include <cmath>
+
+std::shared_ptr<const StencilBuffer> StencilBuffer::build(NodeSocket* input, int width, int height, int radius) {
+    std::shared_ptr<StencilBuffer> buffer(new StencilBuffer());
+    buffer->m_width = qMax(1, width);
+    buffer->m_height = qMax(1, height);
+    buffer->m_radius = qMax(0, radius);
+    buffer->m_stride = buffer->m_width + 2 * buffer->m_radius;
+    
+    const int rows = buffer->m_height + 2 * buffer->m_radius;
+    buffer->m_data.resize(static_cast<size_t>(buffer->m_stride) * rows);
+    
+    StencilBuffer* b = buffer.get();
+    RenderContext::parallelFor(rows, [b, input](int row) {
+        float* out = b->m_data.data() + static_cast<size_t>(row) * b->m_stride;
+        const int y = row - b->m_radius;
+        for (int i = 0; i < b->m_stride; ++i) {
+            const int x = i - b->m_radius;
+            out[i] = static_cast<float>(toScalar(input->getValue(QVector3D(x, y, 0))));
+        }
+    });
+    
+    return buffer;
+}
+
+double StencilBuffer::toScalar(const QVariant& value) {
+    if (value.canConvert<double>()) {
+        return value.toDouble();
+    } else if (value.canConvert<QColor>()) {
+        QColor c = value.value<QColor>();
+        // グレースケール変換（輝度）
+        return 0.299 * c.redF() + 0.587 * c.greenF() + 0.114 * c.blueF();
+    }
+    return 0.0;
+}
+
+bool StencilBuffer::fetch(const QVector3D& pos, double& value) const {
+    // Only exact pixel positions are buffered; fractional taps fall back
+    const float fx = std::floor(pos.x());
+    const float fy = std::floor(pos.y());
+    if (fx != pos.x() || fy != pos.y() || pos.z() != 0.0f) return false;
+    
+    const int x = static_cast<int>(fx) + m_radius;
+    const int y = static_cast<int>(fy) + m_radius;
+    if (x < 0 || y < 0 || x >= m_stride || y >= m_height + 2 * m_radius) return false;
+    
+    value = m_data[static_cast<size_t>(y) * m_stride + x];
+    return true;
+}
@@ -0,0 +1,40 @@
+#ifndef STENCILBUFFER_H
+#define STENCILBUFFER_H
+
+#include <QVariant>
+#include <QVector3D>
+#include <memory>
+#include <vector>
+
+class NodeSocket;
+
+// Stencil Buffer - an input rasterized once per render at integer pixel
+// positions, with an apron of 'radius' pixels around the frame. Stencil
+// nodes (Calculus, Bump) read their neighbour taps from here so every
+// upstream sample is computed once, however many taps read it.
+class StencilBuffer {
+public:
+    // Evaluates 'input' over [-radius, width + radius) x [-radius, height + radius)
+    static std::shared_ptr<const StencilBuffer> build(NodeSocket* input, int width, int height, int radius);
+    
+    // Scalar conversion used for stencil taps (Color -> luminance)
+    static double toScalar(const QVariant& value);
+    
+    int width() const { return m_width; }
+    int height() const { return m_height; }
+    int radius() const { return m_radius; }
+    
+    // Returns true and the buffered value if pos lies on a covered pixel
+    bool fetch(const QVector3D& pos, double& value) const;
+    
+private:
+    StencilBuffer() = default;
+    
+    int m_width = 0;
+    int m_height = 0;
+    int m_radius = 0;
+    int m_stride = 0;
+    std::vector<float> m_data;
+};
+
+#endif // STENCILBUFFER_H
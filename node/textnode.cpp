@@ -1,7 +1,12 @@
 #include "textnode.h"
-#include <QPainter>
+#include "appsettings.h"
+#include "dual.h"
 #include <QFont>
+#include <QFontMetricsF>
 #include <QColor>
+#include <algorithm>
+#include <cmath>
+#include <limits>
 
 TextNode::TextNode() : Node("Text") {
     // Inputs
@@ -16,135 +21,173 @@ TextNode::TextNode() : Node("Text") {
     m_size = 50.0f;
     m_xOffset = 0.5f;
     m_yOffset = 0.5f;
-
-    m_cacheDirty = true;
 }
 
-QVector<Node::ParameterInfo> TextNode::parameters() const {
+QVector<Node::ParameterInfo> TextNode::describeParameters() const {
     return {
-        ParameterInfo(ParameterInfo::String, "Text", "Text", [this](const QVariant& v) {
-            auto* node = const_cast<TextNode*>(this);
-            node->m_text = v.toString();
-            node->m_cacheDirty = true;
-            node->setDirty(true);
-        }),
-        ParameterInfo("Size", 10.0f, 200.0f, 50.0f, 1.0f, "Font Size", [this](const QVariant& v) {
-            auto* node = const_cast<TextNode*>(this);
-            node->m_size = v.toFloat();
-            node->m_cacheDirty = true;
-            node->setDirty(true);
-        }),
-        ParameterInfo("X", -1.0f, 2.0f, 0.5f, 0.01f, "X Position", [this](const QVariant& v) {
-            auto* node = const_cast<TextNode*>(this);
-            node->m_xOffset = v.toFloat();
-            node->setDirty(true);
-        }),
-        ParameterInfo("Y", -1.0f, 2.0f, 0.5f, 0.01f, "Y Position", [this](const QVariant& v) {
-            auto* node = const_cast<TextNode*>(this);
-            node->m_yOffset = v.toFloat();
-            node->setDirty(true);
-        })
+        ParameterInfo(ParameterInfo::String, "Text", m_text)
+            .bind<TextNode>([](const TextNode& n) { return n.m_text; },
+                            [](TextNode& n, const QVariant& v) {
+                                n.m_text = v.toString();
+                                n.invalidateLayout();
+                                n.setDirty(true);
+                            }),
+        ParameterInfo("Size", 10.0f, 200.0f, m_size, 1.0f, "Font Size")
+            .bind<TextNode>([](const TextNode& n) { return n.m_size; },
+                            [](TextNode& n, const QVariant& v) {
+                                n.m_size = v.toFloat();
+                                n.invalidateLayout();
+                                n.setDirty(true);
+                            }),
+        ParameterInfo("X", -1.0f, 2.0f, m_xOffset, 0.01f, "X Position")
+            .bind<TextNode>([](const TextNode& n) { return n.m_xOffset; },
+                            [](TextNode& n, const QVariant& v) {
+                                n.m_xOffset = v.toFloat();
+                                n.setDirty(true);
+                            }),
+        ParameterInfo("Y", -1.0f, 2.0f, m_yOffset, 0.01f, "Y Position")
+            .bind<TextNode>([](const TextNode& n) { return n.m_yOffset; },
+                            [](TextNode& n, const QVariant& v) {
+                                n.m_yOffset = v.toFloat();
+                                n.setDirty(true);
+                            })
     };
 }
 
-void TextNode::renderText() {
-    if (!m_cacheDirty) return;
-
-    // Create a reasonable resolution image
-    int size = 1024;
-    m_cachedImage = QImage(size, size, QImage::Format_ARGB32);
-    m_cachedImage.fill(Qt::transparent);
+void TextNode::invalidateLayout() {
+    QMutexLocker locker(&m_layoutMutex);
+    std::atomic_store(&m_layout, std::shared_ptr<const TextLayout>());
+}
 
-    QPainter painter(&m_cachedImage);
-    painter.setRenderHint(QPainter::Antialiasing);
-    painter.setRenderHint(QPainter::TextAntialiasing);
+std::shared_ptr<const TextNode::TextLayout> TextNode::buildLayout(int sizeClass) const {
+    // 座標系は従来の 1024x1024 キャンバス（UV 0..1）に合わせる
+    const float canvas = 1024.0f;
+    const float fontPixels = m_size * (canvas / 512.0f);
+
+    auto atlas = GlyphAtlas::forFont("Arial", sizeClass); // Default simple font
+    QFont font(atlas->family());
+    font.setPixelSize(sizeClass);
+    QFontMetricsF metrics(font);
+
+    auto layout = std::make_shared<TextLayout>();
+    layout->sizeClass = sizeClass;
+    layout->scale = fontPixels / sizeClass;
+    // X/Y はテキスト中心、ベースラインは高さの 1/4 下（従来の描画位置と同じ）
+    layout->startX = -static_cast<float>(metrics.horizontalAdvance(m_text)) * layout->scale / 2.0f;
+    layout->baselineY = static_cast<float>(metrics.height()) * layout->scale / 4.0f;
+    layout->minX = layout->minY = std::numeric_limits<float>::max();
+    layout->maxX = layout->maxY = -std::numeric_limits<float>::max();
+
+    // 先頭からの幅でペン位置を求める（カーニング込み）
+    int index = 0;
+    for (char32_t codepoint : m_text.toUcs4()) {
+        const int length = codepoint > 0xFFFF ? 2 : 1;
+        PlacedGlyph placed;
+        placed.glyph = atlas->glyph(codepoint);
+        placed.penX = static_cast<float>(metrics.horizontalAdvance(m_text.left(index)));
+        index += length;
+
+        const GlyphAtlas::Glyph& g = *placed.glyph;
+        if (g.width == 0) continue;  // 空白
+        placed.minX = placed.penX + g.originX;
+        placed.minY = g.originY;
+        placed.maxX = placed.minX + g.width;
+        placed.maxY = placed.minY + g.height;
+        layout->minX = std::min(layout->minX, placed.minX);
+        layout->minY = std::min(layout->minY, placed.minY);
+        layout->maxX = std::max(layout->maxX, placed.maxX);
+        layout->maxY = std::max(layout->maxY, placed.maxY);
+        layout->glyphs.append(placed);
+    }
+    return layout;
+}
 
-    QFont font("Arial"); // Default simple font
-    font.setPixelSize(static_cast<int>(m_size * (size / 512.0f))); // Scale relative to texture size
-    painter.setFont(font);
+std::shared_ptr<const TextNode::TextLayout> TextNode::layout() {
+    auto current = std::atomic_load(&m_layout);
+    if (current) return current;
 
-    painter.setPen(Qt::white);
-    
-    // Draw text centered for now, alignment logic handled by UV offset in compute or here?
-    // Let's draw centered and let UV inputs handle detailed placement, 
-    // BUT user asked for X/Y params.
-    // The X/Y params in UV space (0-1) correspond to where the text center should be.
-    // If we draw strictly to the image, we can just center it and shift UV reading.
-    // Or we can draw at the offset position. 
-    // Drawing at offset position is intuitive.
-
-    // Font metrics for centering
-    QFontMetrics params(font);
-    int textWidth = params.horizontalAdvance(m_text);
-    int textHeight = params.height();
-
-    // Map 0-1 offset to pixel coords
-    // Note: Y is usually top-down in QImage, but UV is bottom-up in 3D usually.
-    // Let's assume standard image coords for drawing (0,0 top-left).
-    // If X/Y is 0.5, 0.5, we want text center at 512, 512.
-    
-    // However, since we cache the image once, baking the offset into the image means
-    // if the user pans X, we have to redraw.
-    // Retaining 'centered' image and shifting UV in compute is much faster (no redraw).
-    // BUT, 'TextNode' usually implies baking for specific layout.
-    // Let's bake it for simplicity of "What You See".
-    
-    int x = static_cast<int>(m_xOffset * size) - textWidth / 2;
-    // For UV y=0 at bottom, image y=size at bottom.
-    // yOffset 0.5 -> center. yOffset 0 -> bottom?
-    // Let's stick to standard 2D image Top-Left origin for parameters for now, 
-    // unless this is a texture node chain which assumes UV (0,0 bottom-left).
-    // Most param inputs in this app seem 0-1 range.
-    // Let's treat Y=0.5 as center.
-    int y = static_cast<int>((1.0f - m_yOffset) * size) + textHeight / 4; // Approx baseline adjustment
-
-    // Actually, let's just center draw and apply offset in compute? 
-    // No, reusing cached image is good, but re-rendering text is cheap enough for parameter change triggers.
-    // It's cleaner to bake it if we support rotation later.
-    
-    painter.drawText(x, y, m_text);
-    painter.end();
-
-    m_cacheDirty = false;
+    QMutexLocker locker(&m_layoutMutex);
+    current = std::atomic_load(&m_layout);
+    if (!current) {
+        double emPixels = m_size * AppSettings::instance().renderWidth() / 512.0;
+        current = buildLayout(GlyphAtlas::sizeClassFor(emPixels));
+        std::atomic_store(&m_layout, current);
+    }
+    return current;
 }
 
 void TextNode::evaluate() {
-    if (m_cacheDirty) {
-        renderText();
-    }
+    layout();
     setDirty(false);
 }
 
+void TextNode::prepareRender(int width, int height) {
+    Node::prepareRender(width, height);
+
+    // 出力解像度での文字サイズに合ったサイズクラスでレイアウトする
+    const int sizeClass = GlyphAtlas::sizeClassFor(m_size * width / 512.0);
+    auto current = std::atomic_load(&m_layout);
+    if (current && current->sizeClass == sizeClass) return;
+
+    QMutexLocker locker(&m_layoutMutex);
+    std::atomic_store(&m_layout, buildLayout(sizeClass));
+}
+
+bool TextNode::isPrepared(int width, int height) const {
+    if (!Node::isPrepared(width, height)) return false;
+    auto current = std::atomic_load(&m_layout);
+    return current && current->sizeClass == GlyphAtlas::sizeClassFor(m_size * width / 512.0);
+}
+
 QVariant TextNode::compute(const QVector3D& pos, NodeSocket* socket) {
     // Get UV
     QVector3D uv = pos;
+    // 1ピクセルあたりの UV の幅（距離からのアンチエイリアス用）
+    double footprint = 1.0;
     if (m_inputSockets[0]->isConnected()) {
-        uv = m_inputSockets[0]->getValue(pos).value<QVector3D>();
+        DualVec d;
+        if (m_inputSockets[0]->getDual(pos, d)) {
+            uv = d.value();
+            footprint = std::max(std::hypot(d.x.du, d.y.du), std::hypot(d.x.dv, d.y.dv));
+        } else {
+            uv = m_inputSockets[0]->getValue(pos).value<QVector3D>();
+            footprint = 1.0 / std::max(1, AppSettings::instance().renderWidth());
+        }
     }
 
-    // Since we baked position into the image, we just sample directly at UV.
-    // UV is 0-1.
-    // Image is 0-1 (mapped to 0-1023).
-    // QImage: (0,0) is top-left. UV (0,0) is usually bottom-left.
-    
+    // QImage 時代と同じく V は上下反転、キャンバス外は透明
     float u = uv.x();
-    float v = 1.0f - uv.y(); // Flip V for image sampling
-
-    // Wrap or Clamp? Usually Clamp or Repeat. 
-    // For text, Clamp to Border (Transparent) is best.
+    float v = 1.0f - uv.y();
     if (u < 0 || u > 1 || v < 0 || v > 1) {
         if (socket->type() == SocketType::Color) return QColor(0,0,0,0);
         return 0.0f;
     }
 
-    int x = static_cast<int>(u * (m_cachedImage.width() - 1));
-    int y = static_cast<int>(v * (m_cachedImage.height() - 1));
-
-    QColor c = m_cachedImage.pixelColor(x, y);
+    auto text = layout();
+    const float canvas = 1024.0f;
+
+    // テキスト基準の座標（アトラスの基準ピクセル単位）
+    const float bx = ((u - m_xOffset) * canvas - text->startX) / text->scale;
+    const float by = ((v - (1.0f - m_yOffset)) * canvas - text->baselineY) / text->scale;
+    const float pixel = std::max(1e-6f, static_cast<float>(footprint) * canvas / text->scale);
+    const float reach = pixel;
+
+    float alpha = 0.0f;
+    if (bx >= text->minX - reach && bx <= text->maxX + reach &&
+        by >= text->minY - reach && by <= text->maxY + reach) {
+        float distance = std::numeric_limits<float>::max();
+        for (const PlacedGlyph& g : text->glyphs) {
+            if (bx < g.minX - reach || bx > g.maxX + reach || by < g.minY - reach || by > g.maxY + reach) continue;
+            distance = std::min(distance, g.glyph->distance(bx - g.penX, by));
+        }
+        // 距離から画素のカバレッジを求める
+        alpha = std::clamp(0.5f - distance / pixel, 0.0f, 1.0f);
+    }
 
     if (socket == m_outputSockets[0]) { // Color
-        return c;
+        if (alpha <= 0.0f) return QColor(0, 0, 0, 0);
+        return QColor::fromRgbF(1.0f, 1.0f, 1.0f, alpha);
     } else { // Alpha
-        return c.alphaF();
+        return alpha;
     }
 }
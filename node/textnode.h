@@ -2,7 +2,10 @@
 #define TEXTNODE_H
 
 #include "node.h"
-#include <QImage>
+#include "glyphatlas.h"
+#include <QMutex>
+#include <QVector>
+#include <memory>
 
 class TextNode : public Node {
 public:
@@ -12,23 +15,45 @@ public:
     // checking base class.. Node.h has separate name member.
     // Construct sets name.
 
-    QVector<ParameterInfo> parameters() const override;
-
     void evaluate() override;
+    void prepareRender(int width, int height) override;
+    bool isPrepared(int width, int height) const override;
     QVariant compute(const QVector3D& pos, NodeSocket* socket) override;
 
+protected:
+    QVector<ParameterInfo> describeParameters() const override;
+
 private:
-    void renderText();
+    // レイアウト済みの文字列。位置 (X/Y) には依存しないので移動では作り直さない
+    // Glyph positions are in atlas base pixels relative to the first pen
+    // position on the baseline.
+    struct PlacedGlyph {
+        GlyphAtlas::GlyphPtr glyph;
+        float penX;
+        float minX, minY, maxX, maxY;  // SDF の有効範囲
+    };
+    struct TextLayout {
+        int sizeClass;
+        float scale;       // キャンバス単位 / 基準ピクセル
+        float startX;      // 中心からの書き出し位置（キャンバス単位）
+        float baselineY;   // 中心からのベースライン位置（キャンバス単位）
+        float minX, minY, maxX, maxY;
+        QVector<PlacedGlyph> glyphs;
+    };
+
+    std::shared_ptr<const TextLayout> buildLayout(int sizeClass) const;
+    std::shared_ptr<const TextLayout> layout();
+    void invalidateLayout();
 
     // Parameters
     QString m_text;
     float m_size;
     float m_xOffset;
     float m_yOffset;
-    
+
     // Internal cache
-    QImage m_cachedImage;
-    bool m_cacheDirty;
+    std::shared_ptr<const TextLayout> m_layout;
+    QMutex m_layoutMutex;
 };
 
 #endif // TEXTNODE_H
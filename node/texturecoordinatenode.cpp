@@ -1,6 +1,7 @@
 #include "texturecoordinatenode.h"
 #include "rendercontext.h"
 #include "appsettings.h"
+#include "dual.h"
 
 TextureCoordinateNode::TextureCoordinateNode()
     : Node("Texture Coordinate"), m_coordinateType(CoordinateType::UV)
@@ -16,7 +17,7 @@ TextureCoordinateNode::TextureCoordinateNode()
 
 TextureCoordinateNode::~TextureCoordinateNode() {}
 
-QVector<Node::ParameterInfo> TextureCoordinateNode::parameters() const {
+QVector<Node::ParameterInfo> TextureCoordinateNode::describeParameters() const {
     QVector<ParameterInfo> params;
     
     QStringList types = {"Generated", "Object", "UV", "Camera", "Window", "Normal", "Reflection"};
@@ -25,10 +26,10 @@ QVector<Node::ParameterInfo> TextureCoordinateNode::parameters() const {
     // and setCoordinateType() sets m_typeInput->setDefaultValue().
     // This is because older implementation used the socket to store the state.
     
-    params.append(ParameterInfo("Coordinate", types, 
-        QVariant::fromValue(static_cast<int>(coordinateType())),
-        [this](const QVariant& v) { const_cast<TextureCoordinateNode*>(this)->setCoordinateType(static_cast<CoordinateType>(v.toInt())); }
-    ));
+    params.append(ParameterInfo("Coordinate", types, static_cast<int>(m_coordinateType))
+        .bind<TextureCoordinateNode>(
+            [](const TextureCoordinateNode& n) { return static_cast<int>(n.coordinateType()); },
+            [](TextureCoordinateNode& n, const QVariant& v) { n.setCoordinateType(static_cast<CoordinateType>(v.toInt())); }));
     
     return params;
 }
@@ -85,6 +86,32 @@ QVariant TextureCoordinateNode::compute(const QVector3D& pixelPos, NodeSocket* s
     return QVector3D(u, v, 0.0);
 }
 
+bool TextureCoordinateNode::computeDual(const QVector3D& pixelPos, NodeSocket* socket, DualVec& out) {
+    Q_UNUSED(socket);
+    int w = AppSettings::instance().renderWidth();
+    int h = AppSettings::instance().renderHeight();
+
+    double minU = AppSettings::instance().viewportMinU();
+    double minV = AppSettings::instance().viewportMinV();
+    double maxU = AppSettings::instance().viewportMaxU();
+    double maxV = AppSettings::instance().viewportMaxV();
+
+    // u/v はピクセル座標の一次関数なので微分は定数
+    double dUdx = (maxU - minU) / (double)w;
+    double dVdy = (maxV - minV) / (double)h;
+    Dual u(minU + (pixelPos.x() + 0.5) * dUdx, dUdx, 0.0);
+    Dual v(minV + (pixelPos.y() + 0.5) * dVdy, 0.0, dVdy);
+
+    int type = m_typeInput ? m_typeInput->value().toInt() : 1;
+    if (type == 1) {
+        u = (u - Dual(0.5)) * Dual(2.0);
+        v = (v - Dual(0.5)) * Dual(2.0);
+    }
+
+    out = DualVec(u, v, Dual(0.0));
+    return true;
+}
+
 TextureCoordinateNode::CoordinateType TextureCoordinateNode::coordinateType() const {
     if (m_typeInput) {
         return static_cast<CoordinateType>(m_typeInput->value().toInt());
@@ -13,8 +13,7 @@ public:
     // ノード評価
     void evaluate() override;
     QVariant compute(const QVector3D& pos, NodeSocket* socket) override;
-    
-    QVector<ParameterInfo> parameters() const override;
+    bool computeDual(const QVector3D& pos, NodeSocket* socket, DualVec& out) override;
 
     // Coordinate type
     enum class CoordinateType {
@@ -30,6 +29,9 @@ public:
     CoordinateType coordinateType() const;
     void setCoordinateType(CoordinateType type);
 
+protected:
+    QVector<ParameterInfo> describeParameters() const override;
+
 private:
     NodeSocket* m_typeInput;  // Coordinate type selector
     NodeSocket* m_output;
@@ -0,0 +1,32 @@
+#ifndef TEXTURESOURCE_H
+#define TEXTURESOURCE_H
+
+#include <cstddef>
+
+// Texture Source - common sampling interface for image data held in memory
+// (MipTexture) or streamed from a tiled file (VirtualTexture).
+// Implementations are immutable from the caller's point of view and safe
+// to sample from several render threads at once.
+class TextureSource {
+public:
+    enum class Filter {
+        Closest,    // 最近傍（レベル0のみ）
+        Linear,     // バイリニア（レベル0のみ）
+        Mipmap      // トライリニア（フットプリントからLODを選択）
+    };
+
+    virtual ~TextureSource() = default;
+
+    virtual int width() const = 0;
+    virtual int height() const = 0;
+
+    // Bytes held resident for the lifetime of the texture (cache accounting)
+    virtual size_t byteSize() const = 0;
+
+    // (u, v) are in 0..1 texture space. 'footprint' is the texture-space size
+    // of one render pixel (0..1 units), used to pick the mip level.
+    // Writes straight RGBA in 0..1 to rgba.
+    virtual void sample(double u, double v, double footprint, Filter filter, bool repeat, float rgba[4]) const = 0;
+};
+
+#endif // TEXTURESOURCE_H
@@ -0,0 +1,207 @@
+#include "trace.h"
+#include <QFile>
+#include <QMutex>
+#include <QMutexLocker>
+#include <QTextStream>
+#include <algorithm>
+#include <chrono>
+#include <cstring>
+#include <memory>
+#include <vector>
+
+std::atomic<quint32> Trace::s_categories{(1u << Trace::CategoryCount) - 1};
+std::atomic<bool> Trace::s_echo{false};
+
+namespace {
+
+constexpr int kRingSize = 512;    // スレッドごとのイベント数（2の累乗）
+constexpr int kTextSize = 112;    // UTF-8、超えた分は切り捨て
+
+qint64 nowNs() {
+    using namespace std::chrono;
+    static const steady_clock::time_point start = steady_clock::now();
+    return duration_cast<nanoseconds>(steady_clock::now() - start).count();
+}
+
+// 1スレッド専用のリングバッファ
+// Only the owning thread writes. Each slot carries a sequence number that is
+// odd while the slot is being written, so a concurrent dump() skips slots it
+// would otherwise read half-written (seqlock).
+struct Ring {
+    struct Event {
+        std::atomic<quint32> seq{0};
+        qint64 time = 0;
+        quint8 level = 0;
+        quint8 category = 0;
+        char text[kTextSize];
+    };
+
+    int index = 0;                     // ダンプ時のスレッド番号
+    std::atomic<bool> inUse{false};
+    std::atomic<quint32> head{0};
+    Event events[kRingSize];
+
+    void push(Trace::Level level, Trace::Category category, const QByteArray& utf8) {
+        const quint32 h = head.load(std::memory_order_relaxed);
+        Event& e = events[h & (kRingSize - 1)];
+        const quint32 seq = e.seq.load(std::memory_order_relaxed);
+        e.seq.store(seq + 1, std::memory_order_relaxed);
+        std::atomic_thread_fence(std::memory_order_release);
+        e.time = nowNs();
+        e.level = quint8(level);
+        e.category = quint8(category);
+        const int n = qMin(int(utf8.size()), kTextSize - 1);
+        std::memcpy(e.text, utf8.constData(), size_t(n));
+        e.text[n] = '\0';
+        e.seq.store(seq + 2, std::memory_order_release);
+        head.store(h + 1, std::memory_order_relaxed);
+    }
+};
+
+// 全スレッドのリング
+// Rings are never freed: a thread that exits returns its ring, and the next
+// new thread reuses it, so pool threads coming and going do not grow the
+// list while their last events stay visible to dump().
+struct RingRegistry {
+    QMutex mutex;
+    std::vector<std::unique_ptr<Ring>> rings;
+
+    Ring* acquire() {
+        QMutexLocker locker(&mutex);
+        for (const auto& ring : rings) {
+            bool expected = false;
+            if (ring->inUse.compare_exchange_strong(expected, true)) {
+                return ring.get();
+            }
+        }
+        rings.push_back(std::make_unique<Ring>());
+        Ring* ring = rings.back().get();
+        ring->index = int(rings.size()) - 1;
+        ring->inUse.store(true);
+        return ring;
+    }
+};
+
+RingRegistry& registry() {
+    static RingRegistry instance;
+    return instance;
+}
+
+struct RingLease {
+    Ring* ring = registry().acquire();
+    ~RingLease() { ring->inUse.store(false); }
+};
+
+Ring* localRing() {
+    thread_local RingLease lease;
+    return lease.ring;
+}
+
+const char* const kLevelNames[] = {"", "E", "W", "I", "D"};
+
+} // namespace
+
+Trace::Message::~Message() {
+    if (m_text.endsWith(QLatin1Char(' '))) {
+        m_text.chop(1);
+    }
+    Trace::record(m_level, m_category, m_text);
+}
+
+void Trace::record(Level level, Category category, const QString& text) {
+    localRing()->push(level, category, text.toUtf8());
+    if (s_echo.load(std::memory_order_relaxed)) {
+        qDebug().noquote() << categoryName(category) << text;
+    }
+}
+
+void Trace::setEnabled(Category category, bool enabled) {
+    if (enabled) {
+        s_categories.fetch_or(1u << category, std::memory_order_relaxed);
+    } else {
+        s_categories.fetch_and(~(1u << category), std::memory_order_relaxed);
+    }
+}
+
+void Trace::configure(const QString& spec) {
+    const QStringList names = spec.toLower().split(QLatin1Char(','), Qt::SkipEmptyParts);
+    if (names.isEmpty()) return;
+
+    quint32 mask = 0;
+    for (const QString& raw : names) {
+        const QString name = raw.trimmed();
+        if (name == QLatin1String("all")) {
+            mask = (1u << CategoryCount) - 1;
+            continue;
+        }
+        for (int c = 0; c < CategoryCount; ++c) {
+            if (name == QString::fromLatin1(categoryName(Category(c))).toLower()) {
+                mask |= 1u << c;
+            }
+        }
+    }
+    s_categories.store(mask, std::memory_order_relaxed);
+}
+
+const char* Trace::categoryName(Category category) {
+    switch (category) {
+    case Graph: return "Graph";
+    case Editor: return "Editor";
+    case IO: return "IO";
+    case App: return "App";
+    default: return "?";
+    }
+}
+
+QStringList Trace::dump() {
+    struct Line {
+        qint64 time;
+        QString text;
+    };
+    std::vector<Line> lines;
+
+    RingRegistry& reg = registry();
+    QMutexLocker locker(&reg.mutex);
+    for (const auto& ring : reg.rings) {
+        for (const Ring::Event& e : ring->events) {
+            const quint32 before = e.seq.load(std::memory_order_acquire);
+            if (before == 0 || (before & 1)) continue;  // 未使用 or 書き込み中
+            const qint64 time = e.time;
+            const quint8 level = e.level;
+            const quint8 category = e.category;
+            char text[kTextSize];
+            std::memcpy(text, e.text, sizeof(text));
+            std::atomic_thread_fence(std::memory_order_acquire);
+            if (e.seq.load(std::memory_order_relaxed) != before) continue;  // 上書きされた
+            text[kTextSize - 1] = '\0';
+
+            lines.push_back({time, QStringLiteral("%1 [%2] %3 %4: %5")
+                                       .arg(double(time) / 1e6, 12, 'f', 3)
+                                       .arg(ring->index)
+                                       .arg(QLatin1String(level <= Debug ? kLevelNames[level] : "?"))
+                                       .arg(QLatin1String(categoryName(Category(category))))
+                                       .arg(QString::fromUtf8(text))});
+        }
+    }
+    locker.unlock();
+
+    std::stable_sort(lines.begin(), lines.end(), [](const Line& a, const Line& b) { return a.time < b.time; });
+    QStringList result;
+    result.reserve(int(lines.size()));
+    for (Line& line : lines) {
+        result.append(std::move(line.text));
+    }
+    return result;
+}
+
+bool Trace::dumpToFile(const QString& path) {
+    QFile file(path);
+    if (!file.open(QIODevice::WriteOnly | QIODevice::Truncate | QIODevice::Text)) {
+        return false;
+    }
+    QTextStream out(&file);
+    for (const QString& line : dump()) {
+        out << line << '\n';
+    }
+    return true;
+}
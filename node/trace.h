@@ -0,0 +1,95 @@
+#ifndef TRACE_H
+#define TRACE_H
+
+#include <QDebug>
+#include <QString>
+#include <QStringList>
+#include <atomic>
+
+// コンパイル時のトレースレベル（これより詳細な呼び出しはコードごと消える）
+// 0 = off, 1 = Error, 2 = Warning, 3 = Info, 4 = Debug
+#ifndef NODE_TRACE_LEVEL
+#ifdef QT_NO_DEBUG
+#define NODE_TRACE_LEVEL 3
+#else
+#define NODE_TRACE_LEVEL 4
+#endif
+#endif
+
+// 低コストのトレース
+// Events go to a fixed-size ring buffer owned by the calling thread, so
+// recording takes no lock and never blocks a render worker; the oldest
+// events are overwritten. dump() collects every thread's ring in time
+// order and can be called from any thread at any time.
+//
+// A call below NODE_TRACE_LEVEL compiles to nothing. Above it, a disabled
+// category costs one relaxed atomic load and the message is not formatted.
+//
+//   traceDebug(Trace::Graph) << "addConnection" << socket->name();
+class Trace {
+public:
+    enum Level { Error = 1, Warning = 2, Info = 3, Debug = 4 };
+    enum Category {
+        Graph,    // ノード・ソケット・接続
+        Editor,   // ノードエディタの操作
+        IO,       // 画像・シーンの読み書き
+        App,      // ウィンドウ・マテリアル
+        CategoryCount
+    };
+
+    static bool isEnabled(Category category) {
+        return s_categories.load(std::memory_order_relaxed) & (1u << category);
+    }
+    static void setEnabled(Category category, bool enabled);
+
+    // 名前のリスト（"graph,io" など。"all" / "none" も可）でカテゴリを設定する。
+    // 空なら何も変えない。
+    static void configure(const QString& spec);
+
+    // Also forward events to qDebug as they are recorded
+    static void setEcho(bool echo) { s_echo.store(echo, std::memory_order_relaxed); }
+
+    // 全スレッドのイベントを時刻順に1行ずつ返す
+    static QStringList dump();
+    // dump() をファイルに書き出す
+    static bool dumpToFile(const QString& path);
+
+    static const char* categoryName(Category category);
+
+    // Formats one event with QDebug and records it when destroyed
+    class Message {
+    public:
+        Message(Level level, Category category) : m_level(level), m_category(category), m_debug(&m_text) {}
+        ~Message();
+        Message(const Message&) = delete;
+        Message& operator=(const Message&) = delete;
+
+        template <typename T>
+        Message& operator<<(const T& value) {
+            m_debug << value;
+            return *this;
+        }
+
+    private:
+        Level m_level;
+        Category m_category;
+        QString m_text;
+        QDebug m_debug;
+    };
+
+private:
+    static void record(Level level, Category category, const QString& text);
+
+    static std::atomic<quint32> s_categories;
+    static std::atomic<bool> s_echo;
+};
+
+#define NODE_TRACE(level, category) \
+    if (!((level) <= NODE_TRACE_LEVEL && Trace::isEnabled(category))) {} else Trace::Message((level), (category))
+
+#define traceError(category) NODE_TRACE(Trace::Error, category)
+#define traceWarning(category) NODE_TRACE(Trace::Warning, category)
+#define traceInfo(category) NODE_TRACE(Trace::Info, category)
+#define traceDebug(category) NODE_TRACE(Trace::Debug, category)
+
+#endif // TRACE_H
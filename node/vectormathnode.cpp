@@ -1,4 +1,5 @@
 #include "vectormathnode.h"
+#include "dual.h"
 #include <cmath>
 #include <algorithm>
 #include <QtMath>
@@ -220,6 +221,115 @@ QVariant VectorMathNode::compute(const QVector3D& pos, NodeSocket* socket) {
     return QVariant();
 }
 
+bool VectorMathNode::computeDual(const QVector3D& pos, NodeSocket* socket, DualVec& out) {
+    if (m_operation == VectorMathOperation::Refract) {
+        return false; // 全反射の分岐があるので有限差分に任せる
+    }
+
+    DualVec v1, v2, v3, sv;
+    if (!m_vector1Input->getDual(pos, v1) || !m_vector2Input->getDual(pos, v2) ||
+        !m_vector3Input->getDual(pos, v3) || !m_scaleInput->getDual(pos, sv)) {
+        return false;
+    }
+    const Dual s = sv.x;
+
+    // 成分ごとの演算
+    auto each = [](const DualVec& a, const DualVec& b, const DualVec& c, auto f) {
+        return DualVec(f(a.x, b.x, c.x), f(a.y, b.y, c.y), f(a.z, b.z, c.z));
+    };
+
+    DualVec resVec;
+    Dual resVal(0.0);
+
+    switch (m_operation) {
+        case VectorMathOperation::Add: resVec = v1 + v2; break;
+        case VectorMathOperation::Subtract: resVec = v1 - v2; break;
+        case VectorMathOperation::Multiply: resVec = v1 * v2; break;
+        case VectorMathOperation::Divide:
+            resVec = each(v1, v2, v3, [](const Dual& a, const Dual& b, const Dual&) {
+                return (b.v != 0) ? a / b : Dual(0.0);
+            });
+            break;
+
+        case VectorMathOperation::Cross: resVec = cross(v1, v2); break;
+        case VectorMathOperation::Dot: resVal = dot(v1, v2); break;
+
+        case VectorMathOperation::Distance: resVal = length(v1 - v2); break;
+        case VectorMathOperation::Length: resVal = length(v1); break;
+
+        case VectorMathOperation::Scale: resVec = v1 * s; break;
+        case VectorMathOperation::Normalize: resVec = normalize(v1); break;
+
+        case VectorMathOperation::Absolute:
+            resVec = DualVec(abs(v1.x), abs(v1.y), abs(v1.z));
+            break;
+        case VectorMathOperation::Minimum:
+            resVec = DualVec(dualMin(v1.x, v2.x), dualMin(v1.y, v2.y), dualMin(v1.z, v2.z));
+            break;
+        case VectorMathOperation::Maximum:
+            resVec = DualVec(dualMax(v1.x, v2.x), dualMax(v1.y, v2.y), dualMax(v1.z, v2.z));
+            break;
+
+        case VectorMathOperation::Floor:
+            resVec = DualVec(floor(v1.x), floor(v1.y), floor(v1.z));
+            break;
+        case VectorMathOperation::Ceil:
+            resVec = DualVec(ceil(v1.x), ceil(v1.y), ceil(v1.z));
+            break;
+        case VectorMathOperation::Fraction:
+            resVec = v1 - DualVec(floor(v1.x), floor(v1.y), floor(v1.z));
+            break;
+        case VectorMathOperation::Modulo:
+            resVec = each(v1, v2, v3, [](const Dual& a, const Dual& b, const Dual&) {
+                return (b.v != 0) ? a - Dual(std::trunc(a.v / b.v)) * b : Dual(0.0);
+            });
+            break;
+        case VectorMathOperation::Wrap:
+            resVec = each(v1, v2, v3, [](const Dual& val, const Dual& min, const Dual& max) {
+                Dual range = max - min;
+                if (range.v == 0) return min;
+                return min + (val - min) - range * floor((val - min) / range);
+            });
+            break;
+        case VectorMathOperation::Snap:
+            resVec = each(v1, v2, v3, [](const Dual& val, const Dual& step, const Dual&) {
+                if (step.v == 0) return val;
+                return floor(val / step + Dual(0.5)) * step;
+            });
+            break;
+
+        case VectorMathOperation::Sine:
+            resVec = DualVec(sin(v1.x), sin(v1.y), sin(v1.z));
+            break;
+        case VectorMathOperation::Cosine:
+            resVec = DualVec(cos(v1.x), cos(v1.y), cos(v1.z));
+            break;
+        case VectorMathOperation::Tangent:
+            resVec = DualVec(tan(v1.x), tan(v1.y), tan(v1.z));
+            break;
+
+        case VectorMathOperation::Reflect: {
+            DualVec n = normalize(v2);
+            resVec = v1 - n * (Dual(2.0) * dot(n, v1));
+            break;
+        }
+        case VectorMathOperation::Faceforward:
+            resVec = (dot(v3, v2).v < 0.0) ? v1 : -v1;
+            break;
+        default:
+            return false;
+    }
+
+    if (socket == m_vectorOutput) {
+        out = resVec;
+        return true;
+    } else if (socket == m_valueOutput) {
+        out = DualVec::scalar(resVal);
+        return true;
+    }
+    return false;
+}
+
 void VectorMathNode::setOperation(VectorMathOperation op) {
     m_operation = op;
     setDirty(true);
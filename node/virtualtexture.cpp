@@ -0,0 +1,379 @@
+#include "virtualtexture.h"
+#include "trace.h"
+#include <QDataStream>
+#include <QFile>
+#include <QImage>
+#include <QImageReader>
+#include <QMutexLocker>
+#include <QSaveFile>
+#include <atomic>
+#include <cstring>
+#include <cmath>
+#include <vector>
+
+namespace {
+
+constexpr quint32 kMagic = 0x58455456;  // "VTEX"
+constexpr quint32 kVersion = 1;
+constexpr size_t kDefaultBudget = size_t(256) * 1024 * 1024;
+
+std::atomic<quint64> g_nextTextureId{1};
+// テクスチャが破棄されるたびに進む。スレッドごとのカーソルはこれを見て
+// 保持しているタイル（とファイル）を手放す
+std::atomic<quint64> g_releaseEpoch{0};
+
+inline int wrapIndex(int i, int size, bool repeat) {
+    if (repeat) {
+        i %= size;
+        return i < 0 ? i + size : i;
+    }
+    return qBound(0, i, size - 1);
+}
+
+inline quint64 tileKey(int level, int tx, int ty) {
+    return (quint64(level) << 48) | (quint64(ty) << 24) | quint64(tx);
+}
+
+// 2x2 ボックスフィルタで半分のサイズに縮小（MipTexture と同じ規則）
+QImage downsample(const QImage& src) {
+    const int w = qMax(1, src.width() / 2);
+    const int h = qMax(1, src.height() / 2);
+    QImage dst(w, h, QImage::Format_RGBA8888);
+    for (int y = 0; y < h; ++y) {
+        const uchar* r0 = src.constScanLine(qMin(2 * y, src.height() - 1));
+        const uchar* r1 = src.constScanLine(qMin(2 * y + 1, src.height() - 1));
+        uchar* out = dst.scanLine(y);
+        for (int x = 0; x < w; ++x) {
+            const int x0 = qMin(2 * x, src.width() - 1) * 4;
+            const int x1 = qMin(2 * x + 1, src.width() - 1) * 4;
+            for (int c = 0; c < 4; ++c) {
+                out[x * 4 + c] = static_cast<uchar>((r0[x0 + c] + r0[x1 + c] + r1[x0 + c] + r1[x1 + c] + 2) / 4);
+            }
+        }
+    }
+    return dst;
+}
+
+const uchar kMissingTexel[4] = {0, 0, 0, 255};
+
+} // namespace
+
+struct VirtualTexture::FileHandle {
+    QFile file;
+    QMutex mutex;  // map/unmap は QFile 単位で直列化
+};
+
+bool VirtualTexture::convert(const QString& sourcePath, const QString& targetPath, int tileSize, QString* error) {
+    auto fail = [error](const QString& message) {
+        if (error) *error = message;
+        return false;
+    };
+    if (tileSize <= 0) tileSize = DefaultTileSize;
+
+    // 変換は1回きりなので、ここではソース全体をデコードする
+    QImageReader reader(sourcePath);
+    const int previousLimit = QImageReader::allocationLimit();
+    QImageReader::setAllocationLimit(0);
+    QImage image = reader.read();
+    QImageReader::setAllocationLimit(previousLimit);
+    if (image.isNull()) {
+        return fail(reader.errorString());
+    }
+    if (image.format() != QImage::Format_RGBA8888) {
+        image = image.convertToFormat(QImage::Format_RGBA8888);
+    }
+
+    // レベル構成とタイル位置を先に決める
+    QVector<Level> levels;
+    int w = image.width();
+    int h = image.height();
+    while (true) {
+        levels.append(Level{w, h, (w + tileSize - 1) / tileSize, (h + tileSize - 1) / tileSize, 0});
+        if (w == 1 && h == 1) break;
+        w = qMax(1, w / 2);
+        h = qMax(1, h / 2);
+    }
+    const qint64 tileBytes = qint64(tileSize) * tileSize * 4;
+    const qint64 headerBytes = 6 * 4 + qint64(levels.size()) * (4 * 4 + 8);
+    qint64 offset = (headerBytes + 4095) / 4096 * 4096;  // タイルはページ境界から
+    for (Level& level : levels) {
+        level.offset = offset;
+        offset += qint64(level.tilesX) * level.tilesY * tileBytes;
+    }
+
+    QSaveFile file(targetPath);
+    if (!file.open(QIODevice::WriteOnly)) {
+        return fail(file.errorString());
+    }
+
+    QDataStream header(&file);
+    header.setByteOrder(QDataStream::LittleEndian);
+    header << kMagic << kVersion << quint32(image.width()) << quint32(image.height())
+           << quint32(tileSize) << quint32(levels.size());
+    for (const Level& level : levels) {
+        header << quint32(level.width) << quint32(level.height)
+               << quint32(level.tilesX) << quint32(level.tilesY) << quint64(level.offset);
+    }
+    file.write(QByteArray(levels[0].offset - headerBytes, '\0'));
+
+    std::vector<uchar> tile(static_cast<size_t>(tileBytes));
+    QImage current = image;
+    image = QImage();
+    for (int l = 0; l < levels.size(); ++l) {
+        const Level& level = levels[l];
+        for (int ty = 0; ty < level.tilesY; ++ty) {
+            for (int tx = 0; tx < level.tilesX; ++tx) {
+                for (int r = 0; r < tileSize; ++r) {
+                    const uchar* line = current.constScanLine(qMin(ty * tileSize + r, level.height - 1));
+                    uchar* out = tile.data() + static_cast<size_t>(r) * tileSize * 4;
+                    for (int c = 0; c < tileSize; ++c) {
+                        const int sx = qMin(tx * tileSize + c, level.width - 1);
+                        memcpy(out + c * 4, line + sx * 4, 4);
+                    }
+                }
+                if (file.write(reinterpret_cast<const char*>(tile.data()), tileBytes) != tileBytes) {
+                    file.cancelWriting();
+                    return fail(file.errorString());
+                }
+            }
+        }
+        if (l + 1 < levels.size()) {
+            current = downsample(current);
+        }
+    }
+
+    if (!file.commit()) {
+        return fail(file.errorString());
+    }
+    return true;
+}
+
+std::shared_ptr<const VirtualTexture> VirtualTexture::open(const QString& path) {
+    auto handle = std::make_shared<FileHandle>();
+    handle->file.setFileName(path);
+    if (!handle->file.open(QIODevice::ReadOnly)) {
+        traceWarning(Trace::IO) << "VirtualTexture: cannot open" << path;
+        return nullptr;
+    }
+
+    QDataStream in(&handle->file);
+    in.setByteOrder(QDataStream::LittleEndian);
+    quint32 magic, version, width, height, tileSize, levelCount;
+    in >> magic >> version >> width >> height >> tileSize >> levelCount;
+    if (in.status() != QDataStream::Ok || magic != kMagic || version != kVersion ||
+        tileSize == 0 || levelCount == 0 || levelCount > 32) {
+        traceWarning(Trace::IO) << "VirtualTexture: not a tiled texture" << path;
+        return nullptr;
+    }
+
+    std::shared_ptr<VirtualTexture> texture(new VirtualTexture());
+    texture->m_id = g_nextTextureId.fetch_add(1);
+    texture->m_tileSize = static_cast<int>(tileSize);
+    const qint64 tileBytes = qint64(tileSize) * tileSize * 4;
+    for (quint32 i = 0; i < levelCount; ++i) {
+        quint32 w, h, tilesX, tilesY;
+        quint64 offset;
+        in >> w >> h >> tilesX >> tilesY >> offset;
+        if (in.status() != QDataStream::Ok ||
+            qint64(offset) + qint64(tilesX) * tilesY * tileBytes > handle->file.size()) {
+            traceWarning(Trace::IO) << "VirtualTexture: truncated file" << path;
+            return nullptr;
+        }
+        texture->m_levels.append(Level{int(w), int(h), int(tilesX), int(tilesY), qint64(offset)});
+    }
+    texture->m_file = handle;
+    texture->setCacheBudget(kDefaultBudget);
+    return texture;
+}
+
+VirtualTexture::~VirtualTexture() {
+    // タイルの削除子がファイルをアンマップする
+    m_index.clear();
+    m_lru.clear();
+    g_releaseEpoch.fetch_add(1, std::memory_order_relaxed);
+}
+
+size_t VirtualTexture::byteSize() const {
+    QMutexLocker locker(&m_cacheMutex);
+    return m_lru.size() * size_t(m_tileSize) * m_tileSize * 4;
+}
+
+void VirtualTexture::setCacheBudget(size_t bytes) {
+    QMutexLocker locker(&m_cacheMutex);
+    const size_t tileBytes = size_t(m_tileSize) * m_tileSize * 4;
+    m_maxTiles = qMax(16, static_cast<int>(bytes / tileBytes));
+    while (static_cast<int>(m_lru.size()) > m_maxTiles) {
+        m_index.remove(m_lru.back()->key);
+        m_lru.pop_back();
+    }
+}
+
+int VirtualTexture::residentTiles() const {
+    QMutexLocker locker(&m_cacheMutex);
+    return static_cast<int>(m_lru.size());
+}
+
+VirtualTexture::TilePtr VirtualTexture::tile(int level, int tx, int ty) const {
+    const quint64 key = tileKey(level, tx, ty);
+
+    QMutexLocker locker(&m_cacheMutex);
+    auto it = m_index.find(key);
+    if (it != m_index.end()) {
+        m_lru.splice(m_lru.begin(), m_lru, it.value());
+        return m_lru.front();
+    }
+
+    // 初めて触れたタイルだけをマップする
+    const Level& l = m_levels[level];
+    const qint64 tileBytes = qint64(m_tileSize) * m_tileSize * 4;
+    const qint64 offset = l.offset + (qint64(ty) * l.tilesX + tx) * tileBytes;
+    uchar* data = nullptr;
+    {
+        QMutexLocker fileLocker(&m_file->mutex);
+        data = m_file->file.map(offset, tileBytes);
+    }
+    if (!data) {
+        return nullptr;
+    }
+
+    std::shared_ptr<FileHandle> file = m_file;
+    TilePtr tile(new Tile{key, data}, [file](const Tile* t) {
+        QMutexLocker fileLocker(&file->mutex);
+        file->file.unmap(const_cast<uchar*>(t->data));
+        delete t;
+    });
+    m_lru.push_front(tile);
+    m_index.insert(key, m_lru.begin());
+
+    while (static_cast<int>(m_lru.size()) > m_maxTiles) {
+        // サンプル中のスレッドが参照していれば、その参照が外れた時点でアンマップされる
+        m_index.remove(m_lru.back()->key);
+        m_lru.pop_back();
+    }
+    return tile;
+}
+
+const uchar* VirtualTexture::texel(int level, int x, int y, TileCursor& cursor) const {
+    const int tx = x / m_tileSize;
+    const int ty = y / m_tileSize;
+    const quint64 key = tileKey(level, tx, ty);
+    if (cursor.textureId != m_id) {
+        const quint64 epoch = cursor.epoch;
+        cursor = TileCursor();
+        cursor.epoch = epoch;
+        cursor.textureId = m_id;
+    }
+
+    // 直前のタイル、次に隣のタイルを見てから、なければロックして取得する
+    int slot = cursor.last;
+    if (cursor.keys[slot] != key) {
+        slot = -1;
+        for (int i = 0; i < TileCursor::Slots; ++i) {
+            if (cursor.keys[i] == key) {
+                slot = i;
+                break;
+            }
+        }
+        if (slot < 0) {
+            slot = cursor.next;
+            cursor.next = (cursor.next + 1) % TileCursor::Slots;
+            cursor.keys[slot] = key;
+            cursor.tiles[slot] = tile(level, tx, ty);
+        }
+        cursor.last = slot;
+    }
+
+    const TilePtr& t = cursor.tiles[slot];
+    if (!t) {
+        return kMissingTexel;
+    }
+    const int lx = x - tx * m_tileSize;
+    const int ly = y - ty * m_tileSize;
+    return t->data + (static_cast<size_t>(ly) * m_tileSize + lx) * 4;
+}
+
+void VirtualTexture::sample(double u, double v, double footprint, Filter filter, bool repeat, float rgba[4]) const {
+    if (m_levels.isEmpty()) {
+        rgba[0] = rgba[1] = rgba[2] = 0.0f;
+        rgba[3] = 1.0f;
+        return;
+    }
+
+    // スレッドごとのカーソル（ミップレベルの偶奇ごと）。隣接ピクセルはほぼ同じタイルを読む
+    static thread_local TileCursor cursors[2];
+    const quint64 epoch = g_releaseEpoch.load(std::memory_order_relaxed);
+    if (cursors[0].epoch != epoch) {
+        // 破棄されたテクスチャのタイルを持ち続けない
+        for (TileCursor& cursor : cursors) {
+            cursor = TileCursor();
+            cursor.epoch = epoch;
+        }
+    }
+
+    if (filter == Filter::Closest) {
+        fetchClosest(0, u, v, repeat, cursors[0], rgba);
+        return;
+    }
+
+    double lod = 0.0;
+    if (filter == Filter::Mipmap && footprint > 0.0) {
+        double texels = footprint * qMax(width(), height());
+        if (texels > 1.0) {
+            lod = qMin(std::log2(texels), static_cast<double>(m_levels.size() - 1));
+        }
+    }
+
+    const int l0 = static_cast<int>(lod);
+    const float t = static_cast<float>(lod - l0);
+    fetchBilinear(l0, u, v, repeat, cursors[l0 & 1], rgba);
+
+    if (t > 0.0f && l0 + 1 < m_levels.size()) {
+        float next[4];
+        fetchBilinear(l0 + 1, u, v, repeat, cursors[(l0 + 1) & 1], next);
+        for (int c = 0; c < 4; ++c) {
+            rgba[c] += (next[c] - rgba[c]) * t;
+        }
+    }
+}
+
+void VirtualTexture::fetchClosest(int level, double u, double v, bool repeat, TileCursor& cursor, float rgba[4]) const {
+    const Level& l = m_levels[level];
+    if (repeat) {
+        u -= std::floor(u);
+        v -= std::floor(v);
+    }
+    const int x = qBound(0, static_cast<int>(u * l.width), l.width - 1);
+    const int y = qBound(0, static_cast<int>(v * l.height), l.height - 1);
+    const uchar* p = texel(level, x, y, cursor);
+    for (int c = 0; c < 4; ++c) {
+        rgba[c] = p[c] * (1.0f / 255.0f);
+    }
+}
+
+void VirtualTexture::fetchBilinear(int level, double u, double v, bool repeat, TileCursor& cursor, float rgba[4]) const {
+    const Level& l = m_levels[level];
+    const double fx = u * l.width - 0.5;
+    const double fy = v * l.height - 0.5;
+    const double flx = std::floor(fx);
+    const double fly = std::floor(fy);
+    const float tx = static_cast<float>(fx - flx);
+    const float ty = static_cast<float>(fy - fly);
+
+    const int x0 = wrapIndex(static_cast<int>(flx), l.width, repeat);
+    const int x1 = wrapIndex(static_cast<int>(flx) + 1, l.width, repeat);
+    const int y0 = wrapIndex(static_cast<int>(fly), l.height, repeat);
+    const int y1 = wrapIndex(static_cast<int>(fly) + 1, l.height, repeat);
+
+    // タイル境界をまたぐとスロットが置き換わることがあるので値をコピーしておく
+    uchar p00[4], p10[4], p01[4], p11[4];
+    memcpy(p00, texel(level, x0, y0, cursor), 4);
+    memcpy(p10, texel(level, x1, y0, cursor), 4);
+    memcpy(p01, texel(level, x0, y1, cursor), 4);
+    memcpy(p11, texel(level, x1, y1, cursor), 4);
+
+    for (int c = 0; c < 4; ++c) {
+        const float top = p00[c] + (p10[c] - p00[c]) * tx;
+        const float bottom = p01[c] + (p11[c] - p01[c]) * tx;
+        rgba[c] = (top + (bottom - top) * ty) * (1.0f / 255.0f);
+    }
+}
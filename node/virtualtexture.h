@@ -0,0 +1,104 @@
+#ifndef VIRTUALTEXTURE_H
+#define VIRTUALTEXTURE_H
+
+#include "texturesource.h"
+#include <QHash>
+#include <QMutex>
+#include <QString>
+#include <QVector>
+#include <QtGlobal>
+#include <list>
+#include <memory>
+
+class QFile;
+
+// Virtual Texture - very large images streamed from a tiled mip-mapped
+// file (.vtex). Tiles are memory-mapped on first touch and unmapped when
+// they fall out of an LRU cache, so resident memory follows the UV
+// footprint of the render rather than the size of the source.
+//
+// File layout (little endian):
+//   "VTEX" | version | width | height | tileSize | levelCount       (u32)
+//   per level: width | height | tilesX | tilesY (u32), offset (u64)
+//   tiles: row-major per level, tileSize^2 RGBA8888 texels each,
+//          edge tiles padded by repeating the last row/column
+class VirtualTexture : public TextureSource {
+public:
+    static constexpr int DefaultTileSize = 256;
+
+    // これ以上のピクセル数の画像はタイル形式に変換してストリーミングする
+    static constexpr qint64 StreamingThreshold = qint64(8192) * 8192;
+
+    // One-time conversion from any format Qt can read (PNG, TIFF, ...).
+    // Writes atomically; returns false and fills 'error' on failure.
+    static bool convert(const QString& sourcePath, const QString& targetPath,
+                        int tileSize = DefaultTileSize, QString* error = nullptr);
+
+    static std::shared_ptr<const VirtualTexture> open(const QString& path);
+
+    ~VirtualTexture() override;
+
+    int width() const override { return m_levels.isEmpty() ? 0 : m_levels[0].width; }
+    int height() const override { return m_levels.isEmpty() ? 0 : m_levels[0].height; }
+    int levelCount() const { return m_levels.size(); }
+    size_t byteSize() const override;  // マップ中のタイルのバイト数
+
+    void sample(double u, double v, double footprint, Filter filter, bool repeat, float rgba[4]) const override;
+
+    // Tile cache budget in bytes for this texture (default 256 MiB)
+    void setCacheBudget(size_t bytes);
+    int residentTiles() const;
+
+private:
+    struct Level {
+        int width;
+        int height;
+        int tilesX;
+        int tilesY;
+        qint64 offset;
+    };
+
+    // マップ済みのタイル。最後の参照が外れたときにアンマップされる
+    struct Tile {
+        quint64 key;
+        const uchar* data;
+    };
+    using TilePtr = std::shared_ptr<const Tile>;
+
+    // 直近に使ったタイルを保持して、連続フェッチでロックを避ける
+    // Slots hold up to the 2x2 tiles around a tile corner, so bilinear taps
+    // straddling a tile edge hit without relocking. sample() keeps one cursor
+    // per mip level parity so trilinear fetches do not evict each other.
+    // A cursor is dropped whenever any virtual texture is destroyed, so a
+    // thread does not keep a released texture's tile and file mapped.
+    struct TileCursor {
+        static constexpr int Slots = 4;
+        quint64 epoch = 0;
+        quint64 textureId = 0;
+        quint64 keys[Slots] = {~quint64(0), ~quint64(0), ~quint64(0), ~quint64(0)};
+        TilePtr tiles[Slots];
+        int last = 0;  // 直前にヒットしたスロット
+        int next = 0;  // 次に置き換えるスロット
+    };
+
+    struct FileHandle;
+
+    VirtualTexture() = default;
+
+    TilePtr tile(int level, int tx, int ty) const;
+    const uchar* texel(int level, int x, int y, TileCursor& cursor) const;
+    void fetchClosest(int level, double u, double v, bool repeat, TileCursor& cursor, float rgba[4]) const;
+    void fetchBilinear(int level, double u, double v, bool repeat, TileCursor& cursor, float rgba[4]) const;
+
+    quint64 m_id = 0;
+    int m_tileSize = DefaultTileSize;
+    QVector<Level> m_levels;
+    std::shared_ptr<FileHandle> m_file;
+
+    mutable QMutex m_cacheMutex;
+    mutable std::list<TilePtr> m_lru;  // 先頭が最近使用
+    mutable QHash<quint64, std::list<TilePtr>::iterator> m_index;
+    int m_maxTiles = 0;
+};
+
+#endif // VIRTUALTEXTURE_H
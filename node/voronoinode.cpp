@@ -57,29 +57,25 @@ VoronoiNode::VoronoiNode()
     addOutputSocket(m_radiusOutput);
 }
 
-QVector<Node::ParameterInfo> VoronoiNode::parameters() const {
+QVector<Node::ParameterInfo> VoronoiNode::describeParameters() const {
     return {
         ParameterInfo("Dimensions", {"2D", "3D", "4D"}, 
-            QVariant::fromValue(static_cast<int>(m_dimensions)),
-            [this](const QVariant& v) { 
-                const_cast<VoronoiNode*>(this)->setDimensions(static_cast<Dimensions>(v.toInt())); 
-            }),
+            QVariant::fromValue(static_cast<int>(m_dimensions)))
+            .bind<VoronoiNode>([](const VoronoiNode& n) { return static_cast<int>(n.m_dimensions); },
+                               [](VoronoiNode& n, const QVariant& v) { n.setDimensions(static_cast<Dimensions>(v.toInt())); }),
         ParameterInfo("Feature", 
             {"F1", "F2", "Smooth F1", "Distance to Edge", "N-Sphere Radius"},
-            QVariant::fromValue(static_cast<int>(m_feature)),
-            [this](const QVariant& v) {
-                const_cast<VoronoiNode*>(this)->setFeature(static_cast<Feature>(v.toInt()));
-            }),
+            QVariant::fromValue(static_cast<int>(m_feature)))
+            .bind<VoronoiNode>([](const VoronoiNode& n) { return static_cast<int>(n.m_feature); },
+                               [](VoronoiNode& n, const QVariant& v) { n.setFeature(static_cast<Feature>(v.toInt())); }),
         ParameterInfo("Metric", 
             {"Euclidean", "Manhattan", "Chebyshev", "Minkowski"},
-            QVariant::fromValue(static_cast<int>(m_metric)),
-            [this](const QVariant& v) {
-                const_cast<VoronoiNode*>(this)->setMetric(static_cast<Metric>(v.toInt()));
-            }),
-        ParameterInfo("Normalize", m_normalize,
-            [this](const QVariant& v) {
-                const_cast<VoronoiNode*>(this)->setNormalize(v.toBool());
-            }),
+            QVariant::fromValue(static_cast<int>(m_metric)))
+            .bind<VoronoiNode>([](const VoronoiNode& n) { return static_cast<int>(n.m_metric); },
+                               [](VoronoiNode& n, const QVariant& v) { n.setMetric(static_cast<Metric>(v.toInt())); }),
+        ParameterInfo("Normalize", m_normalize)
+            .bind<VoronoiNode>([](const VoronoiNode& n) { return n.m_normalize; },
+                               [](VoronoiNode& n, const QVariant& v) { n.setNormalize(v.toBool()); }),
         ParameterInfo("Scale", 0.0, 100.0, 5.0),
         ParameterInfo("Randomness", 0.0, 1.0, 1.0),
         ParameterInfo("Detail", 0.0, 15.0, 0.0),
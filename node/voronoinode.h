@@ -11,8 +11,6 @@ public:
     void evaluate() override;
     QVariant compute(const QVector3D& pos, NodeSocket* socket) override;
 
-    QVector<ParameterInfo> parameters() const override;
-
     // Dimensions
     enum class Dimensions {
         D2,
@@ -65,6 +63,9 @@ public:
     QJsonObject save() const override;
     void restore(const QJsonObject& json) override;
 
+protected:
+    QVector<ParameterInfo> describeParameters() const override;
+
 private:
     Dimensions m_dimensions;
     Metric m_metric;
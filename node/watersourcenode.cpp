@@ -6,6 +6,8 @@
 #include <QColor>
 #include <QVector2D>
 #include <QJsonArray>
+#include <QRegularExpression>
+#include <limits>
 
 WaterSourceNode::WaterSourceNode() : Node("Water Source") {
     m_noise = std::make_unique<PerlinNoise>();
@@ -76,6 +78,7 @@ WaterSourceNode::~WaterSourceNode() {}
 
 void WaterSourceNode::clearStops() {
     m_stops.clear();
+    rebuildRamp();
     setDirty(true);
 }
 
@@ -84,12 +87,14 @@ void WaterSourceNode::addStop(double pos, const QColor& color) {
     std::sort(m_stops.begin(), m_stops.end(), [](const Stop& a, const Stop& b) {
         return a.position < b.position;
     });
+    rebuildRamp();
     setDirty(true);
 }
 
 void WaterSourceNode::removeStop(int index) {
     if (index >= 0 && index < m_stops.size() && m_stops.size() > 1) {
         m_stops.remove(index);
+        rebuildRamp();
         setDirty(true);
     }
 }
@@ -100,6 +105,7 @@ void WaterSourceNode::setStopPosition(int index, double pos) {
         std::sort(m_stops.begin(), m_stops.end(), [](const Stop& a, const Stop& b) {
             return a.position < b.position;
         });
+        rebuildRamp();
         setDirty(true);
     }
 }
@@ -107,39 +113,137 @@ void WaterSourceNode::setStopPosition(int index, double pos) {
 void WaterSourceNode::setStopColor(int index, const QColor& color) {
     if (index >= 0 && index < m_stops.size()) {
         m_stops[index].color = color;
+        rebuildRamp();
         setDirty(true);
     }
 }
 
-QColor WaterSourceNode::evaluateRamp(double t) {
-    t = std::max(0.0, std::min(1.0, t));
-
-    if (m_stops.isEmpty()) return Qt::black;
-    if (m_stops.size() == 1) return m_stops[0].color;
-
-    for (int i = 0; i < m_stops.size() - 1; ++i) {
-        if (t >= m_stops[i].position && t <= m_stops[i+1].position) {
-            double range = m_stops[i+1].position - m_stops[i].position;
-            if (range < 0.0001) return m_stops[i].color;
-            
-            double localT = (t - m_stops[i].position) / range;
-            
-            double r = m_stops[i].color.redF() * (1.0 - localT) + m_stops[i+1].color.redF() * localT;
-            double g = m_stops[i].color.greenF() * (1.0 - localT) + m_stops[i+1].color.greenF() * localT;
-            double b = m_stops[i].color.blueF() * (1.0 - localT) + m_stops[i+1].color.blueF() * localT;
-            double a = m_stops[i].color.alphaF() * (1.0 - localT) + m_stops[i+1].color.alphaF() * localT;
-            
-            return QColor::fromRgbF(r, g, b, a);
-        }
+void WaterSourceNode::rebuildRamp() {
+    std::atomic_store(&m_ramp, RampTable::bakeFrom(m_stops));
+}
+
+// === Lake Instances ===
+
+namespace {
+
+// fbm を maxAmp で割った値は Perlin の振幅の余裕込みで [-0.05, 1.05] に収まる
+// → 中心化したノイズの絶対値の上限
+constexpr double kNoiseBound = 0.55;
+
+// ローカル座標（半径 0.5 の湖）でグラデーションが必ず 0 になる距離
+inline double supportRadius(double distortion) {
+    return 0.5 + kNoiseBound * std::abs(distortion) * 1.5;
+}
+
+} // namespace
+
+void WaterSourceNode::setLakes(const QString& text) {
+    m_lakesText = text;
+    std::atomic_store(&m_lakeSet, buildLakeSet());
+    setDirty(true);
+}
+
+std::shared_ptr<const WaterSourceNode::LakeSet> WaterSourceNode::buildLakeSet() const {
+    auto set = std::make_shared<LakeSet>();
+
+    const QStringList entries = m_lakesText.split(QRegularExpression("[;\\n]"), Qt::SkipEmptyParts);
+    for (const QString& entry : entries) {
+        const QStringList fields = entry.split(QRegularExpression("[,\\s]+"), Qt::SkipEmptyParts);
+        if (fields.size() < 2) continue;
+        Lake lake;
+        lake.x = fields[0].toDouble();
+        lake.y = fields[1].toDouble();
+        lake.radius = fields.size() > 2 ? fields[2].toDouble() : 0.5;
+        lake.hasSeed = fields.size() > 3;
+        lake.seed = lake.hasSeed ? fields[3].toDouble() : 0.0;
+        // inf / NaN は後でグリッドの int 変換に流れ込むので捨てる
+        if (!std::isfinite(lake.x) || !std::isfinite(lake.y) || !std::isfinite(lake.radius) ||
+            !std::isfinite(lake.seed)) continue;
+        if (lake.radius <= 0.0) continue;
+        set->lakes.append(lake);
+    }
+    if (set->lakes.isEmpty()) {
+        set->lakes.append({0.0, 0.0, 0.5, 0.0, false});
+    }
+
+    // Distortion / Roughness が一定のときだけ支持半径が決まるのでグリッドを作る
+    if (m_mixFactorInput->isConnected() || m_roughnessInput->isConnected()) return set;
+    set->distortion = m_mixFactorInput->defaultValue().toDouble();
+    set->roughness = m_roughnessInput->defaultValue().toDouble();
+    if (set->roughness < 0.0) return set;
+
+    const double reach = supportRadius(set->distortion) * 2.0;  // × 半径でワールド単位
+    double minX = std::numeric_limits<double>::max(), minY = minX;
+    double maxX = -minX, maxY = -minX;
+    double sumSize = 0.0;
+    for (const Lake& lake : set->lakes) {
+        const double r = reach * lake.radius;
+        minX = std::min(minX, lake.x - r);
+        minY = std::min(minY, lake.y - r);
+        maxX = std::max(maxX, lake.x + r);
+        maxY = std::max(maxY, lake.y + r);
+        sumSize += 2.0 * r;
+    }
+    // セルは湖1つ分程度、1辺 64 セルまで
+    const double extent = std::max(maxX - minX, maxY - minY);
+    if (!std::isfinite(extent) || !std::isfinite(sumSize)) return set;  // 巨大な座標ではグリッドなし
+    set->cellSize = std::max(sumSize / set->lakes.size(), extent / 64.0);
+    set->originX = minX;
+    set->originY = minY;
+    set->cellsX = std::max(1, static_cast<int>(std::ceil((maxX - minX) / set->cellSize)));
+    set->cellsY = std::max(1, static_cast<int>(std::ceil((maxY - minY) / set->cellSize)));
+
+    const int cellCount = set->cellsX * set->cellsY;
+    auto cellRange = [&](const Lake& lake, int& x0, int& y0, int& x1, int& y1) {
+        const double r = reach * lake.radius;
+        x0 = qBound(0, static_cast<int>((lake.x - r - minX) / set->cellSize), set->cellsX - 1);
+        y0 = qBound(0, static_cast<int>((lake.y - r - minY) / set->cellSize), set->cellsY - 1);
+        x1 = qBound(0, static_cast<int>((lake.x + r - minX) / set->cellSize), set->cellsX - 1);
+        y1 = qBound(0, static_cast<int>((lake.y + r - minY) / set->cellSize), set->cellsY - 1);
+    };
+
+    set->cellStart.fill(0, cellCount + 1);
+    for (const Lake& lake : set->lakes) {
+        int x0, y0, x1, y1;
+        cellRange(lake, x0, y0, x1, y1);
+        for (int cy = y0; cy <= y1; ++cy)
+            for (int cx = x0; cx <= x1; ++cx)
+                set->cellStart[cy * set->cellsX + cx + 1]++;
+    }
+    for (int i = 0; i < cellCount; ++i) set->cellStart[i + 1] += set->cellStart[i];
+    set->cellLakes.resize(set->cellStart[cellCount]);
+    QVector<int> fill = set->cellStart;
+    for (int i = 0; i < set->lakes.size(); ++i) {
+        int x0, y0, x1, y1;
+        cellRange(set->lakes[i], x0, y0, x1, y1);
+        for (int cy = y0; cy <= y1; ++cy)
+            for (int cx = x0; cx <= x1; ++cx)
+                set->cellLakes[fill[cy * set->cellsX + cx]++] = i;
     }
+    set->hasGrid = true;
+    return set;
+}
 
-    if (t < m_stops.first().position) return m_stops.first().color;
-    if (t > m_stops.last().position) return m_stops.last().color;
+std::shared_ptr<const WaterSourceNode::LakeSet> WaterSourceNode::lakeSet() {
+    auto set = std::atomic_load(&m_lakeSet);
+    if (set) return set;
 
-    return Qt::black;
+    QMutexLocker locker(&m_mutex);
+    set = std::atomic_load(&m_lakeSet);
+    if (!set) {
+        set = buildLakeSet();
+        std::atomic_store(&m_lakeSet, set);
+    }
+    return set;
 }
 
-QVector<Node::ParameterInfo> WaterSourceNode::parameters() const {
+void WaterSourceNode::prepareRender(int width, int height) {
+    Node::prepareRender(width, height);
+    // Distortion などの既定値が変わっている可能性があるので描画ごとに作り直す（湖の数だけの手間）
+    std::atomic_store(&m_lakeSet, buildLakeSet());
+}
+
+QVector<Node::ParameterInfo> WaterSourceNode::describeParameters() const {
     return {
         ParameterInfo("Position X", -1.0, 1.0, 0.0, 0.01, "Lake center X position"),
         ParameterInfo("Position Y", -1.0, 1.0, 0.0, 0.01, "Lake center Y position"),
@@ -148,7 +252,11 @@ QVector<Node::ParameterInfo> WaterSourceNode::parameters() const {
         ParameterInfo("Detail", 1.0, 15.0, 15.0, 1.0, "Noise octaves"),
         ParameterInfo("Roughness", 0.0, 1.0, 0.736, 0.01, "Noise roughness"),
         ParameterInfo("Lacunarity", 1.0, 4.0, 2.0, 0.1, "Noise lacunarity"),
-        ParameterInfo("Seed", 0.0, 1000.0, 137.3, 1.0, "Random seed (W value)")
+        ParameterInfo("Seed", 0.0, 1000.0, 137.3, 1.0, "Random seed (W value)"),
+        ParameterInfo(ParameterInfo::String, "Lakes", m_lakesText, nullptr,
+                      "x, y, radius, seed; ... (empty = one lake at the center)")
+            .bind<WaterSourceNode>([](const WaterSourceNode& n) { return n.lakes(); },
+                                   [](WaterSourceNode& n, const QVariant& v) { n.setLakes(v.toString()); })
     };
 }
 
@@ -156,6 +264,47 @@ void WaterSourceNode::evaluate() {
     // Stateless
 }
 
+// 1つの湖のグラデーション（湖のローカル座標、半径 0.5）
+double WaterSourceNode::lakeGradient(double x, double y, double seed, const NoiseParams& params) const {
+    // === 4. Calculate Distance from Center ===
+    double centerDist = std::sqrt(x * x + y * y);
+
+    // === 5. Generate Noise (FBM) ===
+    // Use large offset to avoid (0,0) singularity in noise
+    const double NOISE_OFFSET = 100.0;
+    
+    double rawNoiseX = m_noise->fbm(
+        x * params.noiseScale + NOISE_OFFSET, 
+        y * params.noiseScale + NOISE_OFFSET, 
+        seed,
+        params.octaves, params.lacunarity, params.roughness
+    );
+    double noiseX = (rawNoiseX / params.maxAmp) - 0.5;
+    
+    double rawNoiseY = m_noise->fbm(
+        x * params.noiseScale + NOISE_OFFSET + 123.456, 
+        y * params.noiseScale + NOISE_OFFSET + 789.012, 
+        seed,
+        params.octaves, params.lacunarity, params.roughness
+    );
+    double noiseY = (rawNoiseY / params.maxAmp) - 0.5;
+
+    // === 6. Apply Distortion (Distance-based only, no tangential) ===
+    // This avoids the left-tilt issue by using noise to modulate distance directly
+    double dampRadius = 0.5;
+    double damping = std::min(centerDist / dampRadius, 1.0);
+    damping = damping * damping; // Quadratic falloff
+    
+    // Use average noise to modulate distance (symmetrical)
+    // Increased strength coefficient from 0.3 to 1.5 to make distortion more visible
+    double noiseAvg = (noiseX + noiseY) * 0.5;
+    double distortedDist = centerDist + noiseAvg * params.distortion * damping * 1.5;
+
+    // === 7. Spherical Gradient ===
+    double gradient = 1.0 - (distortedDist * 2.0);
+    return std::clamp(gradient, 0.0, 1.0);
+}
+
 QVariant WaterSourceNode::compute(const QVector3D& pos, NodeSocket* socket) {
     // === 1. Get Input Coordinates ===
     QVector3D p;
@@ -181,82 +330,77 @@ QVariant WaterSourceNode::compute(const QVector3D& pos, NodeSocket* socket) {
     p.setY(p.y() - posY);
 
     // === 3. Get Parameters ===
-    double distortion = m_mixFactorInput->isConnected() 
+    NoiseParams params;
+    params.distortion = m_mixFactorInput->isConnected() 
         ? m_mixFactorInput->getValue(pos).toDouble() 
         : m_mixFactorInput->defaultValue().toDouble();
-    double noiseScale = m_scaleInput->isConnected() 
+    params.noiseScale = m_scaleInput->isConnected() 
         ? m_scaleInput->getValue(pos).toDouble() 
         : m_scaleInput->defaultValue().toDouble();
     double detail = m_detailInput->isConnected() 
         ? m_detailInput->getValue(pos).toDouble() 
         : m_detailInput->defaultValue().toDouble();
-    double roughness = m_roughnessInput->isConnected() 
+    params.roughness = m_roughnessInput->isConnected() 
         ? m_roughnessInput->getValue(pos).toDouble() 
         : m_roughnessInput->defaultValue().toDouble();
-    double lacunarity = m_lacunarityInput->isConnected() 
+    params.lacunarity = m_lacunarityInput->isConnected() 
         ? m_lacunarityInput->getValue(pos).toDouble() 
         : m_lacunarityInput->defaultValue().toDouble();
-    double seed = m_seedInput->isConnected() 
+    params.seed = m_seedInput->isConnected() 
         ? m_seedInput->getValue(pos).toDouble() 
         : m_seedInput->defaultValue().toDouble();
 
-    // === 4. Calculate Distance from Center ===
-    double centerDist = p.length();
-
-    // === 5. Generate Noise (FBM) ===
-    int octaves = static_cast<int>(detail);
-    if (octaves < 1) octaves = 1;
+    params.octaves = static_cast<int>(detail);
+    if (params.octaves < 1) params.octaves = 1;
     
     // Normalize noise to 0..1 range to prevent lake shrinkage
     double maxAmp = 0.0;
     double amp = 1.0;
-    for(int i=0; i<octaves; ++i) {
+    for(int i=0; i<params.octaves; ++i) {
         maxAmp += amp;
-        amp *= roughness;
+        amp *= params.roughness;
     }
     if (maxAmp <= 0.0) maxAmp = 1.0;
+    params.maxAmp = maxAmp;
+
+    // 支持半径の外ではノイズを評価しない（Roughness が負だと上限が決まらない）
+    const bool bounded = params.roughness >= 0.0;
+    const double reach = supportRadius(params.distortion);
+
+    auto set = lakeSet();
+    double gradient = 0.0;
+    auto visit = [&](int index) {
+        const Lake& lake = set->lakes[index];
+        const double scale = 0.5 / lake.radius;
+        const double x = (p.x() - lake.x) * scale;
+        const double y = (p.y() - lake.y) * scale;
+        if (bounded && x * x + y * y >= reach * reach) return;
+        gradient = std::max(gradient, lakeGradient(x, y, lake.hasSeed ? lake.seed : params.seed, params));
+    };
 
-    // Use large offset to avoid (0,0) singularity in noise
-    const double NOISE_OFFSET = 100.0;
-    
-    double rawNoiseX = m_noise->fbm(
-        p.x() * noiseScale + NOISE_OFFSET, 
-        p.y() * noiseScale + NOISE_OFFSET, 
-        seed,
-        octaves, lacunarity, roughness
-    );
-    double noiseX = (rawNoiseX / maxAmp) - 0.5;
-    
-    double rawNoiseY = m_noise->fbm(
-        p.x() * noiseScale + NOISE_OFFSET + 123.456, 
-        p.y() * noiseScale + NOISE_OFFSET + 789.012, 
-        seed,
-        octaves, lacunarity, roughness
-    );
-    double noiseY = (rawNoiseY / maxAmp) - 0.5;
-
-    // === 6. Apply Distortion (Distance-based only, no tangential) ===
-    // This avoids the left-tilt issue by using noise to modulate distance directly
-    double dampRadius = 0.5;
-    double damping = std::min(centerDist / dampRadius, 1.0);
-    damping = damping * damping; // Quadratic falloff
-    
-    // Use average noise to modulate distance (symmetrical)
-    // Increased strength coefficient from 0.3 to 1.5 to make distortion more visible
-    double noiseAvg = (noiseX + noiseY) * 0.5;
-    double distortedDist = centerDist + noiseAvg * distortion * damping * 1.5;
-
-    // === 7. Spherical Gradient ===
-    double gradient = 1.0 - (distortedDist * 2.0);
-    gradient = std::clamp(gradient, 0.0, 1.0);
+    if (set->hasGrid && bounded && set->distortion == params.distortion && set->roughness == params.roughness) {
+        const int cx = static_cast<int>(std::floor((p.x() - set->originX) / set->cellSize));
+        const int cy = static_cast<int>(std::floor((p.y() - set->originY) / set->cellSize));
+        if (cx >= 0 && cx < set->cellsX && cy >= 0 && cy < set->cellsY) {
+            const int cell = cy * set->cellsX + cx;
+            for (int i = set->cellStart[cell]; i < set->cellStart[cell + 1] && gradient < 1.0; ++i) {
+                visit(set->cellLakes[i]);
+            }
+        }
+    } else {
+        for (int i = 0; i < set->lakes.size() && gradient < 1.0; ++i) {
+            visit(i);
+        }
+    }
 
     // === 8. Apply Built-in Color Ramp ===
-    QColor rampColor = evaluateRamp(gradient);
-    double fac = 0.299 * rampColor.redF() + 0.587 * rampColor.greenF() + 0.114 * rampColor.blueF();
+    float rgba[4];
+    std::atomic_load(&m_ramp)->sample(gradient, rgba);
+    double fac = 0.299 * rgba[0] + 0.587 * rgba[1] + 0.114 * rgba[2];
 
     // === 9. Output ===
     if (socket == m_colorOutput) {
-        return rampColor;
+        return QColor::fromRgbF(rgba[0], rgba[1], rgba[2], rgba[3]);
     }
     
     return fac;
@@ -294,5 +438,6 @@ void WaterSourceNode::restore(const QJsonObject& json) {
         std::sort(m_stops.begin(), m_stops.end(), [](const Stop& a, const Stop& b) {
             return a.position < b.position;
         });
+        rebuildRamp();
     }
 }
@@ -2,6 +2,7 @@
 #define WATERSOURCENODE_H
 
 #include "node.h"
+#include "ramptable.h"
 #include "noise.h"
 #include <memory>
 #include <QRecursiveMutex>
@@ -15,16 +16,31 @@
  * - Spherical gradient with noise distortion
  * - Built-in Color Ramp for lake size and color control
  * - Position X/Y controls for easy lake placement
+ * - Any number of lake instances; noise is only evaluated inside the
+ *   bounded support of the lakes that can reach a pixel
  */
 class WaterSourceNode : public Node {
 public:
     WaterSourceNode();
     ~WaterSourceNode() override;
 
-    QVector<ParameterInfo> parameters() const override;
-
     void evaluate() override;
     QVariant compute(const QVector3D& pos, NodeSocket* socket) override;
+    void prepareRender(int width, int height) override;
+
+    // === Lake Instances ===
+    // "x, y, radius, seed" per lake, separated by ';' or new lines.
+    // Radius (default 0.5) and seed (default: the Seed input) are optional.
+    // Empty = a single lake at the origin. Position X/Y moves the whole set.
+    struct Lake {
+        double x;
+        double y;
+        double radius;
+        double seed;
+        bool hasSeed;
+    };
+    QString lakes() const { return m_lakesText; }
+    void setLakes(const QString& text);
 
     // === Built-in Color Ramp ===
     struct Stop {
@@ -42,8 +58,42 @@ public:
     QJsonObject save() const override;
     void restore(const QJsonObject& json) override;
 
+protected:
+    QVector<ParameterInfo> describeParameters() const override;
+
 private:
-    QColor evaluateRamp(double t);
+    // ストップ変更時にテーブルを焼き直す
+    void rebuildRamp();
+
+    // 湖の一覧と空間グリッド（不変、作り直して差し替える）
+    // The grid is only usable while Distortion and Roughness are constant,
+    // because the support radius depends on them.
+    struct LakeSet {
+        QVector<Lake> lakes;
+        bool hasGrid = false;
+        double distortion = 0.0;  // グリッド作成時の値
+        double roughness = 0.0;
+        double originX = 0.0;
+        double originY = 0.0;
+        double cellSize = 1.0;
+        int cellsX = 0;
+        int cellsY = 0;
+        QVector<int> cellStart;   // CSR: cellLakes[cellStart[c] .. cellStart[c+1]]
+        QVector<int> cellLakes;
+    };
+    std::shared_ptr<const LakeSet> buildLakeSet() const;
+    std::shared_ptr<const LakeSet> lakeSet();
+
+    struct NoiseParams {
+        double distortion;
+        double noiseScale;
+        int octaves;
+        double roughness;
+        double lacunarity;
+        double seed;
+        double maxAmp;
+    };
+    double lakeGradient(double x, double y, double seed, const NoiseParams& params) const;
 
     std::unique_ptr<PerlinNoise> m_noise;
     mutable QRecursiveMutex m_mutex;
@@ -65,6 +115,10 @@ private:
 
     // Built-in Color Ramp
     QVector<Stop> m_stops;
+    std::shared_ptr<const RampTable> m_ramp;
+
+    QString m_lakesText;
+    std::shared_ptr<const LakeSet> m_lakeSet;
 };
 
 #endif // WATERSOURCENODE_H
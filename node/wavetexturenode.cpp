@@ -44,29 +44,29 @@ void WaveTextureNode::evaluate() {
     // Stateless
 }
 
-QVector<Node::ParameterInfo> WaveTextureNode::parameters() const {
+QVector<Node::ParameterInfo> WaveTextureNode::describeParameters() const {
     QVector<ParameterInfo> params;
     
     // Wave Type
     QStringList types = {"Bands", "Rings"};
     params.append(ParameterInfo("Wave Type", types, 
-        QVariant::fromValue(static_cast<int>(m_waveType)),
-        [this](const QVariant& v) { const_cast<WaveTextureNode*>(this)->setWaveType(static_cast<WaveType>(v.toInt())); }
-    ));
+        QVariant::fromValue(static_cast<int>(m_waveType)))
+        .bind<WaveTextureNode>([](const WaveTextureNode& n) { return static_cast<int>(n.m_waveType); },
+                               [](WaveTextureNode& n, const QVariant& v) { n.setWaveType(static_cast<WaveType>(v.toInt())); }));
 
     // Direction
     QStringList dirs = {"X", "Y", "Z", "Diagonal"};
     params.append(ParameterInfo("Direction", dirs, 
-        QVariant::fromValue(static_cast<int>(m_waveDirection)),
-        [this](const QVariant& v) { const_cast<WaveTextureNode*>(this)->setWaveDirection(static_cast<WaveDirection>(v.toInt())); }
-    ));
+        QVariant::fromValue(static_cast<int>(m_waveDirection)))
+        .bind<WaveTextureNode>([](const WaveTextureNode& n) { return static_cast<int>(n.m_waveDirection); },
+                               [](WaveTextureNode& n, const QVariant& v) { n.setWaveDirection(static_cast<WaveDirection>(v.toInt())); }));
 
     // Profile
     QStringList profiles = {"Sin", "Saw", "Tri"};
     params.append(ParameterInfo("Profile", profiles, 
-        QVariant::fromValue(static_cast<int>(m_waveProfile)),
-        [this](const QVariant& v) { const_cast<WaveTextureNode*>(this)->setWaveProfile(static_cast<WaveProfile>(v.toInt())); }
-    ));
+        QVariant::fromValue(static_cast<int>(m_waveProfile)))
+        .bind<WaveTextureNode>([](const WaveTextureNode& n) { return static_cast<int>(n.m_waveProfile); },
+                               [](WaveTextureNode& n, const QVariant& v) { n.setWaveProfile(static_cast<WaveProfile>(v.toInt())); }));
 
     params.append(ParameterInfo("Scale", 0.0, 100.0, 5.0));
     params.append(ParameterInfo("Distortion", 0.0, 100.0, 0.0));
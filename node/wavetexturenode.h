@@ -10,7 +10,6 @@ public:
 
     void evaluate() override;
     QVariant compute(const QVector3D& pos, NodeSocket* socket) override;
-    QVector<ParameterInfo> parameters() const override;
 
     enum class WaveType { Bands, Rings };
     enum class WaveProfile { Sin, Saw, Tri };
@@ -25,6 +24,9 @@ public:
     WaveDirection waveDirection() const { return m_waveDirection; }
     void setWaveDirection(WaveDirection d);
 
+protected:
+    QVector<ParameterInfo> describeParameters() const override;
+
 private:
     NodeSocket* m_vectorInput;
     NodeSocket* m_scaleInput;